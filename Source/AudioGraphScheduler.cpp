@@ -0,0 +1,405 @@
+/**
+    bespoke synth, a software modular synthesizer
+    Copyright (C) 2021 Ryan Challinor (contact: awwbees@gmail.com)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**/
+/*
+  ==============================================================================
+
+    AudioGraphScheduler.cpp
+    Created: 3 Jul 2021 4:12:06pm
+    Author:  Ryan Challinor
+
+  ==============================================================================
+*/
+
+#include "AudioGraphScheduler.h"
+#include "IAudioSource.h"
+#include "IAudioReceiver.h"
+#include "IDrawableModule.h"
+#include "PatchCableSource.h"
+#include "OutputChannel.h"
+#include "SynthGlobals.h"
+#include "Profiler.h"
+#include <set>
+#include <unordered_map>
+#include <thread>
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#include <immintrin.h>
+#define BESPOKE_SPIN_PAUSE() _mm_pause()
+#elif defined(_M_ARM64)
+#include <intrin.h>
+#define BESPOKE_SPIN_PAUSE() __yield()
+#elif defined(__aarch64__) || defined(__arm__)
+#define BESPOKE_SPIN_PAUSE() __asm__ __volatile__("yield")
+#else
+#define BESPOKE_SPIN_PAUSE()
+#endif
+
+namespace
+{
+   //key for everything that adds into the hardware output buffers
+   IAudioReceiver* const kHardwareOutput = nullptr;
+   
+   //past this many paused spins, a wait starts yielding its time slice instead
+   const int kSpinsBeforeYield = 2000;
+   
+   void ProcessSource(IAudioSource* source, double time)
+   {
+      PROFILER_MODULE(Profiler::IsEnabled() ? dynamic_cast<IDrawableModule*>(source) : nullptr);
+      
+      gRandom.SetEngine(&source->GetRandom());
+      source->Process(time);
+      gRandom.SetEngine(nullptr);
+   }
+}
+
+AudioGraphScheduler::AudioGraphScheduler()
+: mRunningGraph(nullptr)
+, mReadyWriteIndex(0)
+, mReadyReadIndex(0)
+, mNumCompleted(0)
+, mNumActiveWorkers(0)
+, mRunning(false)
+, mTime(0)
+, mDeterministic(false)
+, mLastGeneration(0)
+{
+}
+
+AudioGraphScheduler::~AudioGraphScheduler()
+{
+   SetNumWorkers(0);
+}
+
+void AudioGraphScheduler::SetNumWorkers(int numWorkers)
+{
+   assert(!mRunning);
+
+   for (auto* worker : mWorkers)
+   {
+      worker->signalThreadShouldExit();
+      worker->Wake();
+      worker->stopThread(1000);
+      delete worker;
+   }
+   mWorkers.clear();
+
+   Profiler::StockThreadTraces();
+   for (int i=0; i<numWorkers; ++i)
+   {
+      Worker* worker = new Worker(this, i);
+      worker->startThread(10);
+      mWorkers.push_back(worker);
+   }
+}
+
+void AudioGraphScheduler::SetDeterministic(bool deterministic)
+{
+   mDeterministic = deterministic;
+   const ScopedLock lock(mRebuildLock);
+   Rebuild(vector<IAudioSource*>(mLastSources), mLastGeneration);
+}
+
+void AudioGraphScheduler::Process(const vector<IAudioSource*>& sources, uint64_t generation, double time)
+{
+   Graph& graph = const_cast<Graph&>(mGraph.Get());
+   if (mWorkers.empty() || graph.mGeneration != generation)
+   {
+      for (int i=0; i<sources.size(); ++i)
+         ProcessSource(sources[i], time);
+      return;
+   }
+
+   if (graph.mNodes.empty())
+      return;
+
+   mRunningGraph = &graph;
+   int numNodes = (int)graph.mNodes.size();
+   for (int i=0; i<numNodes; ++i)
+   {
+      graph.mPendingDependencies[i].store(graph.mNodes[i].mNumDependencies, std::memory_order_relaxed);
+      graph.mReadyQueue[i].store(-1, std::memory_order_relaxed);
+   }
+   mReadyWriteIndex.store(0, std::memory_order_relaxed);
+   mReadyReadIndex.store(0, std::memory_order_relaxed);
+   mNumCompleted.store(0, std::memory_order_relaxed);
+   mTime = time;
+   for (int root : graph.mRoots)
+      PushReady(root);
+
+   mRunning = true;
+   for (auto* worker : mWorkers)
+      worker->Wake();
+
+   WorkUntilDone();
+
+   //make sure no worker is still looking at this buffer's state before we hand it back.
+   //they're only finishing up the node they're on by now, so spin briefly and then give up the time slice.
+   mRunning = false;
+   for (int spins = 0; mNumActiveWorkers.load() > 0; ++spins)
+   {
+      if (spins < kSpinsBeforeYield)
+         BESPOKE_SPIN_PAUSE();
+      else
+         std::this_thread::yield();
+   }
+   mRunningGraph = nullptr;
+}
+
+void AudioGraphScheduler::Rebuild(const vector<IAudioSource*>& sources, uint64_t generation)
+{
+   const ScopedLock lock(mRebuildLock);
+   mLastSources = sources;
+   mLastGeneration = generation;
+
+   Graph* graph = new Graph();
+   graph->mGeneration = generation;
+   vector<Node>& nodes = graph->mNodes;
+
+   int numNodes = (int)sources.size();
+   nodes.resize(numNodes);
+
+   std::unordered_map<IAudioSource*, int> sourceIndices;
+   for (int i=0; i<numNodes; ++i)
+   {
+      nodes[i].mSource = sources[i];
+      nodes[i].mNumDependencies = 0;
+      sourceIndices[sources[i]] = i;
+   }
+
+   //audio sources that send notes, pulses or modulation down a cable act on other modules from inside Process(), in ways the audio
+   //connections don't show. those stay on the serial path: everything before them finishes first, and nothing after them starts until they're done.
+   vector<bool> serial(numNodes, false);
+   for (int i=0; i<numNodes; ++i)
+   {
+      IDrawableModule* module = dynamic_cast<IDrawableModule*>(sources[i]);
+      if (module == nullptr)
+         continue;
+      for (auto* cableSource : module->GetPatchCableSources())
+      {
+         for (auto* cable : cableSource->GetPatchCables())
+         {
+            if (cable != nullptr && cable->GetTarget() != nullptr && dynamic_cast<IAudioReceiver*>(cable->GetTarget()) == nullptr)
+               serial[i] = true;
+         }
+      }
+   }
+
+   //gather which receivers each source writes into, in serial order
+   vector< pair<IAudioReceiver*, vector<int> > > writersPerReceiver;
+   std::unordered_map<IAudioReceiver*, int> receiverIndices;
+   auto addWriter = [&writersPerReceiver, &receiverIndices](IAudioReceiver* receiver, int writer)
+   {
+      auto it = receiverIndices.find(receiver);
+      if (it == receiverIndices.end())
+      {
+         receiverIndices[receiver] = (int)writersPerReceiver.size();
+         writersPerReceiver.push_back(make_pair(receiver, vector<int>()));
+         it = receiverIndices.find(receiver);
+      }
+      vector<int>& writers = writersPerReceiver[it->second].second;
+      if (writers.empty() || writers.back() != writer)
+         writers.push_back(writer);
+   };
+
+   for (int i=0; i<numNodes; ++i)
+   {
+      IAudioSource* source = sources[i];
+      vector<IAudioReceiver*> receivers;
+      for (int j=0; j<source->GetNumTargets(); ++j)
+      {
+         if (source->GetTarget(j) != nullptr)
+            receivers.push_back(source->GetTarget(j));
+      }
+      IDrawableModule* module = dynamic_cast<IDrawableModule*>(source);
+      if (module)
+      {
+         for (auto* cableSource : module->GetPatchCableSources())
+         {
+            if (cableSource->GetAudioReceiver() != nullptr)
+               receivers.push_back(cableSource->GetAudioReceiver());
+         }
+      }
+      if (dynamic_cast<OutputChannel*>(source) != nullptr)
+         receivers.push_back(kHardwareOutput);
+
+      for (auto* receiver : receivers)
+         addWriter(receiver, i);
+   }
+
+   //edges always point from earlier to later in the serial ordering, so the graph can't have cycles,
+   //and a feedback connection keeps the one-buffer delay it has in the serial path
+   std::set< pair<int,int> > edges;
+   auto addEdge = [&edges](int a, int b)
+   {
+      if (a == b)
+         return;
+      if (a > b)
+         std::swap(a, b);
+      edges.insert(make_pair(a, b));
+   };
+
+   for (auto& entry : writersPerReceiver)
+   {
+      IAudioReceiver* receiver = entry.first;
+      const vector<int>& writers = entry.second;
+
+      if (receiver != kHardwareOutput)
+      {
+         auto it = sourceIndices.find(dynamic_cast<IAudioSource*>(receiver));
+         if (it != sourceIndices.end())
+         {
+            for (int writer : writers)
+               addEdge(writer, it->second);
+         }
+      }
+
+      if (writers.size() > 1)
+      {
+         if (mDeterministic)
+         {
+            for (size_t i=1; i<writers.size(); ++i)
+               addEdge(writers[i-1], writers[i]);
+         }
+         else
+         {
+            int group = graph->mNumExclusionGroups++;
+            for (int writer : writers)
+               nodes[writer].mExclusionGroups.push_back(group);
+         }
+      }
+   }
+
+   for (int i=0; i<numNodes; ++i)
+   {
+      if (serial[i])
+      {
+         for (int j=0; j<numNodes; ++j)
+            addEdge(i, j);
+      }
+   }
+
+   for (auto& edge : edges)
+   {
+      nodes[edge.first].mDependents.push_back(edge.second);
+      ++nodes[edge.second].mNumDependencies;
+   }
+
+   for (int i=0; i<numNodes; ++i)
+   {
+      std::sort(nodes[i].mExclusionGroups.begin(), nodes[i].mExclusionGroups.end());
+      if (nodes[i].mNumDependencies == 0)
+         graph->mRoots.push_back(i);
+   }
+
+   graph->mPendingDependencies.reset(new std::atomic<int>[MAX(numNodes, 1)]);
+   graph->mReadyQueue.reset(new std::atomic<int>[MAX(numNodes, 1)]);
+   graph->mExclusionLocks.reset(new std::atomic_flag[MAX(graph->mNumExclusionGroups, 1)]);
+   for (int i=0; i<graph->mNumExclusionGroups; ++i)
+      graph->mExclusionLocks[i].clear();
+
+   mGraph.Publish(graph);
+}
+
+void AudioGraphScheduler::WorkUntilDone()
+{
+   int numNodes = (int)mRunningGraph->mNodes.size();
+   while (mRunning && mNumCompleted.load(std::memory_order_acquire) < numNodes)
+   {
+      if (!RunNextReady())
+         BESPOKE_SPIN_PAUSE();
+   }
+}
+
+bool AudioGraphScheduler::RunNextReady()
+{
+   int index = PopReady();
+   if (index == -1)
+      return false;
+   RunNode(index);
+   return true;
+}
+
+void AudioGraphScheduler::RunNode(int index)
+{
+   Graph& graph = *mRunningGraph;
+   Node& node = graph.mNodes[index];
+
+   for (int group : node.mExclusionGroups)
+   {
+      while (graph.mExclusionLocks[group].test_and_set(std::memory_order_acquire))
+         BESPOKE_SPIN_PAUSE();
+   }
+
+   ProcessSource(node.mSource, mTime);
+
+   for (auto it = node.mExclusionGroups.rbegin(); it != node.mExclusionGroups.rend(); ++it)
+      graph.mExclusionLocks[*it].clear(std::memory_order_release);
+
+   for (int dependent : node.mDependents)
+   {
+      if (graph.mPendingDependencies[dependent].fetch_sub(1, std::memory_order_acq_rel) == 1)
+         PushReady(dependent);
+   }
+
+   mNumCompleted.fetch_add(1, std::memory_order_release);
+}
+
+void AudioGraphScheduler::PushReady(int index)
+{
+   //every node becomes ready exactly once per buffer, so each slot is only ever written once
+   int slot = mReadyWriteIndex.fetch_add(1, std::memory_order_acq_rel);
+   mRunningGraph->mReadyQueue[slot].store(index, std::memory_order_release);
+}
+
+int AudioGraphScheduler::PopReady()
+{
+   int readIndex = mReadyReadIndex.load(std::memory_order_acquire);
+   while (readIndex < mReadyWriteIndex.load(std::memory_order_acquire))
+   {
+      int index = mRunningGraph->mReadyQueue[readIndex].load(std::memory_order_acquire);
+      if (index == -1)   //slot claimed but not published yet
+         return -1;
+      if (mReadyReadIndex.compare_exchange_weak(readIndex, readIndex + 1, std::memory_order_acq_rel))
+         return index;
+   }
+   return -1;
+}
+
+AudioGraphScheduler::Worker::Worker(AudioGraphScheduler* owner, int index)
+: juce::Thread("audio worker " + juce::String(index))
+, mOwner(owner)
+{
+}
+
+void AudioGraphScheduler::Worker::run()
+{
+   FloatVectorOperations::disableDenormalisedNumberSupport();
+   gWorkChannelBuffer.Clear();   //touch this thread's scratch buffers up front, so they aren't allocated mid-buffer
+   Profiler::RegisterThread(getThreadName().toRawUTF8());
+
+   while (!threadShouldExit())
+   {
+      mWakeEvent.wait(-1);
+      if (threadShouldExit())
+         break;
+
+      mOwner->mNumActiveWorkers.fetch_add(1);
+      if (mOwner->mRunning)
+         mOwner->WorkUntilDone();
+      mOwner->mNumActiveWorkers.fetch_sub(1);
+   }
+}
@@ -0,0 +1,114 @@
+/**
+    bespoke synth, a software modular synthesizer
+    Copyright (C) 2021 Ryan Challinor (contact: awwbees@gmail.com)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**/
+/*
+  ==============================================================================
+
+    AudioGraphScheduler.h
+    Created: 3 Jul 2021 4:12:06pm
+    Author:  Ryan Challinor
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include "OpenFrameworksPort.h"
+#include "AudioThreadEpoch.h"
+#include <atomic>
+#include <memory>
+
+class IAudioSource;
+class IAudioReceiver;
+
+//runs the audio sources on a pool of worker threads, following the source->target relationships.
+//sources only start once everything that feeds into them has finished, and sources that write into
+//the same receiver never run at the same time. sources with note, pulse or modulation cables run alone, in their serial position.
+class AudioGraphScheduler
+{
+public:
+   AudioGraphScheduler();
+   ~AudioGraphScheduler();
+
+   void SetNumWorkers(int numWorkers);
+   int GetNumWorkers() const { return (int)mWorkers.size(); }
+   //in deterministic mode, sources that share a receiver always add into it in the same order as the serial path,
+   //so rendered output is bit-for-bit identical to processing mSources one at a time
+   void SetDeterministic(bool deterministic);
+   bool IsDeterministic() const { return mDeterministic; }
+
+   //off the audio thread, whenever the sources or their connections change. builds the graph the workers follow and hands it to the audio thread.
+   void Rebuild(const vector<IAudioSource*>& sources, uint64_t generation);
+
+   //call from the audio thread, with sources in their serial processing order. until the graph for this generation has been
+   //rebuilt, the sources are processed one at a time.
+   void Process(const vector<IAudioSource*>& sources, uint64_t generation, double time);
+
+private:
+   class Worker : public juce::Thread
+   {
+   public:
+      Worker(AudioGraphScheduler* owner, int index);
+      void run() override;
+      void Wake() { mWakeEvent.signal(); }
+   private:
+      AudioGraphScheduler* mOwner;
+      juce::WaitableEvent mWakeEvent;
+   };
+
+   struct Node
+   {
+      IAudioSource* mSource;
+      vector<int> mDependents;
+      int mNumDependencies;
+      vector<int> mExclusionGroups; //sorted, so they are always acquired in the same order
+   };
+
+   //the structure is fixed once it's published, only the per-buffer counters and locks change while it's running
+   struct Graph
+   {
+      Graph() : mNumExclusionGroups(0), mGeneration(0) {}
+      vector<Node> mNodes;
+      vector<int> mRoots;
+      int mNumExclusionGroups;
+      std::unique_ptr<std::atomic<int>[]> mPendingDependencies;
+      std::unique_ptr<std::atomic<int>[]> mReadyQueue;
+      std::unique_ptr<std::atomic_flag[]> mExclusionLocks;
+      uint64_t mGeneration;
+   };
+
+   void WorkUntilDone();
+   bool RunNextReady();
+   void RunNode(int index);
+   void PushReady(int index);
+   int PopReady();
+
+   AudioThreadSnapshot<Graph> mGraph;
+   Graph* mRunningGraph;   //what the workers follow during Process()
+   std::atomic<int> mReadyWriteIndex;
+   std::atomic<int> mReadyReadIndex;
+   std::atomic<int> mNumCompleted;
+   std::atomic<int> mNumActiveWorkers;
+   std::atomic<bool> mRunning;
+   double mTime;
+
+   vector<Worker*> mWorkers;
+   bool mDeterministic;
+   CriticalSection mRebuildLock;
+   vector<IAudioSource*> mLastSources;   //to rebuild from when a setting changes
+   uint64_t mLastGeneration;
+};
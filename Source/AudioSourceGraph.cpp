@@ -0,0 +1,220 @@
+/**
+    bespoke synth, a software modular synthesizer
+    Copyright (C) 2021 Ryan Challinor (contact: awwbees@gmail.com)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**/
+/*
+  ==============================================================================
+
+    AudioSourceGraph.cpp
+    Created: 5 Jul 2021 9:47:31pm
+    Author:  Ryan Challinor
+
+  ==============================================================================
+*/
+
+#include "AudioSourceGraph.h"
+#include "IAudioSource.h"
+#include "IAudioReceiver.h"
+#include "IDrawableModule.h"
+#include "PatchCableSource.h"
+
+AudioSourceGraph::AudioSourceGraph()
+: mNextGeneration(1)
+{
+}
+
+AudioSourceGraph::~AudioSourceGraph()
+{
+}
+
+void AudioSourceGraph::AddSource(IAudioSource* source)
+{
+   const ScopedLock lock(mGraphLock);
+   if (mNodes.find(source) != mNodes.end())
+      return;
+   mSources.push_back(source);
+   GatherTargets(source, mNodes[source].mTargets);
+}
+
+void AudioSourceGraph::RemoveSource(IAudioSource* source)
+{
+   const ScopedLock lock(mGraphLock);
+   RemoveFromVector(source, mSources);
+   mNodes.erase(source);
+}
+
+void AudioSourceGraph::UpdateTargets(IAudioSource* source)
+{
+   const ScopedLock lock(mGraphLock);
+   auto it = mNodes.find(source);
+   if (it != mNodes.end())
+      GatherTargets(source, it->second.mTargets);
+}
+
+void AudioSourceGraph::UpdateAllTargets()
+{
+   const ScopedLock lock(mGraphLock);
+   for (auto& node : mNodes)
+      GatherTargets(node.first, node.second.mTargets);
+}
+
+void AudioSourceGraph::Clear()
+{
+   const ScopedLock lock(mGraphLock);
+   mSources.clear();
+   mNodes.clear();
+}
+
+bool AudioSourceGraph::Contains(IAudioSource* source) const
+{
+   const ScopedLock lock(mGraphLock);
+   return mNodes.find(source) != mNodes.end();
+}
+
+void AudioSourceGraph::GatherTargets(IAudioSource* source, vector<IAudioSource*>& targets) const
+{
+   targets.clear();
+   auto addTarget = [&targets](IAudioReceiver* receiver)
+   {
+      IAudioSource* target = dynamic_cast<IAudioSource*>(receiver);
+      if (target != nullptr && !VectorContains(target, targets))
+         targets.push_back(target);
+   };
+
+   for (int i=0; i<source->GetNumTargets(); ++i)
+      addTarget(source->GetTarget(i));
+
+   IDrawableModule* module = dynamic_cast<IDrawableModule*>(source);
+   if (module)
+   {
+      for (auto* cableSource : module->GetPatchCableSources())
+         addTarget(cableSource->GetAudioReceiver());
+   }
+}
+
+string AudioSourceGraph::Sort()
+{
+   const ScopedLock lock(mGraphLock);
+
+   int numSources = (int)mSources.size();
+   std::unordered_map<IAudioSource*, int> indices;
+   indices.reserve(numSources);
+   for (int i=0; i<numSources; ++i)
+      indices[mSources[i]] = i;
+
+   vector<int> inDegree(numSources, 0);
+   for (auto* source : mSources)
+   {
+      for (auto* target : mNodes[source].mTargets)
+      {
+         auto it = indices.find(target);
+         if (it != indices.end() && target != source)
+            ++inDegree[it->second];
+      }
+   }
+
+   //kahn's algorithm, breaking ties by the order sources were added so the result is stable
+   AudioSourceOrdering* ordering = new AudioSourceOrdering();
+   ordering->mSources.reserve(numSources);
+   vector<int> ready;
+   ready.reserve(numSources);
+   for (int i=0; i<numSources; ++i)
+   {
+      if (inDegree[i] == 0)
+         ready.push_back(i);
+   }
+   for (size_t readIndex = 0; readIndex < ready.size(); ++readIndex)
+   {
+      IAudioSource* source = mSources[ready[readIndex]];
+      ordering->mSources.push_back(source);
+      for (auto* target : mNodes[source].mTargets)
+      {
+         auto it = indices.find(target);
+         if (it != indices.end() && target != source)
+         {
+            if (--inDegree[it->second] == 0)
+               ready.push_back(it->second);
+         }
+      }
+   }
+
+   string cycle;
+   if ((int)ordering->mSources.size() < numSources)
+   {
+      cycle = DescribeCycle(inDegree, indices);
+
+      //don't lose the sources that are part of (or downstream of) the feedback loop
+      for (int i=0; i<numSources; ++i)
+      {
+         if (inDegree[i] > 0)
+            ordering->mSources.push_back(mSources[i]);
+      }
+   }
+
+   ordering->mGeneration = mNextGeneration++;
+   mOrdering.Publish(ordering);
+
+   return cycle;
+}
+
+string AudioSourceGraph::DescribeCycle(const vector<int>& remainingInDegree, const std::unordered_map<IAudioSource*, int>& indices) const
+{
+   //every source left over still has an unprocessed source feeding into it, so walking upstream from any of them has to loop back on itself
+   int numSources = (int)mSources.size();
+   vector<int> upstream(numSources, -1);
+   for (int i=0; i<numSources; ++i)
+   {
+      if (remainingInDegree[i] == 0)
+         continue;
+      for (auto* target : mNodes.at(mSources[i]).mTargets)
+      {
+         auto it = indices.find(target);
+         if (it != indices.end() && it->second != i && remainingInDegree[it->second] > 0)
+            upstream[it->second] = i;
+      }
+   }
+
+   int start = -1;
+   for (int i=0; i<numSources && start == -1; ++i)
+   {
+      if (remainingInDegree[i] > 0)
+         start = i;
+   }
+
+   vector<int> visitOrder(numSources, -1);
+   vector<int> path;
+   int current = start;
+   while (current != -1 && visitOrder[current] == -1)
+   {
+      visitOrder[current] = (int)path.size();
+      path.push_back(current);
+      current = upstream[current];
+   }
+
+   if (current == -1)
+      return "unknown";
+
+   //path was walked against the signal flow, so read the loop back to front
+   string description;
+   for (int i=(int)path.size()-1; i>=visitOrder[current]; --i)
+   {
+      IDrawableModule* module = dynamic_cast<IDrawableModule*>(mSources[path[i]]);
+      description += (module ? module->Path() : "?") + " -> ";
+   }
+   IDrawableModule* module = dynamic_cast<IDrawableModule*>(mSources[path.back()]);
+   description += module ? module->Path() : "?";
+   return description;
+}
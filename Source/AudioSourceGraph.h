@@ -0,0 +1,82 @@
+/**
+    bespoke synth, a software modular synthesizer
+    Copyright (C) 2021 Ryan Challinor (contact: awwbees@gmail.com)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**/
+/*
+  ==============================================================================
+
+    AudioSourceGraph.h
+    Created: 5 Jul 2021 9:47:31pm
+    Author:  Ryan Challinor
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include "OpenFrameworksPort.h"
+#include "AudioThreadEpoch.h"
+#include <unordered_map>
+
+class IAudioSource;
+
+//the order in which audio sources get processed. immutable once published, so the audio thread can read it without locking.
+struct AudioSourceOrdering
+{
+   AudioSourceOrdering() : mGeneration(0) {}
+   vector<IAudioSource*> mSources;
+   uint64_t mGeneration;
+};
+
+//keeps track of which audio sources feed into which, and topologically sorts them whenever a connection changes.
+//edits happen off the audio thread, and the result is handed over with an atomic pointer swap.
+class AudioSourceGraph
+{
+public:
+   AudioSourceGraph();
+   ~AudioSourceGraph();
+
+   void AddSource(IAudioSource* source);
+   void RemoveSource(IAudioSource* source);
+   void UpdateTargets(IAudioSource* source);
+   void UpdateAllTargets();
+   void Clear();
+   bool Contains(IAudioSource* source) const;
+
+   //recomputes the ordering and publishes it. returns a description of a feedback loop if the sources aren't a DAG.
+   string Sort();
+
+   //audio thread only, between AudioThreadEpoch::EnterBuffer() and ExitBuffer()
+   const AudioSourceOrdering& GetOrdering() const { return mOrdering.Get(); }
+   //for the thread that calls Sort(), what it last published
+   const AudioSourceOrdering& GetPublishedOrdering() const { return mOrdering.Get(); }
+
+private:
+   struct Node
+   {
+      vector<IAudioSource*> mTargets;
+   };
+
+   void GatherTargets(IAudioSource* source, vector<IAudioSource*>& targets) const;
+   string DescribeCycle(const vector<int>& remainingInDegree, const std::unordered_map<IAudioSource*, int>& indices) const;
+
+   vector<IAudioSource*> mSources;  //in the order they were added
+   std::unordered_map<IAudioSource*, Node> mNodes;
+   CriticalSection mGraphLock;
+
+   AudioThreadSnapshot<AudioSourceOrdering> mOrdering;
+   uint64_t mNextGeneration;
+};
@@ -0,0 +1,40 @@
+/**
+    bespoke synth, a software modular synthesizer
+    Copyright (C) 2021 Ryan Challinor (contact: awwbees@gmail.com)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**/
+/*
+  ==============================================================================
+
+    AudioThreadEpoch.cpp
+    Created: 8 Jul 2021 7:31:15pm
+    Author:  Ryan Challinor
+
+  ==============================================================================
+*/
+
+#include "AudioThreadEpoch.h"
+#include <chrono>
+#include <thread>
+
+std::atomic<uint64_t> AudioThreadEpoch::sEpoch(0);
+std::atomic<bool> AudioThreadEpoch::sInBuffer(false);
+
+void AudioThreadEpoch::WaitUntilSafeToReclaim(uint64_t retireEpoch)
+{
+   //at most one buffer's worth of waiting
+   while (!IsSafeToReclaim(retireEpoch))
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+}
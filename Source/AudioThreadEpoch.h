@@ -0,0 +1,95 @@
+/**
+    bespoke synth, a software modular synthesizer
+    Copyright (C) 2021 Ryan Challinor (contact: awwbees@gmail.com)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**/
+/*
+  ==============================================================================
+
+    AudioThreadEpoch.h
+    Created: 8 Jul 2021 7:31:15pm
+    Author:  Ryan Challinor
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <atomic>
+#include <vector>
+#include <utility>
+
+//tracks the audio thread's progress through buffers, so that data it might still be reading can be freed once it is done with it
+class AudioThreadEpoch
+{
+public:
+   //audio thread, around each buffer
+   static void EnterBuffer() { sInBuffer = true; }
+   static void ExitBuffer() { sEpoch.fetch_add(1); sInBuffer = false; }
+
+   //other threads. anything unpublished at GetRetireEpoch() can be freed once IsSafeToReclaim() says so.
+   static uint64_t GetRetireEpoch() { return sEpoch.load(); }
+   static bool IsSafeToReclaim(uint64_t retireEpoch) { return !sInBuffer.load() || sEpoch.load() > retireEpoch; }
+   //blocks until IsSafeToReclaim(). never call this from the audio thread.
+   static void WaitUntilSafeToReclaim(uint64_t retireEpoch);
+
+private:
+   static std::atomic<uint64_t> sEpoch;
+   static std::atomic<bool> sInBuffer;
+};
+
+//publishes immutable copies of T to the audio thread. writers must be serialized by the caller.
+template<class T>
+class AudioThreadSnapshot
+{
+public:
+   AudioThreadSnapshot() : mCurrent(new T()) {}
+   ~AudioThreadSnapshot()
+   {
+      delete mCurrent.load();
+      for (auto& retired : mRetired)
+         delete retired.first;
+   }
+
+   //only valid until the end of the current audio buffer
+   const T& Get() const { return *mCurrent.load(std::memory_order_acquire); }
+
+   void Publish(T* value)
+   {
+      T* old = mCurrent.exchange(value, std::memory_order_acq_rel);
+      mRetired.push_back(std::make_pair(old, AudioThreadEpoch::GetRetireEpoch()));
+      Reclaim();
+   }
+
+   void Reclaim()
+   {
+      for (auto it = mRetired.begin(); it != mRetired.end();)
+      {
+         if (AudioThreadEpoch::IsSafeToReclaim(it->second))
+         {
+            delete it->first;
+            it = mRetired.erase(it);
+         }
+         else
+         {
+            ++it;
+         }
+      }
+   }
+
+private:
+   std::atomic<T*> mCurrent;
+   std::vector< std::pair<T*, uint64_t> > mRetired;
+};
@@ -52,12 +52,14 @@ BandVocoder::BandVocoder()
 , mMaxBandSlider(nullptr)
 , mSpacingStyle(0)
 , mCarrierDataSet(false)
+, mFiltersChanged(true)
+, mFilterParamsChanged(false)
 {
    mCarrierInputBuffer = new float[GetBuffer()->BufferSize()];
    Clear(mCarrierInputBuffer, GetBuffer()->BufferSize());
    
-   mWorkBuffer = new float[GetBuffer()->BufferSize()];
-   Clear(mWorkBuffer, GetBuffer()->BufferSize());
+   mWorkBuffer = new float[GetBuffer()->BufferSize() * BiquadBank::kNumLanes];
+   Clear(mWorkBuffer, GetBuffer()->BufferSize() * BiquadBank::kNumLanes);
    
    mOutBuffer = new float[GetBuffer()->BufferSize()];
    Clear(mOutBuffer, GetBuffer()->BufferSize());
@@ -129,33 +131,52 @@ void BandVocoder::Process(double time)
    Mult(GetBuffer()->GetChannel(0), inputPreampSq * 5, bufferSize);
    Mult(mCarrierInputBuffer, carrierPreampSq * 5, bufferSize);
    
-   for (int i=0; i<mNumBands; ++i)
+   if (mFiltersChanged.exchange(false, std::memory_order_acquire))
    {
-      //get modulator band
-      BufferCopy(mWorkBuffer,GetBuffer()->GetChannel(0), bufferSize);
-      mBiquadCarrier[i].Filter(mWorkBuffer, bufferSize);
-      
-      float oldPeak = mPeaks[i].GetPeak();
-      
-      //calculate modulator band level
-      mPeaks[i].Process(mWorkBuffer, bufferSize);
+      const BandCoefficients& coefficients = mBandCoefficients.Get();
+      for (int i=0; i<coefficients.mNumBands; ++i)
+      {
+         mModulatorBands[i / BiquadBank::kNumLanes].SetTarget(0, i % BiquadBank::kNumLanes, coefficients.mBands[i]);
+         mCarrierBands[i / BiquadBank::kNumLanes].SetTarget(0, i % BiquadBank::kNumLanes, coefficients.mBands[i]);
+      }
+   }
+   int numBands = mBandCoefficients.Get().mNumBands;   //mNumBands can be ahead of the coefficients until Poll() catches up
+   
+   float* bandBuffers[BiquadBank::kNumLanes];
+   for (int lane=0; lane<BiquadBank::kNumLanes; ++lane)
+      bandBuffers[lane] = mWorkBuffer + lane * bufferSize;
+   
+   //bands run four at a time, one in each lane of a bank
+   for (int firstBand=0; firstBand<numBands; firstBand += BiquadBank::kNumLanes)
+   {
+      int group = firstBand / BiquadBank::kNumLanes;
+      int numBandsInGroup = MIN(BiquadBank::kNumLanes, numBands - firstBand);
       
-      //get carrier band
-      BufferCopy(mWorkBuffer,mCarrierInputBuffer, bufferSize);
-      mBiquadOut[i].Filter(mWorkBuffer, bufferSize);
+      //get modulator bands
+      mModulatorBands[group].ProcessSplit(GetBuffer()->GetChannel(0), bandBuffers, numBandsInGroup, bufferSize);
       
-      //multiply carrier band by modulator band level
-      //Mult(mWorkBuffer, mPeaks[i].GetPeak(), bufferSize);
-      for (int j=0; j<bufferSize; ++j)
-         mWorkBuffer[j] *= ofMap(j,0,bufferSize,oldPeak,mPeaks[i].GetPeak());
+      //calculate modulator band levels
+      float oldPeaks[BiquadBank::kNumLanes];
+      for (int lane=0; lane<numBandsInGroup; ++lane)
+      {
+         oldPeaks[lane] = mPeaks[firstBand + lane].GetPeak();
+         mPeaks[firstBand + lane].Process(bandBuffers[lane], bufferSize);
+      }
       
-      //don't allow a band to go crazy
-      /*mOutputPeaks[i].Process(mWorkBuffer, bufferSize);
-      if (mOutputPeaks[i].GetPeak() > mMaxBand)
-         Mult(mWorkBuffer, 1/mOutputPeaks[i].GetPeak(), bufferSize);*/
+      //get carrier bands
+      mCarrierBands[group].ProcessSplit(mCarrierInputBuffer, bandBuffers, numBandsInGroup, bufferSize);
       
-      //accumulate output band into total output
-      Add(mOutBuffer, mWorkBuffer, bufferSize);
+      for (int lane=0; lane<numBandsInGroup; ++lane)
+      {
+         //multiply carrier band by modulator band level
+         float* band = bandBuffers[lane];
+         float newPeak = mPeaks[firstBand + lane].GetPeak();
+         for (int j=0; j<bufferSize; ++j)
+            band[j] *= ofMap(j,0,bufferSize,oldPeaks[lane],newPeak);
+         
+         //accumulate output band into total output
+         Add(mOutBuffer, band, bufferSize);
+      }
    }
 
    Mult(mOutBuffer, mDryWet * volSq, bufferSize);
@@ -225,6 +246,12 @@ void BandVocoder::DrawModule()
    }
 }
 
+void BandVocoder::Poll()
+{
+   if (mFilterParamsChanged.exchange(false, std::memory_order_acquire))
+      CalcFilters();
+}
+
 void BandVocoder::CalcFilters()
 {
    for (int i=0; i<mNumBands; ++i)
@@ -241,20 +268,25 @@ void BandVocoder::CalcFilters()
          f = ofLerp(fExp, fBass, -mSpacingStyle);
       
       mBiquadCarrier[i].SetFilterType(kFilterType_Bandpass);
-      mBiquadOut[i].SetFilterType(kFilterType_Bandpass);
       mBiquadCarrier[i].SetFilterParams(f, mQ);
-      mBiquadOut[i].CopyCoeffFrom(mBiquadCarrier[i]);
    }
+   
+   BandCoefficients* coefficients = new BandCoefficients();
+   coefficients->mNumBands = mNumBands;
+   for (int i=0; i<mNumBands; ++i)
+      coefficients->mBands[i] = mBiquadCarrier[i];
+   mBandCoefficients.Publish(coefficients);
+   mFiltersChanged.store(true, std::memory_order_release);   //the audio thread picks up the new coefficients and ramps to them
 }
 
 void BandVocoder::CheckboxUpdated(Checkbox* checkbox)
 {
    if (checkbox == mEnabledCheckbox)
    {
-      for (int i = 0; i < VOCODER_MAX_BANDS; ++i)
+      for (int i = 0; i < kNumBandGroups; ++i)
       {
-         mBiquadCarrier[i].Clear();
-         mBiquadOut[i].Clear();
+         mModulatorBands[i].Clear();
+         mCarrierBands[i].Clear();
       }
    }
 }
@@ -263,7 +295,7 @@ void BandVocoder::IntSliderUpdated(IntSlider* slider, int oldVal)
 {
    if (slider == mNumBandsSlider)
    {
-      CalcFilters();
+      mFilterParamsChanged.store(true, std::memory_order_release);
    }
 }
 
@@ -271,7 +303,7 @@ void BandVocoder::FloatSliderUpdated(FloatSlider* slider, float oldVal)
 {
    if (slider == mFBaseSlider || slider == mFRangeSlider || slider == mQSlider || slider == mSpacingStyleSlider)
    {
-      CalcFilters();
+      mFilterParamsChanged.store(true, std::memory_order_release);
    }
    if (slider == mRingTimeSlider)
    {
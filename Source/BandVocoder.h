@@ -35,6 +35,9 @@
 #include "BiquadFilterEffect.h"
 #include "VocoderCarrierInput.h"
 #include "PeakTracker.h"
+#include "BiquadBank.h"
+#include "AudioThreadEpoch.h"
+#include <atomic>
 
 #define VOCODER_MAX_BANDS 64
 
@@ -58,6 +61,9 @@ public:
    
    void SetEnabled(bool enabled) override { mEnabled = enabled; }
    
+   //IPollable
+   void Poll() override;
+   
    void CheckboxUpdated(Checkbox* checkbox) override;
    void FloatSliderUpdated(FloatSlider* slider, float oldVal) override;
    void IntSliderUpdated(IntSlider* slider, int oldVal) override;
@@ -76,7 +82,7 @@ private:
    
    float* mCarrierInputBuffer;
    
-   float* mWorkBuffer;
+   float* mWorkBuffer;   //one buffer for each lane of a band group
    float* mOutBuffer;
    
    float mInputPreamp;
@@ -102,8 +108,21 @@ private:
    float mSpacingStyle;
    FloatSlider* mSpacingStyleSlider;
    
-   BiquadFilter mBiquadCarrier[VOCODER_MAX_BANDS];
-   BiquadFilter mBiquadOut[VOCODER_MAX_BANDS];
+   static const int kNumBandGroups = VOCODER_MAX_BANDS / BiquadBank::kNumLanes;
+   
+   //the coefficients CalcFilters() last worked out, copied so the audio thread never reads them while they're being changed
+   struct BandCoefficients
+   {
+      int mNumBands{ 0 };
+      BiquadFilter mBands[VOCODER_MAX_BANDS];
+   };
+   
+   BiquadFilter mBiquadCarrier[VOCODER_MAX_BANDS];   //parameters and coefficient math for each band, ui thread only
+   AudioThreadSnapshot<BandCoefficients> mBandCoefficients;
+   BiquadBank mModulatorBands[kNumBandGroups];   //four bands per bank, one in each lane
+   BiquadBank mCarrierBands[kNumBandGroups];
+   std::atomic<bool> mFiltersChanged;
+   std::atomic<bool> mFilterParamsChanged;   //set by the slider callbacks, which can run on the audio thread when modulated. Poll() recalculates.
    PeakTracker mPeaks[VOCODER_MAX_BANDS];
    PeakTracker mOutputPeaks[VOCODER_MAX_BANDS];
 
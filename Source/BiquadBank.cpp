@@ -0,0 +1,145 @@
+/**
+    bespoke synth, a software modular synthesizer
+    Copyright (C) 2021 Ryan Challinor (contact: awwbees@gmail.com)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**/
+/*
+  ==============================================================================
+
+    BiquadBank.cpp
+    Created: 17 Jul 2021 3:37:21pm
+    Author:  Ryan Challinor
+
+  ==============================================================================
+*/
+
+#include "BiquadBank.h"
+#include "BiquadFilter.h"
+#include "SynthGlobals.h"
+
+BiquadBank::BiquadBank()
+: mNumStages(1)
+, mRampSamplesLeft(0)
+, mTargetsChanged(false)
+{
+   for (int stage=0; stage<kMaxStages; ++stage)
+      SetTargetPassthrough(stage);
+   StartRamp(0);
+   Clear();
+}
+
+void BiquadBank::SetNumStages(int numStages)
+{
+   assert(numStages >= 0 && numStages <= kMaxStages);
+   
+   //stages coming back into use start from silence, rather than whatever they had in them when they were dropped
+   for (int stage=mNumStages; stage<numStages; ++stage)
+   {
+      mZ1[stage] = 0.0f;
+      mZ2[stage] = 0.0f;
+   }
+   mNumStages = numStages;
+}
+
+void BiquadBank::Clear()
+{
+   for (int stage=0; stage<kMaxStages; ++stage)
+   {
+      mZ1[stage] = 0.0f;
+      mZ2[stage] = 0.0f;
+   }
+}
+
+void BiquadBank::SetTarget(int stage, int lane, const BiquadFilter& coefficientsFrom)
+{
+   mTargets[stage][kA0][lane] = coefficientsFrom.mA0;
+   mTargets[stage][kA1][lane] = coefficientsFrom.mA1;
+   mTargets[stage][kA2][lane] = coefficientsFrom.mA2;
+   mTargets[stage][kB1][lane] = coefficientsFrom.mB1;
+   mTargets[stage][kB2][lane] = coefficientsFrom.mB2;
+   mTargetsChanged = true;
+}
+
+void BiquadBank::SetTargetAllLanes(int stage, const BiquadFilter& coefficientsFrom)
+{
+   for (int lane=0; lane<kNumLanes; ++lane)
+      SetTarget(stage, lane, coefficientsFrom);
+}
+
+void BiquadBank::SetTargetPassthrough(int stage)
+{
+   for (int lane=0; lane<kNumLanes; ++lane)
+   {
+      mTargets[stage][kA0][lane] = 1;
+      for (int c=kA1; c<kNumCoefficients; ++c)
+         mTargets[stage][c][lane] = 0;
+   }
+   mTargetsChanged = true;
+}
+
+void BiquadBank::StartRamp(int numSamples)
+{
+   //stepping the coefficients linearly stays stable, since the set of stable (b1,b2) pairs is a triangle, and anything between two points in it is in it too
+   mTargetsChanged = false;
+   mRampSamplesLeft = numSamples;
+   float inverseLength = numSamples > 0 ? 1.0f / numSamples : 0;
+   for (int stage=0; stage<kMaxStages; ++stage)
+   {
+      for (int c=0; c<kNumCoefficients; ++c)
+      {
+         SimdFloat target = SimdFloat::Load(mTargets[stage][c]);
+         if (numSamples > 0)
+            mSteps[stage][c] = (target - mCoefficients[stage][c]) * inverseLength;
+         else
+            mCoefficients[stage][c] = target;
+      }
+   }
+}
+
+void BiquadBank::StartRampIfTargetsChanged(int numSamples)
+{
+   if (mTargetsChanged)
+      StartRamp(numSamples);
+}
+
+void BiquadBank::Process(float* const* channels, int numChannels, int bufferSize)
+{
+   assert(numChannels <= kNumLanes);
+   StartRampIfTargetsChanged(bufferSize);
+   
+   float lanes[kNumLanes] = {};
+   for (int i=0; i<bufferSize; ++i)
+   {
+      for (int ch=0; ch<numChannels; ++ch)
+         lanes[ch] = channels[ch][i];
+      Process(SimdFloat::Load(lanes)).Store(lanes);
+      for (int ch=0; ch<numChannels; ++ch)
+         channels[ch][i] = lanes[ch];
+   }
+}
+
+void BiquadBank::ProcessSplit(const float* input, float* const* outputs, int numOutputs, int bufferSize)
+{
+   assert(numOutputs <= kNumLanes);
+   StartRampIfTargetsChanged(bufferSize);
+   
+   float lanes[kNumLanes];
+   for (int i=0; i<bufferSize; ++i)
+   {
+      Process(SimdFloat(input[i])).Store(lanes);
+      for (int lane=0; lane<numOutputs; ++lane)
+         outputs[lane][i] = lanes[lane];
+   }
+}
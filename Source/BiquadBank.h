@@ -0,0 +1,115 @@
+/**
+    bespoke synth, a software modular synthesizer
+    Copyright (C) 2021 Ryan Challinor (contact: awwbees@gmail.com)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**/
+/*
+  ==============================================================================
+
+    BiquadBank.h
+    Created: 17 Jul 2021 3:37:21pm
+    Author:  Ryan Challinor
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include "SimdFloat.h"
+
+class BiquadFilter;
+
+//runs up to four independent biquads side by side in simd lanes (stereo channels, vocoder bands, ...), each through up to kMaxStages cascaded stages.
+//coefficients come from a configured BiquadFilter, and are ramped per sample toward new targets, so modulating a cutoff only needs the trig once per block.
+class BiquadBank
+{
+public:
+   static const int kNumLanes = SimdFloat::kNumLanes;
+   static const int kMaxStages = 8;
+   
+   BiquadBank();
+   
+   void SetNumStages(int numStages);
+   int GetNumStages() const { return mNumStages; }
+   void Clear();   //resets the filter state, keeps the coefficients
+   
+   void SetTarget(int stage, int lane, const BiquadFilter& coefficientsFrom);
+   void SetTargetAllLanes(int stage, const BiquadFilter& coefficientsFrom);
+   void SetTargetPassthrough(int stage);
+   void StartRamp(int numSamples);   //move to the targets over the next numSamples samples, or straight away for 0
+   
+   //one sample for each lane, through every stage
+   SimdFloat Process(SimdFloat input);
+   //filters each channel in place, one lane each. targets set since the last ramp are ramped to over this buffer.
+   void Process(float* const* channels, int numChannels, int bufferSize);
+   //filters the same input through every lane, into one output per lane. targets are ramped the same way.
+   void ProcessSplit(const float* input, float* const* outputs, int numOutputs, int bufferSize);
+   
+private:
+   enum Coefficient
+   {
+      kA0,
+      kA1,
+      kA2,
+      kB1,
+      kB2,
+      kNumCoefficients
+   };
+   
+   void StartRampIfTargetsChanged(int numSamples);
+   
+   SimdFloat mCoefficients[kMaxStages][kNumCoefficients];
+   SimdFloat mSteps[kMaxStages][kNumCoefficients];
+   float mTargets[kMaxStages][kNumCoefficients][kNumLanes];
+   SimdFloat mZ1[kMaxStages];
+   SimdFloat mZ2[kMaxStages];
+   int mNumStages;
+   int mRampSamplesLeft;
+   bool mTargetsChanged;
+};
+
+inline SimdFloat BiquadBank::Process(SimdFloat input)
+{
+   if (mRampSamplesLeft > 0)
+   {
+      if (--mRampSamplesLeft == 0)
+      {
+         for (int stage=0; stage<mNumStages; ++stage)
+         {
+            for (int c=0; c<kNumCoefficients; ++c)
+               mCoefficients[stage][c] = SimdFloat::Load(mTargets[stage][c]);   //land exactly on the target
+         }
+      }
+      else
+      {
+         for (int stage=0; stage<mNumStages; ++stage)
+         {
+            for (int c=0; c<kNumCoefficients; ++c)
+               mCoefficients[stage][c] = mCoefficients[stage][c] + mSteps[stage][c];
+         }
+      }
+   }
+   
+   //transposed direct form II, same as BiquadFilter::Filter()
+   for (int stage=0; stage<mNumStages; ++stage)
+   {
+      const SimdFloat* coefficients = mCoefficients[stage];
+      SimdFloat output = input * coefficients[kA0] + mZ1[stage];
+      mZ1[stage] = input * coefficients[kA1] + mZ2[stage] - coefficients[kB1] * output;
+      mZ2[stage] = input * coefficients[kA2] - coefficients[kB2] * output;
+      input = output;
+   }
+   return input;
+}
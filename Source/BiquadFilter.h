@@ -66,6 +66,8 @@ public:
    FilterType mType;
    
 private:
+   friend class BiquadBank;
+   
    double mA0;
    double mA1;
    double mA2;
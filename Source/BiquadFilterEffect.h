@@ -33,6 +33,7 @@
 #include "Slider.h"
 #include "Transport.h"
 #include "BiquadFilter.h"
+#include "BiquadBank.h"
 #include "RadioButton.h"
 
 class BiquadFilterEffect : public IAudioEffect, public IDropdownListener, public IFloatSliderListener, public IRadioButtonListener
@@ -48,8 +49,8 @@ public:
    
    void Init() override;
    
-   void SetFilterType(FilterType type) { mBiquad[0].SetFilterType(type); }
-   void SetFilterParams(float f, float q) { mBiquad[0].SetFilterParams(f, q); }
+   void SetFilterType(FilterType type) { mBiquad.SetFilterType(type); }
+   void SetFilterParams(float f, float q) { mBiquad.SetFilterParams(f, q); }
    void Clear();
    
    //IAudioEffect
@@ -84,7 +85,10 @@ private:
    FloatSlider* mGSlider;
    bool mMouseControl;
    
-   BiquadFilter mBiquad[ChannelBuffer::kMaxNumChannels];
+   static const int kModulationChunkSize = 32;
+   
+   BiquadFilter mBiquad;   //parameters and coefficient math
+   BiquadBank mFilterBank;   //one lane per channel
    ChannelBuffer mDryBuffer;
    
    bool mCoefficientsHaveChanged;
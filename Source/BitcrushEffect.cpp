@@ -34,6 +34,8 @@ BitcrushEffect::BitcrushEffect()
 , mDownsample(1)
 , mCrushSlider(nullptr)
 , mDownsampleSlider(nullptr)
+, mOversampleMode(Oversampler::kOff)
+, mOversampleDropdown(nullptr)
 {
    SetEnabled(true);
    
@@ -50,7 +52,10 @@ void BitcrushEffect::CreateUIControls()
    UIBLOCK0();
    FLOATSLIDER(mCrushSlider, "crush",&mCrush,1,24);
    FLOATSLIDER_DIGITS(mDownsampleSlider, "downsamp",&mDownsample,1,40,0);
+   DROPDOWN(mOversampleDropdown, "oversample", &mOversampleMode, 60);
    ENDUIBLOCK(mWidth, mHeight);
+   
+   Oversampler::AddModeLabels(mOversampleDropdown);
 }
 
 void BitcrushEffect::ProcessAudio(double time, ChannelBuffer* buffer)
@@ -66,22 +71,35 @@ void BitcrushEffect::ProcessAudio(double time, ChannelBuffer* buffer)
 
 	float bitDepth = powf(2, 25-mCrush);
 	float invBitDepth = 1.f / bitDepth;
+   
+   //the steps land between the original samples when oversampled, so holds are counted at the higher rate
+   mOversampler.SetMode(mOversampleMode);
+   int oversampling = mOversampler.GetFactor();
+   int length = bufferSize * oversampling;
+   int hold = (int)mDownsample * oversampling;
 
    for (int ch=0; ch<buffer->NumActiveChannels(); ++ch)
    {
-      for (int i=0; i<bufferSize; ++i)
+      float* data = buffer->GetChannel(ch);
+      if (oversampling > 1)
+         data = mOversampler.Upsample(ch, data, bufferSize);
+      
+      for (int i=0; i<length; ++i)
       {
-         if (mSampleCounter[ch] < (int)mDownsample - 1)
+         if (mSampleCounter[ch] < hold - 1)
          {
             ++mSampleCounter[ch];
          }
          else
          {
-            mHeldDownsample[ch] = buffer->GetChannel(ch)[i];
+            mHeldDownsample[ch] = data[i];
             mSampleCounter[ch] = 0;
          }
-         buffer->GetChannel(ch)[i] = ((int)(mHeldDownsample[ch]*bitDepth)) * invBitDepth;
+         data[i] = ((int)(mHeldDownsample[ch]*bitDepth)) * invBitDepth;
       }
+      
+      if (oversampling > 1)
+         mOversampler.Downsample(ch, buffer->GetChannel(ch), bufferSize);
    }
 }
 
@@ -92,6 +110,7 @@ void BitcrushEffect::DrawModule()
    
    mDownsampleSlider->Draw();
    mCrushSlider->Draw();
+   mOversampleDropdown->Draw();
 }
 
 float BitcrushEffect::GetEffectAmount()
@@ -30,8 +30,10 @@
 #include "IAudioEffect.h"
 #include "Slider.h"
 #include "Checkbox.h"
+#include "DropdownList.h"
+#include "Oversampler.h"
 
-class BitcrushEffect : public IAudioEffect, public IIntSliderListener, public IFloatSliderListener
+class BitcrushEffect : public IAudioEffect, public IIntSliderListener, public IFloatSliderListener, public IDropdownListener
 {
 public:
    BitcrushEffect();
@@ -45,11 +47,13 @@ public:
    void ProcessAudio(double time, ChannelBuffer* buffer) override;
    void SetEnabled(bool enabled) override { mEnabled = enabled; }
    float GetEffectAmount() override;
+   int GetLatency() override { return mEnabled ? (int)round(mOversampler.GetLatency()) : 0; }
    string GetType() override { return "bitcrush"; }
 
    void CheckboxUpdated(Checkbox* checkbox) override;
    void IntSliderUpdated(IntSlider* slider, int oldVal) override;
    void FloatSliderUpdated(FloatSlider* slider, float oldVal) override;
+   void DropdownUpdated(DropdownList* list, int oldVal) override {}
 private:
    //IDrawableModule
    void DrawModule() override;
@@ -58,10 +62,13 @@ private:
    
    float mCrush;
    float mDownsample;
+   int mOversampleMode;
    int mSampleCounter[ChannelBuffer::kMaxNumChannels];
    float mHeldDownsample[ChannelBuffer::kMaxNumChannels];
    FloatSlider* mCrushSlider;
    FloatSlider* mDownsampleSlider;
+   DropdownList* mOversampleDropdown;
+   Oversampler mOversampler;
    
    float mWidth;
    float mHeight;
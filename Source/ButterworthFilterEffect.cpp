@@ -77,9 +77,11 @@ void ButterworthFilterEffect::ProcessAudio(double time, ChannelBuffer* buffer)
    if (fadeOut)
       mDryBuffer.CopyFrom(buffer);
    
+   bool modulated = ComputeSliderBlocks();
    for (int i=0; i<bufferSize; ++i)
    {
-      ComputeSliders(i);
+      if (modulated)
+         ComputeModulatedSliders(i);
       if (mCoefficientsHaveChanged)
       {
          mButterworth[0].Set(mF,mQ);
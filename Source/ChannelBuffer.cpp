@@ -180,6 +180,15 @@ void ChannelBuffer::Save(FileStreamOut& out, int writeLength)
    }
 }
 
+void ChannelBuffer::Stash(FileStreamOut& out, int writeLength)
+{
+   for (int i = 0; i < mActiveChannels; ++i)
+   {
+      if (mBuffers[i] != nullptr)
+         out.Stash(mBuffers[i], writeLength);
+   }
+}
+
 void ChannelBuffer::Load(FileStreamIn& in, int& readLength, LoadMode loadMode)
 {
    int rev;
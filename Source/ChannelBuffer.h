@@ -59,6 +59,7 @@ public:
    };
 
    void Save(FileStreamOut& out, int writeLength);
+   void Stash(FileStreamOut& out, int writeLength);   //copy what Save() will write ahead of time, see FileStreamOut::Stash()
    void Load(FileStreamIn& in, int &readLength, LoadMode loadMode);
    
    static const int kMaxNumChannels = 2;
@@ -99,6 +99,7 @@ void CodeEntry::Poll()
       {
          try
          {
+            ScriptModule::ScopedPythonLock pythonLock;
             py::globals()["syntax_highlight_code"] = GetVisibleCode();
             py::object ret = py::eval("syntax_highlight_basic()", py::globals());
             mSyntaxHighlightMapping = ret.cast< std::vector<int> >();
@@ -132,6 +133,7 @@ void CodeEntry::Poll()
             {
                try
                {
+                  ScriptModule::ScopedPythonLock pythonLock;
                   string prefix = ScriptModule::GetBootstrapImportString() + "; import me\n";
                   py::exec("jediScript = jedi.Script('''" + prefix + GetVisibleCode() + "''', project=jediProject)", py::globals());
                   //py::exec("jediScript = jedi.Script('''" + prefix + GetVisibleCode() + "''')", py::globals());
@@ -0,0 +1,896 @@
+/**
+    bespoke synth, a software modular synthesizer
+    Copyright (C) 2021 Ryan Challinor (contact: awwbees@gmail.com)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**/
+/*
+  ==============================================================================
+
+    CompiledExpression.cpp
+    Created: 22 Jul 2021 9:41:05pm
+    Author:  Ryan Challinor
+
+  ==============================================================================
+*/
+
+#include "CompiledExpression.h"
+#include "SimdFloat.h"
+
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <cctype>
+#include <limits>
+#include <algorithm>
+
+namespace
+{
+   const int kMaxInstructions = 256;
+   const int kMaxDepth = 64;
+
+   struct FunctionInfo
+   {
+      const char* name;
+      int op;
+      int numArgs;   //-1 for two or more
+   };
+}
+
+//recursive descent over the subset of exprtk we know how to compile. constants get folded as the instructions are added.
+class CompiledExpression::Parser
+{
+public:
+   Parser(const std::string& text, unsigned int allowedVariables, std::vector<Instruction>& instructions)
+   : mText(text)
+   , mPos(0)
+   , mAllowedVariables(allowedVariables)
+   , mInstructions(instructions)
+   , mFailed(false)
+   , mDepth(0)
+   , mLastWasPower(false)
+   {
+   }
+
+   bool Parse(int& root)
+   {
+      root = ParseComparison();
+      SkipSpace();
+      if (Peek() == ';')
+      {
+         ++mPos;
+         SkipSpace();
+      }
+      return !mFailed && mPos == mText.size() && !mInstructions.empty();
+   }
+
+private:
+   int Fail()
+   {
+      mFailed = true;
+      return 0;
+   }
+
+   char Peek(int offset = 0) const
+   {
+      if (mPos + offset < mText.size())
+         return mText[mPos + offset];
+      return 0;
+   }
+
+   void SkipSpace()
+   {
+      while (mPos < mText.size() && isspace((unsigned char)mText[mPos]))
+         ++mPos;
+   }
+
+   bool Accept(char c)
+   {
+      SkipSpace();
+      if (Peek() == c)
+      {
+         ++mPos;
+         return true;
+      }
+      return false;
+   }
+
+   static int GetNumArgs(Op op)
+   {
+      switch (op)
+      {
+         case kOpConstant:
+         case kOpVariable:
+            return 0;
+         case kOpAdd:
+         case kOpSubtract:
+         case kOpMultiply:
+         case kOpDivide:
+         case kOpModulo:
+         case kOpPower:
+         case kOpLess:
+         case kOpLessEqual:
+         case kOpGreater:
+         case kOpGreaterEqual:
+         case kOpMin:
+         case kOpMax:
+         case kOpAtan2:
+            return 2;
+         case kOpIf:
+         case kOpClamp:
+            return 3;
+         default:
+            return 1;
+      }
+   }
+
+   int AddConstant(float value)
+   {
+      Instruction instruction;
+      instruction.op = kOpConstant;
+      instruction.args[0] = instruction.args[1] = instruction.args[2] = -1;
+      instruction.constant = value;
+      instruction.variable = kVariableX;
+      return Push(instruction);
+   }
+
+   int AddVariable(Variable variable)
+   {
+      Instruction instruction;
+      instruction.op = kOpVariable;
+      instruction.args[0] = instruction.args[1] = instruction.args[2] = -1;
+      instruction.constant = 0;
+      instruction.variable = variable;
+      return Push(instruction);
+   }
+
+   int Add(Op op, int a, int b = -1, int c = -1)
+   {
+      if (mFailed)
+         return 0;
+
+      int args[3] = { a, b, c };
+      int numArgs = GetNumArgs(op);
+      bool allConstant = true;
+      float values[3] = { 0, 0, 0 };
+      for (int i=0; i<numArgs; ++i)
+      {
+         if (mInstructions[args[i]].op == kOpConstant)
+            values[i] = mInstructions[args[i]].constant;
+         else
+            allConstant = false;
+      }
+      if (allConstant)
+         return AddConstant(CompiledExpression::Apply(op, values[0], values[1], values[2]));
+
+      Instruction instruction;
+      instruction.op = op;
+      for (int i=0; i<3; ++i)
+         instruction.args[i] = args[i];
+      instruction.constant = 0;
+      instruction.variable = kVariableX;
+      return Push(instruction);
+   }
+
+   int Push(const Instruction& instruction)
+   {
+      if (mFailed)
+         return 0;
+      if ((int)mInstructions.size() >= kMaxInstructions)
+         return Fail();
+      mInstructions.push_back(instruction);
+      return (int)mInstructions.size() - 1;
+   }
+
+   int ParseComparison()
+   {
+      int left = ParseAdditive();
+      SkipSpace();
+      Op op;
+      if (Peek() == '<' && Peek(1) == '=')
+         op = kOpLessEqual;
+      else if (Peek() == '>' && Peek(1) == '=')
+         op = kOpGreaterEqual;
+      else if (Peek() == '<' && Peek(1) != '>')
+         op = kOpLess;
+      else if (Peek() == '>')
+         op = kOpGreater;
+      else
+         return left;
+      mPos += (op == kOpLessEqual || op == kOpGreaterEqual) ? 2 : 1;
+
+      int right = ParseAdditive();
+      SkipSpace();
+      if (Peek() == '<' || Peek() == '>' || Peek() == '=' || Peek() == '!')
+         return Fail();   //chained comparisons and equality are left to exprtk
+      return Add(op, left, right);
+   }
+
+   int ParseAdditive()
+   {
+      int left = ParseMultiplicative();
+      while (!mFailed)
+      {
+         if (Accept('+'))
+            left = Add(kOpAdd, left, ParseMultiplicative());
+         else if (Accept('-'))
+            left = Add(kOpSubtract, left, ParseMultiplicative());
+         else
+            break;
+      }
+      return left;
+   }
+
+   int ParseMultiplicative()
+   {
+      int left = ParseUnary();
+      while (!mFailed)
+      {
+         if (Accept('*'))
+            left = Add(kOpMultiply, left, ParseUnary());
+         else if (Accept('/'))
+            left = Add(kOpDivide, left, ParseUnary());
+         else if (Accept('%'))
+            left = Add(kOpModulo, left, ParseUnary());
+         else
+            break;
+      }
+      return left;
+   }
+
+   int ParseUnary()
+   {
+      if (++mDepth > kMaxDepth)
+         return Fail();
+
+      int result;
+      if (Accept('-'))
+      {
+         int operand = ParseUnary();
+         if (mLastWasPower)
+            result = Fail();   //exprtk and everyone else disagree about -x^2
+         else
+            result = Add(kOpNegate, operand);
+      }
+      else if (Accept('+'))
+      {
+         result = ParseUnary();
+      }
+      else
+      {
+         result = ParsePower();
+      }
+
+      --mDepth;
+      return result;
+   }
+
+   int ParsePower()
+   {
+      int base = ParsePrimary();
+      mLastWasPower = false;
+      if (!Accept('^'))
+         return base;
+
+      int exponent = ParseUnary();
+      if (mLastWasPower)
+         return Fail();   //so is x^y^z
+      SkipSpace();
+      if (Peek() == '^')
+         return Fail();
+      mLastWasPower = true;
+      return Add(kOpPower, base, exponent);
+   }
+
+   int ParsePrimary()
+   {
+      if (mFailed)
+         return 0;
+
+      SkipSpace();
+      char c = Peek();
+      if (c == '(')
+      {
+         ++mPos;
+         int result = ParseComparison();
+         if (!Accept(')'))
+            return Fail();
+         return result;
+      }
+
+      if (isdigit((unsigned char)c) || (c == '.' && isdigit((unsigned char)Peek(1))))
+         return ParseNumber();
+
+      if (isalpha((unsigned char)c) || c == '_')
+      {
+         std::string name;
+         while (isalnum((unsigned char)Peek()) || Peek() == '_')
+            name += (char)tolower((unsigned char)mText[mPos++]);
+
+         SkipSpace();
+         if (Peek() == '(')
+            return ParseFunction(name);
+         return ParseIdentifier(name);
+      }
+
+      return Fail();
+   }
+
+   int ParseNumber()
+   {
+      size_t start = mPos;
+      while (isdigit((unsigned char)Peek()))
+         ++mPos;
+      if (Peek() == '.')
+      {
+         ++mPos;
+         while (isdigit((unsigned char)Peek()))
+            ++mPos;
+      }
+      if ((Peek() == 'e' || Peek() == 'E') &&
+          (isdigit((unsigned char)Peek(1)) || ((Peek(1) == '+' || Peek(1) == '-') && isdigit((unsigned char)Peek(2)))))
+      {
+         mPos += 2;
+         while (isdigit((unsigned char)Peek()))
+            ++mPos;
+      }
+      if (isalpha((unsigned char)Peek()) || Peek() == '_' || Peek() == '.')
+         return Fail();   //implicit multiplication like "2x"
+
+      return AddConstant((float)strtod(mText.substr(start, mPos - start).c_str(), nullptr));
+   }
+
+   int ParseIdentifier(const std::string& name)
+   {
+      static const char* kVariableNames[kNumVariables] = { "x", "x1", "x2", "y1", "y2", "t", "a", "b", "c", "d", "e" };
+      for (int i=0; i<kNumVariables; ++i)
+      {
+         if (name == kVariableNames[i])
+         {
+            if ((mAllowedVariables & (1 << i)) == 0)
+               return Fail();
+            return AddVariable((Variable)i);
+         }
+      }
+
+      if (name == "pi")
+         return AddConstant(3.14159265358979323846f);
+      if (name == "inf")
+         return AddConstant(std::numeric_limits<float>::infinity());
+
+      return Fail();
+   }
+
+   int ParseFunction(const std::string& name)
+   {
+      static const FunctionInfo kFunctions[] =
+      {
+         { "abs", kOpAbs, 1 },
+         { "sin", kOpSin, 1 },
+         { "cos", kOpCos, 1 },
+         { "tan", kOpTan, 1 },
+         { "asin", kOpAsin, 1 },
+         { "acos", kOpAcos, 1 },
+         { "atan", kOpAtan, 1 },
+         { "atan2", kOpAtan2, 2 },
+         { "sinh", kOpSinh, 1 },
+         { "cosh", kOpCosh, 1 },
+         { "tanh", kOpTanh, 1 },
+         { "exp", kOpExp, 1 },
+         { "log", kOpLog, 1 },
+         { "log10", kOpLog10, 1 },
+         { "log2", kOpLog2, 1 },
+         { "sqrt", kOpSqrt, 1 },
+         { "floor", kOpFloor, 1 },
+         { "ceil", kOpCeil, 1 },
+         { "round", kOpRound, 1 },
+         { "trunc", kOpTrunc, 1 },
+         { "frac", kOpFrac, 1 },
+         { "sgn", kOpSgn, 1 },
+         { "pow", kOpPower, 2 },
+         { "min", kOpMin, -1 },
+         { "max", kOpMax, -1 },
+         { "clamp", kOpClamp, 3 },
+         { "if", kOpIf, 3 }
+      };
+
+      const FunctionInfo* function = nullptr;
+      for (const auto& info : kFunctions)
+      {
+         if (name == info.name)
+            function = &info;
+      }
+      if (function == nullptr)
+         return Fail();
+
+      ++mPos;   //(
+      std::vector<int> args;
+      if (!Accept(')'))
+      {
+         do
+         {
+            args.push_back(ParseComparison());
+            if (mFailed)
+               return 0;
+         } while (Accept(','));
+         if (!Accept(')'))
+            return Fail();
+      }
+
+      Op op = (Op)function->op;
+      if (function->numArgs == -1)
+      {
+         if (args.size() < 2)
+            return Fail();
+         int result = args[0];
+         for (size_t i=1; i<args.size(); ++i)
+            result = Add(op, result, args[i]);
+         return result;
+      }
+
+      if ((int)args.size() != function->numArgs)
+         return Fail();
+      return Add(op, args[0], args.size() > 1 ? args[1] : -1, args.size() > 2 ? args[2] : -1);
+   }
+
+   const std::string& mText;
+   size_t mPos;
+   unsigned int mAllowedVariables;
+   std::vector<Instruction>& mInstructions;
+   bool mFailed;
+   int mDepth;
+   bool mLastWasPower;
+};
+
+CompiledExpression::Inputs::Inputs()
+{
+   for (int i=0; i<kNumVariables; ++i)
+   {
+      mBlocks[i] = nullptr;
+      mConstants[i] = 0;
+   }
+}
+
+CompiledExpression::CompiledExpression()
+: mValid(false)
+, mUsedVariables(0)
+, mSmooth(false)
+, mTable(kTableSize + 1)
+, mTableMin(-1)
+, mTableMax(1)
+, mTableValid(false)
+, mStableBlocks(0)
+{
+   for (int i=0; i<kNumVariables; ++i)
+      mTableConstants[i] = 0;
+}
+
+bool CompiledExpression::Compile(const std::string& expression, unsigned int allowedVariables)
+{
+   mValid = false;
+   mTableValid = false;
+   mStableBlocks = 0;
+
+   std::vector<Instruction> parsed;
+   Parser parser(expression, allowedVariables, parsed);
+   int root;
+   if (!parser.Parse(root))
+      return false;
+
+   //drop whatever got folded away, keeping everything in dependency order so the root ends up last
+   std::vector<int> remap(parsed.size(), -1);
+   std::vector<bool> used(parsed.size(), false);
+   used[root] = true;
+   for (int i=root; i>=0; --i)
+   {
+      if (used[i])
+      {
+         for (int j=0; j<3; ++j)
+         {
+            if (parsed[i].args[j] >= 0)
+               used[parsed[i].args[j]] = true;
+         }
+      }
+   }
+
+   mInstructions.clear();
+   mUsedVariables = 0;
+   mSmooth = true;
+   for (int i=0; i<=root; ++i)
+   {
+      if (!used[i])
+         continue;
+      Instruction instruction = parsed[i];
+      for (int j=0; j<3; ++j)
+      {
+         if (instruction.args[j] >= 0)
+            instruction.args[j] = remap[instruction.args[j]];
+      }
+      if (instruction.op == kOpVariable)
+         mUsedVariables |= 1 << instruction.variable;
+      if (!IsSmooth(instruction.op))
+         mSmooth = false;
+      remap[i] = (int)mInstructions.size();
+      mInstructions.push_back(instruction);
+   }
+
+   mUniform.assign(mInstructions.size(), false);
+   mRegisters.assign(mInstructions.size() * kChunkSize, 0);
+   mScalarRegisters.assign(mInstructions.size(), 0);
+   mValid = true;
+   return true;
+}
+
+void CompiledExpression::SetTableRange(float min, float max)
+{
+   if (min != mTableMin || max != mTableMax)
+   {
+      mTableMin = min;
+      mTableMax = max;
+      mTableValid = false;
+      mStableBlocks = 0;
+   }
+}
+
+//static
+float CompiledExpression::Apply(Op op, float a, float b, float c)
+{
+   switch (op)
+   {
+      case kOpConstant:
+      case kOpVariable: return a;
+      case kOpAdd: return a + b;
+      case kOpSubtract: return a - b;
+      case kOpMultiply: return a * b;
+      case kOpDivide: return a / b;
+      case kOpModulo: return std::fmod(a, b);
+      case kOpPower: return std::pow(a, b);
+      case kOpNegate: return -a;
+      case kOpLess: return a < b ? 1.0f : 0.0f;
+      case kOpLessEqual: return a <= b ? 1.0f : 0.0f;
+      case kOpGreater: return a > b ? 1.0f : 0.0f;
+      case kOpGreaterEqual: return a >= b ? 1.0f : 0.0f;
+      case kOpIf: return a != 0 ? b : c;
+      case kOpMin: return a < b ? a : b;
+      case kOpMax: return a > b ? a : b;
+      case kOpClamp: return b < a ? a : (b > c ? c : b);
+      case kOpAbs: return std::fabs(a);
+      case kOpSin: return std::sin(a);
+      case kOpCos: return std::cos(a);
+      case kOpTan: return std::tan(a);
+      case kOpAsin: return std::asin(a);
+      case kOpAcos: return std::acos(a);
+      case kOpAtan: return std::atan(a);
+      case kOpAtan2: return std::atan2(a, b);
+      case kOpSinh: return std::sinh(a);
+      case kOpCosh: return std::cosh(a);
+      case kOpTanh: return std::tanh(a);
+      case kOpExp: return std::exp(a);
+      case kOpLog: return std::log(a);
+      case kOpLog10: return std::log10(a);
+      case kOpLog2: return std::log2(a);
+      case kOpSqrt: return std::sqrt(a);
+      case kOpFloor: return std::floor(a);
+      case kOpCeil: return std::ceil(a);
+      case kOpRound: return std::round(a);
+      case kOpTrunc: return std::trunc(a);
+      case kOpFrac: return a - std::trunc(a);
+      case kOpSgn: return a > 0 ? 1.0f : (a < 0 ? -1.0f : 0.0f);
+   }
+   return 0;
+}
+
+//static
+bool CompiledExpression::IsSmooth(Op op)
+{
+   switch (op)
+   {
+      case kOpModulo:
+      case kOpLess:
+      case kOpLessEqual:
+      case kOpGreater:
+      case kOpGreaterEqual:
+      case kOpIf:
+      case kOpFloor:
+      case kOpCeil:
+      case kOpRound:
+      case kOpTrunc:
+      case kOpFrac:
+      case kOpSgn:
+         return false;
+      default:
+         return true;
+   }
+}
+
+float CompiledExpression::EvaluateSample(const float* variables)
+{
+   if (!mValid)
+      return 0;
+
+   for (size_t i=0; i<mInstructions.size(); ++i)
+   {
+      const Instruction& instruction = mInstructions[i];
+      if (instruction.op == kOpConstant)
+         mScalarRegisters[i] = instruction.constant;
+      else if (instruction.op == kOpVariable)
+         mScalarRegisters[i] = variables[instruction.variable];
+      else
+         mScalarRegisters[i] = Apply(instruction.op,
+                                     instruction.args[0] >= 0 ? mScalarRegisters[instruction.args[0]] : 0,
+                                     instruction.args[1] >= 0 ? mScalarRegisters[instruction.args[1]] : 0,
+                                     instruction.args[2] >= 0 ? mScalarRegisters[instruction.args[2]] : 0);
+   }
+   return mScalarRegisters.back();
+}
+
+void CompiledExpression::Evaluate(const Inputs& inputs, float* output, int length)
+{
+   if (!mValid)
+   {
+      std::fill(output, output + length, 0.0f);
+      return;
+   }
+
+   if (UpdateTable(inputs))
+   {
+      const float* x = inputs.mBlocks[kVariableX];
+      float scale = kTableSize / (mTableMax - mTableMin);
+      float variables[kNumVariables];
+      std::copy(inputs.mConstants, inputs.mConstants + kNumVariables, variables);
+      for (int i=0; i<length; ++i)
+      {
+         float pos = (x[i] - mTableMin) * scale;
+         if (pos >= 0 && pos < kTableSize)
+         {
+            int index = (int)pos;
+            float a = mTable[index];
+            output[i] = a + (mTable[index + 1] - a) * (pos - index);
+         }
+         else
+         {
+            variables[kVariableX] = x[i];
+            output[i] = EvaluateSample(variables);
+         }
+      }
+      return;
+   }
+
+   EvaluateDirect(inputs, output, length);
+}
+
+//returns true if the table is ready to use for this block
+bool CompiledExpression::UpdateTable(const Inputs& inputs)
+{
+   if (!mSmooth || !Uses(kVariableX) || inputs.mBlocks[kVariableX] == nullptr)
+      return false;
+
+   bool constantsChanged = false;
+   for (int i=0; i<kNumVariables; ++i)
+   {
+      if (i == kVariableX || !Uses((Variable)i))
+         continue;
+      if (inputs.mBlocks[i] != nullptr)
+         return false;   //something other than x moves within the block
+      if (inputs.mConstants[i] != mTableConstants[i])
+      {
+         mTableConstants[i] = inputs.mConstants[i];
+         constantsChanged = true;
+      }
+   }
+
+   if (constantsChanged)
+   {
+      mTableValid = false;
+      mStableBlocks = 0;
+      return false;
+   }
+
+   if (mTableValid)
+      return true;
+
+   if (++mStableBlocks < kBlocksBeforeTable)
+      return false;
+
+   //build it in place, each chunk reads its x values before it writes over them
+   for (int i=0; i<=kTableSize; ++i)
+      mTable[i] = mTableMin + (mTableMax - mTableMin) * i / kTableSize;
+   Inputs tableInputs = inputs;
+   tableInputs.SetBlock(kVariableX, mTable.data());
+   EvaluateDirect(tableInputs, mTable.data(), kTableSize + 1);
+
+   for (float value : mTable)
+   {
+      if (!std::isfinite(value))
+      {
+         mStableBlocks = std::numeric_limits<int>::min();   //don't try again until the constants change
+         return false;
+      }
+   }
+
+   mTableValid = true;
+   return true;
+}
+
+void CompiledExpression::EvaluateDirect(const Inputs& inputs, float* output, int length)
+{
+   //anything that doesn't depend on a per-sample input only needs computing once for the whole block
+   for (size_t i=0; i<mInstructions.size(); ++i)
+   {
+      const Instruction& instruction = mInstructions[i];
+      bool uniform;
+      if (instruction.op == kOpConstant)
+      {
+         uniform = true;
+         mScalarRegisters[i] = instruction.constant;
+      }
+      else if (instruction.op == kOpVariable)
+      {
+         uniform = inputs.mBlocks[instruction.variable] == nullptr;
+         mScalarRegisters[i] = inputs.mConstants[instruction.variable];
+      }
+      else
+      {
+         uniform = true;
+         for (int j=0; j<3; ++j)
+         {
+            if (instruction.args[j] >= 0 && !mUniform[instruction.args[j]])
+               uniform = false;
+         }
+         if (uniform)
+            mScalarRegisters[i] = Apply(instruction.op,
+                                        instruction.args[0] >= 0 ? mScalarRegisters[instruction.args[0]] : 0,
+                                        instruction.args[1] >= 0 ? mScalarRegisters[instruction.args[1]] : 0,
+                                        instruction.args[2] >= 0 ? mScalarRegisters[instruction.args[2]] : 0);
+      }
+
+      mUniform[i] = uniform;
+      if (uniform)
+         std::fill(&mRegisters[i * kChunkSize], &mRegisters[i * kChunkSize] + kChunkSize, mScalarRegisters[i]);
+   }
+
+   if (mUniform.back())
+   {
+      std::fill(output, output + length, mScalarRegisters.back());
+      return;
+   }
+
+   const float* result = &mRegisters[(mInstructions.size() - 1) * kChunkSize];
+   for (int offset = 0; offset < length; offset += kChunkSize)
+   {
+      int chunkLength = std::min(int(kChunkSize), length - offset);   //int() so std::min doesn't odr-use kChunkSize
+      EvaluateChunk(inputs, offset, chunkLength);
+      std::copy(result, result + chunkLength, output + offset);
+   }
+}
+
+void CompiledExpression::EvaluateChunk(const Inputs& inputs, int offset, int length)
+{
+   const int kNumLanes = SimdFloat::kNumLanes;
+   int paddedLength = (length + kNumLanes - 1) / kNumLanes * kNumLanes;
+   const SimdFloat zero(0.0f);
+   const SimdFloat one(1.0f);
+
+   for (size_t i=0; i<mInstructions.size(); ++i)
+   {
+      if (mUniform[i])
+         continue;
+
+      const Instruction& instruction = mInstructions[i];
+      float* dest = &mRegisters[i * kChunkSize];
+      const float* a = instruction.args[0] >= 0 ? &mRegisters[instruction.args[0] * kChunkSize] : nullptr;
+      const float* b = instruction.args[1] >= 0 ? &mRegisters[instruction.args[1] * kChunkSize] : nullptr;
+      const float* c = instruction.args[2] >= 0 ? &mRegisters[instruction.args[2] * kChunkSize] : nullptr;
+
+      switch (instruction.op)
+      {
+         case kOpVariable:
+         {
+            const float* source = inputs.mBlocks[instruction.variable] + offset;
+            std::copy(source, source + length, dest);
+            std::fill(dest + length, dest + paddedLength, source[length - 1]);
+            break;
+         }
+         case kOpAdd:
+            for (int j=0; j<paddedLength; j += kNumLanes)
+               (SimdFloat::Load(a + j) + SimdFloat::Load(b + j)).Store(dest + j);
+            break;
+         case kOpSubtract:
+            for (int j=0; j<paddedLength; j += kNumLanes)
+               (SimdFloat::Load(a + j) - SimdFloat::Load(b + j)).Store(dest + j);
+            break;
+         case kOpMultiply:
+            for (int j=0; j<paddedLength; j += kNumLanes)
+               (SimdFloat::Load(a + j) * SimdFloat::Load(b + j)).Store(dest + j);
+            break;
+         case kOpDivide:
+            for (int j=0; j<paddedLength; j += kNumLanes)
+               (SimdFloat::Load(a + j) / SimdFloat::Load(b + j)).Store(dest + j);
+            break;
+         case kOpNegate:
+            for (int j=0; j<paddedLength; j += kNumLanes)
+               (zero - SimdFloat::Load(a + j)).Store(dest + j);
+            break;
+         case kOpLess:
+            for (int j=0; j<paddedLength; j += kNumLanes)
+               Select(SimdFloat::Load(a + j) < SimdFloat::Load(b + j), one, zero).Store(dest + j);
+            break;
+         case kOpLessEqual:
+            for (int j=0; j<paddedLength; j += kNumLanes)
+               Select(SimdFloat::Load(a + j) > SimdFloat::Load(b + j), zero, one).Store(dest + j);
+            break;
+         case kOpGreater:
+            for (int j=0; j<paddedLength; j += kNumLanes)
+               Select(SimdFloat::Load(a + j) > SimdFloat::Load(b + j), one, zero).Store(dest + j);
+            break;
+         case kOpGreaterEqual:
+            for (int j=0; j<paddedLength; j += kNumLanes)
+               Select(SimdFloat::Load(a + j) < SimdFloat::Load(b + j), zero, one).Store(dest + j);
+            break;
+         case kOpIf:
+            for (int j=0; j<paddedLength; j += kNumLanes)
+            {
+               SimdFloat condition = SimdFloat::Load(a + j);
+               SimdFloat ifTrue = SimdFloat::Load(b + j);
+               Select(condition < zero, ifTrue, Select(condition > zero, ifTrue, SimdFloat::Load(c + j))).Store(dest + j);
+            }
+            break;
+         case kOpMin:
+            for (int j=0; j<paddedLength; j += kNumLanes)
+               Min(SimdFloat::Load(a + j), SimdFloat::Load(b + j)).Store(dest + j);
+            break;
+         case kOpMax:
+            for (int j=0; j<paddedLength; j += kNumLanes)
+               Max(SimdFloat::Load(a + j), SimdFloat::Load(b + j)).Store(dest + j);
+            break;
+         case kOpClamp:
+            for (int j=0; j<paddedLength; j += kNumLanes)
+            {
+               SimdFloat low = SimdFloat::Load(a + j);
+               SimdFloat value = SimdFloat::Load(b + j);
+               SimdFloat high = SimdFloat::Load(c + j);
+               Select(value < low, low, Select(value > high, high, value)).Store(dest + j);
+            }
+            break;
+         case kOpAbs:
+            for (int j=0; j<paddedLength; j += kNumLanes)
+               Abs(SimdFloat::Load(a + j)).Store(dest + j);
+            break;
+         case kOpFloor:
+            for (int j=0; j<paddedLength; j += kNumLanes)
+               Floor(SimdFloat::Load(a + j)).Store(dest + j);
+            break;
+         case kOpSin:
+            for (int j=0; j<length; ++j)
+               dest[j] = std::sin(a[j]);
+            break;
+         case kOpCos:
+            for (int j=0; j<length; ++j)
+               dest[j] = std::cos(a[j]);
+            break;
+         case kOpTanh:
+            for (int j=0; j<length; ++j)
+               dest[j] = std::tanh(a[j]);
+            break;
+         case kOpExp:
+            for (int j=0; j<length; ++j)
+               dest[j] = std::exp(a[j]);
+            break;
+         default:
+            for (int j=0; j<length; ++j)
+               dest[j] = Apply(instruction.op, a ? a[j] : 0, b ? b[j] : 0, c ? c[j] : 0);
+            break;
+      }
+   }
+}
@@ -0,0 +1,157 @@
+/**
+    bespoke synth, a software modular synthesizer
+    Copyright (C) 2021 Ryan Challinor (contact: awwbees@gmail.com)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**/
+/*
+  ==============================================================================
+
+    CompiledExpression.h
+    Created: 22 Jul 2021 9:41:05pm
+    Author:  Ryan Challinor
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+//compiles the common subset of exprtk syntax (arithmetic, comparisons, if() and the usual math functions) into a flat list of
+//register instructions that run over a whole block at a time. anything outside of that subset fails to compile, and the caller
+//should keep using exprtk for it.
+class CompiledExpression
+{
+public:
+   enum Variable
+   {
+      kVariableX,
+      kVariableX1,
+      kVariableX2,
+      kVariableY1,
+      kVariableY2,
+      kVariableT,
+      kVariableA,
+      kVariableB,
+      kVariableC,
+      kVariableD,
+      kVariableE,
+      kNumVariables
+   };
+
+   //each variable is either one value for the whole block, or a block of per-sample values
+   struct Inputs
+   {
+      Inputs();
+      void SetConstant(Variable variable, float value) { mBlocks[variable] = nullptr; mConstants[variable] = value; }
+      void SetBlock(Variable variable, const float* values) { mBlocks[variable] = values; }
+      const float* mBlocks[kNumVariables];
+      float mConstants[kNumVariables];
+   };
+
+   CompiledExpression();
+
+   //allowedVariables is a bitmask of (1 << Variable)
+   bool Compile(const std::string& expression, unsigned int allowedVariables);
+   void Clear() { mValid = false; }
+   bool IsValid() const { return mValid; }
+   bool Uses(Variable variable) const { return mValid && (mUsedVariables & (1 << variable)) != 0; }
+
+   void Evaluate(const Inputs& inputs, float* output, int length);
+   float EvaluateSample(const float* variables);   //indexed by Variable
+
+   //smooth functions of x alone get evaluated from an interpolated table over this range, once a through e have held still for a few blocks
+   void SetTableRange(float min, float max);
+
+private:
+   enum Op
+   {
+      kOpConstant,
+      kOpVariable,
+      kOpAdd,
+      kOpSubtract,
+      kOpMultiply,
+      kOpDivide,
+      kOpModulo,
+      kOpPower,
+      kOpNegate,
+      kOpLess,
+      kOpLessEqual,
+      kOpGreater,
+      kOpGreaterEqual,
+      kOpIf,
+      kOpMin,
+      kOpMax,
+      kOpClamp,
+      kOpAbs,
+      kOpSin,
+      kOpCos,
+      kOpTan,
+      kOpAsin,
+      kOpAcos,
+      kOpAtan,
+      kOpAtan2,
+      kOpSinh,
+      kOpCosh,
+      kOpTanh,
+      kOpExp,
+      kOpLog,
+      kOpLog10,
+      kOpLog2,
+      kOpSqrt,
+      kOpFloor,
+      kOpCeil,
+      kOpRound,
+      kOpTrunc,
+      kOpFrac,
+      kOpSgn
+   };
+
+   struct Instruction
+   {
+      Op op;
+      int args[3];   //registers, which are the indices of earlier instructions
+      float constant;
+      Variable variable;
+   };
+
+   class Parser;
+
+   static float Apply(Op op, float a, float b, float c);
+   static bool IsSmooth(Op op);
+   void EvaluateDirect(const Inputs& inputs, float* output, int length);
+   void EvaluateChunk(const Inputs& inputs, int offset, int length);
+   bool UpdateTable(const Inputs& inputs);
+
+   static const int kChunkSize = 64;
+   static const int kTableSize = 4096;
+   static const int kBlocksBeforeTable = 8;
+
+   bool mValid;
+   unsigned int mUsedVariables;
+   bool mSmooth;   //continuous in x, so the interpolated table is close everywhere. kinks like abs() are allowed, they're only rounded off within one table step
+   std::vector<Instruction> mInstructions;
+   std::vector<bool> mUniform;   //per instruction, for the current block
+   std::vector<float> mRegisters;   //kChunkSize values per instruction
+   std::vector<float> mScalarRegisters;
+
+   std::vector<float> mTable;
+   float mTableMin;
+   float mTableMax;
+   bool mTableValid;
+   float mTableConstants[kNumVariables];
+   int mStableBlocks;
+};
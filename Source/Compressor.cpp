@@ -31,18 +31,6 @@
 
 namespace
 {
-   static double lin2dB( double lin )
-   {
-      static const double LOG_2_DB = 8.6858896380650365530225783783321;	// 20 / ln( 10 )
-      return log( lin ) * LOG_2_DB;
-   }
-
-   static double dB2lin( double dB )
-   {
-      static const double DB_2_LOG = 0.11512925464970228420089957273422;	// ln( 10 ) / 20
-      return exp( dB * DB_2_LOG );
-   }
-
    const float kMaxLookaheadMs = 50;
 }
 
@@ -60,9 +48,22 @@ Compressor::Compressor()
 , mReleaseSlider(nullptr)
 , mCurrentInputDb(0)
 , mOutputGain(1)
-, mDelayBuffer(kMaxLookaheadMs * gSampleRateMs)
+, mDelay(kMaxLookaheadMs * gSampleRateMs)
 {
    envdB_ = DC_OFFSET;
+   
+   mLevelBuffer = new float[gBufferSize];
+   mGainBuffer = new float[gBufferSize];
+   mMixBlock = new float[gBufferSize];
+   mOutputAdjustBlock = new float[gBufferSize];
+}
+
+Compressor::~Compressor()
+{
+   delete[] mLevelBuffer;
+   delete[] mGainBuffer;
+   delete[] mMixBlock;
+   delete[] mOutputAdjustBlock;
 }
 
 void Compressor::CreateUIControls()
@@ -96,28 +97,28 @@ void Compressor::ProcessAudio(double time, ChannelBuffer* buffer)
       return;
    
    int bufferSize = buffer->BufferSize();
-   mDelayBuffer.SetNumChannels(buffer->NumActiveChannels());
+   bool modulated = ComputeSliderBlocks();
+
+   // create sidechain, linked across channels so they all get the same gain
+   Dynamics::DetectLinkedPeak(buffer, mLevelBuffer, bufferSize);
+   Dynamics::LinearToDb(mLevelBuffer, mLevelBuffer, bufferSize);
 
+   // the attack/release envelope is the only part that has to go a sample at a time, so the dB conversions on either side of it run over the whole block
+   double invRatio = 1 / mRatio;
+   double makeup = (-mThreshold * .5) * (1.0 - invRatio);
    for (int i=0; i<bufferSize; ++i)
    {
-      ComputeSliders(i);
-      
-      // create sidechain
-
-      float input = 0;
-      for (int ch=0; ch<buffer->NumActiveChannels(); ++ch)
-         input = MAX(input, fabsf(buffer->GetChannel(ch)[i]));
-
-      /* if desired, one could use another EnvelopeDetector to smooth
-       * the rectified signal.
-       */
-
-      // convert key to dB
-      input += DC_OFFSET;				// add DC offset to avoid log( 0 )
-      mCurrentInputDb = lin2dB( input );	// convert linear -> dB
+      if (modulated)
+      {
+         ComputeModulatedSliders(i);
+         invRatio = 1 / mRatio;
+         makeup = (-mThreshold * .5) * (1.0 - invRatio);
+         mMixBlock[i] = mMix;
+         mOutputAdjustBlock[i] = mOutputAdjust;
+      }
 
       // threshold
-      double overdB = mCurrentInputDb - mThreshold;	// delta over threshold
+      double overdB = mLevelBuffer[i] - mThreshold;	// delta over threshold
       if ( overdB < 0.0 )
          overdB = 0.0;
 
@@ -133,21 +134,30 @@ void Compressor::ProcessAudio(double time, ChannelBuffer* buffer)
        * constant gain reduction, we must subtract it from the envelope, yielding
        * a minimum value of 0dB.
        */
-      
-      double invRatio = 1 / mRatio;
 
       // transfer function
       double reduction = overdB * ( invRatio - 1.0 );	// gain reduction (dB)
-      double makeup = (-mThreshold * .5) * (1.0 - invRatio);
-      mOutputGain = ofLerp(1, dB2lin( reduction + makeup ) * mOutputAdjust, mMix);
+      mGainBuffer[i] = reduction + makeup;
+   }
+   mCurrentInputDb = mLevelBuffer[bufferSize - 1];
 
-      // output gain
-      for (int ch=0; ch<buffer->NumActiveChannels(); ++ch)
-      {
-         mDelayBuffer.Write(buffer->GetChannel(ch)[i], ch);
-         buffer->GetChannel(ch)[i] = mDelayBuffer.GetSample(ofClamp(int(mLookahead * gSampleRateMs)+1, 1, mDelayBuffer.Size()-1), ch) * mOutputGain;	// apply gain reduction to input
-      }
+   Dynamics::DbToLinear(mGainBuffer, mGainBuffer, bufferSize);
+   if (modulated)
+   {
+      for (int i=0; i<bufferSize; ++i)
+         mGainBuffer[i] = 1 + (mGainBuffer[i] * mOutputAdjustBlock[i] - 1) * mMixBlock[i];
    }
+   else
+   {
+      Mult(mGainBuffer, mOutputAdjust * mMix, bufferSize);
+      for (int i=0; i<bufferSize; ++i)
+         mGainBuffer[i] += 1 - mMix;
+   }
+   mOutputGain = mGainBuffer[bufferSize - 1];
+
+   // delay the signal so the gain reduction lands ahead of what triggered it, then apply it
+   mDelay.Process(buffer, bufferSize, int(mLookahead * gSampleRateMs));
+   Dynamics::ApplyGain(buffer, mGainBuffer, bufferSize);
 }
 
 void Compressor::DrawModule()
@@ -30,7 +30,7 @@
 #include "IAudioEffect.h"
 #include "Slider.h"
 #include "Checkbox.h"
-#include "RollingBuffer.h"
+#include "Dynamics.h"
 
 //-------------------------------------------------------------
 // DC offset (to prevent denormal)
@@ -115,6 +115,7 @@ class Compressor : public IAudioEffect, public IFloatSliderListener
 {
 public:
    Compressor();
+   virtual ~Compressor();
    
    static IAudioEffect* Create() { return new Compressor(); }
    
@@ -160,7 +161,11 @@ private:
 
    AttRelEnvelope mEnv;
    
-   RollingBuffer mDelayBuffer;
+   LookaheadDelay mDelay;
+   float* mLevelBuffer;   //dB
+   float* mGainBuffer;
+   float* mMixBlock;
+   float* mOutputAdjustBlock;
 };
 
 #endif /* defined(__modularSynth__Compressor__) */
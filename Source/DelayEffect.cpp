@@ -94,11 +94,13 @@ void DelayEffect::ProcessAudio(double time, ChannelBuffer* buffer)
    }
 
    mAmountRamp.Start(time, mFeedback, time + 3);
+   bool modulated = ComputeSliderBlocks();
    for (int i=0; i<bufferSize; ++i)
    {
       mFeedback = mAmountRamp.Value(time);
 
-      ComputeSliders(i);
+      if (modulated)
+         ComputeModulatedSliders(i);
 
       float delay = MAX(mDelayRamp.Value(time), GetMinDelayMs());
 
@@ -236,6 +238,12 @@ namespace
    const int kSaveStateRev = 0;
 }
 
+void DelayEffect::StashSaveData(FileStreamOut& out)
+{
+   IDrawableModule::StashSaveData(out);
+   mDelayBuffer.StashSaveData(out);
+}
+
 void DelayEffect::SaveState(FileStreamOut& out)
 {
    IDrawableModule::SaveState(out);
@@ -65,6 +65,7 @@ public:
    void FloatSliderUpdated(FloatSlider* slider, float oldVal) override;
    void DropdownUpdated(DropdownList* list, int oldVal) override;
    
+   void StashSaveData(FileStreamOut& out) override;
    void SaveState(FileStreamOut& out) override;
    void LoadState(FileStreamIn& in) override;
    
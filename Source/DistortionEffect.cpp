@@ -37,6 +37,8 @@ DistortionEffect::DistortionEffect()
 , mPreampSlider(nullptr)
 , mFuzzAmount(0)
 , mRemoveInputDC(true)
+, mOversampleMode(Oversampler::kOff)
+, mOversampleDropdown(nullptr)
 {
    SetClip(1);
    
@@ -59,6 +61,7 @@ void DistortionEffect::CreateUIControls()
    FLOATSLIDER(mPreampSlider, "preamp", &mPreamp, 1, 10);
    FLOATSLIDER(mFuzzAmountSlider, "fuzz", &mFuzzAmount, -1, 1);
    CHECKBOX(mRemoveInputDCCheckbox, "center input", &mRemoveInputDC);
+   DROPDOWN(mOversampleDropdown, "oversample", &mOversampleMode, 60);
    ENDUIBLOCK(mWidth, mHeight);
    
    mTypeDropdown->AddLabel("clean", kClean);
@@ -68,6 +71,8 @@ void DistortionEffect::CreateUIControls()
    mTypeDropdown->AddLabel("asym", kAsymmetric);
    mTypeDropdown->AddLabel("fold", kFold);
    mTypeDropdown->AddLabel("grungy", kGrungy);
+   
+   Oversampler::AddModeLabels(mOversampleDropdown);
 }
 
 void DistortionEffect::ProcessAudio(double time, ChannelBuffer* buffer)
@@ -77,97 +82,114 @@ void DistortionEffect::ProcessAudio(double time, ChannelBuffer* buffer)
    if (!mEnabled)
       return;
    
-   float bufferSize = buffer->BufferSize();
+   int bufferSize = buffer->BufferSize();
+   bool modulated = ComputeSliderBlocks();
+   
+   mOversampler.SetMode(mOversampleMode);
+   int oversampling = mOversampler.GetFactor();
+   int length = bufferSize * oversampling;
    
    for (int ch=0; ch<buffer->NumActiveChannels(); ++ch)
    {
+      float* data = buffer->GetChannel(ch);
+      
       if (mRemoveInputDC)
-         mDCRemover[ch].Filter(buffer->GetChannel(ch), bufferSize);
+         mDCRemover[ch].Filter(data, bufferSize);
 
-      mPeakTracker[ch].Process(buffer->GetChannel(ch), bufferSize);
+      mPeakTracker[ch].Process(data, bufferSize);
+      float peak = mPeakTracker[ch].GetPeak();
       
-      if (mType == kDirty)
-      {
-         for (int i=0; i<bufferSize; ++i)
-         {
-            ComputeSliders(i);
-            buffer->GetChannel(ch)[i] = (ofClamp((buffer->GetChannel(ch)[i] + mFuzzAmount * mPeakTracker[ch].GetPeak()) * mPreamp * mGain, -1, 1)) / mGain;
-         }
-      }
-      else if (mType == kClean)
-      {
-         for (int i=0; i<bufferSize; ++i)
-         {
-            ComputeSliders(i);
-            buffer->GetChannel(ch)[i] = tanh((buffer->GetChannel(ch)[i] + mFuzzAmount * mPeakTracker[ch].GetPeak()) * mPreamp * mGain) / mGain;
-         }
-      }
-      else if (mType == kWarm)
-      {
-         for (int i=0; i<bufferSize; ++i)
-         {
-            ComputeSliders(i);
-            buffer->GetChannel(ch)[i] = sin((buffer->GetChannel(ch)[i] + mFuzzAmount * mPeakTracker[ch].GetPeak()) * mPreamp * mGain) / mGain;
-         }
-      }
-      else if (mType == kGrungy)
-      {
-         for (int i = 0; i < bufferSize; ++i)
-         {
-            ComputeSliders(i);
-            buffer->GetChannel(ch)[i] = asin(ofClamp((buffer->GetChannel(ch)[i] +  mFuzzAmount * mPeakTracker[ch].GetPeak()) * mPreamp * mGain, -1, 1)) / mGain;
-         }
-      }
-      //soft and asymmetric from http://www.music.mcgill.ca/~gary/courses/projects/618_2009/NickDonaldson/#Distortion
-      else if (mType == kSoft)
-      {
-         for (int i=0; i<bufferSize; ++i)
-         {
-            ComputeSliders(i);
-            float sample = (buffer->GetChannel(ch)[i] + mFuzzAmount * mPeakTracker[ch].GetPeak()) * mPreamp * mGain;
-            if (sample > 1)
-               sample = .66666f;
-            else if (sample < -1)
-               sample = -.66666f;
-            else
-               sample = sample - (sample*sample*sample)/3.0f;
-            buffer->GetChannel(ch)[i] = sample / mGain;
-         }
-      }
-      else if (mType == kAsymmetric)
+      float* shaped = data;
+      if (oversampling > 1)
+         shaped = mOversampler.Upsample(ch, data, bufferSize);
+      
+      switch (mType)
       {
-         for (int i=0; i<bufferSize; ++i)
-         {
-            ComputeSliders(i);
-            float sample = (buffer->GetChannel(ch)[i]*.5f+ mFuzzAmount * mPeakTracker[ch].GetPeak()) * mPreamp * mGain;
-            if (sample >= .320018f)
-               sample = .630035f;
-            else if (sample >= -.08905f)
-               sample = -6.153f*sample*sample + 3.9375f*sample;
-            else if (sample >= -1)
-               sample = -.75f*(1-powf(1-(fabsf(sample)-.032847f),12)+.333f*(fabsf(sample)-.032847f))+.01f;
-            else
-               sample = -.9818f;
-            buffer->GetChannel(ch)[i] = sample / mGain;
-         }
+         case kClean: ProcessChannel<kClean>(shaped, length, peak, modulated, oversampling); break;
+         case kWarm: ProcessChannel<kWarm>(shaped, length, peak, modulated, oversampling); break;
+         case kDirty: ProcessChannel<kDirty>(shaped, length, peak, modulated, oversampling); break;
+         case kSoft: ProcessChannel<kSoft>(shaped, length, peak, modulated, oversampling); break;
+         case kAsymmetric: ProcessChannel<kAsymmetric>(shaped, length, peak, modulated, oversampling); break;
+         case kFold: ProcessChannel<kFold>(shaped, length, peak, modulated, oversampling); break;
+         case kGrungy: ProcessChannel<kGrungy>(shaped, length, peak, modulated, oversampling); break;
       }
-      else if (mType == kFold)
+      
+      if (oversampling > 1)
+         mOversampler.Downsample(ch, data, bufferSize);
+   }
+}
+
+template<DistortionEffect::DistortionType kType>
+void DistortionEffect::ProcessChannel(float* data, int length, float peak, bool modulated, int oversampling)
+{
+   const float inputScale = (kType == kAsymmetric || kType == kFold) ? .5f : 1;
+   
+   if (modulated)
+   {
+      for (int i=0; i<length; ++i)
       {
-         for (int i=0; i<bufferSize; ++i)
-         {
-            ComputeSliders(i);
-            float sample = ofClamp((buffer->GetChannel(ch)[i]*.5f+ mFuzzAmount * mPeakTracker[ch].GetPeak()) * mPreamp * mGain, -100, 100);
-            while (sample > 1 || sample < -1)
-            {
-               if (sample > 1)
-                  sample = 2 - sample;
-               if (sample < -1)
-                  sample = -2 - sample;
-            }
-            buffer->GetChannel(ch)[i] = sample / mGain;
-         }
+         if (i % oversampling == 0)
+            ComputeModulatedSliders(i / oversampling);
+         data[i] = Shape<kType>((data[i] * inputScale + mFuzzAmount * peak) * mPreamp * mGain) / mGain;
       }
    }
+   else
+   {
+      const float scale = inputScale * mPreamp * mGain;
+      const float offset = mFuzzAmount * peak * mPreamp * mGain;
+      const float invGain = 1 / mGain;
+      for (int i=0; i<length; ++i)
+         data[i] = Shape<kType>(data[i] * scale + offset) * invGain;
+   }
+}
+
+//static
+template<DistortionEffect::DistortionType kType>
+float DistortionEffect::Shape(float sample)
+{
+   if (kType == kDirty)
+      return ofClamp(sample, -1, 1);
+   
+   if (kType == kClean)
+      return tanh(sample);
+   
+   if (kType == kWarm)
+      return sin(sample);
+   
+   if (kType == kGrungy)
+      return asin(ofClamp(sample, -1, 1));
+   
+   //soft and asymmetric from http://www.music.mcgill.ca/~gary/courses/projects/618_2009/NickDonaldson/#Distortion
+   if (kType == kSoft)
+   {
+      if (sample > 1)
+         return .66666f;
+      if (sample < -1)
+         return -.66666f;
+      return sample - (sample*sample*sample)/3.0f;
+   }
+   
+   if (kType == kAsymmetric)
+   {
+      if (sample >= .320018f)
+         return .630035f;
+      if (sample >= -.08905f)
+         return -6.153f*sample*sample + 3.9375f*sample;
+      if (sample >= -1)
+         return -.75f*(1-powf(1-(fabsf(sample)-.032847f),12)+.333f*(fabsf(sample)-.032847f))+.01f;
+      return -.9818f;
+   }
+   
+   //kFold
+   sample = ofClamp(sample, -100, 100);
+   while (sample > 1 || sample < -1)
+   {
+      if (sample > 1)
+         sample = 2 - sample;
+      if (sample < -1)
+         sample = -2 - sample;
+   }
+   return sample;
 }
 
 void DistortionEffect::SetClip(float amount)
@@ -192,6 +214,7 @@ void DistortionEffect::DrawModule()
    mPreampSlider->Draw();
    mRemoveInputDCCheckbox->Draw();
    mFuzzAmountSlider->Draw();
+   mOversampleDropdown->Draw();
 }
 
 float DistortionEffect::GetEffectAmount()
@@ -207,6 +230,7 @@ void DistortionEffect::CheckboxUpdated(Checkbox* checkbox)
    {
       for (int i = 0; i < ChannelBuffer::kMaxNumChannels; ++i)
          mDCRemover[i].Clear();
+      mOversampler.Reset();
    }
 }
 
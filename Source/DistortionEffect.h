@@ -33,6 +33,7 @@
 #include "DropdownList.h"
 #include "BiquadFilter.h"
 #include "PeakTracker.h"
+#include "Oversampler.h"
 
 class DistortionEffect : public IAudioEffect, public IFloatSliderListener, public IDropdownListener
 {
@@ -50,6 +51,7 @@ public:
    void ProcessAudio(double time, ChannelBuffer* buffer) override;
    void SetEnabled(bool enabled) override { mEnabled = enabled; }
    float GetEffectAmount() override;
+   int GetLatency() override { return mEnabled ? (int)round(mOversampler.GetLatency()) : 0; }
    string GetType() override { return "distortion"; }
    
    void CheckboxUpdated(Checkbox* checkbox) override;
@@ -71,6 +73,9 @@ private:
    void GetModuleDimensions(float& width, float& height) override;
    void DrawModule() override;
    bool Enabled() const override { return mEnabled; }
+   
+   template<DistortionType kType> static float Shape(float sample);
+   template<DistortionType kType> void ProcessChannel(float* data, int length, float peak, bool modulated, int oversampling);
 
    float mWidth;
    float mHeight;
@@ -81,14 +86,17 @@ private:
    float mPreamp;
    float mFuzzAmount;
    bool mRemoveInputDC;
+   int mOversampleMode;
    
    DropdownList* mTypeDropdown;
    FloatSlider* mClipSlider;
    FloatSlider* mPreampSlider;
    Checkbox* mRemoveInputDCCheckbox;
    FloatSlider* mFuzzAmountSlider;
+   DropdownList* mOversampleDropdown;
    BiquadFilter mDCRemover[ChannelBuffer::kMaxNumChannels];
    PeakTracker mPeakTracker[ChannelBuffer::kMaxNumChannels];
+   Oversampler mOversampler;
 };
 
 #endif /* defined(__modularSynth__DistortionEffect__) */
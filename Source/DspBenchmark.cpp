@@ -0,0 +1,614 @@
+/**
+    bespoke synth, a software modular synthesizer
+    Copyright (C) 2021 Ryan Challinor (contact: awwbees@gmail.com)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**/
+/*
+  ==============================================================================
+
+    DspBenchmark.cpp
+    Created: 16 Jul 2021 6:48:03pm
+    Author:  Ryan Challinor
+
+  ==============================================================================
+*/
+
+#include "DspBenchmark.h"
+#include "ModularSynth.h"
+#include "SynthGlobals.h"
+#include "Oscillator.h"
+#include "BiquadFilter.h"
+#include "BiquadBank.h"
+#include "FFT.h"
+#include "RollingBuffer.h"
+#include "ADSR.h"
+#include "Granulator.h"
+#include "PolyphonyMgr.h"
+#include "FMVoice.h"
+#include "KarplusStrongVoice.h"
+#include "SingleOscillatorVoice.h"
+#include "SampleVoice.h"
+#include "ModulationChain.h"
+#include <algorithm>
+#include <chrono>
+#include <sstream>
+
+namespace
+{
+   const int kBlockSize = 256;
+   
+   volatile float sSink = 0;   //results get added in here so the optimizer can't throw the work away
+   
+   uint64_t GetTimestampNs()
+   {
+      return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+   }
+   
+   const char* GetOscillatorTypeName(OscillatorType type)
+   {
+      switch (type)
+      {
+         case kOsc_Sin: return "sin";
+         case kOsc_Square: return "square";
+         case kOsc_Tri: return "tri";
+         case kOsc_Saw: return "saw";
+         case kOsc_NegSaw: return "negsaw";
+         case kOsc_Random: return "random";
+         case kOsc_Drunk: return "drunk";
+         case kOsc_Perlin: return "perlin";
+      }
+      return "unknown";
+   }
+   
+   const char* GetVoiceTypeName(VoiceType type)
+   {
+      switch (type)
+      {
+         case kVoiceType_Karplus: return "karplus";
+         case kVoiceType_FM: return "fm";
+         case kVoiceType_SingleOscillator: return "singleoscillator";
+         case kVoiceType_Sampler: return "sampler";
+      }
+      return "unknown";
+   }
+   
+   class BenchmarkRunner
+   {
+   public:
+      BenchmarkRunner(string filter, double secondsPerBenchmark) : mFilter(filter), mSecondsPerBenchmark(secondsPerBenchmark) {}
+      
+      //times func in batches, and keeps the median and fastest batch. itemsPerCall is what the cost gets divided by (usually samples).
+      template<class F> void Measure(string name, int itemsPerCall, F func)
+      {
+         if (!mFilter.empty() && name.find(mFilter) == string::npos)
+            return;
+         
+         for (int i=0; i<10; ++i)   //warm up caches and lazily allocated state
+            func();
+         
+         //size batches to about a millisecond, so timer resolution doesn't matter
+         int callsPerBatch = 1;
+         while (true)
+         {
+            uint64_t start = GetTimestampNs();
+            for (int i=0; i<callsPerBatch; ++i)
+               func();
+            if (GetTimestampNs() - start > 1000000 || callsPerBatch >= (1 << 24))
+               break;
+            callsPerBatch *= 2;
+         }
+         
+         vector<double> nsPerItem;
+         uint64_t benchmarkStart = GetTimestampNs();
+         while (nsPerItem.size() < 5 || (GetTimestampNs() - benchmarkStart < mSecondsPerBenchmark * 1e9 && nsPerItem.size() < 10000))
+         {
+            uint64_t start = GetTimestampNs();
+            for (int i=0; i<callsPerBatch; ++i)
+               func();
+            nsPerItem.push_back(double(GetTimestampNs() - start) / (double(callsPerBatch) * itemsPerCall));
+         }
+         std::sort(nsPerItem.begin(), nsPerItem.end());
+         
+         Result result;
+         result.mName = name;
+         result.mItemsPerCall = itemsPerCall;
+         result.mMedianNsPerItem = nsPerItem[nsPerItem.size() / 2];
+         result.mMinNsPerItem = nsPerItem[0];
+         result.mNumCalls = (int64)callsPerBatch * (int64)nsPerItem.size();
+         mResults.push_back(result);
+         
+         ofLog() << name << ": " << result.mMedianNsPerItem << " ns per item (min " << result.mMinNsPerItem << ")";
+      }
+      
+      string ToJson() const
+      {
+         std::ostringstream json;
+         json << "{\"sample_rate\":" << gSampleRate << ",\"block_size\":" << kBlockSize << ",\"results\":[";
+         for (size_t i=0; i<mResults.size(); ++i)
+         {
+            const Result& result = mResults[i];
+            json << (i == 0 ? "" : ",") << "\n{\"name\":\"" << result.mName << "\",\"items_per_call\":" << result.mItemsPerCall
+                 << ",\"median_ns_per_item\":" << result.mMedianNsPerItem << ",\"min_ns_per_item\":" << result.mMinNsPerItem
+                 << ",\"calls\":" << result.mNumCalls << "}";
+         }
+         json << "\n]}\n";
+         return json.str();
+      }
+      
+   private:
+      struct Result
+      {
+         string mName;
+         int mItemsPerCall;
+         double mMedianNsPerItem;
+         double mMinNsPerItem;
+         int64 mNumCalls;
+      };
+      
+      string mFilter;
+      double mSecondsPerBenchmark;
+      vector<Result> mResults;
+   };
+   
+   void FillWithNoise(float* buffer, int length)
+   {
+      for (int i=0; i<length; ++i)
+         buffer[i] = ofRandom(-1, 1);
+   }
+   
+   void BenchmarkOscillators(BenchmarkRunner& runner)
+   {
+      OscillatorType types[] = { kOsc_Sin, kOsc_Square, kOsc_Tri, kOsc_Saw, kOsc_NegSaw, kOsc_Random, kOsc_Drunk, kOsc_Perlin };
+      for (OscillatorType type : types)
+      {
+         Oscillator osc(type);
+         float phase = 0;
+         float phaseInc = GetPhaseInc(220);
+         runner.Measure(string("oscillator_value/") + GetOscillatorTypeName(type), kBlockSize, [&]()
+         {
+            float sum = 0;
+            for (int i=0; i<kBlockSize; ++i)
+            {
+               phase += phaseInc;
+               sum += osc.Value(phase);
+            }
+            phase = fmod(phase, FTWO_PI);
+            sSink = sSink + sum;
+         });
+         runner.Measure(string("oscillator_value_bandlimited/") + GetOscillatorTypeName(type), kBlockSize, [&]()
+         {
+            float sum = 0;
+            for (int i=0; i<kBlockSize; ++i)
+            {
+               phase += phaseInc;
+               sum += osc.Value(phase, phaseInc);
+            }
+            phase = fmod(phase, FTWO_PI);
+            sSink = sSink + sum;
+         });
+      }
+   }
+   
+   void BenchmarkBiquad(BenchmarkRunner& runner)
+   {
+      float input[kBlockSize];
+      float buffer[kBlockSize];
+      FillWithNoise(input, kBlockSize);
+      
+      BiquadFilter filter;
+      filter.SetFilterType(kFilterType_Lowpass);
+      filter.SetFilterParams(1000, sqrt(2)/2);
+      
+      runner.Measure("biquad_filter/sample", kBlockSize, [&]()
+      {
+         float sum = 0;
+         for (int i=0; i<kBlockSize; ++i)
+            sum += filter.Filter(input[i]);
+         sSink = sSink + sum;
+      });
+      runner.Measure("biquad_filter/buffer", kBlockSize, [&]()
+      {
+         BufferCopy(buffer, input, kBlockSize);
+         filter.Filter(buffer, kBlockSize);
+         sSink = sSink + buffer[kBlockSize - 1];
+      });
+      
+      //items are channel samples, so these compare directly with the scalar filter above
+      float bufferRight[kBlockSize];
+      float* channels[2] = { buffer, bufferRight };
+      BiquadBank bank;
+      bank.SetTargetAllLanes(0, filter);
+      bank.StartRamp(0);
+      runner.Measure("biquad_bank/stereo", kBlockSize * 2, [&]()
+      {
+         BufferCopy(buffer, input, kBlockSize);
+         BufferCopy(bufferRight, input, kBlockSize);
+         bank.Process(channels, 2, kBlockSize);
+         sSink = sSink + buffer[kBlockSize - 1];
+      });
+      
+      float bands[BiquadBank::kNumLanes][kBlockSize];
+      float* outputs[BiquadBank::kNumLanes] = { bands[0], bands[1], bands[2], bands[3] };
+      BiquadBank cascade;
+      cascade.SetNumStages(4);
+      for (int stage=0; stage<4; ++stage)
+         cascade.SetTargetAllLanes(stage, filter);
+      cascade.StartRamp(0);
+      runner.Measure("biquad_bank/4x4_cascade_ramped", kBlockSize * BiquadBank::kNumLanes * 4, [&]()
+      {
+         cascade.SetTargetAllLanes(0, filter);
+         cascade.ProcessSplit(input, outputs, BiquadBank::kNumLanes, kBlockSize);
+         sSink = sSink + bands[0][kBlockSize - 1];
+      });
+   }
+   
+   void BenchmarkFFT(BenchmarkRunner& runner)
+   {
+      for (int size = 256; size <= 8192; size *= 2)
+      {
+         FFT fft(size);
+         vector<float> input(size);
+         vector<float> output(size);
+         vector<float> real(size / 2 + 1);
+         vector<float> imaginary(size / 2 + 1);
+         FillWithNoise(input.data(), size);
+         fft.Forward(input.data(), real.data(), imaginary.data());
+         
+         runner.Measure("fft_forward/" + ofToString(size), size, [&]()
+         {
+            fft.Forward(input.data(), real.data(), imaginary.data());
+            sSink = sSink + real[1];
+         });
+         
+         vector<float> savedReal = real;
+         vector<float> savedImaginary = imaginary;
+         runner.Measure("fft_inverse/" + ofToString(size), size, [&]()
+         {
+            real = savedReal;   //in case the inverse works in place
+            imaginary = savedImaginary;
+            fft.Inverse(real.data(), imaginary.data(), output.data());
+            sSink = sSink + output[1];
+         });
+      }
+   }
+   
+   //checks the fft against a plain dft in doubles, for both the bin layouts the modules use, so a faster fft can't quietly change the numbers.
+   //returns false and logs the worst error if anything is off by more than float rounding should allow.
+   bool VerifyFFT()
+   {
+      bool passed = true;
+      auto check = [&passed](string name, double error, double scale)
+      {
+         double relativeError = error / MAX(scale, 1e-12);
+         if (relativeError > 1e-4)
+         {
+            ofLog() << "fft verify failed: " << name << " is off by " << relativeError << " relative to the reference";
+            passed = false;
+         }
+      };
+      
+      for (int size = 16; size <= 8192; size *= 2)
+      {
+         int half = size / 2;
+         vector<float> input(size);
+         FillWithNoise(input.data(), size);
+         
+         vector<double> cosTable(size);
+         vector<double> sinTable(size);
+         for (int n=0; n<size; ++n)
+         {
+            cosTable[n] = cos(-2 * M_PI * n / size);
+            sinTable[n] = sin(-2 * M_PI * n / size);
+         }
+         
+         vector<double> dftRe(half + 1);
+         vector<double> dftIm(half + 1);
+         double dftScale = 0;
+         for (int k=0; k<=half; ++k)
+         {
+            for (int n=0; n<size; ++n)
+            {
+               int angle = (int)((int64)k * n % size);
+               dftRe[k] += input[n] * cosTable[angle];
+               dftIm[k] += input[n] * sinTable[angle];
+            }
+            dftScale = MAX(dftScale, sqrt(dftRe[k] * dftRe[k] + dftIm[k] * dftIm[k]));
+         }
+         
+         FFT fft(size);
+         vector<float> re(half + 1);
+         vector<float> im(half + 1);
+         fft.ForwardBins(input.data(), re.data(), im.data());
+         double binsError = 0;
+         for (int k=0; k<=half; ++k)
+            binsError = MAX(binsError, MAX(fabs(re[k] - dftRe[k]), fabs(im[k] - dftIm[k])));
+         check("bins/" + ofToString(size), binsError, dftScale);
+         
+         //the mayer layout: real parts in place, negated imaginary parts one bin lower, and the nyquist bin's real part in the last imaginary slot
+         fft.Forward(input.data(), re.data(), im.data());
+         double layoutError = 0;
+         for (int k=0; k<=half; ++k)
+         {
+            double expectedIm = (k < half - 1) ? -dftIm[k + 1] : (k == half - 1 ? dftRe[half] : 0);
+            layoutError = MAX(layoutError, MAX(fabs(re[k] - dftRe[k]), fabs(im[k] - expectedIm)));
+         }
+         check("mayer_layout/" + ofToString(size), layoutError, dftScale);
+         
+         vector<float> output(size);
+         fft.Inverse(re.data(), im.data(), output.data());
+         double roundTripError = 0;
+         for (int n=0; n<size; ++n)
+            roundTripError = MAX(roundTripError, fabs(output[n] - input[n] * size));
+         check("round_trip/" + ofToString(size), roundTripError, size);
+         
+         //and the complex plan on its own, at the same size
+         const FFTPlan& plan = FFTPlan::Get(size);
+         vector<float> planRe(size);
+         vector<float> planIm(size);
+         FillWithNoise(planRe.data(), size);
+         FillWithNoise(planIm.data(), size);
+         vector<float> planInputRe = planRe;
+         vector<float> planInputIm = planIm;
+         plan.Forward(planRe.data(), planIm.data());
+         double planError = 0;
+         double planScale = 0;
+         for (int k=0; k<size; ++k)
+         {
+            double expectedRe = 0;
+            double expectedIm = 0;
+            for (int n=0; n<size; ++n)
+            {
+               int angle = (int)((int64)k * n % size);
+               expectedRe += planInputRe[n] * cosTable[angle] - planInputIm[n] * sinTable[angle];
+               expectedIm += planInputRe[n] * sinTable[angle] + planInputIm[n] * cosTable[angle];
+            }
+            planError = MAX(planError, MAX(fabs(planRe[k] - expectedRe), fabs(planIm[k] - expectedIm)));
+            planScale = MAX(planScale, sqrt(expectedRe * expectedRe + expectedIm * expectedIm));
+         }
+         check("plan/" + ofToString(size), planError, planScale);
+      }
+      
+      ofLog() << "fft verify " << (passed ? "passed" : "FAILED");
+      return passed;
+   }
+   
+   void BenchmarkInterpolatedSample(BenchmarkRunner& runner)
+   {
+      int length = gSampleRate;
+      vector<float> buffer(length);
+      FillWithNoise(buffer.data(), length);
+      double offset = 0;
+      
+      runner.Measure("get_interpolated_sample", kBlockSize, [&]()
+      {
+         float sum = 0;
+         for (int i=0; i<kBlockSize; ++i)
+         {
+            offset += 1.37;   //a playback rate that never lands on whole samples
+            if (offset >= length)
+               offset -= length;
+            sum += GetInterpolatedSample(offset, buffer.data(), length);
+         }
+         sSink = sSink + sum;
+      });
+   }
+   
+   void BenchmarkRollingBuffer(BenchmarkRunner& runner)
+   {
+      RollingBuffer rollingBuffer(gSampleRate * 5);   //a delay line of a few seconds
+      rollingBuffer.SetNumChannels(1);
+      float input[kBlockSize];
+      float output[kBlockSize];
+      FillWithNoise(input, kBlockSize);
+      
+      runner.Measure("rolling_buffer/write_chunk", kBlockSize, [&]()
+      {
+         rollingBuffer.WriteChunk(input, kBlockSize, 0);
+      });
+      runner.Measure("rolling_buffer/read_chunk", kBlockSize, [&]()
+      {
+         rollingBuffer.ReadChunk(output, kBlockSize, gSampleRate / 2, 0);
+         sSink = sSink + output[0];
+      });
+   }
+   
+   void BenchmarkADSR(BenchmarkRunner& runner)
+   {
+      ::ADSR adsr(10, 100, .5f, 200);
+      double time = 0;
+      adsr.Start(time, 1);
+      
+      runner.Measure("adsr_value", kBlockSize, [&]()
+      {
+         float sum = 0;
+         for (int i=0; i<kBlockSize; ++i)
+         {
+            time += gInvSampleRateMs;
+            sum += adsr.Value(time);
+         }
+         //cycle through every stage
+         if (time > 500)
+         {
+            time = 0;
+            adsr.Start(time, 1);
+         }
+         else if (time > 300 && adsr.GetStopTime(time) < adsr.GetStartTime(time))
+         {
+            adsr.Stop(time, false);
+         }
+         sSink = sSink + sum;
+      });
+   }
+   
+   void BenchmarkGranulator(BenchmarkRunner& runner)
+   {
+      ChannelBuffer buffer(gSampleRate * 5);
+      buffer.SetNumActiveChannels(2);
+      for (int ch=0; ch<2; ++ch)
+         FillWithNoise(buffer.GetChannel(ch), buffer.BufferSize());
+      
+      ChannelBuffer output(kBlockSize);
+      output.SetNumActiveChannels(2);
+      float* outputChannels[2] = { output.GetChannel(0), output.GetChannel(1) };
+      
+      const float kOverlaps[] = { 12, 256 };
+      for (float overlap : kOverlaps)
+      {
+         Granulator granulator;
+         granulator.mGrainOverlap = overlap;
+         granulator.mGrainLengthMs = 300;
+         double time = 0;
+         double offset = 0;
+         
+         runner.Measure("granulator/overlap_" + ofToString(overlap), kBlockSize, [&]()
+         {
+            granulator.Process(time, &buffer, buffer.BufferSize(), offset, 1, outputChannels, kBlockSize);
+            time += kBlockSize * gInvSampleRateMs;
+            offset += kBlockSize;
+            if (offset >= buffer.BufferSize())
+               offset -= buffer.BufferSize();
+            sSink = sSink + outputChannels[0][0] + outputChannels[1][kBlockSize-1];
+         });
+      }
+   }
+   
+   void BenchmarkPolyphony(BenchmarkRunner& runner)
+   {
+      FMVoiceParams fmParams;
+      fmParams.mOscADSRParams.Set(10, 0, 1, 10);
+      fmParams.mModIdxADSRParams.Set(1, 0, 1, 1);
+      fmParams.mHarmRatioADSRParams.Set(1, 0, 1, 1);
+      fmParams.mModIdxADSRParams2.Set(1, 0, 1, 1);
+      fmParams.mHarmRatioADSRParams2.Set(1, 0, 1, 1);
+      fmParams.mModIdx = 2;
+      fmParams.mHarmRatio = 2;
+      fmParams.mModIdx2 = 1;
+      fmParams.mHarmRatio2 = 3;
+      fmParams.mVol = 1;
+      fmParams.mPhaseOffset0 = 0;
+      fmParams.mPhaseOffset1 = 0;
+      fmParams.mPhaseOffset2 = 0;
+      
+      KarplusStrongVoiceParams karplusParams;
+      karplusParams.mFeedback = .999f;   //keep ringing for the whole benchmark
+      
+      OscillatorVoiceParams oscillatorParams;
+      oscillatorParams.mAdsr.Set(10, 0, 1, 10);
+      oscillatorParams.mVol = .25f;
+      oscillatorParams.mPulseWidth = .5f;
+      oscillatorParams.mSync = false;
+      oscillatorParams.mSyncFreq = 200;
+      oscillatorParams.mMult = 1;
+      oscillatorParams.mOscType = kOsc_Saw;
+      oscillatorParams.mDetune = 0;
+      oscillatorParams.mShuffle = 0;
+      oscillatorParams.mPhaseOffset = 0;
+      oscillatorParams.mUnison = 1;
+      oscillatorParams.mUnisonWidth = 0;
+      oscillatorParams.mSoften = 0;
+      oscillatorParams.mFilterAdsr.Set(1, 0, 1, 1000);
+      oscillatorParams.mFilterCutoffMax = 4000;   //with the filter on, which is the expensive path
+      oscillatorParams.mFilterCutoffMin = 10;
+      oscillatorParams.mFilterQ = sqrt(2)/2;
+      oscillatorParams.mVelToVolume = .5f;
+      oscillatorParams.mVelToEnvelope = 0;
+      oscillatorParams.mLiteCPUMode = false;
+      oscillatorParams.mBandLimited = false;
+      
+      vector<float> sampleData(gSampleRate * 2);
+      FillWithNoise(sampleData.data(), (int)sampleData.size());
+      SampleVoiceParams sampleParams;
+      sampleParams.mAdsr.Set(10, 0, 1, 10);
+      sampleParams.mVol = 1;
+      sampleParams.mSampleData = sampleData.data();
+      sampleParams.mSampleLength = (int)sampleData.size();
+      sampleParams.mDetectedFreq = 440;
+      sampleParams.mLoop = true;
+      
+      std::pair<VoiceType, IVoiceParams*> voiceTypes[] = { std::make_pair(kVoiceType_Karplus, (IVoiceParams*)&karplusParams),
+                                                           std::make_pair(kVoiceType_FM, (IVoiceParams*)&fmParams),
+                                                           std::make_pair(kVoiceType_SingleOscillator, (IVoiceParams*)&oscillatorParams),
+                                                           std::make_pair(kVoiceType_Sampler, (IVoiceParams*)&sampleParams) };
+      for (auto& voiceType : voiceTypes)
+      {
+         PolyphonyMgr polyMgr(nullptr);
+         polyMgr.Init(voiceType.first, voiceType.second);
+         ChannelBuffer out(kBlockSize);
+         out.SetNumActiveChannels(2);
+         
+         double time = 0;
+         for (int i=0; i<kNumVoices; ++i)
+            polyMgr.Start(time, 36 + i * 3, 1, -1, ModulationParameters());
+         
+         runner.Measure(string("polyphony_process/") + GetVoiceTypeName(voiceType.first) + "/" + ofToString(kNumVoices) + "_voices", kBlockSize, [&]()
+         {
+            out.Clear();
+            polyMgr.Process(time, &out, kBlockSize);
+            time += kBlockSize * gInvSampleRateMs;
+            sSink = sSink + out.GetChannel(0)[0];
+         });
+      }
+   }
+}
+
+//static
+bool DspBenchmark::IsRequested(const juce::StringArray& args)
+{
+   return args.contains("--benchmark");
+}
+
+//static
+int DspBenchmark::Run(const juce::StringArray& args)
+{
+   auto getOption = [&args](juce::String name, juce::String defaultValue)
+   {
+      int index = args.indexOf(name);
+      if (index != -1 && index + 1 < args.size())
+         return args[index + 1];
+      return defaultValue;
+   };
+   
+   juce::File output = juce::File::getCurrentWorkingDirectory().getChildFile(getOption("--out", "benchmark.json"));
+   string filter = getOption("--filter", "").toStdString();
+   double secondsPerBenchmark = getOption("--seconds-per", "0.5").getDoubleValue();
+   
+   //the kernels lean on the globals (sample rate, scale, transport), so stand up a synth with nothing loaded
+   SetGlobalSampleRateAndBufferSize(48000, kBlockSize);
+   GlobalManagers globalManagers;
+   ModularSynth synth;
+   synth.Setup(&globalManagers, nullptr, nullptr);
+   
+   bool verified = true;
+   if (string("fft_verify").find(filter) != string::npos)
+      verified = VerifyFFT();
+   
+   BenchmarkRunner runner(filter, secondsPerBenchmark);
+   BenchmarkOscillators(runner);
+   BenchmarkBiquad(runner);
+   BenchmarkFFT(runner);
+   BenchmarkInterpolatedSample(runner);
+   BenchmarkRollingBuffer(runner);
+   BenchmarkADSR(runner);
+   BenchmarkGranulator(runner);
+   BenchmarkPolyphony(runner);
+   
+   if (!output.replaceWithText(runner.ToJson()))
+   {
+      ofLog() << "couldn't write to " << output.getFullPathName().toStdString();
+      return 1;
+   }
+   ofLog() << "wrote benchmark results to " << output.getFullPathName().toStdString();
+   return verified ? 0 : 1;
+}
@@ -0,0 +1,40 @@
+/**
+    bespoke synth, a software modular synthesizer
+    Copyright (C) 2021 Ryan Challinor (contact: awwbees@gmail.com)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**/
+/*
+  ==============================================================================
+
+    DspBenchmark.h
+    Created: 16 Jul 2021 6:48:03pm
+    Author:  Ryan Challinor
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+//micro-benchmarks of the core dsp kernels, at the sizes we actually run them at. results are written as json so changes can be diffed against a baseline.
+//BespokeSynth --benchmark [--out benchmark.json] [--filter fft] [--seconds-per 0.5]
+//the fft is also checked against a reference dft first, and a mismatch makes the run exit with 1.
+class DspBenchmark
+{
+public:
+   static bool IsRequested(const juce::StringArray& args);
+   static int Run(const juce::StringArray& args);   //returns the exit code
+};
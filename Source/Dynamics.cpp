@@ -0,0 +1,114 @@
+/**
+    bespoke synth, a software modular synthesizer
+    Copyright (C) 2021 Ryan Challinor (contact: awwbees@gmail.com)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**/
+/*
+  ==============================================================================
+
+    Dynamics.cpp
+    Created: 24 Jul 2021 3:12:48pm
+    Author:  Ryan Challinor
+
+  ==============================================================================
+*/
+
+#include "Dynamics.h"
+#include "SimdFloat.h"
+#include "SynthGlobals.h"
+
+namespace
+{
+   const float kMinLevel = 1e-25f;   //-500dB
+   const float kLog2ToDb = 6.02059991327962390f;   //20 * log10(2)
+   const float kDbToLog2 = 0.16609640474436811f;   //log2(10) / 20
+   const int kNumLanes = SimdFloat::kNumLanes;
+}
+
+void Dynamics::DetectLinkedPeak(ChannelBuffer* buffer, float* output, int length)
+{
+   Clear(output, length);
+   for (int ch=0; ch<buffer->NumActiveChannels(); ++ch)
+   {
+      const float* input = buffer->GetChannel(ch);
+      int i = 0;
+      for (; i + kNumLanes <= length; i += kNumLanes)
+         Max(SimdFloat::Load(output + i), Abs(SimdFloat::Load(input + i))).Store(output + i);
+      for (; i < length; ++i)
+         output[i] = MAX(output[i], fabsf(input[i]));
+   }
+}
+
+void Dynamics::LinearToDb(const float* input, float* output, int length)
+{
+   int i = 0;
+   for (; i + kNumLanes <= length; i += kNumLanes)
+      (FastLog2(Max(SimdFloat::Load(input + i), kMinLevel)) * kLog2ToDb).Store(output + i);
+   for (; i < length; ++i)
+      output[i] = log2f(MAX(input[i], kMinLevel)) * kLog2ToDb;
+}
+
+void Dynamics::DbToLinear(const float* input, float* output, int length)
+{
+   int i = 0;
+   for (; i + kNumLanes <= length; i += kNumLanes)
+      FastExp2(SimdFloat::Load(input + i) * kDbToLog2).Store(output + i);
+   for (; i < length; ++i)
+      output[i] = exp2f(input[i] * kDbToLog2);
+}
+
+void Dynamics::ApplyGain(ChannelBuffer* buffer, const float* gain, int length)
+{
+   for (int ch=0; ch<buffer->NumActiveChannels(); ++ch)
+      Mult(buffer->GetChannel(ch), gain, length);
+}
+
+LookaheadDelay::LookaheadDelay(int maxDelaySamples)
+: mSize(maxDelaySamples + gBufferSize)
+, mWritePos(0)
+{
+   for (int ch=0; ch<ChannelBuffer::kMaxNumChannels; ++ch)
+      mBuffer[ch].resize(mSize * 2);
+}
+
+void LookaheadDelay::Process(ChannelBuffer* buffer, int length, int delaySamples)
+{
+   delaySamples = CLAMP(delaySamples, 0, mSize - length);
+   int firstPart = MIN(length, mSize - mWritePos);
+   int readPos = (mWritePos - delaySamples + mSize) % mSize;
+
+   for (int ch=0; ch<buffer->NumActiveChannels(); ++ch)
+   {
+      float* data = buffer->GetChannel(ch);
+      float* history = mBuffer[ch].data();
+
+      //write into both copies, wrapping around the end
+      BufferCopy(history + mWritePos, data, firstPart);
+      BufferCopy(history + mWritePos + mSize, data, firstPart);
+      BufferCopy(history, data + firstPart, length - firstPart);
+      BufferCopy(history + mSize, data + firstPart, length - firstPart);
+
+      BufferCopy(data, history + readPos, length);
+   }
+
+   mWritePos = (mWritePos + length) % mSize;
+}
+
+void LookaheadDelay::Clear()
+{
+   for (int ch=0; ch<ChannelBuffer::kMaxNumChannels; ++ch)
+      std::fill(mBuffer[ch].begin(), mBuffer[ch].end(), 0.0f);
+   mWritePos = 0;
+}
@@ -0,0 +1,61 @@
+/**
+    bespoke synth, a software modular synthesizer
+    Copyright (C) 2021 Ryan Challinor (contact: awwbees@gmail.com)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**/
+/*
+  ==============================================================================
+
+    Dynamics.h
+    Created: 24 Jul 2021 3:12:48pm
+    Author:  Ryan Challinor
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include "ChannelBuffer.h"
+#include <vector>
+
+//block helpers for compressors, gates and anything else that rides gain on a level
+namespace Dynamics
+{
+   //the loudest channel at each sample, so that gain computed from it treats every channel the same
+   void DetectLinkedPeak(ChannelBuffer* buffer, float* output, int length);
+
+   //20*log10() and back, using FastLog2()/FastExp2(). anything quieter than -500dB reads as -500dB.
+   void LinearToDb(const float* input, float* output, int length);
+   void DbToLinear(const float* input, float* output, int length);
+
+   //multiplies every active channel by the same gain curve
+   void ApplyGain(ChannelBuffer* buffer, const float* gain, int length);
+}
+
+//delays whole buffers by up to a fixed number of samples. the history is kept twice, one copy right after the other,
+//so any delayed block is a single contiguous read.
+class LookaheadDelay
+{
+public:
+   LookaheadDelay(int maxDelaySamples);
+
+   void Process(ChannelBuffer* buffer, int length, int delaySamples);
+   void Clear();
+
+private:
+   int mSize;
+   int mWritePos;
+   std::vector<float> mBuffer[ChannelBuffer::kMaxNumChannels];
+};
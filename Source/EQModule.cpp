@@ -34,18 +34,12 @@ EQModule::EQModule()
    : IAudioProcessor(gBufferSize)
    , mWidth(825)
    , mHeight(255)
-   , mFFT(kNumFFTBins)
-   , mFFTData(kNumFFTBins, kNumFFTBins / 2 + 1)
-   , mRollingInputBuffer(kNumFFTBins)
+   , mAnalysis(kNumFFTBins, kNumFFTBins / 4)
    , mHoveredFilterHandleIndex(-1)
    , mDragging(false)
    , mNeedToUpdateFrequencyResponseGraph(true)
    , mDrawGain(1)
 {
-   // Generate a window with a single raised cosine from N/4 to 3N/4
-   mWindower = new float[kNumFFTBins];
-   for (int i = 0; i < kNumFFTBins; ++i)
-      mWindower[i] = -.5f*cos(FTWO_PI*i / kNumFFTBins) + .5f;
    mSmoother = new float[kNumFFTBins / 2 + 1 - kBinIgnore];
    for (int i = 0; i < kNumFFTBins / 2 + 1 - kBinIgnore; ++i)
       mSmoother[i] = 0;
@@ -57,11 +51,8 @@ EQModule::EQModule()
    {
       auto& filter = mFilters[i];
       filter.mEnabled = i < 4;
-      for (auto& biquad : filter.mFilter)
-      {
-         biquad.SetFilterParams(cutoffs[i], sqrtf(2)/2);
-         biquad.SetFilterType(types[i]);
-      }
+      filter.mFilter.SetFilterParams(cutoffs[i], sqrtf(2)/2);
+      filter.mFilter.SetFilterType(types[i]);
       filter.mNeedToCalculateCoefficients = true;
    }
 }
@@ -76,10 +67,10 @@ void EQModule::CreateUIControls()
       auto& filter = mFilters[i];
 
       CHECKBOX(filter.mEnabledCheckbox, ("enabled" + ofToString(i)).c_str(), &filter.mEnabled);
-      DROPDOWN(filter.mTypeSelector, ("type" + ofToString(i)).c_str(), (int*)(&filter.mFilter[0].mType), 45);
-      FLOATSLIDER(filter.mFSlider, ("f" + ofToString(i)).c_str(), &filter.mFilter[0].mF, 0, 10000);
-      FLOATSLIDER(filter.mGSlider, ("g" + ofToString(i)).c_str(), &filter.mFilter[0].mDbGain, -15, 15);
-      FLOATSLIDER(filter.mQSlider, ("q" + ofToString(i)).c_str(), &filter.mFilter[0].mQ, .1f, 18);
+      DROPDOWN(filter.mTypeSelector, ("type" + ofToString(i)).c_str(), (int*)(&filter.mFilter.mType), 45);
+      FLOATSLIDER(filter.mFSlider, ("f" + ofToString(i)).c_str(), &filter.mFilter.mF, 0, 10000);
+      FLOATSLIDER(filter.mGSlider, ("g" + ofToString(i)).c_str(), &filter.mFilter.mDbGain, -15, 15);
+      FLOATSLIDER(filter.mQSlider, ("q" + ofToString(i)).c_str(), &filter.mFilter.mQ, .1f, 18);
       UIBLOCK_NEWCOLUMN();
 
       filter.mTypeSelector->AddLabel("lp", kFilterType_Lowpass);
@@ -92,15 +83,14 @@ void EQModule::CreateUIControls()
 
       filter.mFSlider->SetMode(FloatSlider::kSquare);
       filter.mQSlider->SetMode(FloatSlider::kSquare);
-      filter.mGSlider->SetShowing(filter.mFilter[0].UsesGain());
-      filter.mQSlider->SetShowing(filter.mFilter[0].UsesQ());
+      filter.mGSlider->SetShowing(filter.mFilter.UsesGain());
+      filter.mQSlider->SetShowing(filter.mFilter.UsesQ());
    }
    ENDUIBLOCK0();
 }
 
 EQModule::~EQModule()
 {
-   delete[] mWindower;
    delete[] mSmoother;
 }
 
@@ -110,13 +100,17 @@ void EQModule::Process(double time)
 
    ComputeSliders(0);
 
-   for (auto& filter : mFilters)
+   for (size_t i=0; i<mFilters.size(); ++i)
    {
-      if (filter.mEnabled)
+      auto& filter = mFilters[i];
+      if (filter.UpdateCoefficientsIfNecessary())
       {
-         bool updated = filter.UpdateCoefficientsIfNecessary();
-         if (updated)
-            mNeedToUpdateFrequencyResponseGraph = true;
+         //disabled filters stay in the cascade as passthrough stages, so switching them doesn't click
+         if (filter.mEnabled)
+            mFilterBank.SetTargetAllLanes((int)i, filter.mFilter);
+         else
+            mFilterBank.SetTargetPassthrough((int)i);
+         mNeedToUpdateFrequencyResponseGraph = true;
       }
    }
 
@@ -134,16 +128,26 @@ void EQModule::Process(double time)
       ChannelBuffer* out = target->GetBuffer();
       gWorkChannelBuffer.SetNumActiveChannels(out->NumActiveChannels());
 
+      float* channels[ChannelBuffer::kMaxNumChannels];
       for (int ch = 0; ch < GetBuffer()->NumActiveChannels(); ++ch)
       {
          BufferCopy(gWorkChannelBuffer.GetChannel(ch), GetBuffer()->GetChannel(ch), GetBuffer()->BufferSize());
-         for (auto& filter : mFilters)
-         {
-            if (filter.mEnabled)
-               filter.mFilter[ch].Filter(gWorkChannelBuffer.GetChannel(ch), GetBuffer()->BufferSize());
-         }
-         //Add(gWorkChannelBuffer.GetChannel(ch), GetBuffer()->GetChannel(ch), GetBuffer()->BufferSize());
+         channels[ch] = gWorkChannelBuffer.GetChannel(ch);
+      }
+
+      //only run as far as the last enabled filter, but give one that was just switched off this buffer to ramp out
+      int numStages = 0;
+      for (size_t i=0; i<mFilters.size(); ++i)
+      {
+         if (mFilters[i].mEnabled)
+            numStages = (int)i + 1;
+      }
+      mFilterBank.SetNumStages(MAX(numStages, mFilterBank.GetNumStages()));
+      mFilterBank.Process(channels, GetBuffer()->NumActiveChannels(), GetBuffer()->BufferSize());
+      mFilterBank.SetNumStages(numStages);
 
+      for (int ch = 0; ch < GetBuffer()->NumActiveChannels(); ++ch)
+      {
          Add(out->GetChannel(ch), gWorkChannelBuffer.GetChannel(ch), GetBuffer()->BufferSize());
          GetVizBuffer()->WriteChunk(gWorkChannelBuffer.GetChannel(ch), GetBuffer()->BufferSize(), ch);
       }
@@ -151,15 +155,7 @@ void EQModule::Process(double time)
       for (int ch = 0; ch < GetBuffer()->NumActiveChannels(); ++ch)
          Add(gWorkBuffer, gWorkChannelBuffer.GetChannel(ch), GetBuffer()->BufferSize());
 
-      mRollingInputBuffer.WriteChunk(gWorkBuffer, GetBuffer()->BufferSize(), 0);
-
-      //copy rolling input buffer into working buffer and window it
-      mRollingInputBuffer.ReadChunk(mFFTData.mTimeDomain, kNumFFTBins, 0, 0);
-      Mult(mFFTData.mTimeDomain, mWindower, kNumFFTBins);
-
-      mFFT.Forward(mFFTData.mTimeDomain,
-         mFFTData.mRealValues,
-         mFFTData.mImaginaryValues);
+      mAnalysis.WriteLatest(gWorkBuffer, GetBuffer()->BufferSize());
    }
    else   //passthrough
    {
@@ -183,8 +179,8 @@ void EQModule::DrawModule()
    {
       filter.mTypeSelector->SetShowing(filter.mEnabled);
       filter.mFSlider->SetShowing(filter.mEnabled);
-      filter.mGSlider->SetShowing(filter.mEnabled && filter.mFilter[0].UsesGain());
-      filter.mQSlider->SetShowing(filter.mEnabled && filter.mFilter[0].UsesQ());
+      filter.mGSlider->SetShowing(filter.mEnabled && filter.mFilter.UsesGain());
+      filter.mQSlider->SetShowing(filter.mEnabled && filter.mFilter.UsesQ());
 
       filter.mEnabledCheckbox->Draw();
       filter.mTypeSelector->Draw();
@@ -210,7 +206,7 @@ void EQModule::DrawModule()
    {
       float freq = FreqForBin(i);
       float x = PosForFreq(freq) * w;
-      float samp = ofClamp(sqrtf(fabsf(mFFTData.mRealValues[i]) / end) * 3 * mDrawGain, 0, 1);
+      float samp = ofClamp(sqrtf(fabsf(mAnalysis.GetFrame().mRealValues[i]) / end) * 3 * mDrawGain, 0, 1);
       float y = (1 - samp) * h + kDrawYOffset;
       if (int(x) != lastX)
          ofVertex(x, y);
@@ -258,7 +254,7 @@ void EQModule::DrawModule()
             for (auto& filter : mFilters)
             {
                if (filter.mEnabled)
-                  response *= filter.mFilter[0].GetMagnitudeResponseAt(freq);
+                  response *= filter.mFilter.GetMagnitudeResponseAt(freq);
             }
             if (responseGraphIndex < mFrequencyResponse.size())
                mFrequencyResponse[responseGraphIndex] = response;
@@ -278,8 +274,8 @@ void EQModule::DrawModule()
       auto& filter = mFilters[i];
       if (filter.mEnabled)
       {
-         float x = PosForFreq(filter.mFilter[0].mF) * w;
-         float y = PosForGain(filter.mFilter[0].mDbGain) * h + kDrawYOffset;
+         float x = PosForFreq(filter.mFilter.mF) * w;
+         float y = PosForGain(filter.mFilter.mDbGain) * h + kDrawYOffset;
          ofFill();
          ofSetColor(255, 210, 0);
          ofCircle(x, y, 8);
@@ -302,9 +298,7 @@ bool EQModule::Filter::UpdateCoefficientsIfNecessary()
 {
    if (mNeedToCalculateCoefficients)
    {
-      mFilter[0].UpdateFilterCoeff();
-      for (size_t ch = 1; ch < mFilter.size(); ++ch)
-         mFilter[ch].CopyCoeffFrom(mFilter[0]);
+      mFilter.UpdateFilterCoeff();
       mNeedToCalculateCoefficients = false;
       return true;
    }
@@ -349,8 +343,8 @@ bool EQModule::MouseMoved(float x, float y)
       for (int i = 0; i < mFilters.size(); ++i)
       {
          if (mFilters[i].mEnabled &&
-             abs(x - PosForFreq(mFilters[i].mFilter[0].mF)*w) < 5 &&
-             abs((y - kDrawYOffset) - PosForGain(mFilters[i].mFilter[0].mDbGain)*h) < 5)
+             abs(x - PosForFreq(mFilters[i].mFilter.mF)*w) < 5 &&
+             abs((y - kDrawYOffset) - PosForGain(mFilters[i].mFilter.mDbGain)*h) < 5)
          {
             mHoveredFilterHandleIndex = i;
             break;
@@ -381,7 +375,7 @@ void EQModule::DropdownUpdated(DropdownList* list, int oldVal)
    {
       if (list == filter.mTypeSelector)
       {
-         filter.mFilter[0].SetFilterType(filter.mFilter[0].mType);
+         filter.mFilter.SetFilterType(filter.mFilter.mType);
          filter.mNeedToCalculateCoefficients = true;
       }
    }
@@ -393,8 +387,7 @@ void EQModule::CheckboxUpdated(Checkbox* checkbox)
    {
       if (checkbox == filter.mEnabledCheckbox)
       {
-         filter.mFilter[0].Clear();
-         filter.mFilter[1].Clear();
+         filter.mNeedToCalculateCoefficients = true;   //moves its stage in or out of the cascade
          mNeedToUpdateFrequencyResponseGraph = true;
       }
    }
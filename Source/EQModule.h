@@ -30,9 +30,9 @@
 #include "IAudioProcessor.h"
 #include "IDrawableModule.h"
 #include "Slider.h"
-#include "FFT.h"
-#include "RollingBuffer.h"
+#include "Stft.h"
 #include "BiquadFilter.h"
+#include "BiquadBank.h"
 #include "DropdownList.h"
 
 class EQModule : public IAudioProcessor, public IDrawableModule, public IFloatSliderListener, public IDropdownListener
@@ -82,17 +82,14 @@ private:
    float mWidth;
    float mHeight;
 
-   float* mWindower;
    float* mSmoother;
 
-   ::FFT mFFT;
-   FFTData mFFTData;
-   RollingBuffer mRollingInputBuffer;
+   StftAnalysis mAnalysis;
 
    struct Filter
    {
       bool mEnabled;
-      std::array<BiquadFilter,2> mFilter;
+      BiquadFilter mFilter;   //parameters and coefficient math, the audio runs through the bank
       Checkbox* mEnabledCheckbox;
       DropdownList* mTypeSelector;
       FloatSlider* mFSlider;
@@ -104,6 +101,7 @@ private:
    };
 
    std::array<Filter, 8> mFilters;
+   BiquadBank mFilterBank;   //one stage per filter, one lane per channel
    int mHoveredFilterHandleIndex;
    int mDragging;
    std::array<float, 1024> mFrequencyResponse;
@@ -44,6 +44,7 @@ EffectChain::EffectChain()
 , mShowSpawnList(true)
 , mWantToDeleteEffectAtIndex(-1)
 , mPush2DisplayEffect(nullptr)
+, mDryDelays(MAX_EFFECTS_IN_CHAIN)
 {
 }
 
@@ -127,7 +128,7 @@ void EffectChain::Process(double time)
    if (target == nullptr)
       return;
 
-   ComputeSliders(0);
+   bool modulated = ComputeSliderBlocks();
    SyncBuffers();
    mDryBuffer.SetNumActiveChannels(GetBuffer()->NumActiveChannels());
    
@@ -139,24 +140,46 @@ void EffectChain::Process(double time)
       
       for (int i=0; i<mEffects.size(); ++i)
       {
-         mDryBuffer.CopyFrom(GetBuffer());
+         bool mixDry = modulated || mDryWetLevels[i] < 1;   //fully wet effects don't need the dry signal at all
+         if (mixDry)
+            mDryBuffer.CopyFrom(GetBuffer());
          
-         mEffects[i]->ProcessAudio(time,GetBuffer());
-       
-         float* dryWetBuffer = gWorkBuffer;
-         float* invDryWetBuffer = gWorkBuffer + bufferSize;
-         for (int j = 0; j < bufferSize; ++j)
          {
-            ComputeSliders(j);
-            dryWetBuffer[j] = mDryWetLevels[i];
-            invDryWetBuffer[j] = 1.0f - mDryWetLevels[i];
+            PROFILER_MODULE(mEffects[i]);
+            mEffects[i]->ProcessAudio(time,GetBuffer());
          }
-
-         for (int ch=0; ch<GetBuffer()->NumActiveChannels(); ++ch)
+         
+         if (mixDry)
+            DelayDryBuffer(i, mEffects[i]->GetLatency());
+         else
+            mDryDelays[i].mEffect = nullptr;   //the history goes stale while it isn't needed
+         
+         if (modulated)
+         {
+            float* dryWetBuffer = gWorkBuffer;
+            float* invDryWetBuffer = gWorkBuffer + bufferSize;
+            for (int j = 0; j < bufferSize; ++j)
+            {
+               ComputeModulatedSliders(j);
+               dryWetBuffer[j] = mDryWetLevels[i];
+               invDryWetBuffer[j] = 1.0f - mDryWetLevels[i];
+            }
+
+            for (int ch=0; ch<GetBuffer()->NumActiveChannels(); ++ch)
+            {
+               Mult(mDryBuffer.GetChannel(ch), invDryWetBuffer, bufferSize);
+               Mult(GetBuffer()->GetChannel(ch), dryWetBuffer, bufferSize);
+               Add(GetBuffer()->GetChannel(ch), mDryBuffer.GetChannel(ch), bufferSize);
+            }
+         }
+         else if (mixDry)
          {
-            Mult(mDryBuffer.GetChannel(ch), invDryWetBuffer, bufferSize);
-            Mult(GetBuffer()->GetChannel(ch), dryWetBuffer, bufferSize);
-            Add(GetBuffer()->GetChannel(ch), mDryBuffer.GetChannel(ch), bufferSize);
+            for (int ch=0; ch<GetBuffer()->NumActiveChannels(); ++ch)
+            {
+               Mult(mDryBuffer.GetChannel(ch), 1.0f - mDryWetLevels[i], bufferSize);
+               Mult(GetBuffer()->GetChannel(ch), mDryWetLevels[i], bufferSize);
+               Add(GetBuffer()->GetChannel(ch), mDryBuffer.GetChannel(ch), bufferSize);
+            }
          }
       }
       
@@ -176,6 +199,40 @@ void EffectChain::Process(double time)
    GetBuffer()->Reset();
 }
 
+void EffectChain::DelayDryBuffer(int index, int latency)
+{
+   DryDelay& delay = mDryDelays[index];
+   latency = MIN(latency, kMaxDryDelay);
+   if (delay.mEffect != mEffects[index] || delay.mLatency != latency)
+   {
+      delay.mEffect = mEffects[index];
+      delay.mLatency = latency;
+      delay.mPos = 0;
+      bzero(delay.mHistory, sizeof(delay.mHistory));
+   }
+   
+   if (latency == 0)
+      return;
+   
+   int bufferSize = mDryBuffer.BufferSize();
+   int pos = delay.mPos;
+   for (int ch=0; ch<mDryBuffer.NumActiveChannels(); ++ch)
+   {
+      float* dry = mDryBuffer.GetChannel(ch);
+      float* history = delay.mHistory[ch];
+      pos = delay.mPos;
+      for (int i=0; i<bufferSize; ++i)
+      {
+         float delayed = history[pos];
+         history[pos] = dry[i];
+         dry[i] = delayed;
+         if (++pos == latency)
+            pos = 0;
+      }
+   }
+   delay.mPos = pos;
+}
+
 void EffectChain::Poll()
 {
    if (mWantToDeleteEffectAtIndex != -1)
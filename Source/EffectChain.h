@@ -88,6 +88,7 @@ private:
    void MoveEffect(int index, int direction);
    void UpdateReshuffledDryWetSliders();
    ofVec2f GetEffectPos(int index) const;
+   void DelayDryBuffer(int index, int latency);
 
    struct EffectControls
    {
@@ -103,6 +104,17 @@ private:
    vector<EffectControls> mEffectControls;
    std::array<float, MAX_EFFECTS_IN_CHAIN> mDryWetLevels;
    
+   //delays each effect's dry signal by the effect's latency, so mixing doesn't comb filter
+   static const int kMaxDryDelay = 128;
+   struct DryDelay
+   {
+      IAudioEffect* mEffect{ nullptr };   //the history is thrown out when a different effect moves into the slot
+      int mLatency{ 0 };
+      int mPos{ 0 };
+      float mHistory[ChannelBuffer::kMaxNumChannels][kMaxDryDelay];
+   };
+   std::vector<DryDelay> mDryDelays;   //per effect slot
+   
    double mSwapTime;
    int mSwapFromIdx;
    int mSwapToIdx;
@@ -0,0 +1,155 @@
+/**
+    bespoke synth, a software modular synthesizer
+    Copyright (C) 2021 Ryan Challinor (contact: awwbees@gmail.com)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**/
+/*
+  ==============================================================================
+
+    EventSchedule.h
+    Created: 21 Jul 2021 10:12:37am
+    Author:  Ryan Challinor
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <vector>
+#include <algorithm>
+#include <cstdint>
+
+//events waiting for their time to come up. T needs a double "time" member.
+//events live in pooled slots ordered by a min-heap, so adding one and taking the next due one are O(log n), and cancelling one is O(1).
+//events with the same time come out in the order they were added.
+template<typename T>
+class EventSchedule
+{
+public:
+   EventSchedule()
+   : mNextOrder(0)
+   , mNumActive(0)
+   {
+   }
+
+   //returns a handle that stays valid until the event comes out of PopDue() or gets cancelled
+   int Add(const T& event)
+   {
+      int slot;
+      if (mFreeSlots.empty())
+      {
+         slot = (int)mSlots.size();
+         mSlots.push_back(Slot());
+      }
+      else
+      {
+         slot = mFreeSlots.back();
+         mFreeSlots.pop_back();
+      }
+
+      mSlots[slot].event = event;
+      mSlots[slot].active = true;
+      mHeap.push_back(HeapEntry{ event.time, mNextOrder++, slot });
+      std::push_heap(mHeap.begin(), mHeap.end(), IsLater);
+      ++mNumActive;
+      return slot;
+   }
+
+   //takes the earliest event that's before time. returns false if there isn't one.
+   bool PopDue(double time, T& event, int& handle)
+   {
+      while (!mHeap.empty() && mHeap.front().time < time)
+      {
+         int slot = mHeap.front().slot;
+         std::pop_heap(mHeap.begin(), mHeap.end(), IsLater);
+         mHeap.pop_back();
+         mFreeSlots.push_back(slot);   //a cancelled slot waits for its heap entry to come out before getting reused
+
+         if (mSlots[slot].active)
+         {
+            mSlots[slot].active = false;
+            --mNumActive;
+            event = mSlots[slot].event;
+            handle = slot;
+            return true;
+         }
+      }
+      return false;
+   }
+
+   bool PopDue(double time, T& event)
+   {
+      int handle;
+      return PopDue(time, event, handle);
+   }
+
+   void Cancel(int handle)
+   {
+      if (mSlots[handle].active)
+      {
+         mSlots[handle].active = false;
+         --mNumActive;
+      }
+   }
+
+   const T& Get(int handle) const { return mSlots[handle].event; }
+
+   template<typename F>
+   void ForEach(F func) const
+   {
+      for (const auto& slot : mSlots)
+      {
+         if (slot.active)
+            func(slot.event);
+      }
+   }
+
+   void Clear()
+   {
+      mSlots.clear();
+      mFreeSlots.clear();
+      mHeap.clear();
+      mNumActive = 0;
+   }
+
+   int GetNumEvents() const { return mNumActive; }
+
+private:
+   struct Slot
+   {
+      T event;
+      bool active;
+   };
+
+   struct HeapEntry
+   {
+      double time;
+      uint64_t order;
+      int slot;
+   };
+
+   static bool IsLater(const HeapEntry& a, const HeapEntry& b)
+   {
+      if (a.time != b.time)
+         return a.time > b.time;
+      return a.order > b.order;
+   }
+
+   std::vector<Slot> mSlots;
+   std::vector<int> mFreeSlots;
+   std::vector<HeapEntry> mHeap;
+   uint64_t mNextOrder;
+   int mNumActive;
+};
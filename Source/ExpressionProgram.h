@@ -0,0 +1,42 @@
+/**
+    bespoke synth, a software modular synthesizer
+    Copyright (C) 2021 Ryan Challinor (contact: awwbees@gmail.com)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**/
+/*
+  ==============================================================================
+
+    ExpressionProgram.h
+    Created: 12 Jul 2021 9:04:37pm
+    Author:  Ryan Challinor
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include "CompiledExpression.h"
+#include "AudioThreadEpoch.h"
+#include "exprtk/exprtk.hpp"
+
+//a parsed expression, as the audio thread runs it. editing the text builds a whole new one on the ui thread and publishes it through
+//an AudioThreadSnapshot, so the one the audio thread is evaluating is never changed under it, and is only freed once the audio thread
+//has moved on. that way the ui never needs the audio mutex to swap expressions, and no buffer gets dropped.
+struct ExpressionProgram
+{
+   bool mValid{ false };   //false if exprtk couldn't parse it
+   exprtk::expression<float> mExpression;
+   mutable CompiledExpression mCompiled;   //runs it a block at a time when it fits the compiled subset. evaluating updates its table, which only the audio thread does.
+};
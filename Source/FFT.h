@@ -29,18 +29,53 @@
 #include <iostream>
 #include "SynthGlobals.h"
 
-// Variables for FFT routine
+//precomputed bit reversal and twiddle tables for a complex fft of one power of two size.
+//plans are built once per size and shared, so get them through Get() rather than making them.
+class FFTPlan
+{
+public:
+   static const FFTPlan& Get(int size);
+   
+   int GetSize() const { return mSize; }
+   
+   //in place on split real and imaginary arrays, unnormalized in both directions
+   void Forward(float* re, float* im) const;
+   void Inverse(float* re, float* im) const { Forward(im, re); }   //swapping the parts conjugates the input and the output, which turns it into the inverse
+   
+private:
+   FFTPlan(int size);
+   
+   int mSize;
+   vector<int> mSwaps;   //index pairs for the bit reversal permutation
+   vector<float> mTwiddleRe;   //twiddles for each stage from half size 4 up, back to back
+   vector<float> mTwiddleIm;
+};
+
+//real fft, run as a complex fft of half the size
 class FFT
 {
 public:
    FFT(int nfft);
    ~FFT();
+   
+   //bin k in re[k] and im[k] for k up to nfft/2, with the usual e^-i sign. unnormalized, so InverseBins(ForwardBins(x)) is nfft*x.
+   //InverseBins() takes the dc and nyquist bins as purely real.
+   void ForwardBins(const float* input, float* re, float* im);
+   void InverseBins(const float* re, const float* im, float* output);
+   
+   //the layout the spectral modules were written against: the imaginary parts are negated and stored one bin lower,
+   //so output_im[k] holds bin k+1, and output_im[nfft/2-1] holds the real part of the nyquist bin
    void Forward(float* input, float* output_re, float* output_im);
    void Inverse(float* input_re, float* input_im, float* output);
 private:
    int mNfft;        // size of FFT
    int mNumfreqs;    // number of frequencies represented (nfft/2 + 1)
-   float* mFft_data; // array for writing/reading to/from FFT function
+   const FFTPlan& mPlan;
+   vector<float> mWorkRe;
+   vector<float> mWorkIm;
+   vector<float> mTwiddleRe;   //e^(-i*pi*k/(nfft/2)), to split the half size transform into the real spectrum
+   vector<float> mTwiddleIm;
+   vector<float> mBinsIm;
 };
 
 struct FFTData
@@ -76,17 +111,4 @@ struct FFTData
    float* mTimeDomain;
 };
 
-
-#ifndef MAYER_H
-#define MAYER_H
-
-#define REAL float
-
-void mayer_realfft(int n, REAL *real);
-void mayer_realifft(int n, REAL *real);
-
-#endif
-
-
-
 #endif /* defined(__modularSynth__FFT__) */
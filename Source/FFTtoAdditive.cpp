@@ -31,6 +31,7 @@ namespace
 {
    const int fftWindowSize = 1024;
    const int fftFreqDomainSize = fftWindowSize/2 + 1;
+   const int fftHopSize = fftWindowSize/4;
 
    const int numPartials = fftFreqDomainSize-1;
 
@@ -41,10 +42,9 @@ namespace
 
 FFTtoAdditive::FFTtoAdditive()
 : IAudioProcessor(gBufferSize)
-, mFFT(fftWindowSize)
-, mRollingInputBuffer(fftWindowSize)
-, mRollingOutputBuffer(fftWindowSize)
 , mFFTData(fftWindowSize, fftFreqDomainSize)
+, mAnalysis(fftWindowSize, fftHopSize)
+, mSamplesSinceFrame(0)
 , mInputPreamp(1)
 , mValue1(1)
 , mVolume(1)
@@ -61,11 +61,6 @@ FFTtoAdditive::FFTtoAdditive()
 , mPhaseOffsetSlider(nullptr)
 , mHistoryPtr(0)
 {
-   // Generate a window with a single raised cosine from N/4 to 3N/4
-   mWindower = new float[fftWindowSize];
-   for (int i=0; i<fftWindowSize; ++i)
-      mWindower[i] = -.5*cos(FTWO_PI*i/fftWindowSize)+.5;
-
    mPhaseInc = new float[numPartials];
    for (int i=0; i<numPartials; ++i)
    {
@@ -94,7 +89,6 @@ void FFTtoAdditive::CreateUIControls()
 
 FFTtoAdditive::~FFTtoAdditive()
 {
-   delete[] mWindower;
 }
 
 void FFTtoAdditive::Process(double time)
@@ -113,22 +107,43 @@ void FFTtoAdditive::Process(double time)
    float volSq = mVolume * mVolume;
 
    int bufferSize = GetBuffer()->BufferSize();
+   float* input = GetBuffer()->GetChannel(0);
+   float* out = target->GetBuffer()->GetChannel(0);
+
+   //play the partials from the latest frame, and pick up new ones once per hop
+   for (int pos=0; pos<bufferSize;)
+   {
+      int numSamples = MIN(bufferSize - pos, mAnalysis.SamplesUntilFrame());
+      for (int i=pos; i<pos+numSamples; ++i)
+      {
+         float write = 0;
+         for (int j=1; j<numPartials; ++j)
+         {
+            float phase = ((mFFTData.mImaginaryValues[j+1] + mSamplesSinceFrame*mPhaseInc[j]) / FTWO_PI) * 512;
+            float sample = SinSample(phase) * mFFTData.mRealValues[j+1] * volSq * .4f;
+            write += sample;
+         }
+
+         GetVizBuffer()->Write(write, 0);
 
-   mRollingInputBuffer.WriteChunk(GetBuffer()->GetChannel(0), bufferSize, 0);
+         out[i] += write;
+         ++mSamplesSinceFrame;
+      }
 
-   //copy rolling input buffer into working buffer and window it
-   mRollingInputBuffer.ReadChunk(mFFTData.mTimeDomain, fftWindowSize, 0, 0);
-   Mult(mFFTData.mTimeDomain, mWindower, fftWindowSize);
-   Mult(mFFTData.mTimeDomain, inputPreampSq, fftWindowSize);
+      if (mAnalysis.Write(input + pos, numSamples, inputPreampSq))
+         UpdatePartials(mAnalysis.GetFrame());
+      pos += numSamples;
+   }
 
-   mFFT.Forward(mFFTData.mTimeDomain,
-                mFFTData.mRealValues,
-                mFFTData.mImaginaryValues);
+   GetBuffer()->Reset();
+}
 
+void FFTtoAdditive::UpdatePartials(const FFTData& frame)
+{
    for (int i=0; i<fftFreqDomainSize; ++i)
    {
-      float real = mFFTData.mRealValues[i];
-      float imag = mFFTData.mImaginaryValues[i];
+      float real = frame.mRealValues[i];
+      float imag = frame.mImaginaryValues[i];
 
       //cartesian to polar
       float amp = 2.*sqrtf(real*real + imag*imag);
@@ -137,26 +152,7 @@ void FFTtoAdditive::Process(double time)
       mFFTData.mRealValues[i] = amp / (fftWindowSize/2);
       mFFTData.mImaginaryValues[i] = phase;
    }
-
-   float* out = target->GetBuffer()->GetChannel(0);
-   for (int i=0; i<bufferSize; ++i)
-   {
-      float write = 0;
-      for (int j=1; j<numPartials; ++j)
-      {
-         float phase = ((mFFTData.mImaginaryValues[j+1] + i*mPhaseInc[j]) / FTWO_PI) * 512;
-         float sample = SinSample(phase) * mFFTData.mRealValues[j+1] * volSq * .4f;
-         write += sample;
-      }
-
-      GetVizBuffer()->Write(write, 0);
-
-      out[i] += write;
-
-      time += gInvSampleRateMs;
-   }
-
-   GetBuffer()->Reset();
+   mSamplesSinceFrame = 0;
 }
 
 float FFTtoAdditive::SinSample(float phase)
@@ -30,8 +30,7 @@
 #include "IAudioProcessor.h"
 #include "IDrawableModule.h"
 #include "Checkbox.h"
-#include "FFT.h"
-#include "RollingBuffer.h"
+#include "Stft.h"
 #include "Slider.h"
 #include "GateEffect.h"
 #include "BiquadFilterEffect.h"
@@ -74,13 +73,12 @@ private:
    void GetModuleDimensions(float& w, float& h) override { w=235; h=170; }
    bool Enabled() const override { return mEnabled; }
 
-   FFTData mFFTData;
-   
-   float* mWindower;
+   void UpdatePartials(const FFTData& frame);
+
+   FFTData mFFTData;   //partial amplitudes in the real values, and phases in the imaginary ones
 
-   ::FFT mFFT;
-   RollingBuffer mRollingInputBuffer;
-   RollingBuffer mRollingOutputBuffer;
+   StftAnalysis mAnalysis;
+   int mSamplesSinceFrame;
 
    float mInputPreamp;
    float mValue1;
@@ -26,77 +26,320 @@
 #include "FileStream.h"
 #include "ModularSynth.h"
 #include "SynthGlobals.h"
+#include <set>
+
+namespace
+{
+   const int kChunkedStreamTag = 0x4b4e4843;   //"CHNK", chunk table pointed to from the end of the file. streams without a tag are from before audio was chunked.
+   const int kIndexedStreamTag = 0x324b4843;   //"CHK2", chunk table pointed to from the header, so later saves can be appended
+   const int64 kHeaderSize = sizeof(int) + sizeof(int64);
+   const int kSamplesPerChunk = 65536;
+   const int kSilentChunk = -1;   //CHNK streams marked silence in place of a chunk index, now the chunk table does
+   const int64 kSilentChunkOffset = -1;
+   
+   typedef std::pair<uint64_t, uint64_t> ChunkHash;
+   
+   ChunkHash HashSamples(const float* samples, int size)
+   {
+      //fnv-1a and a multiply-xorshift over whole samples. within a save collisions are caught by comparing the samples,
+      //but chunks from earlier saves are only on disk, so they're matched on both hashes.
+      uint64_t fnv = 14695981039346656037ULL;
+      uint64_t mix = 0x9e3779b97f4a7c15ULL ^ (uint64_t)size;
+      const uint32_t* words = reinterpret_cast<const uint32_t*>(samples);
+      for (int i=0; i<size; ++i)
+      {
+         fnv ^= words[i];
+         fnv *= 1099511628211ULL;
+         mix = (mix ^ words[i]) * 0xff51afd7ed558ccdULL;
+         mix ^= mix >> 29;
+      }
+      return ChunkHash(fnv, mix);
+   }
+   
+   bool IsSilent(const float* samples, int size)
+   {
+      for (int i=0; i<size; ++i)
+      {
+         if (samples[i] != 0)
+            return false;
+      }
+      return true;
+   }
+}
+
+bool SaveChunkIndex::CanAppendTo(string path) const
+{
+   //appending leaves everything older saves used in the file, so start over once it's mostly dead space
+   return path == mPath && mFileSize > 0 && mFileSize <= 2 * mLiveBytes && File(path).getSize() == mFileSize;
+}
+
+void SaveChunkIndex::Reset(string path)
+{
+   mPath = path;
+   mFileSize = 0;
+   mLiveBytes = 0;
+   mChunks.clear();
+   mAppendedAt = -1;
+   mTableOffset = 0;
+}
 
 FileStreamOut::FileStreamOut(const char* file)
-: mStream(File(file))
+: mIndex(nullptr)
+, mBaseOffset(0)
+{
+   FileOutputStream* stream = new FileOutputStream(File(file));
+   stream->setPosition(0);
+   stream->truncate();
+   mStream.reset(stream);
+   int64 tableOffset = 0;   //filled in at the end
+   *this << kIndexedStreamTag;
+   WriteGeneric(&tableOffset, sizeof(int64));
+   mStreamStart = kHeaderSize;
+}
+
+FileStreamOut::FileStreamOut(MemoryBlock& destination, SaveChunkIndex* index /*= nullptr*/)
+: mStream(new MemoryOutputStream(destination, false))
+, mIndex(index)
+, mBaseOffset(index != nullptr ? index->mFileSize : 0)
 {
-   mStream.setPosition(0);
-   mStream.truncate();
+   if (mBaseOffset == 0)
+   {
+      if (mIndex != nullptr)
+         mIndex->mChunks.clear();
+      int64 tableOffset = 0;
+      *this << kIndexedStreamTag;
+      WriteGeneric(&tableOffset, sizeof(int64));
+   }
+   mStreamStart = mBaseOffset + mStream->getPosition();
 }
 
 FileStreamOut::~FileStreamOut()
 {
-   mStream.flush();
+   WriteChunks();
+   mStream->flush();
 }
 
 FileStreamIn::FileStreamIn(const char* file)
 : mStream(File(file))
+, mHasChunks(false)
+, mHasHashes(false)
+, mStreamStart(0)
+, mStreamEnd(0)
+, mTableOffset(0)
 {
+   int tag = 0;
+   int64 length = mStream.openedOk() ? mStream.getTotalLength() : 0;
+   if (length >= kHeaderSize)
+      Peek(&tag, sizeof(int));
+   if (tag == kChunkedStreamTag)
+   {
+      *this >> tag;
+      int64 tableOffset;
+      mStream.setPosition(length - sizeof(int64));
+      ReadGeneric(&tableOffset, sizeof(int64));
+      ReadChunkTable(tableOffset, false);
+      mStream.setPosition(sizeof(int));
+   }
+   else if (tag == kIndexedStreamTag)
+   {
+      *this >> tag;
+      int64 tableOffset;
+      ReadGeneric(&tableOffset, sizeof(int64));
+      if (!ReadChunkTable(tableOffset, true))
+         mStreamStart = kHeaderSize;
+      mStream.setPosition(mStreamStart);
+   }
 }
 
 FileStreamOut& FileStreamOut::operator<<(const int &var)
 {
-   mStream.write((const void*)&var, sizeof(int));
+   mStream->write((const void*)&var, sizeof(int));
    return *this;
 }
 
 FileStreamOut& FileStreamOut::operator<<(const uint32_t &var)
 {
-   mStream.write((const void*)&var, sizeof(uint32_t));
+   mStream->write((const void*)&var, sizeof(uint32_t));
    return *this;
 }
 
 FileStreamOut& FileStreamOut::operator<<(const bool &var)
 {
-   mStream.write((const void*)&var, sizeof(bool));
+   mStream->write((const void*)&var, sizeof(bool));
    return *this;
 }
 
 FileStreamOut& FileStreamOut::operator<<(const float &var)
 {
-   mStream.write((const void*)&var, sizeof(float));
+   mStream->write((const void*)&var, sizeof(float));
    return *this;
 }
 
 FileStreamOut& FileStreamOut::operator<<(const double &var)
 {
-   mStream.write((const void*)&var, sizeof(double));
+   mStream->write((const void*)&var, sizeof(double));
    return *this;
 }
 
 FileStreamOut& FileStreamOut::operator<<(const string &var)
 {
    size_t len = var.length();
-   mStream.write((const void*)&len, sizeof(size_t));
-   for (int i=0; i<len; ++i)
-      mStream.write((const void*)&var[i], sizeof(char));
+   mStream->write((const void*)&len, sizeof(size_t));
+   mStream->write((const void*)var.data(), len);
    return *this;
 }
 
 FileStreamOut& FileStreamOut::operator<<(const char &var)
 {
-   mStream.write(&var, sizeof(char));
+   mStream->write(&var, sizeof(char));
    return *this;
 }
 
 void FileStreamOut::Write(const float* buffer, int size)
 {
-   mStream.write((const void*)buffer, sizeof(float)*size);
+   auto stash = mStashes.find(std::make_pair(buffer, size));
+   if (stash != mStashes.end())
+   {
+      int index = stash->second;
+      mStashes.erase(stash);
+      for (int pos=0; pos<size; pos += kSamplesPerChunk, ++index)
+      {
+         mChunks[index].mReferenced = true;
+         *this << index;
+      }
+      return;
+   }
+   
+   for (int pos=0; pos<size; pos += kSamplesPerChunk)
+   {
+      int index = AddChunk(buffer + pos, MIN(kSamplesPerChunk, size - pos));
+      mChunks[index].mReferenced = true;
+      *this << index;
+   }
+}
+
+void FileStreamOut::Stash(const float* buffer, int size)
+{
+   if (size <= 0)
+      return;
+   int first = (int)mChunks.size();
+   for (int pos=0; pos<size; pos += kSamplesPerChunk)
+      AddChunk(buffer + pos, MIN(kSamplesPerChunk, size - pos));
+   mStashes[std::make_pair(buffer, size)] = first;
+}
+
+int FileStreamOut::AddChunk(const float* samples, int size)
+{
+   int index = (int)mChunks.size();
+   mChunks.push_back(SampleChunk());
+   mChunks.back().mSamples.assign(samples, samples + size);
+   mChunks.back().mReferenced = false;
+   return index;
+}
+
+void FileStreamOut::WriteChunks()
+{
+   //chunk data, then the table of where each chunk is, and then the header gets pointed at the table.
+   //identical chunks share their data, silent or unused ones don't get any, and ones the file already has from an earlier save aren't written again.
+   int64 streamEnd = mBaseOffset + mStream->getPosition();
+   int64 liveBytes = streamEnd - mStreamStart + kHeaderSize;
+   vector<int64> offsets;
+   vector<ChunkHash> hashes;
+   offsets.reserve(mChunks.size());
+   hashes.reserve(mChunks.size());
+   std::map<ChunkHash, int> saved;
+   for (int i=0; i<(int)mChunks.size(); ++i)
+   {
+      const SampleChunk& chunk = mChunks[i];
+      const float* samples = chunk.mSamples.data();
+      int size = (int)chunk.mSamples.size();
+      if (!chunk.mReferenced || IsSilent(samples, size))
+      {
+         offsets.push_back(kSilentChunkOffset);
+         hashes.push_back(ChunkHash(0, 0));
+         continue;
+      }
+      
+      ChunkHash hash = HashSamples(samples, size);
+      int64 offset = kSilentChunkOffset;
+      auto inThisSave = saved.find(hash);
+      if (inThisSave != saved.end())
+      {
+         const SampleChunk& other = mChunks[inThisSave->second];
+         if ((int)other.mSamples.size() == size && memcmp(other.mSamples.data(), samples, sizeof(float)*size) == 0)
+            offset = offsets[inThisSave->second];
+      }
+      
+      if (offset == kSilentChunkOffset && mIndex != nullptr)
+      {
+         auto inFile = mIndex->mChunks.find(hash);
+         if (inFile != mIndex->mChunks.end() && inFile->second.mNumSamples == size)
+         {
+            offset = inFile->second.mOffset;
+            liveBytes += sizeof(float) * size;
+         }
+      }
+      
+      if (offset == kSilentChunkOffset)
+      {
+         offset = mBaseOffset + mStream->getPosition();
+         mStream->write((const void*)samples, sizeof(float)*size);
+         liveBytes += sizeof(float) * size;
+      }
+      
+      if (inThisSave == saved.end())
+         saved[hash] = i;
+      offsets.push_back(offset);
+      hashes.push_back(hash);
+   }
+   
+   int64 tableOffset = mBaseOffset + mStream->getPosition();
+   *this << (int)mChunks.size();
+   for (size_t i=0; i<mChunks.size(); ++i)
+   {
+      WriteGeneric(&offsets[i], sizeof(int64));
+      *this << (int)mChunks[i].mSamples.size();
+      WriteGeneric(&hashes[i].first, sizeof(uint64_t));
+      WriteGeneric(&hashes[i].second, sizeof(uint64_t));
+   }
+   WriteGeneric(&mStreamStart, sizeof(int64));
+   WriteGeneric(&streamEnd, sizeof(int64));
+   int64 end = mStream->getPosition();
+   liveBytes += mBaseOffset + end - tableOffset;
+   
+   //an appended stream has no header of its own, the writer points the file's header at the new table once it's all on disk
+   if (mBaseOffset == 0)
+   {
+      mStream->setPosition(sizeof(int));
+      WriteGeneric(&tableOffset, sizeof(int64));
+      mStream->setPosition(end);
+   }
+   
+   if (mIndex != nullptr)
+   {
+      for (size_t i=0; i<mChunks.size(); ++i)
+      {
+         if (offsets[i] != kSilentChunkOffset)
+         {
+            SaveChunkIndex::Location location;
+            location.mOffset = offsets[i];
+            location.mNumSamples = (int)mChunks[i].mSamples.size();
+            mIndex->mChunks[hashes[i]] = location;
+         }
+      }
+      mIndex->mAppendedAt = mBaseOffset == 0 ? -1 : mBaseOffset;
+      mIndex->mTableOffset = tableOffset;
+      mIndex->mFileSize = mBaseOffset + end;
+      mIndex->mLiveBytes = liveBytes;
+   }
+   
+   mChunks.clear();
+   mStashes.clear();
 }
 
 void FileStreamOut::WriteGeneric(const void* buffer, int size)
 {
-   mStream.write((const void*)buffer, size);
+   mStream->write((const void*)buffer, size);
 }
 
 FileStreamIn& FileStreamIn::operator>>(int &var)
@@ -153,7 +396,122 @@ FileStreamIn& FileStreamIn::operator>>(char &var)
 
 void FileStreamIn::Read(float* buffer, int size)
 {
-   mStream.read((void*)buffer, sizeof(float)*size);
+   if (!mHasChunks)
+   {
+      mStream.read((void*)buffer, sizeof(float)*size);
+      return;
+   }
+   
+   //chunks are paged in straight from the file as they're asked for
+   for (int pos=0; pos<size; pos += kSamplesPerChunk)
+   {
+      int length = MIN(kSamplesPerChunk, size - pos);
+      int index;
+      *this >> index;
+      if (index == kSilentChunk)
+      {
+         FloatVectorOperations::clear(buffer + pos, length);
+         continue;
+      }
+      
+      //a bad index or table entry fails the module's load, rather than reading garbage from wherever it points
+      LoadStateValidate(index >= 0 && index < (int)mChunks.size() && mChunks[index].mNumSamples == length);
+      if (mChunks[index].mOffset == kSilentChunkOffset)
+      {
+         FloatVectorOperations::clear(buffer + pos, length);
+         continue;
+      }
+      auto returnPos = mStream.getPosition();
+      mStream.setPosition(mChunks[index].mOffset);
+      mStream.read((void*)(buffer + pos), sizeof(float)*length);
+      mStream.setPosition(returnPos);
+   }
+}
+
+bool FileStreamIn::ReadChunkTable(int64 tableOffset, bool hasHashes)
+{
+   //a damaged table leaves no chunks (or bad entries zeroed out), so reading audio through it fails the load instead of reading garbage
+   int64 length = mStream.getTotalLength();
+   mHasChunks = true;
+   mHasHashes = false;
+   mChunks.clear();
+   mStreamStart = hasHashes ? kHeaderSize : (int64)sizeof(int);
+   mStreamEnd = length;
+   mTableOffset = tableOffset;
+   
+   int64 entrySize = sizeof(int64) + sizeof(int) + (hasHashes ? 2 * sizeof(uint64_t) : 0);
+   int64 trailerSize = hasHashes ? 2 * sizeof(int64) : sizeof(int64);
+   if (tableOffset < mStreamStart || tableOffset + (int64)sizeof(int) + trailerSize > length)
+      return false;
+   
+   mStream.setPosition(tableOffset);
+   int numChunks;
+   *this >> numChunks;
+   if (numChunks < 0 || numChunks > (length - tableOffset - (int64)sizeof(int) - trailerSize) / entrySize)
+      return false;
+   
+   mChunks.resize(numChunks);
+   for (auto& chunk : mChunks)
+   {
+      ReadGeneric(&chunk.mOffset, sizeof(int64));
+      *this >> chunk.mNumSamples;
+      chunk.mHash[0] = chunk.mHash[1] = 0;
+      if (hasHashes)
+         ReadGeneric(chunk.mHash, 2 * sizeof(uint64_t));
+      
+      bool valid = chunk.mNumSamples > 0 && chunk.mNumSamples <= kSamplesPerChunk &&
+                   (chunk.mOffset == kSilentChunkOffset || (chunk.mOffset >= (int64)sizeof(int) && chunk.mOffset + (int64)sizeof(float) * chunk.mNumSamples <= tableOffset));
+      if (!valid)
+         chunk.mNumSamples = 0;
+   }
+   
+   if (hasHashes)
+   {
+      ReadGeneric(&mStreamStart, sizeof(int64));
+      ReadGeneric(&mStreamEnd, sizeof(int64));
+      if (mStreamStart < kHeaderSize || mStreamEnd < mStreamStart || mStreamEnd > tableOffset)
+      {
+         mChunks.clear();
+         mStreamStart = kHeaderSize;
+         mStreamEnd = length;
+         return false;
+      }
+      mHasHashes = true;
+   }
+   else
+   {
+      mStreamEnd = tableOffset;
+      for (const auto& chunk : mChunks)
+      {
+         if (chunk.mOffset != kSilentChunkOffset && chunk.mNumSamples > 0)
+            mStreamEnd = MIN(mStreamEnd, chunk.mOffset);
+      }
+   }
+   
+   return true;
+}
+
+void FileStreamIn::FillSaveChunkIndex(SaveChunkIndex& index, string path)
+{
+   index.Reset(path);
+   if (!mHasHashes)
+      return;   //nothing to go on, the next save writes the whole file
+   
+   std::set<int64> counted;
+   int64 liveBytes = kHeaderSize + (mStreamEnd - mStreamStart) + (mStream.getTotalLength() - mTableOffset);
+   for (const auto& chunk : mChunks)
+   {
+      if (chunk.mOffset == kSilentChunkOffset || chunk.mNumSamples == 0)
+         continue;
+      SaveChunkIndex::Location location;
+      location.mOffset = chunk.mOffset;
+      location.mNumSamples = chunk.mNumSamples;
+      index.mChunks[ChunkHash(chunk.mHash[0], chunk.mHash[1])] = location;
+      if (counted.insert(chunk.mOffset).second)
+         liveBytes += sizeof(float) * chunk.mNumSamples;
+   }
+   index.mFileSize = mStream.getTotalLength();
+   index.mLiveBytes = liveBytes;
 }
 
 void FileStreamIn::ReadGeneric(void* buffer, int size)
@@ -170,6 +528,8 @@ void FileStreamIn::Peek(void* buffer, int size)
 
 bool FileStreamIn::Eof()
 {
+   if (mHasChunks)
+      return mStream.getPosition() >= mStreamEnd;
    return mStream.isExhausted();
 }
 
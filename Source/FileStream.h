@@ -28,11 +28,35 @@
 
 #include <JuceHeader.h>
 #include "OpenFrameworksPort.h"
+#include <map>
 
+//where the audio chunks in a save file are, by content, so saving over it again only has to append the chunks that aren't in it yet
+struct SaveChunkIndex
+{
+   struct Location
+   {
+      int64 mOffset;
+      int mNumSamples;
+   };
+   
+   bool CanAppendTo(string path) const;
+   void Reset(string path);
+   
+   string mPath;
+   int64 mFileSize{ 0 };   //what the file should be on disk, 0 if there's nothing to append to
+   int64 mLiveBytes{ 0 };   //how much of that the latest save uses
+   std::map<std::pair<uint64_t, uint64_t>, Location> mChunks;
+   int64 mAppendedAt{ -1 };   //where the latest stream goes in the file, or -1 if it's the whole file
+   int64 mTableOffset{ 0 };   //where its chunk table is, for pointing the header at once it's appended
+};
+
+//audio passed to Write() is split into chunks, and stored once per unique chunk at the end of the stream.
+//silent chunks aren't stored at all, so long mostly-empty buffers stay small. Write() only copies the audio, finding duplicates and silence waits until the end.
 class FileStreamOut
 {
 public:
    FileStreamOut(const char* file);
+   FileStreamOut(MemoryBlock& destination, SaveChunkIndex* index = nullptr);   //for serializing quickly now and writing to disk later. with an index that has a file, it's an append to that file.
    ~FileStreamOut();
    FileStreamOut& operator<<(const int& var);
    FileStreamOut& operator<<(const uint32_t &var);
@@ -43,8 +67,26 @@ public:
    FileStreamOut& operator<<(const char& var);
    void Write(const float* buffer, int size);
    void WriteGeneric(const void* buffer, int size);
+   
+   //copies audio that's about to be passed to Write(), so that copy can happen before a lock is taken instead of while it's held.
+   //a later Write() of the same buffer and size uses the stashed copy.
+   void Stash(const float* buffer, int size);
 private:
-   FileOutputStream mStream;
+   struct SampleChunk
+   {
+      vector<float> mSamples;
+      bool mReferenced;
+   };
+   
+   int AddChunk(const float* samples, int size);
+   void WriteChunks();
+   
+   std::unique_ptr<OutputStream> mStream;
+   vector<SampleChunk> mChunks;
+   std::map<std::pair<const float*, int>, int> mStashes;   //buffer and size to the first of its chunks
+   SaveChunkIndex* mIndex;
+   int64 mBaseOffset;   //where the start of mStream will be in the file
+   int64 mStreamStart;
 };
 
 class FileStreamIn
@@ -63,10 +105,26 @@ public:
    void Peek(void* buffer, int size);
    int GetFilePosition();
    bool OpenedOk() { return mStream.openedOk(); }
+   void FillSaveChunkIndex(SaveChunkIndex& index, string path);   //so the next save over this file can append to it
    
    bool Eof();
 private:
+   struct SampleChunkInfo
+   {
+      int64 mOffset;
+      int mNumSamples;   //0 if the table entry was bad
+      uint64_t mHash[2];
+   };
+   
+   bool ReadChunkTable(int64 tableOffset, bool hasHashes);
+   
    FileInputStream mStream;
+   vector<SampleChunkInfo> mChunks;
+   bool mHasChunks;
+   bool mHasHashes;
+   int64 mStreamStart;
+   int64 mStreamEnd;
+   int64 mTableOffset;
 };
 
 #endif /* defined(__Bespoke__FileStream__) */
@@ -275,6 +275,29 @@ float FloatSliderLFOControl::Value(int samplesIn /*= 0*/)
    return GetLFOValue(samplesIn);
 }
 
+void FloatSliderLFOControl::FillBlock(float* buffer, int length)
+{
+   if (HasModulatedSliders())
+   {
+      IModulator::FillBlock(buffer, length);
+      return;
+   }
+   
+   ComputeSliders(0);
+   mLFO.FillBuffer(buffer, length);
+   float spread = mLFOSettings.mSpread;
+   float min = GetMin();
+   float max = GetMax();
+   for (int i=0; i<length; ++i)
+   {
+      float val = buffer[i];
+      if (spread > 0)
+         val = val * (1-spread) + (-cosf(val * FPI) + 1) * .5f * spread;
+      buffer[i] = Interp(val, min, max);
+   }
+   Clamp(buffer, GetTargetMin(), GetTargetMax(), length);
+}
+
 float FloatSliderLFOControl::GetLFOValue(int samplesIn /*= 0*/, float forcePhase /*= -1*/)
 {
    float val = mLFO.Value(samplesIn, forcePhase);
@@ -99,6 +99,7 @@ public:
    
    //IModulator
    float Value(int samplesIn = 0) override;
+   void FillBlock(float* buffer, int length) override;
    bool Active() const override { return mEnabled; }
    bool InitializeWithZeroRange() const override { return true; }
    
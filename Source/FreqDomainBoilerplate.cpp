@@ -30,14 +30,13 @@ namespace
 {
    const int fftWindowSize = 1024;
    const int fftFreqDomainSize = fftWindowSize/2 + 1;
+   const int fftHopSize = fftWindowSize/4;
 }
 
 FreqDomainBoilerplate::FreqDomainBoilerplate()
 : IAudioProcessor(gBufferSize)
-, mFFT(fftWindowSize)
-, mRollingInputBuffer(fftWindowSize)
-, mRollingOutputBuffer(fftWindowSize)
-, mFFTData(fftWindowSize, fftFreqDomainSize)
+, mAnalysis(fftWindowSize, fftHopSize)
+, mSynthesis(fftWindowSize, fftHopSize)
 , mInputPreamp(1)
 , mValue1(1)
 , mVolume(1)
@@ -53,10 +52,6 @@ FreqDomainBoilerplate::FreqDomainBoilerplate()
 , mPhaseOffset(0)
 , mPhaseOffsetSlider(nullptr)
 {
-   // Generate a window with a single raised cosine from N/4 to 3N/4
-   mWindower = new float[fftWindowSize];
-   for (int i=0; i<fftWindowSize; ++i)
-      mWindower[i] = -.5*cos(FTWO_PI*i/fftWindowSize)+.5;
 }
 
 void FreqDomainBoilerplate::CreateUIControls()
@@ -73,7 +68,6 @@ void FreqDomainBoilerplate::CreateUIControls()
 
 FreqDomainBoilerplate::~FreqDomainBoilerplate()
 {
-   delete[] mWindower;
 }
 
 void FreqDomainBoilerplate::Process(double time)
@@ -92,22 +86,35 @@ void FreqDomainBoilerplate::Process(double time)
    float volSq = mVolume * mVolume;
 
    int bufferSize = GetBuffer()->BufferSize();
+   float* input = GetBuffer()->GetChannel(0);
 
-   mRollingInputBuffer.WriteChunk(GetBuffer()->GetChannel(0), bufferSize, 0);
+   //frames happen once per hop, wherever they fall in the buffer
+   for (int pos=0; pos<bufferSize;)
+   {
+      int numSamples = MIN(bufferSize - pos, mAnalysis.SamplesUntilFrame());
+      mSynthesis.Read(gWorkBuffer + pos, numSamples);
+      if (mAnalysis.Write(input + pos, numSamples, inputPreampSq))
+         ProcessFrame(mAnalysis.GetFrame());
+      pos += numSamples;
+   }
+
+   Mult(input, (1-mDryWet)*inputPreampSq, bufferSize);
+   Mult(gWorkBuffer, volSq * mDryWet, bufferSize);
+   Add(input, gWorkBuffer, bufferSize);
+
+   Add(target->GetBuffer()->GetChannel(0), input, bufferSize);
 
-   //copy rolling input buffer into working buffer and window it
-   mRollingInputBuffer.ReadChunk(mFFTData.mTimeDomain, fftWindowSize, 0, 0);
-   Mult(mFFTData.mTimeDomain, mWindower, fftWindowSize);
-   Mult(mFFTData.mTimeDomain, inputPreampSq, fftWindowSize);
+   GetVizBuffer()->WriteChunk(input, bufferSize, 0);
 
-   mFFT.Forward(mFFTData.mTimeDomain,
-                mFFTData.mRealValues,
-                mFFTData.mImaginaryValues);
+   GetBuffer()->Reset();
+}
 
+void FreqDomainBoilerplate::ProcessFrame(FFTData& frame)
+{
    for (int i=0; i<fftFreqDomainSize; ++i)
    {
-      float real = mFFTData.mRealValues[i];
-      float imag = mFFTData.mImaginaryValues[i];
+      float real = frame.mRealValues[i];
+      float imag = frame.mImaginaryValues[i];
 
       //cartesian to polar
       float amp = 2.*sqrtf(real*real + imag*imag);
@@ -120,31 +127,11 @@ void FreqDomainBoilerplate::Process(double time)
       real = amp*cos(phase);
       imag = amp*sin(phase);
 
-      mFFTData.mRealValues[i] = real;
-      mFFTData.mImaginaryValues[i] = imag;
+      frame.mRealValues[i] = real;
+      frame.mImaginaryValues[i] = imag;
    }
 
-   mFFT.Inverse(mFFTData.mRealValues,
-                mFFTData.mImaginaryValues,
-                mFFTData.mTimeDomain);
-
-   for (int i=0; i<bufferSize; ++i)
-      mRollingOutputBuffer.Write(0, 0);
-
-   //copy rolling input buffer into working buffer and window it
-   for (int i=0; i<fftWindowSize; ++i)
-      mRollingOutputBuffer.Accum(fftWindowSize-i-1, mFFTData.mTimeDomain[i] * mWindower[i] * .0001f, 0);
-
-   Mult(GetBuffer()->GetChannel(0), (1-mDryWet)*inputPreampSq, GetBuffer()->BufferSize());
-
-   for (int i=0; i<bufferSize; ++i)
-      GetBuffer()->GetChannel(0)[i] += mRollingOutputBuffer.GetSample(fftWindowSize-i-1, 0) * volSq * mDryWet;
-
-   Add(target->GetBuffer()->GetChannel(0), GetBuffer()->GetChannel(0), bufferSize);
-
-   GetVizBuffer()->WriteChunk(GetBuffer()->GetChannel(0),bufferSize, 0);
-
-   GetBuffer()->Reset();
+   mSynthesis.AddFrame(frame, .0001f);
 }
 
 void FreqDomainBoilerplate::DrawModule()
@@ -47,13 +47,21 @@ void GainStageEffect::ProcessAudio(double time, ChannelBuffer* buffer)
    if (!mEnabled)
       return;
    
-   float bufferSize = buffer->BufferSize();
+   int bufferSize = buffer->BufferSize();
 
-   for (int i = 0; i < bufferSize; ++i)
+   if (ComputeSliderBlocks())
+   {
+      for (int i = 0; i < bufferSize; ++i)
+      {
+         ComputeModulatedSliders(i);
+         for (int ch = 0; ch < buffer->NumActiveChannels(); ++ch)
+            buffer->GetChannel(ch)[i] *= mGain;
+      }
+   }
+   else
    {
-      ComputeSliders(i);
       for (int ch = 0; ch < buffer->NumActiveChannels(); ++ch)
-         buffer->GetChannel(ch)[i] *= mGain;
+         Mult(buffer->GetChannel(ch), mGain, bufferSize);
    }
 }
 
@@ -26,6 +26,7 @@
 #include "GateEffect.h"
 #include "SynthGlobals.h"
 #include "Profiler.h"
+#include "Dynamics.h"
 
 GateEffect::GateEffect()
 : mThreshold(.1f)
@@ -37,6 +38,12 @@ GateEffect::GateEffect()
 , mEnvelope(0)
 , mPeak(0)
 {
+   mGainBuffer = new float[gBufferSize];
+}
+
+GateEffect::~GateEffect()
+{
+   delete[] mGainBuffer;
 }
 
 void GateEffect::CreateUIControls()
@@ -56,17 +63,20 @@ void GateEffect::ProcessAudio(double time, ChannelBuffer* buffer)
    if (!mEnabled)
       return;
    
-   float bufferSize = buffer->BufferSize();
+   int bufferSize = buffer->BufferSize();
 
-   ComputeSliders(0);
+   bool modulated = ComputeSliderBlocks();
+   
+   Dynamics::DetectLinkedPeak(buffer, mGainBuffer, bufferSize);
 
+   const float decayTime = .01f;
+   const float scalar = powf( 0.5f, 1.0f/(decayTime * gSampleRate));
    for (int i=0; i<bufferSize; ++i)
    {
-      const float decayTime = .01f;
-      float scalar = powf( 0.5f, 1.0f/(decayTime * gSampleRate));
-      float input = 0;
-      for (int ch=0; ch<buffer->NumActiveChannels(); ++ch)
-         input = MAX(input, fabsf(buffer->GetChannel(ch)[i]));
+      if (modulated)
+         ComputeModulatedSliders(i);
+      
+      float input = mGainBuffer[i];
 
       if ( input >= mPeak )
       {
@@ -86,11 +96,10 @@ void GateEffect::ProcessAudio(double time, ChannelBuffer* buffer)
       if (mPeak < mThreshold && mEnvelope > 0)
          mEnvelope = MAX(0, mEnvelope-gInvSampleRateMs/mReleaseTime );
 
-      for (int ch=0; ch<buffer->NumActiveChannels(); ++ch)
-         buffer->GetChannel(ch)[i] *= mEnvelope;
-
-      time += gInvSampleRateMs;
+      mGainBuffer[i] = mEnvelope;
    }
+   
+   Dynamics::ApplyGain(buffer, mGainBuffer, bufferSize);
 }
 
 void GateEffect::DrawModule()
@@ -35,6 +35,7 @@ class GateEffect : public IAudioEffect, public IIntSliderListener, public IFloat
 {
 public:
    GateEffect();
+   virtual ~GateEffect();
    static IAudioEffect* Create() { return new GateEffect(); }
    
    string GetTitleLabel() override { return "gate"; }
@@ -67,6 +68,7 @@ private:
    FloatSlider* mReleaseSlider;
    float mEnvelope;
    float mPeak;
+   float* mGainBuffer;
 };
 
 #endif /* defined(__modularSynth__GateEffect__) */
@@ -27,13 +27,56 @@
 #include "SynthGlobals.h"
 #include "Profiler.h"
 #include "ChannelBuffer.h"
+#include "SimdFloat.h"
+
+namespace
+{
+   //hann window, tabulated so grains don't need a cos() per sample
+   const int kWindowTableSize = 1024;
+   struct WindowTable
+   {
+      WindowTable()
+      {
+         for (int i=0; i<=kWindowTableSize; ++i)
+            mValues[i] = .5f * (1 - cosf(FTWO_PI * i / kWindowTableSize));
+      }
+      float mValues[kWindowTableSize+1];
+   };
+   const WindowTable sWindowTable;
+   
+   float LookupWindow(double phase)
+   {
+      if (phase <= 0 || phase >= 1)
+         return 0;
+      double x = phase * kWindowTableSize;
+      int index = int(x);
+      float a = float(x - index);
+      return sWindowTable.mValues[index] + a * (sWindowTable.mValues[index+1] - sWindowTable.mValues[index]);
+   }
+   
+   //output += gainA * a + gainB * b
+   void MixInto(float* output, const float* a, float gainA, const float* b, float gainB, int start, int end)
+   {
+      int i = start;
+      for (; i + SimdFloat::kNumLanes <= end; i += SimdFloat::kNumLanes)
+      {
+         SimdFloat mixed = SimdFloat::Load(output + i) + SimdFloat::Load(a + i) * gainA + SimdFloat::Load(b + i) * gainB;
+         mixed.Store(output + i);
+      }
+      for (; i < end; ++i)
+         output[i] += gainA * a[i] + gainB * b[i];
+   }
+}
 
 Granulator::Granulator()
-: mNextGrainIdx(0)
-, mNextGrainSpawnMs(0)
+: mNextGrainSpawnMs(0)
+, mNumActiveGrains(0)
+, mNumFreeGrains(0)
 , mLiveMode(false)
 , mOctaves(false)
 {
+   for (int i=0; i<kMaxGrains; ++i)
+      mFreeGrains[mNumFreeGrains++] = kMaxGrains - 1 - i;
    Reset();
 }
 
@@ -57,30 +100,135 @@ void Granulator::Reset()
    }
 }
 
-void Granulator::ProcessFrame(double time, ChannelBuffer* buffer, int bufferLength, double offset, float* output)
+void Granulator::Process(double time, ChannelBuffer* buffer, int bufferLength, double offset, double offsetIncrement, float* const* output, int numSamples)
 {
-   if (time + gInvSampleRateMs >= mNextGrainSpawnMs)
+   int numChannels = buffer->NumActiveChannels();
+   for (int ch = 0; ch < numChannels; ++ch)
+      ::Clear(output[ch], numSamples);
+   
+   for (int blockStart = 0; blockStart < numSamples; blockStart += kRenderBlockSize)
    {
-      double startFromMs = mNextGrainSpawnMs;
-      if (startFromMs < time - 1000)   //must have recently started processing, reset
-         startFromMs = time;
-      SpawnGrain(mNextGrainSpawnMs, offset, buffer->NumActiveChannels() == 2 ? mWidth : 0);
-      mNextGrainSpawnMs = startFromMs + mGrainLengthMs * 1/mGrainOverlap * ofRandom(1-mSpacingRandomize/2,1+mSpacingRandomize/2);
+      int blockSize = MIN(kRenderBlockSize, numSamples - blockStart);
+      double blockTime = time + blockStart * gInvSampleRateMs;
+      
+      for (int i = 0; i < blockSize; ++i)
+      {
+         double sampleTime = blockTime + i * gInvSampleRateMs;
+         if (sampleTime + gInvSampleRateMs >= mNextGrainSpawnMs)
+         {
+            double startFromMs = mNextGrainSpawnMs;
+            if (startFromMs < sampleTime - 1000)   //must have recently started processing, reset
+               startFromMs = sampleTime;
+            SpawnGrain(mNextGrainSpawnMs, offset + (blockStart + i) * offsetIncrement, numChannels == 2 ? mWidth : 0);
+            mNextGrainSpawnMs = startFromMs + mGrainLengthMs * 1/mGrainOverlap * ofRandom(1-mSpacingRandomize/2,1+mSpacingRandomize/2);
+         }
+      }
+      
+      float* blockOutput[ChannelBuffer::kMaxNumChannels];
+      for (int ch = 0; ch < numChannels; ++ch)
+         blockOutput[ch] = output[ch] + blockStart;
+      
+      double nextBlockTime = blockTime + blockSize * gInvSampleRateMs;
+      for (int i = 0; i < mNumActiveGrains;)
+      {
+         Grain& grain = mGrains[mActiveGrains[i]];
+         RenderGrain(grain, blockTime, buffer, bufferLength, blockOutput, blockSize);
+         if (grain.mEndTime < nextBlockTime || grain.mVol == 0)
+         {
+            mFreeGrains[mNumFreeGrains++] = mActiveGrains[i];
+            mActiveGrains[i] = mActiveGrains[--mNumActiveGrains];
+         }
+         else
+         {
+            ++i;
+         }
+      }
    }
    
-   for (int i=0; i<MAX_GRAINS; ++i)
-      mGrains[i].Process(time, buffer, bufferLength, output);
+   float overlapGain = GetOverlapGain();
+   for (int ch = 0; ch < numChannels; ++ch)
+   {
+      if (overlapGain != 1)
+         Mult(output[ch], overlapGain, numSamples);
+      mBiquad[ch].Filter(output[ch], numSamples);
+   }
+}
+
+void Granulator::RenderGrain(Grain& grain, double time, ChannelBuffer* buffer, int bufferLength, float* const* output, int numSamples)
+{
+   int start = int(MAX(0.0, ceil((grain.mStartTime - time) / gInvSampleRateMs)));
+   int end = int(MIN(double(numSamples), floor((grain.mEndTime - time) / gInvSampleRateMs) + 1));
+   if (start >= end || grain.mVol == 0)
+      return;
    
-   for (int ch = 0; ch < buffer->NumActiveChannels(); ++ch)
+   //work out the read positions and window once, then read the windowed grain for each source channel
+   int readIndex[kRenderBlockSize];
+   float readFrac[kRenderBlockSize];
+   float window[kRenderBlockSize];
+   double length = grain.mEndTime - grain.mStartTime;
+   double phase = (time + start * gInvSampleRateMs - grain.mStartTime) / length;
+   double phaseIncrement = gInvSampleRateMs / length;
+   double posIncrement = grain.mSpeedMult * mSpeed;
+   double pos = grain.mPos;
+   FloatWrap(pos, bufferLength);
+   for (int i = start; i < end; ++i)
    {
-      if (mGrainOverlap > 4)
-         output[ch] *= ofMap(mGrainOverlap, MAX_GRAINS, 4, .5f, 1);   //lower volume on dense granulation, starting at 4 overlap
-      output[ch] = mBiquad[ch].Filter(output[ch]);
+      pos += posIncrement;
+      if (pos >= bufferLength)
+         pos -= bufferLength;
+      else if (pos < 0)
+         pos += bufferLength;
+      readIndex[i] = int(pos);
+      readFrac[i] = float(pos - readIndex[i]);
+      window[i] = LookupWindow(phase);
+      phase += phaseIncrement;
    }
+   grain.mPos = pos;
+   
+   float windowed[2][kRenderBlockSize];
+   int numChannels = buffer->NumActiveChannels();
+   int numSourceChannels = MIN(numChannels, 2);
+   for (int ch = 0; ch < numSourceChannels; ++ch)
+   {
+      const float* source = buffer->GetChannel(ch);
+      for (int i = start; i < end; ++i)
+      {
+         int index = readIndex[i];
+         int next = index + 1 == bufferLength ? 0 : index + 1;
+         windowed[ch][i] = window[i] * (source[index] + readFrac[i] * (source[next] - source[index]));
+      }
+   }
+   
+   for (int ch = 0; ch < numChannels; ++ch)
+   {
+      float gain = grain.mVol * (1 + (ch == 0 ? grain.mStereoPosition : -grain.mStereoPosition));
+      if (numSourceChannels == 1)
+      {
+         MixInto(output[ch], windowed[0], gain, windowed[0], 0, start, end);
+      }
+      else
+      {
+         float channelBlend = ofClamp(ch + grain.mStereoPosition, 0, 1);
+         MixInto(output[ch], windowed[0], gain * (1 - channelBlend), windowed[1], gain * channelBlend, start, end);
+      }
+   }
+}
+
+float Granulator::GetOverlapGain() const
+{
+   //lower volume on dense granulation, starting at 4 overlap
+   if (mGrainOverlap > MAX_GRAINS)
+      return .5f * sqrtf(MAX_GRAINS / mGrainOverlap);
+   if (mGrainOverlap > 4)
+      return ofMap(mGrainOverlap, MAX_GRAINS, 4, .5f, 1);
+   return 1;
 }
 
 void Granulator::SpawnGrain(double time, double offset, float width)
 {
+   if (mNumFreeGrains == 0)   //cloud is saturated, skip this one rather than cutting off a grain that's still sounding
+      return;
+   
    if (mLiveMode)
    {
       float speedMult = 1+mSpeedRandomize;
@@ -107,21 +255,27 @@ void Granulator::SpawnGrain(double time, double offset, float width)
       }
    }
    offset += ofRandom(-mPosRandomizeMs, mPosRandomizeMs) / gInvSampleRateMs;
-   mGrains[mNextGrainIdx].Spawn(this, time, offset, speedMult, mGrainLengthMs, vol, width);
    
-   mNextGrainIdx = (mNextGrainIdx+1) % MAX_GRAINS;
+   int index = mFreeGrains[--mNumFreeGrains];
+   mGrains[index].Spawn(this, time, offset, speedMult, mGrainLengthMs, vol, width);
+   mActiveGrains[mNumActiveGrains++] = index;
 }
 
 void Granulator::Draw(float x, float y, float w, float h, int bufferStart, int viewLength, int bufferLength)
 {
-   for (int i=0; i<MAX_GRAINS; ++i)
-      mGrains[i].DrawGrain(i, x, y, w, h, bufferStart, viewLength, bufferLength);
+   int numActiveGrains = mNumActiveGrains;
+   for (int i=0; i<numActiveGrains; ++i)
+      mGrains[mActiveGrains[i]].DrawGrain(i, x, y, w, h, bufferStart, viewLength, bufferLength);
 }
 
 void Granulator::ClearGrains()
 {
-   for (int i=0; i<MAX_GRAINS; ++i)
-      mGrains[i].Clear();
+   for (int i=0; i<mNumActiveGrains; ++i)
+   {
+      mGrains[mActiveGrains[i]].Clear();
+      mFreeGrains[mNumFreeGrains++] = mActiveGrains[i];
+   }
+   mNumActiveGrains = 0;
 }
 
 void Grain::Spawn(Granulator* owner, double time, double pos, float speedMult, float lengthInMs, float vol, float width)
@@ -136,27 +290,10 @@ void Grain::Spawn(Granulator* owner, double time, double pos, float speedMult, f
    mDrawPos = ofRandom(1);
 }
 
-void Grain::Process(double time, ChannelBuffer* buffer, int bufferLength, float* output)
-{
-   if (time >= mStartTime && time <= mEndTime && mVol != 0)
-   {
-      mPos += mSpeedMult * mOwner->mSpeed;
-      float window = GetWindow(time);
-      for (int ch=0; ch<buffer->NumActiveChannels(); ++ch)
-      {
-         float sample = GetInterpolatedSample(mPos, buffer, bufferLength, ofClamp(ch + mStereoPosition, 0, 1));
-         output[ch] += sample * window * mVol * (1 + (ch == 0 ? mStereoPosition : -mStereoPosition));
-      }
-   }
-}
-
 double Grain::GetWindow(double time)
 {
    if (time > mStartTime && time < mEndTime)
-   {
-      double phase = (time-mStartTime)/(mEndTime-mStartTime);
-      return .5 * (1 - cos(phase * TWO_PI));
-   }
+      return LookupWindow((time-mStartTime)/(mEndTime-mStartTime));
    return 0;
 }
 
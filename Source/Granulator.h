@@ -31,7 +31,7 @@
 #include "BiquadFilter.h"
 #include "ChannelBuffer.h"
 
-#define MAX_GRAINS 32
+#define MAX_GRAINS 32   //top of the overlap sliders. the granulator itself can hold many more grains than this.
 
 class Granulator;
 
@@ -40,10 +40,10 @@ class Grain
 public:
    Grain() : mPos(0), mSpeedMult(1), mStartTime(0), mEndTime(0), mVol(0), mStereoPosition(0) {}
    void Spawn(Granulator* owner, double time, double pos, float speedMult, float lengthInMs, float vol, float width);
-   void Process(double time, ChannelBuffer* buffer, int bufferLength, float* output);
    void DrawGrain(int idx, float x, float y, float w, float h, int bufferStart, int viewLength, int bufferLength);
    void Clear() { mVol = 0; }
 private:
+   friend class Granulator;
    double GetWindow(double time);
    double mPos;
    float mSpeedMult;
@@ -59,12 +59,16 @@ class Granulator
 {
 public:
    Granulator();
-   void ProcessFrame(double time, ChannelBuffer* buffer, int bufferLength, double offset, float* output);
+   //writes numSamples of grains into output, one channel for each channel of buffer.
+   //new grains start reading from offset, which moves by offsetIncrement every sample.
+   void Process(double time, ChannelBuffer* buffer, int bufferLength, double offset, double offsetIncrement, float* const* output, int numSamples);
    void Draw(float x, float y, float w, float h, int bufferStart, int viewLength, int bufferLength);
    void Reset();
    void ClearGrains();
    void SetLiveMode(bool live) { mLiveMode = live; }
    
+   static const int kMaxGrains = 512;
+   
    float mSpeed;
    float mGrainLengthMs;
    float mGrainOverlap;
@@ -75,11 +79,18 @@ public:
    float mWidth;
    
 private:
+   static const int kRenderBlockSize = 128;
+   
    void SpawnGrain(double time, double offset, float width);
+   void RenderGrain(Grain& grain, double time, ChannelBuffer* buffer, int bufferLength, float* const* output, int numSamples);
+   float GetOverlapGain() const;
    
    double mNextGrainSpawnMs;
-   int mNextGrainIdx;
-   Grain mGrains[MAX_GRAINS];
+   Grain mGrains[kMaxGrains];
+   int mActiveGrains[kMaxGrains];   //indices into mGrains. only these get rendered.
+   int mNumActiveGrains;
+   int mFreeGrains[kMaxGrains];
+   int mNumFreeGrains;
    bool mLiveMode;
    BiquadFilter mBiquad[ChannelBuffer::kMaxNumChannels];
 };
@@ -101,7 +101,7 @@ void GridModule::OnGridButton(int x, int y, float velocity, IGridController* gri
    if (y < GetRows() && x < GetCols())
    {
       for (auto listener : mScriptListeners)
-         listener->RunCode(gTime, "on_grid_button("+ofToString(x)+", "+ofToString(y)+", "+ofToString(velocity)+")");
+         listener->GridButtonReceived(x, y, velocity);
       
       if (mGridControllerOwner)
          mGridControllerOwner->OnGridButton(x, y, velocity, this);
@@ -0,0 +1,146 @@
+/**
+    bespoke synth, a software modular synthesizer
+    Copyright (C) 2021 Ryan Challinor (contact: awwbees@gmail.com)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**/
+/*
+  ==============================================================================
+
+    HeadlessRender.cpp
+    Created: 15 Jul 2021 8:22:40pm
+    Author:  Ryan Challinor
+
+  ==============================================================================
+*/
+
+#include "HeadlessRender.h"
+#include "ModularSynth.h"
+#include "SynthGlobals.h"
+#include "Profiler.h"
+#include "SampleStream.h"
+
+namespace
+{
+   const int kNumChannels = 2;
+   
+   juce::String GetOption(const juce::StringArray& args, juce::String name, juce::String defaultValue)
+   {
+      int index = args.indexOf(name);
+      if (index != -1 && index + 1 < args.size())
+         return args[index + 1];
+      return defaultValue;
+   }
+   
+   //command line paths are relative to where we were run from, not the data directory
+   juce::File GetFileOption(const juce::StringArray& args, juce::String name, juce::String defaultValue)
+   {
+      juce::String path = GetOption(args, name, defaultValue);
+      if (path.isEmpty())
+         return juce::File();
+      return juce::File::getCurrentWorkingDirectory().getChildFile(path);
+   }
+}
+
+//static
+bool HeadlessRender::IsRequested(const juce::StringArray& args)
+{
+   return args.contains("--render");
+}
+
+//static
+int HeadlessRender::Run(const juce::StringArray& args)
+{
+   juce::File patch = GetFileOption(args, "--render", "");
+   juce::File output = GetFileOption(args, "--out", "render.wav");
+   juce::File timing = GetFileOption(args, "--timing", "");
+   double seconds = GetOption(args, "--seconds", "10").getDoubleValue();
+   int sampleRate = GetOption(args, "--samplerate", "48000").getIntValue();
+   int bufferSize = GetOption(args, "--buffersize", "256").getIntValue();
+   
+   if (!patch.existsAsFile() || seconds <= 0 || sampleRate <= 0 || bufferSize <= 0 || bufferSize > kWorkBufferSize)
+   {
+      ofLog() << "usage: --render <file.bsk or layout.json> [--seconds 10] [--out render.wav] [--timing timing.json] [--samplerate 48000] [--buffersize 256]";
+      return 1;
+   }
+   
+   SetGlobalSampleRateAndBufferSize(sampleRate, bufferSize);
+   SampleStream::SetSynchronous(true);   //renders run faster than realtime, so streamed samples have to be read in step
+   
+   GlobalManagers globalManagers;
+   ModularSynth synth;
+   synth.Setup(&globalManagers, nullptr, nullptr);
+   synth.InitIOBuffers(kNumChannels, kNumChannels);
+   
+   string patchPath = patch.getFullPathName().toStdString();
+   if (patch.hasFileExtension("bsk"))
+      synth.LoadState(patchPath);
+   else if (!synth.LoadLayoutFromFile(patchPath, false))
+      return 1;
+   
+   output.deleteFile();
+   std::unique_ptr<FileOutputStream> outputStream = output.createOutputStream();
+   if (outputStream == nullptr)
+   {
+      ofLog() << "couldn't write to " << output.getFullPathName().toStdString();
+      return 1;
+   }
+   WavAudioFormat wavFormat;
+   std::unique_ptr<AudioFormatWriter> writer(wavFormat.createWriterFor(outputStream.get(), sampleRate, kNumChannels, 32, StringPairArray(), 0));
+   if (writer == nullptr)
+      return 1;
+   outputStream.release();   //the writer owns it now
+   
+   bool writeTiming = timing != juce::File();
+   if (writeTiming && !Profiler::IsEnabled())
+      Profiler::ToggleProfiler();
+   
+   vector<float> inputData(kNumChannels * bufferSize, 0);
+   vector<float> outputData(kNumChannels * bufferSize, 0);
+   const float* inputs[kNumChannels];
+   float* outputs[kNumChannels];
+   for (int ch=0; ch<kNumChannels; ++ch)
+   {
+      inputs[ch] = &inputData[ch * bufferSize];
+      outputs[ch] = &outputData[ch * bufferSize];
+   }
+   
+   //the ui thread polls at 60hz, so keep polling at that rate relative to the audio we're rendering
+   int buffersPerPoll = MAX(1, int(sampleRate / 60.0 / bufferSize));
+   int numBuffers = (int)ceil(seconds * sampleRate / bufferSize);
+   
+   double startMs = Time::getMillisecondCounterHiRes();
+   for (int i=0; i<numBuffers; ++i)
+   {
+      synth.AudioIn(inputs, bufferSize, kNumChannels);
+      synth.AudioOut(outputs, bufferSize, kNumChannels);
+      writer->writeFromFloatArrays(outputs, kNumChannels, bufferSize);
+      
+      if (i % buffersPerPoll == 0)
+         synth.Poll();
+   }
+   double elapsedMs = Time::getMillisecondCounterHiRes() - startMs;
+   writer.reset();
+   
+   double renderedMs = numBuffers * bufferSize * 1000.0 / sampleRate;
+   ofLog() << "rendered " << renderedMs / 1000 << "s of audio in " << elapsedMs / 1000 << "s (" << renderedMs / MAX(elapsedMs, .001) << "x realtime) to " << output.getFullPathName().toStdString();
+   
+   if (writeTiming)
+   {
+      Profiler::WriteSummary(timing.getFullPathName().toStdString());
+      ofLog() << "wrote per-module timing to " << timing.getFullPathName().toStdString();
+   }
+   
+   return 0;
+}
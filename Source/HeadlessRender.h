@@ -0,0 +1,39 @@
+/**
+    bespoke synth, a software modular synthesizer
+    Copyright (C) 2021 Ryan Challinor (contact: awwbees@gmail.com)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**/
+/*
+  ==============================================================================
+
+    HeadlessRender.h
+    Created: 15 Jul 2021 8:22:40pm
+    Author:  Ryan Challinor
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+//renders a patch to a wav file as fast as possible, with no window or audio device, for benchmarking and catching regressions.
+//BespokeSynth --render <file.bsk or layout.json> [--seconds 10] [--out render.wav] [--timing timing.json] [--samplerate 48000] [--buffersize 256]
+class HeadlessRender
+{
+public:
+   static bool IsRequested(const juce::StringArray& args);
+   static int Run(const juce::StringArray& args);   //returns the exit code
+};
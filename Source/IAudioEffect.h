@@ -36,6 +36,7 @@ public:
    virtual void ProcessAudio(double time, ChannelBuffer* buffer) = 0;
    void SetEnabled(bool enabled) override = 0;
    virtual float GetEffectAmount() { return 0; }
+   virtual int GetLatency() { return 0; }   //samples the processed audio lags its input by, so EffectChain can delay the dry signal to match
    virtual string GetType() = 0;
    bool CanMinimize() override { return false; }
    bool IsSaveable() override { return false; }
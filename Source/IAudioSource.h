@@ -37,16 +37,19 @@ class IAudioReceiver;
 class IAudioSource : public virtual IPatchable
 {
 public:
-   IAudioSource() : mVizBuffer(VIZ_BUFFER_SECONDS*gSampleRate) {}
+   IAudioSource() : mVizBuffer(VIZ_BUFFER_SECONDS*gSampleRate), mRandom(gRandom()) {}   //seeded from the creating thread's generator, so each session differs
    virtual ~IAudioSource() {}
    virtual void Process(double time) = 0;
    IAudioReceiver* GetTarget(int index=0);
    virtual int GetNumTargets() { return 1; }
    RollingBuffer* GetVizBuffer() { return &mVizBuffer; }
+   //what gRandom draws from while this source processes, so its randomness doesn't depend on which audio worker runs it
+   std::mt19937& GetRandom() { return mRandom; }
 protected:
    void SyncOutputBuffer(int numChannels);
 private:
    RollingBuffer mVizBuffer;
+   std::mt19937 mRandom;
 };
 
 #endif
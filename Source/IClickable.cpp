@@ -30,6 +30,7 @@
 
 string IClickable::sLoadContext = "";
 string IClickable::sSaveContext = "";
+std::atomic<int> IClickable::sPathGeneration(0);
 
 IClickable::IClickable()
 : mX(0)
@@ -27,6 +27,7 @@
 #define __modularSynth__IClickable__
 
 #include "SynthGlobals.h"
+#include <atomic>
 
 //TODO(Ryan) factor Transformable stuff out of here
 
@@ -55,6 +56,8 @@ public:
    void SetName(const char* name) {
      if (mName != name)
        StringCopy(mName, name, MAX_TEXTENTRY_LENGTH);
+     InvalidatePaths();
+     OnRenamed();
    }
    const char* Name() const { return mName; }
    char* NameMutable() { return mName; }
@@ -76,10 +79,15 @@ public:
    static string sLoadContext;
    static string sSaveContext;
    
+   //bumped whenever something is added, removed or renamed, so cached path lookups know to resolve again
+   static int GetPathGeneration() { return sPathGeneration.load(std::memory_order_acquire); }
+   static void InvalidatePaths() { sPathGeneration.fetch_add(1, std::memory_order_acq_rel); }
+   
 protected:
    virtual void OnClicked(int x, int y, bool right) {}
    virtual bool MouseMoved(float x, float y) { return false; }
    virtual bool MouseScrolled(int x, int y, float scrollX, float scrollY) { return false; }
+   virtual void OnRenamed() {}
    
    float mX;
    float mY;
@@ -87,6 +95,8 @@ protected:
    bool mShowing;
    
 private:
+   static std::atomic<int> sPathGeneration;
+   
    char mName[MAX_TEXTENTRY_LENGTH];
    double mBeaconTime;
 };
@@ -679,6 +679,12 @@ bool IDrawableModule::MouseMoved(float x, float y)
    return false;
 }
 
+void IDrawableModule::OnRenamed()
+{
+   if (mOwningContainer != nullptr)
+      mOwningContainer->OnModuleRenamed(this);
+}
+
 void IDrawableModule::MouseReleased()
 {
    if (CanMinimize() && mMinimizeAreaClicked &&
@@ -698,11 +704,32 @@ IUIControl* IDrawableModule::FindUIControl(const char* name, bool fail /*=true*/
 {
    if (name != 0)
    {
-      for (int i=0; i<mUIControls.size(); ++i)
+      //scripts look controls up from their own thread, so the index is only touched under the lock
+      IUIControl* found = nullptr;
+      uint32_t hash = JenkinsHash(name);
+      mSliderMutex.lock();
+      auto it = mUIControlIndex.find(hash);
+      if (it != mUIControlIndex.end() && strcmp(it->second->Name(),name) == 0)
+      {
+         found = it->second;
+      }
+      else
       {
-         if (strcmp(mUIControls[i]->Name(),name) == 0)
-            return mUIControls[i];
+         //controls can be renamed after they're added, so a miss falls back to a scan and fixes up the index
+         for (int i=0; i<mUIControls.size(); ++i)
+         {
+            if (strcmp(mUIControls[i]->Name(),name) == 0)
+            {
+               mUIControlIndex[hash] = mUIControls[i];
+               found = mUIControls[i];
+               break;
+            }
+         }
       }
+      mSliderMutex.unlock();
+      
+      if (found != nullptr)
+         return found;
    }
    if (fail)
       throw UnknownUIControlException();
@@ -738,12 +765,14 @@ void IDrawableModule::AddChild(IDrawableModule* child)
    }
    
    mChildren.push_back(child);
+   IClickable::InvalidatePaths();
 }
 
 void IDrawableModule::RemoveChild(IDrawableModule* child)
 {
    child->SetParent(nullptr);
    RemoveFromVector(child, mChildren);
+   IClickable::InvalidatePaths();
 }
 
 vector<IUIControl*> IDrawableModule::GetUIControls() const
@@ -837,26 +866,35 @@ void IDrawableModule::AddUIControl(IUIControl* control)
    {
    }
    
+   mSliderMutex.lock();
    mUIControls.push_back(control);
+   mUIControlIndex.insert(std::make_pair(JenkinsHash(control->Name()), control));   //keep the first of any same-named controls, like the scan does
    FloatSlider* slider = dynamic_cast<FloatSlider*>(control);
    if (slider)
-   {
-      mSliderMutex.lock();
       mFloatSliders.push_back(slider);
-      mSliderMutex.unlock();
-   }
+   mSliderMutex.unlock();
+   IClickable::InvalidatePaths();
 }
 
 void IDrawableModule::RemoveUIControl(IUIControl* control)
 {
+   mSliderMutex.lock();
    RemoveFromVector(control, mUIControls, K(fail));
+   for (auto it = mUIControlIndex.begin(); it != mUIControlIndex.end();)
+   {
+      if (it->second == control)
+         it = mUIControlIndex.erase(it);
+      else
+         ++it;
+   }
    FloatSlider* slider = dynamic_cast<FloatSlider*>(control);
    if (slider)
    {
-      mSliderMutex.lock();
       RemoveFromVector(slider, mFloatSliders, K(fail));
-      mSliderMutex.unlock();
+      RemoveFromVector(slider, mModulatedSliders);
    }
+   mSliderMutex.unlock();
+   IClickable::InvalidatePaths();
 }
 
 void IDrawableModule::ComputeSliders(int samplesIn)
@@ -867,6 +905,33 @@ void IDrawableModule::ComputeSliders(int samplesIn)
    //mSliderMutex.unlock();
 }
 
+bool IDrawableModule::ComputeSliderBlocks()
+{
+   mModulatedSliders.clear();
+   for (int i=0; i<mFloatSliders.size(); ++i)
+   {
+      if (mFloatSliders[i]->ComputeForBlock())
+         mModulatedSliders.push_back(mFloatSliders[i]);
+   }
+   return !mModulatedSliders.empty();
+}
+
+void IDrawableModule::ComputeModulatedSliders(int samplesIn)
+{
+   for (int i=0; i<mModulatedSliders.size(); ++i)
+      mModulatedSliders[i]->Compute(samplesIn);
+}
+
+bool IDrawableModule::HasModulatedSliders() const
+{
+   for (int i=0; i<mFloatSliders.size(); ++i)
+   {
+      if (mFloatSliders[i]->IsModulated())
+         return true;
+   }
+   return false;
+}
+
 PatchCableOld IDrawableModule::GetPatchCableOld(IClickable* target)
 {
    float wThis,hThis,xThis,yThis,wThat,hThat,xThat,yThat;
@@ -1088,6 +1153,18 @@ void IDrawableModule::SaveState(FileStreamOut& out)
       cable->SaveState(out);
 }
 
+void IDrawableModule::StashSaveData(FileStreamOut& out)
+{
+   if (GetContainer())
+   {
+      for (auto* module : GetContainer()->GetModules())
+         module->StashSaveData(out);
+   }
+   
+   for (auto* child : mChildren)
+      child->StashSaveData(out);
+}
+
 void IDrawableModule::LoadState(FileStreamIn& in)
 {
    if (!CanSaveState())
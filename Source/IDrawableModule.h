@@ -32,6 +32,7 @@
 #include "Checkbox.h"
 #include "FileStream.h"
 #include "IPatchable.h"
+#include <unordered_map>
 
 class IUIControl;
 class FloatSlider;
@@ -123,6 +124,9 @@ public:
    virtual bool HasSpecialDelete() const { return false; }
    virtual void DoSpecialDelete() {}
    void ComputeSliders(int samplesIn);
+   bool HasModulatedSliders() const;   //whether any of our sliders can change value partway through a buffer
+   bool ComputeSliderBlocks();   //ComputeSliders(0), rendering whole buffers for the sliders that can change partway through. returns whether there are any.
+   void ComputeModulatedSliders(int samplesIn);   //ComputeSliders(), for just the sliders found by the last ComputeSliderBlocks()
    void SetOwningContainer(ModuleContainer* container) { mOwningContainer = container; }
    ModuleContainer* GetOwningContainer() const { return mOwningContainer; }
    virtual ModuleContainer* GetContainer() { return nullptr; }
@@ -146,6 +150,7 @@ public:
    virtual bool IsSaveable() { return true; }
    ModuleSaveData& GetSaveData() { return mModuleSaveData; }
    virtual void SaveState(FileStreamOut& out);
+   virtual void StashSaveData(FileStreamOut& out);   //copy big buffers into the stream before SaveState(), while the audio thread isn't held off
    virtual void LoadState(FileStreamIn& in);
    virtual void PostLoadState() {}
    virtual vector<IUIControl*> ControlsToNotSetDuringLoadState() const;
@@ -176,6 +181,7 @@ protected:
    virtual void Poll() override {}
    virtual void OnClicked(int x, int y, bool right) override;
    virtual bool MouseMoved(float x, float y) override;
+   void OnRenamed() override;
    
    ModuleSaveData mModuleSaveData;
    Checkbox* mEnabledCheckbox;
@@ -191,8 +197,10 @@ private:
    PatchCableOld GetPatchCableOld(IClickable* target);
 
    vector<IUIControl*> mUIControls;
+   mutable std::unordered_map<uint32_t, IUIControl*> mUIControlIndex;   //by JenkinsHash of name, checked against the name on lookup
    vector<IDrawableModule*> mChildren;
    vector<FloatSlider*> mFloatSliders;
+   vector<FloatSlider*> mModulatedSliders;
    static const int mTitleBarHeight = 12;
    string mTypeName;
    static const int sResizeCornerSize = 8;
@@ -212,7 +220,7 @@ private:
    bool mCanReceiveNotes;
    bool mCanReceivePulses;
 
-   ofMutex mSliderMutex;
+   mutable ofMutex mSliderMutex;   //guards the control lists and mUIControlIndex
    
    PatchCableSource* mMainPatchCableSource;
    vector<PatchCableSource*> mPatchCableSources;
@@ -50,7 +50,29 @@ public:
    float GetPitch(int samplesIn) { return mPitch + (mModulators.pitchBend ? mModulators.pitchBend->GetValue(samplesIn) : 0); }
    float GetModWheel(int samplesIn) { return mModulators.modWheel ? mModulators.modWheel->GetValue(samplesIn) : 0.5f; }
    float GetPressure(int samplesIn) { return mModulators.pressure ? mModulators.pressure->GetValue(samplesIn) : 0.5f; }
+   
+   //the same as above, for a run of samples at once
+   void GetPitches(float* buffer, int samplesIn, int length)
+   {
+      if (mModulators.pitchBend)
+         mModulators.pitchBend->GetValues(buffer, samplesIn, length);
+      else
+         std::fill(buffer, buffer + length, 0.0f);
+      for (int i=0; i<length; ++i)
+         buffer[i] += mPitch;
+   }
+   void GetModWheels(float* buffer, int samplesIn, int length) { GetValues(mModulators.modWheel, buffer, samplesIn, length); }
+   void GetPressures(float* buffer, int samplesIn, int length) { GetValues(mModulators.pressure, buffer, samplesIn, length); }
 private:
+   static void GetValues(ModulationChain* chain, float* buffer, int samplesIn, int length)
+   {
+      if (chain)
+         chain->GetValues(buffer, samplesIn, length);
+      else
+         std::fill(buffer, buffer + length, 0.5f);
+   }
+   
+
    float mPitch;
    float mPan;
    ModulationParameters mModulators;
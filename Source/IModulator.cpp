@@ -48,6 +48,12 @@ IModulator::~IModulator()
    TheSynth->RemoveExtraPoller(this);
 }
 
+void IModulator::FillBlock(float* buffer, int length)
+{
+   for (int i=0; i<length; ++i)
+      buffer[i] = Value(i);
+}
+
 void IModulator::OnModulatorRepatch()
 {
    assert(mTargetCable != nullptr);
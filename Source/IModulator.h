@@ -38,6 +38,7 @@ public:
    IModulator();
    virtual ~IModulator();
    virtual float Value(int samplesIn = 0) = 0;
+   virtual void FillBlock(float* buffer, int length);   //Value() for the first length samples of this buffer. override to do it faster than one at a time.
    virtual bool Active() const = 0;
    virtual bool CanAdjustRange() const { return true; }
    virtual bool InitializeWithZeroRange() const { return false; }
@@ -143,6 +143,61 @@ float LFO::Value(int samplesIn /*= 0*/, float forcePhase /*= -1*/) const
    return sample;
 }
 
+void LFO::FillBuffer(float* buffer, int length) const
+{
+   if (mPeriod == kInterval_None || mLength != 1)
+   {
+      for (int i=0; i<length; ++i)
+         buffer[i] = Value(i);
+      return;
+   }
+   
+   //the phase moves linearly across a buffer, so step it rather than asking the transport for every sample
+   float startPhase = CalculatePhase(0);
+   float phaseStep;
+   if (mPeriod == kInterval_Free)
+      phaseStep = mFreeRate / gSampleRate;
+   else
+      phaseStep = gInvSampleRateMs / TheTransport->MsPerBar() / (TheTransport->GetDuration(mPeriod) / TheTransport->GetDuration(kInterval_1n));
+   
+   switch (mOsc.GetType())
+   {
+      case kOsc_Sin: FillOscillatorBuffer<kOsc_Sin>(buffer, length, startPhase, phaseStep); break;
+      case kOsc_Square: FillOscillatorBuffer<kOsc_Square>(buffer, length, startPhase, phaseStep); break;
+      case kOsc_Tri: FillOscillatorBuffer<kOsc_Tri>(buffer, length, startPhase, phaseStep); break;
+      case kOsc_Saw: FillOscillatorBuffer<kOsc_Saw>(buffer, length, startPhase, phaseStep); break;
+      case kOsc_NegSaw: FillOscillatorBuffer<kOsc_NegSaw>(buffer, length, startPhase, phaseStep); break;
+      default:
+         for (int i=0; i<length; ++i)
+            buffer[i] = Value(i);
+         break;
+   }
+}
+
+template<OscillatorType kType>
+void LFO::FillOscillatorBuffer(float* buffer, int length, float startPhase, float phaseStep) const
+{
+   const float laneIndices[SimdFloat::kNumLanes] = { 0, 1, 2, 3 };
+   SimdFloat laneOffsets = SimdFloat::Load(laneIndices) * phaseStep;
+   
+   int i = 0;
+   for (; i + SimdFloat::kNumLanes <= length; i += SimdFloat::kNumLanes)
+   {
+      SimdFloat phase = laneOffsets + (startPhase + i * phaseStep);
+      SimdFloat sample = mOsc.Value<kType>(phase * FTWO_PI);
+      if (mMode == kLFOMode_Envelope)     //rescale to 0 1
+         sample = sample * .5f + .5f;
+      sample.Store(buffer + i);
+   }
+   for (; i < length; ++i)
+   {
+      float sample = mOsc.Value((startPhase + i * phaseStep) * FTWO_PI);
+      if (mMode == kLFOMode_Envelope)
+         sample = sample * .5f + .5f;
+      buffer[i] = sample;
+   }
+}
+
 void LFO::SetPeriod(NoteInterval interval)
 {
    if (interval == kInterval_Free)
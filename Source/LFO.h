@@ -45,6 +45,7 @@ public:
    LFO();
    ~LFO();
    float Value(int samplesIn = 0, float forcePhase = -1) const;
+   void FillBuffer(float* buffer, int length) const;  //Value() for the first length samples of this buffer
    void SetOffset(float offset) { mPhaseOffset = offset; }
    void SetPeriod(NoteInterval interval);
    void SetType(OscillatorType type);
@@ -62,6 +63,8 @@ public:
    //IAudioPoller
    void OnTransportAdvanced(float amount) override;
 private:
+   template<OscillatorType kType> void FillOscillatorBuffer(float* buffer, int length, float startPhase, float phaseStep) const;
+   
    NoteInterval mPeriod;
    float mPhaseOffset;
    Oscillator mOsc;
@@ -112,36 +112,54 @@ void LiveGranulator::ProcessAudio(double time, ChannelBuffer* buffer)
 {
    PROFILER(LiveGranulator);
    
-   float bufferSize = buffer->BufferSize();
-   mBuffer.SetNumChannels(buffer->NumActiveChannels());
+   int bufferSize = buffer->BufferSize();
+   int numChannels = buffer->NumActiveChannels();
+   mBuffer.SetNumChannels(numChannels);
+   gWorkChannelBuffer.SetNumActiveChannels(numChannels);
 
-   for (int i=0; i<bufferSize; ++i)
+   bool modulated = ComputeSliderBlocks();
+   for (int chunkStart=0; chunkStart<bufferSize; chunkStart += kModulationChunkSize)
    {
-      ComputeSliders(i);
+      int chunkSize = MIN(kModulationChunkSize, bufferSize - chunkStart);
+      if (modulated)
+         ComputeModulatedSliders(chunkStart);
       
+      //the newest sample we've written is where grains spawn from. while frozen, that stays put.
       mGranulator.SetLiveMode(!mFreeze);
+      double offset = mBuffer.GetRawBufferOffset(0) - mFreezeExtraSamples - 1 + mPos;
+      double offsetIncrement = mFreeze ? 0 : 1;
       if (!mFreeze)
+         ++offset;
+      for (int i=chunkStart; i<chunkStart+chunkSize; ++i)
       {
-         for (int ch=0; ch<buffer->NumActiveChannels(); ++ch)
-            mBuffer.Write(buffer->GetChannel(ch)[i], ch);
-      }
-      else if (mFreezeExtraSamples < FREEZE_EXTRA_SAMPLES_COUNT)
-      {
-         ++mFreezeExtraSamples;
-         for (int ch=0; ch<buffer->NumActiveChannels(); ++ch)
-            mBuffer.Write(buffer->GetChannel(ch)[i], ch);
+         if (!mFreeze)
+         {
+            for (int ch=0; ch<numChannels; ++ch)
+               mBuffer.Write(buffer->GetChannel(ch)[i], ch);
+         }
+         else if (mFreezeExtraSamples < FREEZE_EXTRA_SAMPLES_COUNT)
+         {
+            ++mFreezeExtraSamples;
+            for (int ch=0; ch<numChannels; ++ch)
+               mBuffer.Write(buffer->GetChannel(ch)[i], ch);
+         }
       }
       
       if (mEnabled)
       {
-         float sample[ChannelBuffer::kMaxNumChannels];
-         Clear(sample, ChannelBuffer::kMaxNumChannels);
-         mGranulator.ProcessFrame(time, mBuffer.GetRawBuffer(), mBufferLength, mBuffer.GetRawBufferOffset(0)-mFreezeExtraSamples-1+mPos, sample);
-         for (int ch=0; ch<buffer->NumActiveChannels(); ++ch)
-            buffer->GetChannel(ch)[i] = mDry * buffer->GetChannel(ch)[i] + sample[ch];
+         float* grains[ChannelBuffer::kMaxNumChannels];
+         for (int ch=0; ch<numChannels; ++ch)
+            grains[ch] = gWorkChannelBuffer.GetChannel(ch) + chunkStart;
+         mGranulator.Process(time, mBuffer.GetRawBuffer(), mBufferLength, offset, offsetIncrement, grains, chunkSize);
+         for (int ch=0; ch<numChannels; ++ch)
+         {
+            float* channel = buffer->GetChannel(ch) + chunkStart;
+            Mult(channel, mDry, chunkSize);
+            Add(channel, grains[ch], chunkSize);
+         }
       }
       
-      time += gInvSampleRateMs;
+      time += chunkSize * gInvSampleRateMs;
    }
 }
 
@@ -70,6 +70,8 @@ private:
    void GetModuleDimensions(float& w, float& h) override { w = mWidth; h = mHeight; }
    bool Enabled() const override { return mEnabled; }   
    
+   static const int kModulationChunkSize = 32;
+   
    float mBufferLength;
    RollingBuffer mBuffer;
    Granulator mGranulator;
@@ -11,78 +11,147 @@
 #ifndef LOCKFREEQUEUE_H_INCLUDED
 #define LOCKFREEQUEUE_H_INCLUDED
 
+#include <atomic>
+#include <algorithm>
+#include <memory>
+#include <cstddef>
+
 /**
- * A simple single producer & consumer lock free queue, based on Herb Sutter's code:
- * http://www.drdobbs.com/parallel/writing-lock-free-code-a-corrected-queue/
- * 
- * This is a linked list, which can expand arbitrarily without losing old data,
- * but which has poor cache locality (I plan to write a ring buffer version soon).
+ * A single producer & single consumer lock free queue.
+ *
+ * This is a ring buffer with a fixed, power-of-two capacity that is allocated up
+ * front, so neither produce() nor consume() ever allocate, lock or wait. When the
+ * queue is full, new items are dropped and counted rather than overwriting old
+ * ones, so the producer can tell that the consumer has fallen behind.
+ *
+ * The producer's and consumer's indices live on separate cache lines, and each
+ * side keeps a cached copy of the other's index, so the two threads only share a
+ * cache line when one of them actually catches up with the other.
  */
 template<typename T>
 class LockFreeQueue
 {
 public:
-    LockFreeQueue()
+    /** The capacity is rounded up to the next power of two. */
+    explicit LockFreeQueue (int minCapacity = 1024)
+        : capacity (roundUpToPowerOfTwo (minCapacity)),
+          mask (capacity - 1),
+          items (new T[capacity]),
+          writeIndex (0),
+          cachedReadIndex (0),
+          numOverflows (0),
+          readIndex (0),
+          cachedWriteIndex (0)
     {
-        first = new Node (T()); // Dummy seperator.
-        
-        last.set (first);
-        divider.set (first);
     }
     
-    ~LockFreeQueue()
+    /**
+     * Add an item to the queue. Should only be called from the producer's thread.
+     * Returns false, and counts an overflow, if the queue is full.
+     */
+    bool produce (const T& t)
     {
-        while (first != nullptr)
-        {
-            Node* toDel = first;
-            first = toDel->next;
-            delete toDel;
-        }
+        return produceN (&t, 1) == 1;
     }
     
     /**
-     * Add an item to the queue. Obviously, should only be called from producer's thread.
+     * Add up to count items to the queue, in order. Should only be called from the
+     * producer's thread. Returns how many were added; the rest are counted as overflows.
      */
-    void produce (const T& t)
+    int produceN (const T* t, int count)
     {
-        last.get()->next = new Node (t);
+        size_t write = writeIndex.load (std::memory_order_relaxed);
+        
+        if (write - cachedReadIndex + count > capacity)
+            cachedReadIndex = readIndex.load (std::memory_order_acquire);
+        
+        int numToWrite = (int) std::min<size_t> (count, capacity - (write - cachedReadIndex));
+        
+        for (int i = 0; i < numToWrite; ++i)
+            items[(write + i) & mask] = t[i];
+        
+        writeIndex.store (write + numToWrite, std::memory_order_release);
         
-        last.set (last.get()->next);
+        if (numToWrite < count)
+            numOverflows.fetch_add (count - numToWrite, std::memory_order_relaxed);
         
-        while (first != divider.get() ) { // trim unused nodes
-            Node* tmp = first;
-            first = first->next;
-            delete tmp;
-        }
+        return numToWrite;
     }
     
     /**
      * Consume an item in the queue. Returns false if no items left to consume.
+     * Should only be called from the consumer's thread.
      */
     bool consume (T& result)
     {
-        Node* div = divider.get();
+        return consumeN (&result, 1) == 1;
+    }
+    
+    /**
+     * Consume up to maxCount items from the queue, oldest first. Returns how many
+     * were consumed. Should only be called from the consumer's thread.
+     */
+    int consumeN (T* results, int maxCount)
+    {
+        size_t read = readIndex.load (std::memory_order_relaxed);
+        
+        if (cachedWriteIndex - read < (size_t) maxCount)
+            cachedWriteIndex = writeIndex.load (std::memory_order_acquire);
+        
+        int numToRead = (int) std::min<size_t> (maxCount, cachedWriteIndex - read);
         
-        if (div != last.get() ) {             // if queue is nonempty
-            result = div->next->value;       // copy requested value
-            divider.set(div->next);         // publish that we took it
-            return true;
-        }
+        for (int i = 0; i < numToRead; ++i)
+            results[i] = items[(read + i) & mask];
         
-        return false;
+        readIndex.store (read + numToRead, std::memory_order_release);
+        
+        return numToRead;
+    }
+    
+    /** Number of items waiting to be consumed. Only a snapshot when called from the producer. */
+    int getNumReady() const
+    {
+        return (int) (writeIndex.load (std::memory_order_acquire) - readIndex.load (std::memory_order_acquire));
+    }
+    
+    int getCapacity() const { return (int) capacity; }
+    
+    /** Number of items dropped because the queue was full, since the last call. Safe from any thread. */
+    int getAndResetNumOverflows()
+    {
+        return numOverflows.exchange (0, std::memory_order_relaxed);
     }
     
 private:
-    struct Node
+    static size_t roundUpToPowerOfTwo (int n)
     {
-        Node (const T& val) : value(val), next(nullptr) {}
-        
-        T value;
-        Node* next;
-    };
+        size_t size = 2;
+        while (size < (size_t) n)
+            size <<= 1;
+        return size;
+    }
+    
+    enum { cacheLineSize = 64 };
+    
+    // shared, read-only after construction
+    const size_t capacity;
+    const size_t mask;
+    std::unique_ptr<T[]> items;
+    char sharedPadding[cacheLineSize];
+    
+    // written by the producer
+    std::atomic<size_t> writeIndex;
+    size_t cachedReadIndex;
+    std::atomic<int> numOverflows;
+    char producerPadding[cacheLineSize];
+    
+    // written by the consumer
+    std::atomic<size_t> readIndex;
+    size_t cachedWriteIndex;
+    char consumerPadding[cacheLineSize];
     
-    Node* first;
-    Atomic<Node*> divider, last;
+    LockFreeQueue (const LockFreeQueue&) = delete;
+    LockFreeQueue& operator= (const LockFreeQueue&) = delete;
 };
 
 
@@ -345,6 +345,21 @@ void Looper::Process(double time)
    if (mPitchShift != 1)
       latencyOffset = mPitchShifter[0]->GetLatency();
 
+   //grains only look at the play position when they spawn, so render them for the whole buffer up front, unless something
+   //moves the position around within the buffer. then they're rendered a sample at a time, as the position is worked out.
+   bool offsetMovesInBlock = mLoopPosOffsetSlider->IsModulated() || mAllowScratch || mFourTet > 0 || mBeatwheel;
+   bool granularBlock = doGranular && !offsetMovesInBlock;
+   if (doGranular)
+      gWorkChannelBuffer.SetNumActiveChannels(mBuffer->NumActiveChannels());
+   if (granularBlock)
+   {
+      mLoopPosOffsetSlider->Compute(0);
+      float* grains[ChannelBuffer::kMaxNumChannels];
+      for (int ch=0; ch<mBuffer->NumActiveChannels(); ++ch)
+         grains[ch] = gWorkChannelBuffer.GetChannel(ch);
+      mGranulator->Process(time, mLoopPos+mLoopPosOffset+latencyOffset, speed, grains, bufferSize);
+   }
+
    double processStartTime = gTime;
    for (int i=0; i<bufferSize; ++i)
    {
@@ -368,7 +383,17 @@ void Looper::Process(double time)
       ::Clear(output, ChannelBuffer::kMaxNumChannels);
 
       if (doGranular)
-         mGranulator->ProcessFrame(time, offset, output);
+      {
+         if (!granularBlock)
+         {
+            float* grains[ChannelBuffer::kMaxNumChannels];
+            for (int ch=0; ch<mBuffer->NumActiveChannels(); ++ch)
+               grains[ch] = gWorkChannelBuffer.GetChannel(ch) + i;
+            mGranulator->Process(time, offset, speed, grains, 1);
+         }
+         for (int ch=0; ch<mBuffer->NumActiveChannels(); ++ch)
+            output[ch] = gWorkChannelBuffer.GetChannel(ch)[i];
+      }
       
       for (int ch=0; ch<mBuffer->NumActiveChannels(); ++ch)
       {
@@ -1335,6 +1360,14 @@ namespace
    const int kSaveStateRev = 1;
 }
 
+void Looper::StashSaveData(FileStreamOut& out)
+{
+   IDrawableModule::StashSaveData(out);
+   mBufferMutex.lock();
+   mBuffer->Stash(out, mLoopLength);
+   mBufferMutex.unlock();
+}
+
 void Looper::SaveState(FileStreamOut& out)
 {
    IDrawableModule::SaveState(out);
@@ -99,13 +99,13 @@ void LooperGranulator::DrawOverlay(ofRectangle bufferRect, int loopLength)
       mGranulator.Draw(bufferRect.x, bufferRect.y, bufferRect.width, bufferRect.height, 0, loopLength, loopLength);
 }
 
-void LooperGranulator::ProcessFrame(double time, float bufferOffset, float* output)
+void LooperGranulator::Process(double time, double bufferOffset, double offsetIncrement, float* const* output, int numSamples)
 {
    if (mLooper != nullptr)
    {
       int bufferLength;
       auto* buffer = mLooper->GetLoopBuffer(bufferLength);
-      mGranulator.ProcessFrame(time, buffer, bufferLength, bufferOffset, output);
+      mGranulator.Process(time, buffer, bufferLength, bufferOffset, offsetIncrement, output, numSamples);
    }
 }
 
@@ -49,7 +49,7 @@ public:
    string GetTitleLabel() override { return "looper granulator"; }
    void CreateUIControls() override;
 
-   void ProcessFrame(double time, float bufferOffset, float* output);
+   void Process(double time, double bufferOffset, double offsetIncrement, float* const* output, int numSamples);
    void DrawOverlay(ofRectangle bufferRect, int loopLength);
    bool IsActive() { return mOn; }
    bool ShouldFreeze() { return mOn && mFreeze; }
@@ -824,6 +824,12 @@ namespace
    const int kSaveStateRev = 0;
 }
 
+void LooperRecorder::StashSaveData(FileStreamOut& out)
+{
+   IDrawableModule::StashSaveData(out);
+   mRecordBuffer.StashSaveData(out);
+}
+
 void LooperRecorder::SaveState(FileStreamOut& out)
 {
    IDrawableModule::SaveState(out);
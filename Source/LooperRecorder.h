@@ -97,6 +97,7 @@ public:
    void LoadLayout(const ofxJSONElement& moduleInfo) override;
    void SaveLayout(ofxJSONElement& moduleInfo) override;
    void SetUpFromSaveData() override;
+   void StashSaveData(FileStreamOut& out) override;
    void SaveState(FileStreamOut& out) override;
    void LoadState(FileStreamIn& in) override;
    
@@ -90,8 +90,10 @@ MidiController::MidiController()
 , mLayoutWidth(0)
 , mLayoutHeight(0)
 , mFoundLayoutFile(false)
+, mMidiQueue(1024)
 {
    mListeners.resize(MAX_MIDI_PAGES);  
+   mMidiQueueProducerLock.clear();
 }
 
 void MidiController::CreateUIControls()
@@ -322,75 +324,140 @@ void MidiController::OnTransportAdvanced(float amount)
 {
    PROFILER(MidiController);
    
-   mQueuedMessageMutex.lock();
+   //lay out the messages that arrived during the last buffer's worth of wall-clock time across this buffer, keeping their spacing.
+   //that costs a buffer of latency, but dense streams don't all bunch up at the start of the buffer.
+   double bufferMs = gInvSampleRateMs * gBufferSize;
+   double windowStartMs = Time::getMillisecondCounterHiRes() - bufferMs;
    
-   double firstNoteTimestampMs = -1;
-   for (auto note = mQueuedNotes.begin(); note != mQueuedNotes.end(); ++note)
+   QueuedMidiMessage message;
+   while (mMidiQueue.consume(message))
    {
-      int voiceIdx = -1;
-      
-      if (mUseChannelAsVoice)
-         voiceIdx = note->mChannel - 1;
-      
-      //TODO(Ryan) how can I use note->mTimestamp to get more accurate timing for midi input?
-      //this here is not accurate, but prevents notes played within the same buffer from having the exact same time
-      double playTime;
-      if (firstNoteTimestampMs == -1) //this is the first note
-      {
-         firstNoteTimestampMs = note->mTimestampMs;
-         playTime = gTime;
-      }
-      else
-      {
-         playTime = gTime + (note->mTimestampMs - firstNoteTimestampMs);
-      }
-      PlayNoteOutput(playTime, note->mPitch + mNoteOffset, MIN(127,note->mVelocity*mVelocityMult), voiceIdx, ModulationParameters(mModulation.GetPitchBend(voiceIdx), mModulation.GetModWheel(voiceIdx), mModulation.GetPressure(voiceIdx), 0));
-      
-      for (auto i = mListeners[mControllerPage].begin(); i != mListeners[mControllerPage].end(); ++i)
-         (*i)->OnMidiNote(*note);
+      double offsetMs = MAX(0, MIN(message.TimestampMs() - windowStartMs, bufferMs - gInvSampleRateMs));
+      DispatchQueuedMidiMessage(message, gTime + offsetMs);
    }
-   mQueuedNotes.clear();
-   
-   for (auto note = mQueuedControls.begin(); note != mQueuedControls.end(); ++note)
+}
+
+double& QueuedMidiMessage::TimestampMs()
+{
+   switch (mType)
    {
-      for (auto i = mListeners[mControllerPage].begin(); i != mListeners[mControllerPage].end(); ++i)
-         (*i)->OnMidiControl(*note);
+      case kControl: return mControl.mTimestampMs;
+      case kProgramChange: return mProgramChange.mTimestampMs;
+      case kPitchBend: return mPitchBend.mTimestampMs;
+      case kPressure: return mPressure.mTimestampMs;
+      case kNote: break;
    }
-   mQueuedControls.clear();
-   
-   for (auto note = mQueuedProgramChanges.begin(); note != mQueuedProgramChanges.end(); ++note)
+   return mNote.mTimestampMs;
+}
+
+void MidiController::QueueMidiMessage(QueuedMidiMessage& message)
+{
+   while (mMidiQueueProducerLock.test_and_set(std::memory_order_acquire))
    {
-      for (auto i = mListeners[mControllerPage].begin(); i != mListeners[mControllerPage].end(); ++i)
-         (*i)->OnMidiProgramChange(*note);
    }
-   mQueuedProgramChanges.clear();
    
-   for (auto note = mQueuedPitchBends.begin(); note != mQueuedPitchBends.end(); ++note)
+   //use when the device got the message rather than when it was handed to us, so the spacing holds up when the midi thread delivers a burst.
+   //that's on the same clock OnTransportAdvanced() uses. messages that didn't come from a device get stamped now.
+   double& timestampMs = message.TimestampMs();
+   if (timestampMs <= 0)
+      timestampMs = Time::getMillisecondCounterHiRes();
+   mMidiQueue.produce(message);   //if the audio thread isn't keeping up, this drops the message rather than waiting
+   
+   mMidiQueueProducerLock.clear(std::memory_order_release);
+}
+
+void MidiController::DispatchQueuedMidiMessage(QueuedMidiMessage& message, double time)
+{
+   list<MidiDeviceListener*>& listeners = mListeners[mControllerPage];
+   
+   switch (message.mType)
    {
-      for (auto i = mListeners[mControllerPage].begin(); i != mListeners[mControllerPage].end(); ++i)
-         (*i)->OnMidiPitchBend(*note);
+      case QueuedMidiMessage::kNote:
+      {
+         MidiNote& note = message.mNote;
+         int voiceIdx = -1;
+         
+         if (mUseChannelAsVoice)
+         {
+            voiceIdx = note.mChannel - 1;
+            if (note.mVelocity > 0)
+               mModulation.GetPitchBend(voiceIdx)->SetValue(0, time);
+         }
+         
+         PlayNoteOutput(time, note.mPitch + mNoteOffset, MIN(127,note.mVelocity*mVelocityMult), voiceIdx, ModulationParameters(mModulation.GetPitchBend(voiceIdx), mModulation.GetModWheel(voiceIdx), mModulation.GetPressure(voiceIdx), 0));
+         
+         for (auto i = listeners.begin(); i != listeners.end(); ++i)
+            (*i)->OnMidiNote(note);
+         break;
+      }
+      case QueuedMidiMessage::kControl:
+      {
+         MidiControl& control = message.mControl;
+         int voiceIdx = -1;
+         
+         if (mUseChannelAsVoice)
+            voiceIdx = control.mChannel - 1;
+         
+         if (control.mControl == mModwheelCC)
+         {
+            //if (mModwheelCC == 74) //MPE
+            //   mModulation.GetModWheel(voiceIdx)->SetValue((control.mValue-63) / 127.0f * 2);
+            //else
+            mModulation.GetModWheel(voiceIdx)->SetValue(control.mValue / 127.0f, time);
+         }
+         
+         for (auto i = listeners.begin(); i != listeners.end(); ++i)
+            (*i)->OnMidiControl(control);
+         break;
+      }
+      case QueuedMidiMessage::kProgramChange:
+      {
+         for (auto i = listeners.begin(); i != listeners.end(); ++i)
+            (*i)->OnMidiProgramChange(message.mProgramChange);
+         break;
+      }
+      case QueuedMidiMessage::kPitchBend:
+      {
+         MidiPitchBend& pitchBend = message.mPitchBend;
+         int voiceIdx = -1;
+         
+         if (mUseChannelAsVoice)
+            voiceIdx = pitchBend.mChannel - 1;
+         
+         float amount = (pitchBend.mValue - 8192.0f) / (8192.0f/mPitchBendRange);
+         mModulation.GetPitchBend(voiceIdx)->SetValue(amount, time);
+         
+         for (auto i = listeners.begin(); i != listeners.end(); ++i)
+            (*i)->OnMidiPitchBend(pitchBend);
+         break;
+      }
+      case QueuedMidiMessage::kPressure:
+      {
+         MidiPressure& pressure = message.mPressure;
+         int voiceIdx = -1;
+         
+         if (mUseChannelAsVoice)
+            voiceIdx = pressure.mChannel - 1;
+         
+         mModulation.GetPressure(voiceIdx)->SetValue(pressure.mPressure / 127.0f, time);
+         
+         mNoteOutput.SendPressure(pressure.mPitch, pressure.mPressure);
+         break;
+      }
    }
-   mQueuedPitchBends.clear();
-   
-   mQueuedMessageMutex.unlock();
 }
 
 void MidiController::OnMidiNote(MidiNote& note)
 {
    if (!mEnabled || (mChannelFilter != ChannelFilter::kAny && note.mChannel != (int)mChannelFilter))
       return;
-
-   if (mUseChannelAsVoice && note.mVelocity > 0)
-   {
-      int voiceIdx = note.mChannel - 1;
-      mModulation.GetPitchBend(voiceIdx)->SetValue(0);
-   }
    
    MidiReceived(kMidiMessage_Note, note.mPitch, note.mVelocity/127.0f, note.mChannel);
    
-   mQueuedMessageMutex.lock();
-   mQueuedNotes.push_back(note);
-   mQueuedMessageMutex.unlock();
+   QueuedMidiMessage message;
+   message.mType = QueuedMidiMessage::kNote;
+   message.mNote = note;
+   QueueMidiMessage(message);
    
    if (mPrintInput)
       ofLog() << Name() << " note: " << note.mPitch << ", " << note.mVelocity;
@@ -401,24 +468,12 @@ void MidiController::OnMidiControl(MidiControl& control)
    if (!mEnabled || (mChannelFilter != ChannelFilter::kAny && control.mChannel != (int)mChannelFilter))
       return;
    
-   int voiceIdx = -1;
-   
-   if (mUseChannelAsVoice)
-      voiceIdx = control.mChannel - 1;
-   
-   if (control.mControl == mModwheelCC)
-   {
-      //if (mModwheelCC == 74) //MPE
-      //   mModulation.GetModWheel(voiceIdx)->SetValue((control.mValue-63) / 127.0f * 2);
-      //else
-      mModulation.GetModWheel(voiceIdx)->SetValue(control.mValue / 127.0f);
-   }
-   
    MidiReceived(kMidiMessage_Control, control.mControl, control.mValue/127.0f, control.mChannel);
    
-   mQueuedMessageMutex.lock();
-   mQueuedControls.push_back(control);
-   mQueuedMessageMutex.unlock();
+   QueuedMidiMessage message;
+   message.mType = QueuedMidiMessage::kControl;
+   message.mControl = control;
+   QueueMidiMessage(message);
    
    if (mPrintInput)
       ofLog() << Name() << " control: " << control.mControl << ", " << control.mValue;
@@ -429,14 +484,10 @@ void MidiController::OnMidiPressure(MidiPressure& pressure)
    if (!mEnabled || (mChannelFilter != ChannelFilter::kAny && pressure.mChannel != (int)mChannelFilter))
       return;
    
-   int voiceIdx = -1;
-   
-   if (mUseChannelAsVoice)
-      voiceIdx = pressure.mChannel - 1;
-   
-   mModulation.GetPressure(voiceIdx)->SetValue(pressure.mPressure / 127.0f);
-   
-   mNoteOutput.SendPressure(pressure.mPitch, pressure.mPressure);
+   QueuedMidiMessage message;
+   message.mType = QueuedMidiMessage::kPressure;
+   message.mPressure = pressure;
+   QueueMidiMessage(message);
 }
 
 void MidiController::OnMidiProgramChange(MidiProgramChange& program)
@@ -446,9 +497,10 @@ void MidiController::OnMidiProgramChange(MidiProgramChange& program)
    
    MidiReceived(kMidiMessage_Program, program.mProgram, 1, program.mChannel);
    
-   mQueuedMessageMutex.lock();
-   mQueuedProgramChanges.push_back(program);
-   mQueuedMessageMutex.unlock();
+   QueuedMidiMessage message;
+   message.mType = QueuedMidiMessage::kProgramChange;
+   message.mProgramChange = program;
+   QueueMidiMessage(message);
    
    if (mPrintInput)
       ofLog() << Name() << " program change: " << program.mProgram;
@@ -459,22 +511,15 @@ void MidiController::OnMidiPitchBend(MidiPitchBend& pitchBend)
    if (!mEnabled || (mChannelFilter != ChannelFilter::kAny && pitchBend.mChannel != (int)mChannelFilter))
       return;
    
-   int voiceIdx = -1;
-   
-   float amount = (pitchBend.mValue - 8192.0f) / (8192.0f/mPitchBendRange);
-   
-   if (mUseChannelAsVoice)
-      voiceIdx = pitchBend.mChannel - 1;
-   else
-      mCurrentPitchBend = amount;
-   
-   mModulation.GetPitchBend(voiceIdx)->SetValue(amount);
+   if (!mUseChannelAsVoice)
+      mCurrentPitchBend = (pitchBend.mValue - 8192.0f) / (8192.0f/mPitchBendRange);
    
    MidiReceived(kMidiMessage_PitchBend, MIDI_PITCH_BEND_CONTROL_NUM, pitchBend.mValue/16383.0f, pitchBend.mChannel);   //16383 = max pitch bend
- 
-   mQueuedMessageMutex.lock();
-   mQueuedPitchBends.push_back(pitchBend);
-   mQueuedMessageMutex.unlock();
+   
+   QueuedMidiMessage message;
+   message.mType = QueuedMidiMessage::kPitchBend;
+   message.mPitchBend = pitchBend;
+   QueueMidiMessage(message);
    
    if (mPrintInput)
       ofLog() << Name() << " pitch bend: " << pitchBend.mValue;
@@ -703,6 +748,10 @@ void MidiController::Poll()
    bool lastBlink = mBlink;
    mBlink = int(TheTransport->GetMeasurePos(gTime) * TheTransport->GetTimeSigTop() * 2) % 2 == 0;
    
+   int droppedMessages = mMidiQueue.getAndResetNumOverflows();
+   if (droppedMessages > 0)
+      ofLog() << Name() << " dropped " << droppedMessages << " midi messages, the audio thread isn't keeping up";
+   
    if (IsInputConnected(!K(immediate)) || mReconnectWaitTimer > 0)
    {
       if (!mIsConnected && gTime - mInitialConnectionTime > 1000)
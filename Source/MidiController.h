@@ -27,6 +27,8 @@
 #define __modularSynth__MidiController__
 
 #include <iostream>
+#include <atomic>
+#include "LockFreeQueue.h"
 #include "MidiDevice.h"
 #include "IDrawableModule.h"
 #include "Checkbox.h"
@@ -256,6 +258,32 @@ struct GridLayout
    GridControlTarget* mGridControlTarget[MAX_MIDI_PAGES];
 };
 
+//a fixed-size copy of an incoming message, so it can wait for the audio thread in a preallocated ring
+struct QueuedMidiMessage
+{
+   QueuedMidiMessage() : mType(kNote), mNote() {}   //the structs have member initializers, so the union needs one of them picked explicitly
+   double& TimestampMs();   //the active struct's, so it's only stored in one place
+   
+   enum Type
+   {
+      kNote,
+      kControl,
+      kProgramChange,
+      kPitchBend,
+      kPressure
+   };
+   
+   Type mType;
+   union
+   {
+      MidiNote mNote;
+      MidiControl mControl;
+      MidiProgramChange mProgramChange;
+      MidiPitchBend mPitchBend;
+      MidiPressure mPressure;
+   };
+};
+
 #define NUM_LAYOUT_CONTROLS 128+128+128+1+1 //128 notes, 128 ccs, 128 program change, 1 pitch bend, 1 dummy
 
 class MidiController : public MidiDeviceListener, public IDrawableModule, public IButtonListener, public IDropdownListener, public IRadioButtonListener, public IAudioPoller, public ITextEntryListener, public INoteSource
@@ -366,6 +394,8 @@ private:
    string GetLayoutTooltip(int controlIndex);
    void UpdateControllerIndex();
    void LoadLayout(string filename);
+   void QueueMidiMessage(QueuedMidiMessage& message);
+   void DispatchQueuedMidiMessage(QueuedMidiMessage& message, double time);
    
    float mVelocityMult;
    bool mUseChannelAsVoice;
@@ -393,10 +423,6 @@ private:
    bool mSendTwoWayOnChange;
    bool mResendFeedbackOnRelease;
    ClickButton* mAddConnectionButton;
-   std::list<MidiNote> mQueuedNotes;
-   std::list<MidiControl> mQueuedControls;
-   std::list<MidiProgramChange> mQueuedProgramChanges;
-   std::list<MidiPitchBend> mQueuedPitchBends;
    DropdownList* mControllerList;
    Checkbox* mDrawCablesCheckbox;
    MappingDisplayMode mMappingDisplayMode;
@@ -438,7 +464,9 @@ private:
    vector<GridLayout*> mGrids;
    bool mFoundLayoutFile;
    
-   ofMutex mQueuedMessageMutex;
+   //incoming messages, handed from the midi thread to the audio thread without locking or allocating
+   LockFreeQueue<QueuedMidiMessage> mMidiQueue;
+   std::atomic_flag mMidiQueueProducerLock;  //osc, monome and midicapturer can feed us too, so producers take turns
 };
 
 #endif /* defined(__modularSynth__MidiController__) */
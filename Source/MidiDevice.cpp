@@ -257,11 +257,13 @@ void MidiDevice::SendMidiMessage(MidiDeviceListener* listener, const char* devic
 {
    listener->OnMidi(message);
    
+   double timestampMs = message.getTimeStamp() * 1000; //message.getTimeStamp() is equivalent to Time::getMillisecondCounterHiRes() / 1000.0 (see juce_MidiDevices.h)
+   
    if (message.isNoteOnOrOff())
    {
       MidiNote note;
       note.mDeviceName = deviceName;
-      note.mTimestampMs = message.getTimeStamp() * 1000; //message.getTimeStamp() is equivalent to Time::getMillisecondCounter() / 1000.0 (see juce_MidiDevices.h)
+      note.mTimestampMs = timestampMs;
       note.mPitch = message.getNoteNumber();
       if (message.isNoteOn())
          note.mVelocity = message.getVelocity();
@@ -274,6 +276,7 @@ void MidiDevice::SendMidiMessage(MidiDeviceListener* listener, const char* devic
    {
       MidiControl control;
       control.mDeviceName = deviceName;
+      control.mTimestampMs = timestampMs;
       control.mControl = message.getControllerNumber();
       control.mValue = message.getControllerValue();
       control.mChannel = message.getChannel();
@@ -283,6 +286,7 @@ void MidiDevice::SendMidiMessage(MidiDeviceListener* listener, const char* devic
    {
       MidiProgramChange program;
       program.mDeviceName = deviceName;
+      program.mTimestampMs = timestampMs;
       program.mProgram = message.getProgramChangeNumber();
       program.mChannel = message.getChannel();
       listener->OnMidiProgramChange(program);
@@ -291,6 +295,7 @@ void MidiDevice::SendMidiMessage(MidiDeviceListener* listener, const char* devic
    {
       MidiPitchBend pitchBend;
       pitchBend.mDeviceName = deviceName;
+      pitchBend.mTimestampMs = timestampMs;
       pitchBend.mValue = message.getPitchWheelValue();
       pitchBend.mChannel = message.getChannel();
       listener->OnMidiPitchBend(pitchBend);
@@ -299,6 +304,7 @@ void MidiDevice::SendMidiMessage(MidiDeviceListener* listener, const char* devic
    {
       MidiPressure pressure;
       pressure.mDeviceName = deviceName;
+      pressure.mTimestampMs = timestampMs;
       //TODO_PORT(Ryan) - is this correct for the pitch? does pitch have meaning for channel pressure messages?
       pressure.mPitch = message.getNoteNumber();
       pressure.mPressure = message.getChannelPressureValue();
@@ -309,6 +315,7 @@ void MidiDevice::SendMidiMessage(MidiDeviceListener* listener, const char* devic
    {
       MidiPressure pressure;
       pressure.mDeviceName = deviceName;
+      pressure.mTimestampMs = timestampMs;
       pressure.mPitch = -1;
       pressure.mPressure = message.getAfterTouchValue();
       pressure.mChannel = message.getChannel();
@@ -29,10 +29,11 @@
 #include "OpenFrameworksPort.h"
 #include "ModularSynth.h"
 
+//mTimestampMs is on the Time::getMillisecondCounterHiRes() clock, or 0 for messages that didn't come from a device
 struct MidiNote
 {
    const char* mDeviceName;
-   double mTimestampMs;
+   double mTimestampMs{ 0 };
    int mPitch;
    float mVelocity; //0-127
    int mChannel;
@@ -41,6 +42,7 @@ struct MidiNote
 struct MidiControl
 {
    const char* mDeviceName;
+   double mTimestampMs{ 0 };
    int mControl;
    float mValue;
    int mChannel;
@@ -49,6 +51,7 @@ struct MidiControl
 struct MidiProgramChange
 {
    const char* mDeviceName;
+   double mTimestampMs{ 0 };
    int mProgram;
    int mChannel;
 };
@@ -56,6 +59,7 @@ struct MidiProgramChange
 struct MidiPitchBend
 {
    const char* mDeviceName;
+   double mTimestampMs{ 0 };
    float mValue;
    int mChannel;
 };
@@ -63,6 +67,7 @@ struct MidiPitchBend
 struct MidiPressure
 {
    const char* mDeviceName;
+   double mTimestampMs{ 0 };
    int mPitch;
    float mPressure;
    int mChannel;
@@ -75,6 +75,9 @@ ModularSynth::ModularSynth()
 , mLastClickedModule(nullptr)
 , mInitialized(false)
 , mRecordingLength(0)
+, mFreezeRecording(false)
+, mDeletedModulesEpoch(0)
+, mHoldAudioSourceSort(false)
 , mGroupSelectContext(nullptr)
 , mResizeModule(nullptr)
 , mShowLoadStatePopup(false)
@@ -238,6 +241,8 @@ void ModularSynth::Setup(GlobalManagers* globalManagers, juce::Component* mainCo
    mOpenGLContext = openGLContext;
    int recordBufferLengthMinutes = 30;
    
+   Profiler::StockThreadTraces();   //before the audio thread starts, so it can register without allocating
+   
    bool loaded = mUserPrefs.open(GetUserPrefsPath(false));
    if (loaded)
    {
@@ -250,6 +255,11 @@ void ModularSynth::Setup(GlobalManagers* globalManagers, juce::Component* mainCo
 
       if (!mUserPrefs["record_buffer_length_minutes"].isNull())
          recordBufferLengthMinutes = mUserPrefs["record_buffer_length_minutes"].asDouble();
+
+      if (!mUserPrefs["deterministic_audio_graph"].isNull())
+         mAudioGraph.SetDeterministic(mUserPrefs["deterministic_audio_graph"].asBool());
+      if (!mUserPrefs["audio_worker_threads"].isNull())
+         mAudioGraph.SetNumWorkers(MAX(0, MIN(mUserPrefs["audio_worker_threads"].asInt(), juce::SystemStats::getNumCpus() - 1)));
    }
    /*else
    {
@@ -341,7 +351,7 @@ void ModularSynth::Poll()
       if (!mUserPrefs["layout"].isNull())
          defaultLayout = mUserPrefs["layout"].asString();
       
-      if (!mInitialized && sFrameCount > 3) //let some frames render before blocking for a load
+      if (!mInitialized && !IsHeadless() && sFrameCount > 3) //let some frames render before blocking for a load. (headless renders load their own patch.)
       {
          LoadLayoutFromFile(ofToDataPath(defaultLayout));
          mInitialized = true;
@@ -355,6 +365,8 @@ void ModularSynth::Poll()
    }
    
    mZoomer.Update();
+   if (mSaveStateWriter.Poll())
+      mSaveChunkIndices.clear();   //don't know what's in the files now
    
    if (!mIsLoadingState)
    {
@@ -412,7 +424,7 @@ void ModularSynth::Poll()
          desiredCursor = MouseCursor::NormalCursor;
       }
 
-      if (desiredCursor != sCurrentCursor)
+      if (desiredCursor != sCurrentCursor && !IsHeadless())
       {
          sCurrentCursor = desiredCursor;
          mMainComponent->setMouseCursor(desiredCursor);
@@ -848,10 +860,9 @@ void ModularSynth::DrawConsole()
 
 void ModularSynth::Exit()
 {
-   mAudioThreadMutex.Lock("exiting");
-   mAudioPaused = true;
-   mAudioThreadMutex.Unlock();
+   PauseAudio();
    mSoundStream.stop();
+   mSaveStateWriter.Stop();
    mModuleContainer.Exit();
    DeleteAllModules();
    ofExit();
@@ -1513,9 +1524,10 @@ void ModularSynth::OnModuleDeleted(IDrawableModule* module)
    if (!module->CanBeDeleted() || module->IsDeleted())
       return;
    
+   //the audio thread may be partway through a buffer that still reaches this module, so it stays alive until ResetLayout() frees it past a quiescent point.
+   //everything the audio thread walks to find it (source ordering, graph, pollers, cable receivers) is republished below or by the cables that were destroyed.
    mDeletedModules.push_back(module);
-   
-   mAudioThreadMutex.Lock("delete");
+   mDeletedModulesEpoch = AudioThreadEpoch::GetRetireEpoch();
    
    list<PatchCable*> cablesToRemove;
    for (auto* cable : mPatchCables)
@@ -1526,7 +1538,12 @@ void ModularSynth::OnModuleDeleted(IDrawableModule* module)
    for (auto* cable : cablesToRemove)
       RemoveFromVector(cable, mPatchCables);
    
-   RemoveFromVector(dynamic_cast<IAudioSource*>(module),mSources);
+   IAudioSource* source = dynamic_cast<IAudioSource*>(module);
+   if (source)
+   {
+      mSourceGraph.RemoveSource(source);
+      SortAudioSources();
+   }
    RemoveFromVector(module,mLissajousDrawers);
    TheTransport->RemoveAudioPoller(dynamic_cast<IAudioPoller*>(module));
    //delete module; TODO(Ryan) deleting is hard... need to clear out everything with a reference to this, or switch to smart pointers
@@ -1535,8 +1552,6 @@ void ModularSynth::OnModuleDeleted(IDrawableModule* module)
       TheChaosEngine = nullptr;
    if (module == TheLFOController)
       TheLFOController = nullptr;
-   
-   mAudioThreadMutex.Unlock();
 }
 
 void ModularSynth::MouseReleased(int intX, int intY, int button)
@@ -1607,27 +1622,29 @@ void ModularSynth::MouseReleased(int intX, int intY, int button)
 
 void ModularSynth::AudioOut(float** output, int bufferSize, int nChannels)
 {
+   Profiler::BeginFrame();
    PROFILER(audioOut_total);
    
    static bool sFirst = true;
    if (sFirst)
    {
       FloatVectorOperations::disableDenormalisedNumberSupport();
+      Profiler::RegisterThread("audio");
       sFirst = false;
    }
    
-   if (mAudioPaused)
+   //enter the buffer before checking the pause flag, so that PauseAudio() either sees us in here or we see its flag
+   AudioThreadEpoch::EnterBuffer();
+   
+   //never wait on the audio mutex here. modules only hold it briefly for their own state, so we output silence until they're done.
+   if (mAudioPaused || !mAudioThreadMutex.TryLock("audioOut()"))
    {
+      AudioThreadEpoch::ExitBuffer();
       for (int ch=0; ch<nChannels; ++ch)
-      {
-         for (int i=0; i<bufferSize; ++i)
-            output[ch][i] = 0;
-      }
+         Clear(output[ch], bufferSize);
       return;
    }
    
-   ScopedMutex mutex(&mAudioThreadMutex, "audioOut()");
-   
    /////////// AUDIO PROCESSING STARTS HERE /////////////
    assert(bufferSize == mIOBufferSize);
    assert(nChannels == (int)mOutputBuffers.size());
@@ -1644,8 +1661,8 @@ void ModularSynth::AudioOut(float** output, int bufferSize, int nChannels)
       TheTransport->Advance(elapsed);
       
       //process all audio
-      for (int i=0; i<mSources.size(); ++i)
-         mSources[i]->Process(gTime);
+      const AudioSourceOrdering& ordering = mSourceGraph.GetOrdering();
+      mAudioGraph.Process(ordering.mSources, ordering.mGeneration, gTime);
 
       //put it into speakers
       for (int i = 0; i < nChannels; ++i)
@@ -1664,12 +1681,18 @@ void ModularSynth::AudioOut(float** output, int bufferSize, int nChannels)
       }
    }
    /////////// AUDIO PROCESSING ENDS HERE /////////////
-   if (nChannels >= 1)
-      mGlobalRecordBuffer->WriteChunk(output[0], bufferSize, 0);
-   if (nChannels >= 2)
-      mGlobalRecordBuffer->WriteChunk(output[1], bufferSize, 1);
-   mRecordingLength += bufferSize;
-   mRecordingLength = MIN(mRecordingLength, mGlobalRecordBuffer->Size());
+   if (!mFreezeRecording)
+   {
+      if (nChannels >= 1)
+         mGlobalRecordBuffer->WriteChunk(output[0], bufferSize, 0);
+      if (nChannels >= 2)
+         mGlobalRecordBuffer->WriteChunk(output[1], bufferSize, 1);
+      mRecordingLength += bufferSize;
+      mRecordingLength = MIN(mRecordingLength, mGlobalRecordBuffer->Size());
+   }
+   
+   AudioThreadEpoch::ExitBuffer();
+   mAudioThreadMutex.Unlock();
    
    Profiler::PrintCounters();
 }
@@ -1678,8 +1701,6 @@ void ModularSynth::AudioIn(const float** input, int bufferSize, int nChannels)
 {
    if (mAudioPaused)
       return;
-   
-   ScopedMutex mutex(&mAudioThreadMutex, "audioIn()");
 
    assert(bufferSize == mIOBufferSize);
    assert(nChannels == (int)mInputBuffers.size());
@@ -1724,103 +1745,63 @@ void ModularSynth::FilesDropped(vector<string> files, int intX, int intY)
    }
 }
 
-struct SourceDepInfo
+void ModularSynth::ArrangeAudioSourceDependencies()
 {
-   SourceDepInfo(IAudioSource* me) : mMe(me) {}
-   IAudioSource* mMe;
-   vector<IAudioSource*> mDeps;
-};
+   mSourceGraph.UpdateAllTargets();
+   SortAudioSources();
+}
 
-void ModularSynth::ArrangeAudioSourceDependencies()
+void ModularSynth::OnAudioTargetChanged(IAudioSource* source)
 {
-   //ofLog() << "Calculating audio source dependencies:";
-   
-   vector<SourceDepInfo> deps;
-   for (int i=0; i<mSources.size(); ++i)
-      deps.push_back(SourceDepInfo(mSources[i]));
-      
-   for (int i=0; i<mSources.size(); ++i)
-   {
-      for (int j=0; j<mSources.size(); ++j)
-      {
-         for (int k=0; k<mSources[i]->GetNumTargets(); ++k)
-         {
-            if (mSources[i]->GetTarget(k) != nullptr &&
-                mSources[i]->GetTarget(k) == dynamic_cast<IAudioReceiver*>(mSources[j]))
-            {
-               deps[j].mDeps.push_back(mSources[i]);
-            }
-         }
-      }
-   }
-   
-   /*for (int i=0; i<deps.size(); ++i)
-   {
-      string depStr;
-      for (int j=0;j<deps[i].mDeps.size();++j)
-      {
-         depStr += dynamic_cast<IDrawableModule*>(deps[i].mDeps[j])->Name();
-         if (j<deps[i].mDeps.size()-1)
-            depStr += ", ";
-      }
-      ofLog() << dynamic_cast<IDrawableModule*>(deps[i].mMe)->Name() << "depends on:" << depStr;
-   }*/
-   
-   //TODO(Ryan) detect circular dependencies
-   
-   mSources.clear();
-   int loopCount = 0;
-   while (deps.size() > 0 && loopCount < 1000) //stupid circular dependency detection, make better
-   {
-      for (int i=0; i<deps.size(); ++i)
-      {
-         bool hasDeps = false;
-         for (int j=0; j<deps[i].mDeps.size(); ++j)
-         {
-            bool found = false;
-            for (int k=0; k<mSources.size(); ++k)
-            {
-               if (deps[i].mDeps[j] == mSources[k])
-                  found = true;
-            }
-            if (!found) //has a dep that hasn't been added yet
-               hasDeps = true;
-         }
-         if (!hasDeps)
-         {
-            mSources.push_back(deps[i].mMe);
-            deps.erase(deps.begin() + i);
-            i-=1;
-         }
-      }
-      ++loopCount;
-   }
-   
-   if (loopCount == 1000)  //circular dependency, don't lose the rest of the sources
-   {
-      ofLog() << "circular dependency detected";
-      for (int i=0; i<deps.size(); ++i)
-         mSources.push_back(deps[i].mMe);
-   }
+   mSourceGraph.UpdateTargets(source);
+   SortAudioSources();
+}
+
+void ModularSynth::SortAudioSources()
+{
+   if (mHoldAudioSourceSort)
+      return;
    
-   /*ofLog() << "new ordering:";
-   for (int i=0; i<mSources.size(); ++i)
-      ofLog() << dynamic_cast<IDrawableModule*>(mSources[i])->Name();*/
+   string feedbackLoop = mSourceGraph.Sort();
+   //the worker threads' graph gets built here too, so the audio thread never has to
+   const AudioSourceOrdering& ordering = mSourceGraph.GetPublishedOrdering();
+   mAudioGraph.Rebuild(ordering.mSources, ordering.mGeneration);
+   if (feedbackLoop != "" && feedbackLoop != mAudioFeedbackLoop)
+      LogEvent("circular audio dependency: " + feedbackLoop, kLogEventType_Warning);
+   mAudioFeedbackLoop = feedbackLoop;
+}
+
+//stops audio processing without the audio thread ever waiting on us: once the buffer it might be in has finished, it won't touch the patch again.
+//returns whether audio was already paused, so callers can restore that.
+bool ModularSynth::PauseAudio()
+{
+   bool wasPaused = mAudioPaused.exchange(true);
+   AudioThreadEpoch::WaitUntilSafeToReclaim(AudioThreadEpoch::GetRetireEpoch());
+   return wasPaused;
+}
+
+void ModularSynth::SetWindowTitle(string title)
+{
+   if (!IsHeadless())
+      mMainComponent->getTopLevelComponent()->setName(title);
 }
 
 void ModularSynth::ResetLayout()
 {
-   mMainComponent->getTopLevelComponent()->setName("bespoke synth");
+   SetWindowTitle("bespoke synth");
    mCurrentSaveStatePath = "";
 
    mModuleContainer.Clear();
    mUILayerModuleContainer.Clear();
    
+   //callers pause audio first, so this won't wait long
+   AudioThreadEpoch::WaitUntilSafeToReclaim(mDeletedModulesEpoch);
    for (int i=0; i<mDeletedModules.size(); ++i)
       delete mDeletedModules[i];
 
    mDeletedModules.clear();
-   mSources.clear();
+   mSourceGraph.Clear();
+   SortAudioSources();
    mLissajousDrawers.clear();
    mMoveModule = nullptr;
    LFOPool::Shutdown();
@@ -1969,17 +1950,20 @@ void ModularSynth::LoadLayout(ofxJSONElement json)
    
    //ofLoadURLAsync("http://bespoke.com/telemetry/"+jsonFile);
    
-   ScopedMutex mutex(&mAudioThreadMutex, "LoadLayout()");
-   ScopedLock renderLock(mRenderLock);
-   
-   ResetLayout();
-   
-   mModuleContainer.LoadModules(json["modules"]);
-   
-   //timer.PrintCosts();
-   
-   mZoomer.LoadFromSaveData(json["zoomlocations"]);
-   ArrangeAudioSourceDependencies();
+   bool wasPaused = PauseAudio();
+   {
+      ScopedLock renderLock(mRenderLock);
+      
+      ResetLayout();
+      
+      mModuleContainer.LoadModules(json["modules"]);
+      
+      //timer.PrintCosts();
+      
+      mZoomer.LoadFromSaveData(json["zoomlocations"]);
+      ArrangeAudioSourceDependencies();
+   }
+   mAudioPaused = wasPaused;
 }
 
 void ModularSynth::UpdateUserPrefsLayout()
@@ -2058,7 +2042,10 @@ void ModularSynth::OnModuleAdded(IDrawableModule* module)
 {
    IAudioSource* source = dynamic_cast<IAudioSource*>(module);
    if (source)
-      mSources.push_back(source);
+   {
+      mSourceGraph.AddSource(source);
+      SortAudioSources();
+   }
 }
 
 void ModularSynth::AddDynamicModule(IDrawableModule* module)
@@ -2207,7 +2194,14 @@ IDrawableModule* ModularSynth::DuplicateModule(IDrawableModule* module)
    {
       FileStreamIn in(ofToDataPath("tmp").c_str());
       mIsLoadingModule = true;
-      newModule->LoadState(in);
+      try
+      {
+         newModule->LoadState(in);
+      }
+      catch (LoadStateException& e)
+      {
+         LogEvent("Error loading state for duplicated module \""+string(module->Name())+"\"", kLogEventType_Error);
+      }
       mIsLoadingModule = false;
    }
    
@@ -2285,22 +2279,40 @@ void ModularSynth::SaveState(string file, bool autosave)
       mCurrentSaveStatePath = file;
       mLastSaveTime = gTime;
       string filename = File(mCurrentSaveStatePath).getFileName().toStdString();
-      mMainComponent->getTopLevelComponent()->setName("bespoke synth - "+filename);
+      SetWindowTitle("bespoke synth - "+filename);
    }
 
-   mAudioThreadMutex.Lock("SaveState()");
-   
-   FileStreamOut out(file.c_str());
+   //autosaves all go into one slot file, so they can append like saving over the same file does, and the writer copies each one out to its timestamped name
+   string autosaveSlot = ofToDataPath("savestate/autosave/autosave.slot");
+   string path = autosave ? autosaveSlot : file;
    
-   out << GetLayout().getRawString(true);
-   mModuleContainer.SaveState(out);
-   
-   mAudioThreadMutex.Unlock();
+   //saving over the last save only appends the audio that changed, unless the file changed behind our back or is mostly dead space by now
+   SaveChunkIndex& chunkIndex = mSaveChunkIndices[path];
+   if (!mSaveStateWriter.IsIdle() || !chunkIndex.CanAppendTo(path))
+      chunkIndex.Reset(path);
+   for (auto it = mSaveChunkIndices.begin(); it != mSaveChunkIndices.end();)
+   {
+      if (it->first == path || it->first == autosaveSlot || it->first == mCurrentSaveStatePath)
+         ++it;
+      else
+         it = mSaveChunkIndices.erase(it);
+   }
+
+   //serialize into memory, holding the audio thread off just once and only for the small stuff, then let the writer thread put it on disk
+   std::unique_ptr<MemoryBlock> data(new MemoryBlock());
+   {
+      FileStreamOut out(*data, &chunkIndex);
+      out << GetLayout().getRawString(true);
+      mModuleContainer.SaveState(out, K(lockAudio));
+   }
+   mSaveStateWriter.Write(path, std::move(data), chunkIndex.mAppendedAt, chunkIndex.mTableOffset, autosave ? file : "");
 }
 
 void ModularSynth::LoadState(string file)
 {
    ofLog() << "LoadState() " << file;
+   
+   mSaveStateWriter.WaitUntilIdle();   //in case we're loading something that's still being written
 
    if (!juce::File(file).existsAsFile())
    {
@@ -2311,12 +2323,10 @@ void ModularSynth::LoadState(string file)
    if (mInitialized)
       TitleBar::sShowInitialHelpOverlay = false;  //don't show initial help popup
    
-   mAudioThreadMutex.Lock("LoadState()");
+   bool wasPaused = PauseAudio();
    LockRender(true);
-   mAudioPaused = true;
    mIsLoadingState = true;
    LockRender(false);
-   mAudioThreadMutex.Unlock();
    
    FileStreamIn in(ofToDataPath(file).c_str());
    
@@ -2332,17 +2342,16 @@ void ModularSynth::LoadState(string file)
       
       TheTransport->Reset();
    }
+   in.FillSaveChunkIndex(mSaveChunkIndices[file], file);
    
    mCurrentSaveStatePath = file;
    string filename = File(mCurrentSaveStatePath).getFileName().toStdString();
-   mMainComponent->getTopLevelComponent()->setName("bespoke synth - " + filename);
+   SetWindowTitle("bespoke synth - " + filename);
 
-   mAudioThreadMutex.Lock("LoadState()");
    LockRender(true);
-   mAudioPaused = false;
    mIsLoadingState = false;
    LockRender(false);
-   mAudioThreadMutex.Unlock();
+   mAudioPaused = wasPaused;
 }
 
 IAudioReceiver* ModularSynth::FindAudioReceiver(string name, bool fail)
@@ -2409,10 +2418,12 @@ void ModularSynth::OnConsoleInput()
       }
       else if (tokens[0] == "clearall")
       {
-         mAudioThreadMutex.Lock("clearall");
-         ScopedLock renderLock(mRenderLock);
-         ResetLayout();
-         mAudioThreadMutex.Unlock();
+         bool wasPaused = PauseAudio();
+         {
+            ScopedLock renderLock(mRenderLock);
+            ResetLayout();
+         }
+         mAudioPaused = wasPaused;
       }
       else if (tokens[0] == "load")
       {
@@ -2437,6 +2448,10 @@ void ModularSynth::OnConsoleInput()
       {
          Profiler::ToggleProfiler();
       }
+      else if (tokens[0] == "trace")
+      {
+         Profiler::ToggleTrace();
+      }
       else if (tokens[0] == "clear")
       {
          mErrors.clear();
@@ -2655,7 +2670,8 @@ IDrawableModule* ModularSynth::SpawnModuleOnTheFly(string moduleName, float x, f
    IDrawableModule* module = nullptr;
    try
    {
-      ScopedMutex mutex(&mAudioThreadMutex, "CreateModule");
+      //the audio thread can't reach the new module until the sorted sources are published, so hold that until it's set up
+      mHoldAudioSourceSort = true;
       module = CreateModule(dummy);
       if (module != nullptr)
       {
@@ -2681,6 +2697,9 @@ IDrawableModule* ModularSynth::SpawnModuleOnTheFly(string moduleName, float x, f
       LogEvent("Error spawning \""+moduleName+"\" on the fly, couldn't find \""+e.mSearchName+"\"", kLogEventType_Warning);
    }
 
+   mHoldAudioSourceSort = false;
+   SortAudioSources();
+
    if (prefabToSetUp != "")
    {
       Prefab* prefab = dynamic_cast<Prefab*>(module);
@@ -2729,8 +2748,6 @@ void ModularSynth::ReconnectMidiDevices()
 
 void ModularSynth::SaveOutput()
 {
-   ScopedMutex mutex(&mAudioThreadMutex, "SaveOutput()");
-
    string recordingsPath = "recordings/";
    if (!mUserPrefs["recordings_path"].isNull())
       recordingsPath = mUserPrefs["recordings_path"].asString();
@@ -2738,21 +2755,27 @@ void ModularSynth::SaveOutput()
    string filename = ofGetTimestampString(recordingsPath + "recording_%Y-%m-%d_%H-%M.wav");
    //string filenamePos = ofGetTimestampString("recordings/pos_%Y-%m-%d_%H-%M.wav");
 
+   //stop the audio thread writing the record buffer while we copy it out, it keeps playing meanwhile
+   mFreezeRecording = true;
+   AudioThreadEpoch::WaitUntilSafeToReclaim(AudioThreadEpoch::GetRetireEpoch());
+   
    assert(mRecordingLength <= mGlobalRecordBuffer->Size());
    
-   for (int i=0; i<mRecordingLength; ++i)
+   int recordingLength = (int)mRecordingLength;
+   for (int i=0; i<recordingLength; ++i)
    {
-      mSaveOutputBuffer[0][i] = mGlobalRecordBuffer->GetSample((int)mRecordingLength-i-1, 0);
-      mSaveOutputBuffer[1][i] = mGlobalRecordBuffer->GetSample((int)mRecordingLength-i-1, 1);
+      mSaveOutputBuffer[0][i] = mGlobalRecordBuffer->GetSample(recordingLength-i-1, 0);
+      mSaveOutputBuffer[1][i] = mGlobalRecordBuffer->GetSample(recordingLength-i-1, 1);
    }
+   
+   mGlobalRecordBuffer->ClearBuffer();
+   mRecordingLength = 0;
+   mFreezeRecording = false;
 
-   Sample::WriteDataToFile(filename.c_str(), mSaveOutputBuffer, (int)mRecordingLength, 2);
+   Sample::WriteDataToFile(filename.c_str(), mSaveOutputBuffer, recordingLength, 2);
    
    //mOutputBufferMeasurePos.ReadChunk(mSaveOutputBuffer, mRecordingLength);
    //Sample::WriteDataToFile(filenamePos.c_str(), mSaveOutputBuffer, mRecordingLength, 1);
-   
-   mGlobalRecordBuffer->ClearBuffer();
-   mRecordingLength = 0;
 }
 
 const String& ModularSynth::GetTextFromClipboard() const {
@@ -16,9 +16,13 @@
 #include "LocationZoomer.h"
 #include "EffectFactory.h"
 #include "ModuleContainer.h"
+#include "AudioGraphScheduler.h"
+#include "AudioSourceGraph.h"
+#include "SaveStateWriter.h"
 #ifdef BESPOKE_LINUX
 #include <climits>
 #endif
+#include <atomic>
 
 class IAudioSource;
 class IAudioReceiver;
@@ -92,6 +96,7 @@ public:
    
    void AddMidiDevice(MidiDevice* device);
    void ArrangeAudioSourceDependencies();
+   void OnAudioTargetChanged(IAudioSource* source);
    IDrawableModule* SpawnModuleOnTheFly(string moduleName, float x, float y, bool addToContainer = true);
    void SetMoveModule(IDrawableModule* module, float offsetX, float offsetY);
    
@@ -162,6 +167,7 @@ public:
    GlobalManagers* GetGlobalManagers() { return mGlobalManagers; }
    juce::Component* GetMainComponent() { return mMainComponent; }
    juce::OpenGLContext* GetOpenGLContext() { return mOpenGLContext; }
+   bool IsHeadless() const { return mMainComponent == nullptr; }   //rendering offline, with no window or audio device
    IDrawableModule* GetLastClickedModule() const;
    EffectFactory* GetEffectFactory() { return &mEffectFactory; }
    const vector<IDrawableModule*>& GetGroupSelectedModules() const { return mGroupSelectedModules; }
@@ -222,6 +228,7 @@ public:
    
 private:
    void ResetLayout();
+   void SetWindowTitle(string title);
    void ReconnectMidiDevices();
    void DrawConsole();
    void CheckClick(IDrawableModule* clickedModule, int x, int y, bool rightButton);
@@ -231,6 +238,8 @@ private:
    void DeleteAllModules();
    void TriggerClapboard();
    void DoAutosave();
+   void SortAudioSources();
+   bool PauseAudio();
    IDrawableModule* GetModuleAtCursor();
 
    void ReadClipboardTextFromSystem();
@@ -238,9 +247,12 @@ private:
    ofSoundStream mSoundStream;
    int mIOBufferSize;
    
-   vector<IAudioSource*> mSources;
+   AudioSourceGraph mSourceGraph;
+   string mAudioFeedbackLoop;
    vector<IDrawableModule*> mLissajousDrawers;
    vector<IDrawableModule*> mDeletedModules;
+   uint64_t mDeletedModulesEpoch;   //audio thread epoch when the last of mDeletedModules was retired
+   bool mHoldAudioSourceSort;
    
    vector<IDrawableModule*> mModalFocusItemStack;
    
@@ -276,6 +288,7 @@ private:
 
    RollingBuffer* mGlobalRecordBuffer;
    long long mRecordingLength;
+   std::atomic<bool> mFreezeRecording;
    
    struct LogEventItem
    {
@@ -288,8 +301,11 @@ private:
    std::list<string> mErrors;
    
    NamedMutex mAudioThreadMutex;
+   SaveStateWriter mSaveStateWriter;
+   std::map<string, SaveChunkIndex> mSaveChunkIndices;   //by path, for the current save and the autosave slot
+   AudioGraphScheduler mAudioGraph;
    
-   bool mAudioPaused;
+   std::atomic<bool> mAudioPaused;
    bool mIsLoadingState;
    
    ModuleFactory mModuleFactory;
@@ -64,9 +64,65 @@ float ModulationChain::GetIndividualValue(int samplesIn) const
    return value;
 }
 
+void ModulationChain::GetValues(float* buffer, int samplesIn, int length) const
+{
+   for (int offset=0; offset<length; offset += kChunkSize)
+      GetValuesChunk(buffer + offset, samplesIn + offset, MIN(kChunkSize, length - offset));
+}
+
+void ModulationChain::GetValuesChunk(float* buffer, int samplesIn, int length) const
+{
+   GetIndividualValuesChunk(buffer, samplesIn, length);
+   
+   float other[kChunkSize];
+   if (mMultiplyIn)
+   {
+      mMultiplyIn->GetIndividualValuesChunk(other, samplesIn, length);
+      Mult(buffer, other, length);
+   }
+   if (mSidechain)
+   {
+      mSidechain->GetIndividualValuesChunk(other, samplesIn, length);
+      Add(buffer, other, length);
+   }
+   if (mPrev)
+   {
+      mPrev->GetValuesChunk(other, samplesIn, length);
+      Add(buffer, other, length);
+   }
+   
+   for (int i=0; i<length; ++i)
+   {
+      if (buffer[i] != buffer[i])
+         buffer[i] = 0;
+   }
+}
+
+void ModulationChain::GetIndividualValuesChunk(float* buffer, int samplesIn, int length) const
+{
+   mRamp.FillBuffer(buffer, length, gTime + gInvSampleRateMs*samplesIn, gInvSampleRateMs);
+   if (mLFOAmount != 0)
+   {
+      for (int i=0; i<length; ++i)
+         buffer[i] += mLFO.Value(samplesIn + i) * mLFOAmount;
+   }
+   if (mBuffer != nullptr)
+   {
+      int start = MAX(samplesIn, 0);
+      int end = MIN(samplesIn + length, gBufferSize);
+      if (start < end)
+         Add(buffer + (start - samplesIn), mBuffer + start, end - start);
+   }
+}
+
 void ModulationChain::SetValue(float value)
 {
-   mRamp.Start(gTime, value, gTime + gInvSampleRateMs*gBufferSize);
+   SetValue(value, gTime);
+}
+
+void ModulationChain::SetValue(float value, double time)
+{
+   mRamp.Start(time, value, time + gInvSampleRateMs*gBufferSize);
 }
 
 void ModulationChain::RampValue(double time, float from, float to, double length)
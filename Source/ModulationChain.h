@@ -35,7 +35,9 @@ public:
    ModulationChain();
    float GetValue(int samplesIn) const;
    float GetIndividualValue(int samplesIn) const;
+   void GetValues(float* buffer, int samplesIn, int length) const;   //GetValue() for a run of samples, much cheaper than calling it per sample
    void SetValue(float value);
+   void SetValue(float value, double time);
    void RampValue(double time, float from, float to, double length);
    void SetLFO(NoteInterval interval, float amount);
    void AppendTo(ModulationChain* chain);
@@ -45,6 +47,10 @@ public:
    void FillBuffer(float* buffer);
    float GetBufferValue(int sampleIdx);
 private:
+   static const int kChunkSize = 64;
+   void GetValuesChunk(float* buffer, int samplesIn, int length) const;
+   void GetIndividualValuesChunk(float* buffer, int samplesIn, int length) const;
+   
    Ramp mRamp;
    LFO mLFO;
    float mLFOAmount;
@@ -97,6 +97,28 @@ float ModulatorCurve::Value(int samplesIn)
    return ofLerp(GetMin(), GetMax(), val);
 }
 
+void ModulatorCurve::FillBlock(float* buffer, int length)
+{
+   if (!HasModulatedSliders())
+   {
+      Fill(buffer, Value(0), length);
+      return;
+   }
+   
+   //set the envelope up once for the whole buffer, rather than for every sample
+   mAdsr.Clear();
+   mAdsr.Start(0,1);
+   mAdsr.Stop(kAdsrTime);
+   for (int i=0; i<length; ++i)
+   {
+      ComputeSliders(i);
+      float val = ofClamp(mAdsr.Value(mInput * kAdsrTime), 0, 1);
+      if (val != val)
+         val = 0;
+      buffer[i] = ofLerp(GetMin(), GetMax(), val);
+   }
+}
+
 void ModulatorCurve::OnClicked(int x, int y, bool right)
 {
    IDrawableModule::OnClicked(x, y, right);
@@ -49,6 +49,7 @@ public:
    
    //IModulator
    float Value(int samplesIn = 0) override;
+   void FillBlock(float* buffer, int length) override;
    bool Active() const override { return mEnabled; }
    
    FloatSlider* GetTarget() { return mTarget; }
@@ -56,6 +56,10 @@ ModulatorExpression::ModulatorExpression()
 , mLastDrawMaxOutput(1)
 {
    mEntryString = "x";
+   
+   mTimeBlock = new float[gBufferSize];
+   for (int i=0; i<kNumBlockParameters; ++i)
+      mParameterBlocks[i] = new float[gBufferSize];
 }
 
 void ModulatorExpression::CreateUIControls()
@@ -83,7 +87,6 @@ void ModulatorExpression::CreateUIControls()
    mSymbolTable.add_variable("d",mD);
    mSymbolTable.add_variable("e",mE);
    mSymbolTable.add_constants();
-   mExpression.register_symbol_table(mSymbolTable);
    
    mSymbolTableDraw.add_variable("x",mExpressionInputDraw);
    mSymbolTableDraw.add_variable("t",mT);
@@ -100,15 +103,24 @@ void ModulatorExpression::CreateUIControls()
 
 ModulatorExpression::~ModulatorExpression()
 {
+   delete[] mTimeBlock;
+   for (int i=0; i<kNumBlockParameters; ++i)
+      delete[] mParameterBlocks[i];
 }
 
 float ModulatorExpression::Value(int samplesIn)
 {
    ComputeSliders(samplesIn);
-   if (mExpressionValid)
+   const ExpressionProgram& program = mProgram.Get();
+   if (program.mValid)
    {
       mT = (gTime + samplesIn * gInvSampleRateMs) * .001;
-      return mExpression.value();
+      if (program.mCompiled.IsValid())
+      {
+         float variables[CompiledExpression::kNumVariables] = { mExpressionInput, 0, 0, 0, 0, mT, mA, mB, mC, mD, mE };
+         return program.mCompiled.EvaluateSample(variables);
+      }
+      return program.mExpression.value();
    }
    
    if (mTarget)
@@ -116,6 +128,47 @@ float ModulatorExpression::Value(int samplesIn)
    return 0;
 }
 
+void ModulatorExpression::FillBlock(float* buffer, int length)
+{
+   const ExpressionProgram& program = mProgram.Get();
+   if (!program.mValid || !program.mCompiled.IsValid())
+   {
+      IModulator::FillBlock(buffer, length);
+      return;
+   }
+   
+   CompiledExpression::Inputs inputs;
+   float* values[kNumBlockParameters] = { &mExpressionInput, &mA, &mB, &mC, &mD, &mE };
+   const CompiledExpression::Variable variables[kNumBlockParameters] = { CompiledExpression::kVariableX, CompiledExpression::kVariableA, CompiledExpression::kVariableB, CompiledExpression::kVariableC, CompiledExpression::kVariableD, CompiledExpression::kVariableE };
+   if (HasModulatedSliders())
+   {
+      for (int i=0; i<length; ++i)
+      {
+         ComputeSliders(i);
+         for (int j=0; j<kNumBlockParameters; ++j)
+            mParameterBlocks[j][i] = *values[j];
+      }
+      for (int j=0; j<kNumBlockParameters; ++j)
+         inputs.SetBlock(variables[j], mParameterBlocks[j]);
+   }
+   else
+   {
+      ComputeSliders(0);
+      for (int j=0; j<kNumBlockParameters; ++j)
+         inputs.SetConstant(variables[j], *values[j]);
+   }
+   
+   if (program.mCompiled.Uses(CompiledExpression::kVariableT))
+   {
+      for (int i=0; i<length; ++i)
+         mTimeBlock[i] = (gTime + i * gInvSampleRateMs) * .001;
+      inputs.SetBlock(CompiledExpression::kVariableT, mTimeBlock);
+   }
+   
+   program.mCompiled.SetTableRange(mExpressionInputSlider->GetMin(), mExpressionInputSlider->GetMax());
+   program.mCompiled.Evaluate(inputs, buffer, length);
+}
+
 void ModulatorExpression::PostRepatch(PatchCableSource* cableSource, bool fromUserClick)
 {
    OnModulatorRepatch();
@@ -130,9 +183,21 @@ void ModulatorExpression::PostRepatch(PatchCableSource* cableSource, bool fromUs
 void ModulatorExpression::TextEntryComplete(TextEntry* entry)
 {
    exprtk::parser<float> parser;
-   mExpressionValid = parser.compile(mEntryString, mExpression);
-   if (mExpressionValid)
+   ExpressionProgram* program = new ExpressionProgram();
+   program->mExpression.register_symbol_table(mSymbolTable);
+   program->mValid = parser.compile(mEntryString, program->mExpression);
+   if (program->mValid)
+   {
       parser.compile(mEntryString, mExpressionDraw);
+      
+      const unsigned int kVariables = (1 << CompiledExpression::kVariableX) | (1 << CompiledExpression::kVariableT) |
+                                      (1 << CompiledExpression::kVariableA) | (1 << CompiledExpression::kVariableB) | (1 << CompiledExpression::kVariableC) |
+                                      (1 << CompiledExpression::kVariableD) | (1 << CompiledExpression::kVariableE);
+      program->mCompiled.Compile(mEntryString, kVariables);
+   }
+   
+   mExpressionValid = program->mValid;
+   mProgram.Publish(program);
 }
 
 void ModulatorExpression::DrawModule()
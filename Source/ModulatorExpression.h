@@ -32,7 +32,7 @@
 #include "Slider.h"
 #include "ClickButton.h"
 #include "TextEntry.h"
-#include "exprtk/exprtk.hpp"
+#include "ExpressionProgram.h"
 
 class ModulatorExpression : public IDrawableModule, public IFloatSliderListener, public ITextEntryListener, public IModulator
 {
@@ -46,6 +46,7 @@ public:
    
    //IModulator
    float Value(int samplesIn = 0) override;
+   void FillBlock(float* buffer, int length) override;
    bool Active() const override { return mEnabled; }
    bool CanAdjustRange() const override { return false; }
    
@@ -82,13 +83,27 @@ private:
    string mEntryString;
    TextEntry* mTextEntry;
    exprtk::symbol_table<float> mSymbolTable;
-   exprtk::expression<float> mExpression;
+   AudioThreadSnapshot<ExpressionProgram> mProgram;
    exprtk::symbol_table<float> mSymbolTableDraw;
    exprtk::expression<float> mExpressionDraw;
    
    float mExpressionInputDraw;
    float mT;
-   bool mExpressionValid;
+   bool mExpressionValid;   //ui thread, for drawing
    float mLastDrawMinOutput;
    float mLastDrawMaxOutput;
+   
+   enum BlockParameter
+   {
+      kBlockInput,
+      kBlockA,
+      kBlockB,
+      kBlockC,
+      kBlockD,
+      kBlockE,
+      kNumBlockParameters
+   };
+   
+   float* mTimeBlock;
+   float* mParameterBlocks[kNumBlockParameters];
 };
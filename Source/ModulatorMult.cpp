@@ -85,6 +85,26 @@ float ModulatorMult::Value(int samplesIn)
       return mValue1 * mValue2;
 }
 
+void ModulatorMult::FillBlock(float* buffer, int length)
+{
+   if (HasModulatedSliders())
+   {
+      for (int i=0; i<length; ++i)
+      {
+         ComputeSliders(i);
+         buffer[i] = mValue1 * mValue2;
+      }
+   }
+   else
+   {
+      ComputeSliders(0);
+      Fill(buffer, mValue1 * mValue2, length);
+   }
+   
+   if (mTarget)
+      Clamp(buffer, mTarget->GetMin(), mTarget->GetMax(), length);
+}
+
 void ModulatorMult::SaveLayout(ofxJSONElement& moduleInfo)
 {
    IDrawableModule::SaveLayout(moduleInfo);
@@ -96,6 +96,19 @@ float ModulatorSmoother::Value(int samplesIn)
    return ofClamp(mRamp.Value(gTime + samplesIn * gInvSampleRateMs), GetMin(), GetMax());
 }
 
+void ModulatorSmoother::FillBlock(float* buffer, int length)
+{
+   if (HasModulatedSliders())
+   {
+      IModulator::FillBlock(buffer, length);
+      return;
+   }
+   
+   ComputeSliders(0);
+   mRamp.FillBuffer(buffer, length, gTime, gInvSampleRateMs);
+   Clamp(buffer, GetMin(), GetMax(), length);
+}
+
 void ModulatorSmoother::SaveLayout(ofxJSONElement& moduleInfo)
 {
    IDrawableModule::SaveLayout(moduleInfo);
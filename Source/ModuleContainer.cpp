@@ -131,6 +131,10 @@ void ModuleContainer::Clear()
          DeleteModule(module);
    }
    mModules.clear();
+   mModuleIndexMutex.lock();
+   mModuleIndex.clear();
+   mModuleIndexMutex.unlock();
+   IClickable::InvalidatePaths();
 }
 
 void ModuleContainer::Exit()
@@ -288,6 +292,7 @@ void ModuleContainer::MoveToFront(IDrawableModule* module)
 void ModuleContainer::AddModule(IDrawableModule* module)
 {
    mModules.push_back(module);
+   IndexModule(module);
    MoveToFront(module);
    TheSynth->OnModuleAdded(module);
    module->SetOwningContainer(this);
@@ -302,8 +307,10 @@ void ModuleContainer::TakeModule(IDrawableModule* module)
    if (module->GetOwningContainer()->mOwner)
       module->GetOwningContainer()->mOwner->RemoveChild(module);
    RemoveFromVector(module, module->GetOwningContainer()->mModules);
+   module->GetOwningContainer()->UnindexModule(module);
    
    mModules.push_back(module);
+   IndexModule(module);
    MoveToFront(module);
    
    ofVec2f offset = oldOwnerPos - GetOwnerPosition();
@@ -316,7 +323,7 @@ void ModuleContainer::TakeModule(IDrawableModule* module)
    }
    else   //root modulecontainer
    {
-      module->SetName(GetUniqueName(module->Name(), mModules).c_str());
+      module->SetName(GetUniqueName(module->Name(), mModules).c_str());   //reindexes it through OnModuleRenamed()
    }
 }
 
@@ -329,10 +336,12 @@ void ModuleContainer::DeleteModule(IDrawableModule* module)
    {
       module->DoSpecialDelete();
       RemoveFromVector(module, mModules, K(fail));
+      UnindexModule(module);
       return;
    }
    
    RemoveFromVector(module, mModules, K(fail));
+   UnindexModule(module);
    for (auto iter : mModules)
    {
       if (iter->GetPatchCableSource())
@@ -375,31 +384,35 @@ IDrawableModule* ModuleContainer::FindModule(string name, bool fail)
    if (name == "")
       return nullptr;
    
-   for (int i=0; i<mModules.size(); ++i)
+   size_t separator = name.find('~');
+   if (separator == string::npos)
    {
-      if (name == mModules[i]->Name())
-         return mModules[i];
-      vector<string> tokens = ofSplitString(name, "~");
-      if (mModules[i]->GetContainer())
-      {
-         if (tokens[0] == mModules[i]->Name())
-         {
-            ofStringReplace(name, tokens[0]+"~", "", true);
-            return mModules[i]->GetContainer()->FindModule(name, fail);
-         }
-      }
-      if (tokens.size() == 2 && tokens[0] == mModules[i]->Name())
+      IDrawableModule* module = FindModuleByName(name.c_str());
+      if (module)
+         return module;
+   }
+   else
+   {
+      IDrawableModule* module = FindModuleByName(name.substr(0, separator).c_str());
+      if (module)
       {
-         IDrawableModule* child = nullptr;
-         try
-         {
-            child = mModules[i]->FindChild(tokens[1].c_str());
-         }
-         catch (UnknownModuleException& e)
+         string rest = name.substr(separator + 1);
+         if (module->GetContainer())
+            return module->GetContainer()->FindModule(rest, fail);
+         
+         if (rest.find('~') == string::npos)
          {
+            IDrawableModule* child = nullptr;
+            try
+            {
+               child = module->FindChild(rest.c_str());
+            }
+            catch (UnknownModuleException& e)
+            {
+            }
+            if (child)
+               return child;
          }
-         if (child)
-            return child;
       }
    }
    
@@ -408,6 +421,55 @@ IDrawableModule* ModuleContainer::FindModule(string name, bool fail)
    return nullptr;
 }
 
+IDrawableModule* ModuleContainer::FindModuleByName(const char* name)
+{
+   //the index holds every module, so a miss means there's no such module
+   IDrawableModule* found = nullptr;
+   mModuleIndexMutex.lock();
+   auto range = mModuleIndex.equal_range(JenkinsHash(name));
+   for (auto it = range.first; it != range.second; ++it)
+   {
+      if (strcmp(it->second->Name(), name) == 0)
+      {
+         found = it->second;
+         break;
+      }
+   }
+   mModuleIndexMutex.unlock();
+   return found;
+}
+
+void ModuleContainer::IndexModule(IDrawableModule* module)
+{
+   mModuleIndexMutex.lock();
+   mModuleIndex.insert(std::make_pair(JenkinsHash(module->Name()), module));   //same-named modules keep their order, so lookups find the oldest like the scan did
+   mModuleIndexMutex.unlock();
+   IClickable::InvalidatePaths();
+}
+
+void ModuleContainer::UnindexModule(IDrawableModule* module)
+{
+   //it's indexed under the name it had when it was last indexed, so look for it by value
+   mModuleIndexMutex.lock();
+   for (auto it = mModuleIndex.begin(); it != mModuleIndex.end();)
+   {
+      if (it->second == module)
+         it = mModuleIndex.erase(it);
+      else
+         ++it;
+   }
+   mModuleIndexMutex.unlock();
+   IClickable::InvalidatePaths();
+}
+
+void ModuleContainer::OnModuleRenamed(IDrawableModule* module)
+{
+   if (!VectorContains(module, mModules))
+      return;   //not added yet, it gets indexed under its final name when it is
+   UnindexModule(module);
+   IndexModule(module);
+}
+
 IUIControl* ModuleContainer::FindUIControl(string path)
 {
    /*string ownerPath = "";
@@ -421,9 +483,9 @@ IUIControl* ModuleContainer::FindUIControl(string path)
    if (path == "")
       return nullptr;
    
-   vector<string> tokens = ofSplitString(path,"~");
-   string control = tokens[tokens.size()-1];
-   string modulePath = path.substr(0, path.length() - (control.length() + 1));
+   size_t separator = path.rfind('~');
+   string control = separator == string::npos ? path : path.substr(separator + 1);
+   string modulePath = separator == string::npos ? "" : path.substr(0, separator);
    IDrawableModule* module = FindModule(modulePath, false);
    
    if (module)
@@ -570,8 +632,21 @@ namespace
    const int kSaveStateRev = 420;
 }
 
-void ModuleContainer::SaveState(FileStreamOut& out)
+void ModuleContainer::SaveState(FileStreamOut& out, bool lockAudio /*= false*/)
 {
+   std::unique_ptr<ScopedMutex> audioLock;
+   if (lockAudio)
+   {
+      //copy the big buffers out first, without the lock. then a single short lock covers everything else, rather than one
+      //lock per module, each of which can cost the audio thread a buffer.
+      for (auto* module : mModules)
+      {
+         if (module != TheSaveDataPanel && module != TheTitleBar)
+            module->StashSaveData(out);
+      }
+      audioLock.reset(new ScopedMutex(TheSynth->GetAudioMutex(), "SaveState()"));
+   }
+   
    out << kSaveStateRev;
    
    int savedModules = 0;
@@ -31,6 +31,7 @@
 #include "OpenFrameworksPort.h"
 #include "IDrawableModule.h"
 #include "ofxJSONElement.h"
+#include <unordered_map>
 
 class ModuleContainer
 {
@@ -83,15 +84,23 @@ public:
    
    void LoadModules(const ofxJSONElement& modules);
    ofxJSONElement WriteModules();
-   void SaveState(FileStreamOut& out);
+   void SaveState(FileStreamOut& out, bool lockAudio = false);
    void LoadState(FileStreamIn& in);
    
    static constexpr int GetModuleSeparatorLength() { return 13; }
    static const char* GetModuleSeparator() { return "ryanchallinor"; }
    static bool DoesModuleHaveMoreSaveData(FileStreamIn& in);
    
-private:   
+   void OnModuleRenamed(IDrawableModule* module);
+   
+private:
+   void IndexModule(IDrawableModule* module);
+   void UnindexModule(IDrawableModule* module);
+   IDrawableModule* FindModuleByName(const char* name);
+   
    vector<IDrawableModule*> mModules;
+   std::unordered_multimap<uint32_t, IDrawableModule*> mModuleIndex;   //by JenkinsHash of name, checked against the name on lookup. kept up to date on add, remove and rename.
+   ofMutex mModuleIndexMutex;   //scripts look modules up from their own thread
    IDrawableModule* mOwner;
 
    ofVec2f mDrawOffset;
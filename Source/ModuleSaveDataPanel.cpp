@@ -283,6 +283,8 @@ void ModuleSaveDataPanel::IntSliderUpdated(IntSlider* slider, int oldVal)
 
 void ModuleSaveDataPanel::TextEntryComplete(TextEntry* entry)
 {
+   if (mSaveModule != nullptr)
+      mSaveModule->SetName(mSaveModule->Name());   //the name entry edits the module's name in place, so this only reindexes it
 }
 
 void ModuleSaveDataPanel::DropdownClicked(DropdownList* list)
@@ -49,6 +49,9 @@ MultibandCompressor::MultibandCompressor()
    mOutBuffer = new float[GetBuffer()->BufferSize()];
    Clear(mOutBuffer, GetBuffer()->BufferSize());
    
+   mBandBuffer = new float[GetBuffer()->BufferSize()];
+   mPeakBuffer = new float[GetBuffer()->BufferSize()];
+   
    CalcFilters();
 }
 
@@ -67,6 +70,8 @@ MultibandCompressor::~MultibandCompressor()
 {
    delete[] mOutBuffer;
    delete[] mWorkBuffer;
+   delete[] mBandBuffer;
+   delete[] mPeakBuffer;
 }
 
 void MultibandCompressor::Process(double time)
@@ -85,19 +90,20 @@ void MultibandCompressor::Process(double time)
    {
       Clear(mOutBuffer, bufferSize);
       
-      for (int i=0; i<bufferSize; ++i)
+      //split one band at a time off of what's left above the previous ones, and scale it by its own level
+      float* highLeftover = mWorkBuffer;
+      BufferCopy(highLeftover, GetBuffer()->GetChannel(0), bufferSize);
+      for (int j=0; j<mNumBands; ++j)
       {
-         float lower;
-         float highLeftover = GetBuffer()->GetChannel(0)[i];
-         for (int j=0; j<mNumBands; ++j)
-         {
-            mFilters[j].ProcessSample(highLeftover, lower, highLeftover);
-            mPeaks[j].Process(&lower, 1);
-            float compress = ofClamp(1/mPeaks[i].GetPeak(), 0, 10);
-            mOutBuffer[i] += lower * compress;
-         }
-         mOutBuffer[i] += highLeftover;
+         for (int i=0; i<bufferSize; ++i)
+            mFilters[j].ProcessSample(highLeftover[i], mBandBuffer[i], highLeftover[i]);
+         mPeaks[j].Process(mBandBuffer, mPeakBuffer, bufferSize);
+         for (int i=0; i<bufferSize; ++i)
+            mPeakBuffer[i] = ofClamp(1/mPeakBuffer[i], 0, 10);
+         Mult(mBandBuffer, mPeakBuffer, bufferSize);
+         Add(mOutBuffer, mBandBuffer, bufferSize);
       }
+      Add(mOutBuffer, highLeftover, bufferSize);
       
       /*for (int i=0; i<mNumBands; ++i)
       {
@@ -70,6 +70,8 @@ private:
    
    float* mWorkBuffer;
    float* mOutBuffer;
+   float* mBandBuffer;
+   float* mPeakBuffer;
    
    float mDryWet;
    FloatSlider* mDryWetSlider;
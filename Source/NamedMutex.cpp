@@ -36,6 +36,14 @@ void NamedMutex::Lock(string locker)
    mLocker = locker;
 }
 
+bool NamedMutex::TryLock(string locker)
+{
+   if (!mMutex.try_lock())
+      return false;
+   mLocker = locker;
+   return true;
+}
+
 void NamedMutex::Unlock()
 {
    if (mExtraLockCount == 0)
@@ -33,6 +33,7 @@ class NamedMutex
 public:
    NamedMutex() : mLocker("<none>"), mExtraLockCount(0) {}
    void Lock(string locker);
+   bool TryLock(string locker);  //never waits, and isn't reentrant
    void Unlock();
 private:
    ofMutex mMutex;
@@ -25,7 +25,7 @@
 
 #include "Oscillator.h"
 
-float Oscillator::Value(float phase) const
+float Oscillator::Value(float phase, float phaseInc /*= 0*/) const
 {
    if (mType == kOsc_Tri)
       phase += .5f * FPI;  //shift phase to make triangle start at zero instead of 1, to eliminate click on start
@@ -81,6 +81,41 @@ float Oscillator::Value(float phase) const
          break;
    }
    
+   if (phaseInc > 0 && mShuffle == 0)
+   {
+      //smooth out the discontinuities (and the triangle's corners) over the samples around them
+      float t = phase / FTWO_PI;
+      float dt = MIN(phaseInc / FTWO_PI, .5f);
+      switch (mType)
+      {
+         case kOsc_Saw:
+            if (mSoften == 0)
+               sample -= PolyBlep(t, dt);
+            break;
+         case kOsc_NegSaw:
+            if (mSoften == 0)
+               sample += PolyBlep(t, dt);
+            break;
+         case kOsc_Square:
+            if (mSoften == 0)
+            {
+               float fallingT = t - mPulseWidth;
+               fallingT -= floor(fallingT);
+               sample += PolyBlep(t, dt) - PolyBlep(fallingT, dt);
+            }
+            break;
+         case kOsc_Tri:
+         {
+            float troughT = t + .5f;
+            troughT -= floor(troughT);
+            sample += (PolyBlamp(troughT, dt) - PolyBlamp(t, dt)) * dt * 8;
+            break;
+         }
+         default:
+            break;
+      }
+   }
+   
    if (mType != kOsc_Square && mPulseWidth != .5f)
       sample = (Bias(sample/2+.5f, mPulseWidth) - .5f) * 2; //give "pulse width" to non-square oscillators
    
@@ -96,3 +131,35 @@ float Oscillator::SawSample(float phase) const
       return phase/(1-mSoften) * 2 - 1;
    return 1 - ((phase - (1-mSoften)) / mSoften * 2);
 }
+
+//static
+float Oscillator::PolyBlep(float t, float dt)
+{
+   if (t < dt)
+   {
+      t /= dt;
+      return t + t - t * t - 1;
+   }
+   if (t > 1 - dt)
+   {
+      t = (t - 1) / dt;
+      return t * t + t + t + 1;
+   }
+   return 0;
+}
+
+//static
+float Oscillator::PolyBlamp(float t, float dt)
+{
+   if (t < dt)
+   {
+      t = t / dt - 1;
+      return -1.0f / 3 * t * t * t;
+   }
+   if (t > 1 - dt)
+   {
+      t = (t - 1) / dt + 1;
+      return 1.0f / 3 * t * t * t;
+   }
+   return 0;
+}
@@ -29,6 +29,7 @@
 #include <iostream>
 #include "SynthGlobals.h"
 #include "ADSR.h"
+#include "SimdFloat.h"
 
 class Oscillator
 {
@@ -37,7 +38,11 @@ public:
    
    OscillatorType GetType() const { return mType; }
    void SetType(OscillatorType type) { mType = type; }
-   float Value(float phase) const;
+   //pass the phase increment per sample to get band-limited edges (PolyBLEP), so saw/square/tri don't alias without oversampling
+   float Value(float phase, float phaseInc = 0) const;
+   //Value() for several phases at once. kType must match GetType(); it's a template parameter so the waveform is picked once per block instead of per sample.
+   template<OscillatorType kType> SimdFloat Value(SimdFloat phase) const { return ValueImpl<kType, false>(phase, 0.0f); }
+   template<OscillatorType kType> SimdFloat BandLimitedValue(SimdFloat phase, SimdFloat phaseInc) const { return ValueImpl<kType, true>(phase, phaseInc); }
    float GetPulseWidth() const { return mPulseWidth; }
    void SetPulseWidth(float width) { mPulseWidth = width; }
    float GetShuffle() const { return mShuffle; }
@@ -46,11 +51,140 @@ public:
    void SetSoften(float soften) { mSoften = ofClamp(soften,0,1); }
    OscillatorType mType;
 private:
+   template<OscillatorType kType, bool kBandLimited> SimdFloat ValueImpl(SimdFloat phase, SimdFloat phaseInc) const;
    float SawSample(float phase) const;
+   SimdFloat SawSample(SimdFloat phase) const;
+   
+   //residuals to add at a discontinuity (BLEP, for a downward step of 2) or a corner (BLAMP, for a slope change of 1 per sample).
+   //t is the position in the cycle in [0,1), dt is the phase increment in cycles per sample.
+   static float PolyBlep(float t, float dt);
+   static float PolyBlamp(float t, float dt);
+   static SimdFloat PolyBlep(SimdFloat t, SimdFloat dt);
+   static SimdFloat PolyBlamp(SimdFloat t, SimdFloat dt);
    
    float mPulseWidth;
    float mShuffle;
    float mSoften;
 };
 
+template<OscillatorType kType, bool kBandLimited>
+inline SimdFloat Oscillator::ValueImpl(SimdFloat phase, SimdFloat phaseInc) const
+{
+   if (kType != kOsc_Sin && kType != kOsc_Square && kType != kOsc_Tri && kType != kOsc_Saw && kType != kOsc_NegSaw)
+   {
+      //nothing to vectorize for these, do them a lane at a time
+      float lanes[SimdFloat::kNumLanes];
+      float incLanes[SimdFloat::kNumLanes];
+      phase.Store(lanes);
+      phaseInc.Store(incLanes);
+      for (int i=0; i<SimdFloat::kNumLanes; ++i)
+         lanes[i] = Value(lanes[i], incLanes[i]);
+      return SimdFloat::Load(lanes);
+   }
+   
+   if (kType == kOsc_Tri)
+      phase = phase + .5f * FPI;
+   
+   if (mShuffle > 0)
+   {
+      phase = Wrap(phase, FTWO_PI * 2);
+      
+      float shufflePoint = FTWO_PI * (1+mShuffle);
+      
+      phase = Select(phase < shufflePoint, phase / (1+mShuffle), (phase - shufflePoint) / (1-mShuffle));
+   }
+   
+   phase = Wrap(phase, FTWO_PI);
+   
+   SimdFloat sample(0.0f);
+   if (kType == kOsc_Sin)
+   {
+      sample = FastSin(phase);
+   }
+   else if (kType == kOsc_Saw)
+   {
+      sample = SawSample(phase);
+   }
+   else if (kType == kOsc_NegSaw)
+   {
+      sample = SimdFloat(0.0f) - SawSample(phase);
+   }
+   else if (kType == kOsc_Square)
+   {
+      if (mSoften == 0)
+      {
+         sample = Select(phase > FTWO_PI * mPulseWidth, -1.0f, 1.0f);
+      }
+      else
+      {
+         SimdFloat phase01 = phase * (1 / FTWO_PI) + (.75f - (mPulseWidth - .5f) / 2);
+         phase01 = phase01 - Floor(phase01);
+         sample = Clamp((Abs(phase01 - .5f) * 4 - 1 + (mPulseWidth-.5f) * 2) / mSoften, -1.0f, 1.0f);
+      }
+   }
+   else if (kType == kOsc_Tri)
+   {
+      sample = Abs(phase * (1 / FTWO_PI) - .5f) * 4 - 1;
+   }
+   
+   if (kBandLimited && mShuffle == 0)
+   {
+      SimdFloat t = phase * (1 / FTWO_PI);
+      SimdFloat dt = Min(phaseInc * (1 / FTWO_PI), .5f);
+      if (kType == kOsc_Saw && mSoften == 0)
+      {
+         sample = sample - PolyBlep(t, dt);
+      }
+      else if (kType == kOsc_NegSaw && mSoften == 0)
+      {
+         sample = sample + PolyBlep(t, dt);
+      }
+      else if (kType == kOsc_Square && mSoften == 0)
+      {
+         SimdFloat fallingT = t - mPulseWidth;
+         fallingT = fallingT - Floor(fallingT);
+         sample = sample + PolyBlep(t, dt) - PolyBlep(fallingT, dt);
+      }
+      else if (kType == kOsc_Tri)
+      {
+         SimdFloat troughT = t + .5f;
+         troughT = troughT - Floor(troughT);
+         sample = sample + (PolyBlamp(troughT, dt) - PolyBlamp(t, dt)) * dt * 8;
+      }
+   }
+   
+   if (kType != kOsc_Square && mPulseWidth != .5f)
+   {
+      float lanes[SimdFloat::kNumLanes];
+      sample.Store(lanes);
+      for (int i=0; i<SimdFloat::kNumLanes; ++i)
+         lanes[i] = (Bias(lanes[i]/2+.5f, mPulseWidth) - .5f) * 2; //give "pulse width" to non-square oscillators
+      sample = SimdFloat::Load(lanes);
+   }
+   
+   return sample;
+}
+
+inline SimdFloat Oscillator::SawSample(SimdFloat phase) const
+{
+   phase = phase * (1 / FTWO_PI);
+   if (mSoften == 0)
+      return phase * 2 - 1;
+   return Select(phase < 1-mSoften, phase / (1-mSoften) * 2 - 1, SimdFloat(1.0f) - ((phase - (1-mSoften)) / mSoften * 2));
+}
+
+inline SimdFloat Oscillator::PolyBlep(SimdFloat t, SimdFloat dt)
+{
+   SimdFloat start = t / dt;
+   SimdFloat end = (t - 1) / dt;
+   return Select(t < dt, start + start - start * start - 1, Select(t > SimdFloat(1.0f) - dt, end * end + end + end + 1, 0.0f));
+}
+
+inline SimdFloat Oscillator::PolyBlamp(SimdFloat t, SimdFloat dt)
+{
+   SimdFloat start = t / dt - 1;
+   SimdFloat end = (t - 1) / dt + 1;
+   return Select(t < dt, start * start * start * (-1.0f / 3), Select(t > SimdFloat(1.0f) - dt, end * end * end * (1.0f / 3), 0.0f));
+}
+
 #endif /* defined(__Bespoke__Oscillator__) */
@@ -0,0 +1,394 @@
+/**
+    bespoke synth, a software modular synthesizer
+    Copyright (C) 2021 Ryan Challinor (contact: awwbees@gmail.com)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**/
+/*
+  ==============================================================================
+
+    Oversampler.cpp
+    Created: 25 Jul 2021 11:02:19am
+    Author:  Ryan Challinor
+
+  ==============================================================================
+*/
+
+#include "Oversampler.h"
+#include "DropdownList.h"
+#include "SimdFloat.h"
+#include "SynthGlobals.h"
+
+namespace
+{
+   //the first stage has to hold the audio band right up to its edge. later stages only have to reject the images of it,
+   //which sit further and further from their new nyquist, so they get away with far shorter filters.
+   const int kFirHalfLengths[] = { 32, 6, 4 };   //even phase taps / 2, kept a multiple of SimdFloat::kNumLanes / 2
+   const float kFirKaiserBeta[] = { 8.0f, 7.0f, 7.0f };
+   const int kIirNumCoefficients[] = { 8, 4, 3 };
+   const double kIirTransitionBandwidth[] = { .04, .13, .19 };   //as a fraction of the upsampled rate
+
+   double BesselI0(double x)
+   {
+      double sum = 1;
+      double term = 1;
+      for (int k=1; k<50; ++k)
+      {
+         term *= (x / (2 * k)) * (x / (2 * k));
+         sum += term;
+         if (term < sum * 1e-12)
+            break;
+      }
+      return sum;
+   }
+
+   //kaiser windowed sinc at a quarter of the upsampled rate. every other tap of a half-band filter is zero, apart from the
+   //center one, which is always .5, so only the even phase is stored, normalized so that it sums to .5 and dc passes at unity.
+   std::vector<float> DesignFir(int halfLength, double beta)
+   {
+      int center = halfLength * 2 - 1;
+      std::vector<float> taps(halfLength * 2);
+      double sum = 0;
+      for (int i=0; i<halfLength*2; ++i)
+      {
+         double offset = i * 2 - center;
+         double sinc = sin(offset * M_PI * .5) / (offset * M_PI);
+         double position = offset / center;
+         double window = BesselI0(beta * sqrt(1 - position * position)) / BesselI0(beta);
+         taps[i] = sinc * window;
+         sum += taps[i];
+      }
+      for (int i=0; i<halfLength*2; ++i)
+         taps[i] *= .5 / sum;
+      return taps;
+   }
+
+   //elliptic half-band as two parallel chains of first order allpasses, after the method in laurent de soras' hiir
+   double IirNumerator(double q, int order, int c)
+   {
+      double acc = 0;
+      double term;
+      int i = 0;
+      int sign = 1;
+      do
+      {
+         term = pow(q, i * (i + 1)) * sin((i * 2 + 1) * c * M_PI / order) * sign;
+         acc += term;
+         sign = -sign;
+         ++i;
+      } while (fabs(term) > 1e-100);
+      return acc;
+   }
+
+   double IirDenominator(double q, int order, int c)
+   {
+      double acc = 0;
+      double term;
+      int i = 1;
+      int sign = -1;
+      do
+      {
+         term = pow(q, i * i) * cos(i * 2 * c * M_PI / order) * sign;
+         acc += term;
+         sign = -sign;
+         ++i;
+      } while (fabs(term) > 1e-100);
+      return acc;
+   }
+
+   std::vector<float> DesignIir(int numCoefficients, double transitionBandwidth)
+   {
+      double k = tan((1 - transitionBandwidth * 2) * M_PI / 4);
+      k *= k;
+      double kksqrt = pow(1 - k * k, .25);
+      double e = .5 * (1 - kksqrt) / (1 + kksqrt);
+      double e2 = e * e;
+      double e4 = e2 * e2;
+      double q = e * (1 + e4 * (2 + e4 * (15 + 150 * e4)));
+
+      int order = numCoefficients * 2 + 1;
+      std::vector<float> coefficients(numCoefficients);
+      for (int i=0; i<numCoefficients; ++i)
+      {
+         double num = IirNumerator(q, order, i + 1) * pow(q, .25);
+         double den = IirDenominator(q, order, i + 1) + .5;
+         double ww = num / den;
+         double wwsq = ww * ww;
+         double x = sqrt((1 - wwsq * k) * (1 - wwsq / k)) / (1 + wwsq);
+         coefficients[i] = (1 - x) / (1 + x);
+      }
+      return coefficients;
+   }
+
+   struct Designs
+   {
+      Designs()
+      {
+         for (int i=0; i<3; ++i)
+         {
+            mFirTaps[i] = DesignFir(kFirHalfLengths[i], kFirKaiserBeta[i]);
+            std::vector<float> coefficients = DesignIir(kIirNumCoefficients[i], kIirTransitionBandwidth[i]);
+            for (int j=0; j<(int)coefficients.size(); ++j)
+               mIirCoefficients[i][j % 2].push_back(coefficients[j]);
+            
+            //a half-band filter delays by half its length at the upsampled rate, and the signal goes through one on the way up and one on the way down.
+            //that's 2 * (2 * halfLength - 1) samples at the stage's upper rate, which is (1 << (i + 1)) times the original rate.
+            mFirLatency[i] = (kFirHalfLengths[i] * 2 - 1) / float(1 << i);
+            
+            //the allpasses' delay depends on frequency, so use their delay at dc, where a first order allpass delays by (1 - c) / (1 + c) at the
+            //phase's rate. the two phases are averaged, with the odd one a sample behind at the upsampled rate.
+            double phaseDelay = .5;
+            for (int j=0; j<(int)coefficients.size(); ++j)
+               phaseDelay += (1 - coefficients[j]) / (1 + coefficients[j]);
+            mIirLatency[i] = float(phaseDelay / (1 << i));
+         }
+      }
+      std::vector<float> mFirTaps[3];
+      std::vector<float> mIirCoefficients[3][2];   //alternate coefficients go to alternate phases
+      float mFirLatency[3];   //per stage, in samples at the original rate
+      float mIirLatency[3];
+   };
+
+   const Designs& GetDesigns()
+   {
+      static Designs sDesigns;
+      return sDesigns;
+   }
+}
+
+Oversampler::Oversampler()
+: mFactor(1)
+, mNumStages(0)
+, mLinearPhase(false)
+{
+   //everything is allocated up front, so that switching modes from the ui doesn't pull buffers out from under the audio thread
+   for (int ch=0; ch<ChannelBuffer::kMaxNumChannels; ++ch)
+   {
+      mWork[ch][0].resize(gBufferSize * kMaxFactor);
+      mWork[ch][1].resize(gBufferSize * kMaxFactor);
+      for (int i=0; i<kMaxStages; ++i)
+         mStages[ch][i].Init(i);
+   }
+}
+
+void Oversampler::SetMode(int mode)
+{
+   int factor = mode & ~kLinearPhase;
+   bool linearPhase = (mode & kLinearPhase) != 0;
+   if (factor != 1 && factor != 2 && factor != 4 && factor != 8)
+      factor = 1;
+
+   int numStages = 0;
+   while ((1 << numStages) < factor)
+      ++numStages;
+
+   if (factor == mFactor && linearPhase == mLinearPhase)
+      return;
+
+   for (int ch=0; ch<ChannelBuffer::kMaxNumChannels; ++ch)
+   {
+      for (int i=0; i<kMaxStages; ++i)
+         mStages[ch][i].SetLinearPhase(linearPhase);
+   }
+
+   mFactor = factor;
+   mNumStages = numStages;
+   mLinearPhase = linearPhase;
+   Reset();
+}
+
+float Oversampler::GetLatency() const
+{
+   //roughly 63-70 samples for the linear phase modes, and 3.5-5.5 for the minimum phase ones
+   const Designs& designs = GetDesigns();
+   float latency = 0;
+   for (int i=0; i<mNumStages; ++i)
+      latency += mLinearPhase ? designs.mFirLatency[i] : designs.mIirLatency[i];
+   return latency;
+}
+
+void Oversampler::Reset()
+{
+   for (int ch=0; ch<ChannelBuffer::kMaxNumChannels; ++ch)
+   {
+      for (int i=0; i<kMaxStages; ++i)
+         mStages[ch][i].Reset();
+   }
+}
+
+float* Oversampler::Upsample(int channel, const float* input, int length)
+{
+   assert(length <= gBufferSize);
+
+   if (mNumStages == 0)
+   {
+      BufferCopy(mWork[channel][0].data(), input, length);
+      return mWork[channel][0].data();
+   }
+
+   //ping-pong between the work buffers so that the last stage always lands in mWork[channel][0]
+   const float* source = input;
+   for (int i=0; i<mNumStages; ++i)
+   {
+      float* dest = mWork[channel][(mNumStages - 1 - i) % 2].data();
+      mStages[channel][i].Upsample(source, dest, length << i);
+      source = dest;
+   }
+   return mWork[channel][0].data();
+}
+
+void Oversampler::Downsample(int channel, float* output, int length)
+{
+   if (mNumStages == 0)
+   {
+      BufferCopy(output, mWork[channel][0].data(), length);
+      return;
+   }
+
+   const float* source = mWork[channel][0].data();
+   for (int i=mNumStages-1; i>=0; --i)
+   {
+      float* dest = (i == 0) ? output : mWork[channel][(mNumStages - i) % 2].data();
+      mStages[channel][i].Downsample(source, dest, length << i);
+      source = dest;
+   }
+}
+
+//static
+void Oversampler::AddModeLabels(DropdownList* list)
+{
+   list->AddLabel("off", kOff);
+   list->AddLabel("2x", k2x);
+   list->AddLabel("4x", k4x);
+   list->AddLabel("8x", k8x);
+   list->AddLabel("2x linear", k2x | kLinearPhase);
+   list->AddLabel("4x linear", k4x | kLinearPhase);
+   list->AddLabel("8x linear", k8x | kLinearPhase);
+}
+
+void Oversampler::HalfbandStage::Init(int stageIndex)
+{
+   const Designs& designs = GetDesigns();
+   int maxLength = gBufferSize << stageIndex;   //at the lower of this stage's two rates
+
+   mLinearPhase = false;
+
+   mTaps = designs.mFirTaps[stageIndex].data();
+   mHalfLength = kFirHalfLengths[stageIndex];
+   mUpHistory.assign(mHalfLength * 2 - 1 + maxLength, 0);
+   mDownEvenHistory.assign(mHalfLength * 2 - 1 + maxLength, 0);
+   mDownOddHistory.assign(mHalfLength + maxLength, 0);
+
+   for (int phase=0; phase<2; ++phase)
+   {
+      mCoefficients[phase] = designs.mIirCoefficients[stageIndex][phase].data();
+      mNumCoefficients[phase] = (int)designs.mIirCoefficients[stageIndex][phase].size();
+      mUpState[phase].assign(mNumCoefficients[phase] * 2, 0);
+      mDownState[phase].assign(mNumCoefficients[phase] * 2, 0);
+   }
+}
+
+void Oversampler::HalfbandStage::Reset()
+{
+   std::fill(mUpHistory.begin(), mUpHistory.end(), 0.0f);
+   std::fill(mDownEvenHistory.begin(), mDownEvenHistory.end(), 0.0f);
+   std::fill(mDownOddHistory.begin(), mDownOddHistory.end(), 0.0f);
+   for (int phase=0; phase<2; ++phase)
+   {
+      std::fill(mUpState[phase].begin(), mUpState[phase].end(), 0.0f);
+      std::fill(mDownState[phase].begin(), mDownState[phase].end(), 0.0f);
+   }
+}
+
+//taps are stored oldest-first, so this is a straight dot product against the history
+//static
+float Oversampler::HalfbandStage::Convolve(const float* taps, const float* samples, int numTaps)
+{
+   SimdFloat acc = SimdFloat::Broadcast(0);
+   for (int i=0; i<numTaps; i += SimdFloat::kNumLanes)
+      acc = acc + SimdFloat::Load(taps + i) * SimdFloat::Load(samples + i);
+   return acc.Sum();
+}
+
+//state holds the previous input and output of each allpass, y = c * (x - y[-1]) + x[-1]
+//static
+void Oversampler::HalfbandStage::RunAllpasses(const float* coefficients, float* state, int numCoefficients, float& sample)
+{
+   for (int i=0; i<numCoefficients; ++i)
+   {
+      float output = coefficients[i] * (sample - state[i * 2 + 1]) + state[i * 2];
+      state[i * 2] = sample;
+      state[i * 2 + 1] = output;
+      sample = output;
+   }
+}
+
+void Oversampler::HalfbandStage::Upsample(const float* input, float* output, int length)
+{
+   if (mLinearPhase)
+   {
+      //even outputs are the filtered input at twice the gain, odd outputs land on the center tap and are just the delayed input
+      int historyLength = mHalfLength * 2 - 1;
+      float* history = mUpHistory.data();
+      BufferCopy(history + historyLength, input, length);
+      for (int i=0; i<length; ++i)
+      {
+         output[i * 2] = Convolve(mTaps, history + i, mHalfLength * 2) * 2;
+         output[i * 2 + 1] = history[i + mHalfLength];
+      }
+      memmove(history, history + length, historyLength * sizeof(float));
+   }
+   else
+   {
+      for (int i=0; i<length; ++i)
+      {
+         float even = input[i];
+         float odd = input[i];
+         RunAllpasses(mCoefficients[0], mUpState[0].data(), mNumCoefficients[0], even);
+         RunAllpasses(mCoefficients[1], mUpState[1].data(), mNumCoefficients[1], odd);
+         output[i * 2] = even;
+         output[i * 2 + 1] = odd;
+      }
+   }
+}
+
+void Oversampler::HalfbandStage::Downsample(const float* input, float* output, int length)
+{
+   if (mLinearPhase)
+   {
+      int evenHistoryLength = mHalfLength * 2 - 1;
+      float* evenHistory = mDownEvenHistory.data();
+      float* oddHistory = mDownOddHistory.data();
+      for (int i=0; i<length; ++i)
+      {
+         evenHistory[evenHistoryLength + i] = input[i * 2];
+         oddHistory[mHalfLength + i] = input[i * 2 + 1];
+      }
+      for (int i=0; i<length; ++i)
+         output[i] = Convolve(mTaps, evenHistory + i, mHalfLength * 2) + oddHistory[i] * .5f;
+      memmove(evenHistory, evenHistory + length, evenHistoryLength * sizeof(float));
+      memmove(oddHistory, oddHistory + length, mHalfLength * sizeof(float));
+   }
+   else
+   {
+      for (int i=0; i<length; ++i)
+      {
+         float even = input[i * 2 + 1];
+         float odd = input[i * 2];
+         RunAllpasses(mCoefficients[0], mDownState[0].data(), mNumCoefficients[0], even);
+         RunAllpasses(mCoefficients[1], mDownState[1].data(), mNumCoefficients[1], odd);
+         output[i] = (even + odd) * .5f;
+      }
+   }
+}
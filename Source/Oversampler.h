@@ -0,0 +1,101 @@
+/**
+    bespoke synth, a software modular synthesizer
+    Copyright (C) 2021 Ryan Challinor (contact: awwbees@gmail.com)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**/
+/*
+  ==============================================================================
+
+    Oversampler.h
+    Created: 25 Jul 2021 11:02:19am
+    Author:  Ryan Challinor
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include "ChannelBuffer.h"
+#include <vector>
+
+class DropdownList;
+
+//runs part of an effect at 2x, 4x or 8x the sample rate, so that a nonlinearity's harmonics above nyquist get filtered out instead of aliasing.
+//each doubling is a polyphase half-band stage: either a linear phase FIR, or an allpass IIR with much less latency but nonlinear phase.
+//usage: process the samples returned by Upsample() in place, then Downsample() them back into the original buffer.
+//the round trip delays the signal by GetLatency(), so anything mixing the result with the unprocessed input needs to delay that to match.
+class Oversampler
+{
+public:
+   enum Mode
+   {
+      kOff = 1,
+      k2x = 2,
+      k4x = 4,
+      k8x = 8,
+      kLinearPhase = 16   //combined with a factor
+   };
+
+   Oversampler();
+
+   void SetMode(int mode);
+   int GetFactor() const { return mFactor; }
+   float GetLatency() const;   //how far Downsample()'s output lags Upsample()'s input, in samples at the original rate
+   void Reset();
+
+   float* Upsample(int channel, const float* input, int length);   //returns GetFactor() * length samples
+   void Downsample(int channel, float* output, int length);
+
+   static void AddModeLabels(DropdownList* list);
+
+   static const int kMaxFactor = 8;
+
+private:
+   class HalfbandStage
+   {
+   public:
+      void Init(int stageIndex);
+      void SetLinearPhase(bool linearPhase) { mLinearPhase = linearPhase; }
+      void Reset();
+      void Upsample(const float* input, float* output, int length);
+      void Downsample(const float* input, float* output, int length);
+   private:
+      static float Convolve(const float* taps, const float* samples, int numTaps);
+      static void RunAllpasses(const float* coefficients, float* state, int numCoefficients, float& sample);
+
+      bool mLinearPhase;
+
+      //linear phase: 2*mHalfLength taps on the even phase, and a delay for the odd phase
+      const float* mTaps;
+      int mHalfLength;
+      std::vector<float> mUpHistory;
+      std::vector<float> mDownEvenHistory;
+      std::vector<float> mDownOddHistory;
+
+      //minimum phase: a chain of first order allpasses on each phase
+      const float* mCoefficients[2];
+      int mNumCoefficients[2];
+      std::vector<float> mUpState[2];
+      std::vector<float> mDownState[2];
+   };
+
+   static const int kMaxStages = 3;
+
+   int mFactor;
+   int mNumStages;
+   bool mLinearPhase;
+   HalfbandStage mStages[ChannelBuffer::kMaxNumChannels][kMaxStages];
+   std::vector<float> mWork[ChannelBuffer::kMaxNumChannels][2];
+};
@@ -30,6 +30,7 @@
 #include "INoteReceiver.h"
 #include "GridController.h"
 #include "IPulseReceiver.h"
+#include "IAudioSource.h"
 #include "AudioSend.h"
 #include "MacroSlider.h"
 
@@ -110,9 +111,9 @@ void PatchCableSource::SetPatchCableTarget(PatchCable* cable, IClickable* target
    
    mOwner->PreRepatch(this);
    
-   if (cable->GetTarget())
+   bool hadTarget = cable->GetTarget() != nullptr;
+   if (hadTarget)
    {
-      mAudioReceiver = nullptr;
       RemoveFromVector(dynamic_cast<INoteReceiver*>(cable->GetTarget()), mNoteReceivers);
       RemoveFromVector(dynamic_cast<IPulseReceiver*>(cable->GetTarget()), mPulseReceivers);
    }
@@ -125,14 +126,14 @@ void PatchCableSource::SetPatchCableTarget(PatchCable* cable, IClickable* target
    IPulseReceiver* pulseReceiver = dynamic_cast<IPulseReceiver*>(target);
    if (pulseReceiver)
       mPulseReceivers.push_back(pulseReceiver);
+   PublishReceivers();
    IAudioReceiver* audioReceiver = dynamic_cast<IAudioReceiver*>(target);
-   if (audioReceiver)
-   {
-      mAudioReceiver = audioReceiver;
-      TheSynth->ArrangeAudioSourceDependencies();
-   }
+   if (audioReceiver || hadTarget)
+      SetAudioReceiver(audioReceiver);
    
    mOwner->PostRepatch(this, fromUserClick);
+   if (audioReceiver == nullptr)
+      NotifyAudioGraph();
    
    //insert
    if (GetKeyModifiers() == kModifier_Shift && fromUserClick)
@@ -623,17 +624,44 @@ void PatchCableSource::KeyPressed(int key, bool isRepeat)
 void PatchCableSource::RemovePatchCable(PatchCable* cable)
 {
    mOwner->PreRepatch(this);
-   mAudioReceiver = nullptr;
+   SetAudioReceiver(nullptr);
    if (cable != nullptr)
    {
       RemoveFromVector(dynamic_cast<INoteReceiver*>(cable->GetTarget()), mNoteReceivers);
       RemoveFromVector(dynamic_cast<IPulseReceiver*>(cable->GetTarget()), mPulseReceivers);
+      PublishReceivers();
    }
    RemoveFromVector(cable, mPatchCables);
    mOwner->PostRepatch(this, false);
+   NotifyAudioGraph();
    delete cable;
 }
 
+void PatchCableSource::SetAudioReceiver(IAudioReceiver* receiver)
+{
+   if (receiver == mAudioReceiver)
+      return;
+   
+   mAudioReceiver = receiver;
+   NotifyAudioGraph();
+}
+
+void PatchCableSource::NotifyAudioGraph()
+{
+   //note, pulse and modulation cables matter to the audio graph too, it keeps audio sources that have them on the serial path
+   IAudioSource* source = dynamic_cast<IAudioSource*>(mOwner);
+   if (source)
+      TheSynth->OnAudioTargetChanged(source);
+}
+
+void PatchCableSource::PublishReceivers()
+{
+   Receivers* receivers = new Receivers();
+   receivers->mNoteReceivers = mNoteReceivers;
+   receivers->mPulseReceivers = mPulseReceivers;
+   mReceivers.Publish(receivers);
+}
+
 void PatchCableSource::ClearPatchCables()
 {
    while (mPatchCables.empty() == false)
@@ -651,9 +679,10 @@ void PatchCableSource::SetTarget(IClickable* target)
    }
    else
    {
-      mAudioReceiver = nullptr;
+      SetAudioReceiver(nullptr);
       mNoteReceivers.clear();
       mPulseReceivers.clear();
+      PublishReceivers();
    }
 }
 
@@ -30,6 +30,8 @@
 #include "IClickable.h"
 #include "SynthGlobals.h"
 #include "IDrawableModule.h"
+#include "AudioThreadEpoch.h"
+#include <atomic>
 
 class IAudioReceiver;
 class INoteReceiver;
@@ -102,8 +104,8 @@ public:
    void RemovePatchCable(PatchCable* cable);
    void ClearPatchCables();
    void SetPatchCableTarget(PatchCable* cable, IClickable* target, bool fromUserClick);
-   const vector<INoteReceiver*>& GetNoteReceivers() const { return mNoteReceivers; }
-   const vector<IPulseReceiver*>& GetPulseReceivers() const { return mPulseReceivers; }
+   const vector<INoteReceiver*>& GetNoteReceivers() const { return mReceivers.Get().mNoteReceivers; }
+   const vector<IPulseReceiver*>& GetPulseReceivers() const { return mReceivers.Get().mPulseReceivers; }
    IAudioReceiver* GetAudioReceiver() const { return mAudioReceiver; }
    IClickable* GetTarget() const;
    void SetTarget(IClickable* target);
@@ -148,6 +150,9 @@ protected:
 private:
    bool InAddCableMode() const;
    int GetHoverIndex(float x, float y) const;
+   void SetAudioReceiver(IAudioReceiver* receiver);
+   void NotifyAudioGraph();
+   void PublishReceivers();
    
    vector<PatchCable*> mPatchCables;
    int mHoverIndex; //-1 = not hovered
@@ -170,7 +175,15 @@ private:
    
    vector<INoteReceiver*> mNoteReceivers;
    vector<IPulseReceiver*> mPulseReceivers;
-   IAudioReceiver* mAudioReceiver;
+   std::atomic<IAudioReceiver*> mAudioReceiver;
+   
+   //the audio thread walks these while notes and pulses go out, so it gets a published copy instead of the lists we edit
+   struct Receivers
+   {
+      vector<INoteReceiver*> mNoteReceivers;
+      vector<IPulseReceiver*> mPulseReceivers;
+   };
+   AudioThreadSnapshot<Receivers> mReceivers;
    
    vector<string> mTypeFilter;
    vector<IClickable*> mValidTargets;
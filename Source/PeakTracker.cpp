@@ -28,12 +28,17 @@
 #include "Profiler.h"
 
 void PeakTracker::Process(float* buffer, int bufferSize)
+{
+   Process(buffer, nullptr, bufferSize);
+}
+
+void PeakTracker::Process(const float* buffer, float* peaks, int bufferSize)
 {
    PROFILER(PeakTracker);
 
+   float scalar = powf( 0.5f, 1.0f/(mDecayTime * gSampleRate));
    for (int j=0; j<bufferSize; ++j)
    {
-      float scalar = powf( 0.5f, 1.0f/(mDecayTime * gSampleRate));
       float input = fabsf(buffer[j]);
       
       if ( input >= mPeak )
@@ -50,5 +55,8 @@ void PeakTracker::Process(float* buffer, int bufferSize)
          if(mPeak < FLT_EPSILON)
             mPeak = 0.0;
       }
+      
+      if (peaks)
+         peaks[j] = mPeak;
    }
 }
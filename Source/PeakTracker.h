@@ -34,6 +34,7 @@ public:
    PeakTracker() : mPeak(0), mDecayTime(.01f), mLimit(-1) {}
    
    void Process(float* buffer, int bufferSize);
+   void Process(const float* buffer, float* peaks, int bufferSize);   //also writes out the peak at each sample
    float GetPeak() const { return mPeak; }
    void SetDecayTime(float time) { mDecayTime = time; }
    void SetLimit(float limit) { mLimit = limit; }
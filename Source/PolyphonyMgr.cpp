@@ -32,7 +32,7 @@
 #include "SynthGlobals.h"
 #include "Profiler.h"
 
-ChannelBuffer gMidiVoiceWorkChannelBuffer(kWorkBufferSize);
+thread_local ChannelBuffer gMidiVoiceWorkChannelBuffer(kWorkBufferSize);
 
 PolyphonyMgr::PolyphonyMgr(IDrawableModule* owner)
    : mAllowStealing(true)
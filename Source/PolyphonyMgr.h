@@ -33,7 +33,7 @@
 
 const int kVoiceFadeSamples = 50;
 
-extern ChannelBuffer gMidiVoiceWorkChannelBuffer;
+extern thread_local ChannelBuffer gMidiVoiceWorkChannelBuffer;
 
 class IMidiVoice;
 class IVoiceParams;
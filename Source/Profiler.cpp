@@ -25,102 +25,211 @@
 
 #include "Profiler.h"
 #include "SynthGlobals.h"
-#include <time.h>
-#if BESPOKE_WINDOWS
-#include <intrin.h>
-#else
+#include "IDrawableModule.h"
+#include "LockFreeQueue.h"
 #include <chrono>
-#endif
+#include <sstream>
 
 Profiler::Cost Profiler::sCosts[];
-bool Profiler::sEnableProfiler = false;
+std::atomic<bool> Profiler::sEnableProfiler(false);
+std::atomic<bool> Profiler::sResetPending(false);
+long long Profiler::sNumFrames = 0;
+std::atomic<long long> Profiler::sNumDroppedScopes(0);
+std::atomic<bool> Profiler::sTracing(false);
 
-namespace {
-   static inline uint64_t rdtscp( uint32_t & aux )
+namespace
+{
+   uint64_t GetTimestampNs()
    {
-#if BESPOKE_WINDOWS
-      unsigned __int64 i;
-      unsigned int ui;
-      i = __rdtscp(&ui);
-      //printf_s("%I64d ticks\n", i);
-      //printf_s("TSC_AUX was %x\n", ui);
-      return i;
-#else
-      std::chrono::high_resolution_clock::time_point time_point = std::chrono::high_resolution_clock::now();
-      return time_point.time_since_epoch().count();
-#endif
+      return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
    }
-}
-
-Profiler::Profiler(const char* name, uint32_t hash)
-: mIndex(-1)
-{
-   if (sEnableProfiler)
+   
+   struct TraceEvent
+   {
+      int mCostIndex;
+      uint64_t mStartNs;
+      uint64_t mEndNs;
+   };
+   
+   //the events recorded on one thread. only that thread produces, and the ui thread drains it.
+   struct ThreadTrace
    {
-      for (int i=0; i<PROFILER_MAX_TRACK; ++i)
+      ThreadTrace() : mEvents(1 << 14), mIndex(-1) { mName[0] = 0; }
+      LockFreeQueue<TraceEvent> mEvents;
+      int mIndex;
+      char mName[64];
+   };
+   
+   struct CollectedTraceEvent
+   {
+      TraceEvent mEvent;
+      int mThreadIndex;
+   };
+   
+   const int kMaxTraceThreads = 64;
+   const size_t kMaxCollectedTraceEvents = 4000000;
+   const int kNumSpareThreadTraces = 4;
+   std::atomic<ThreadTrace*> sThreadTraces[kMaxTraceThreads];   //kept for the life of the program, there are only a handful of threads
+   std::atomic<int> sNumThreadTraces(0);
+   std::atomic<ThreadTrace*> sSpareThreadTraces[kNumSpareThreadTraces];   //allocated on the main thread, claimed by threads as they first trace
+   thread_local ThreadTrace* tThreadTrace = nullptr;
+   thread_local bool tThreadTraceFull = false;
+   thread_local int tCurrentScope = -1;
+   
+   //ui thread only
+   vector<CollectedTraceEvent> sCollectedTrace;
+   uint64_t sTraceStartNs = 0;
+   
+   ThreadTrace* GetThreadTrace(const char* name = nullptr)
+   {
+      if (tThreadTrace == nullptr && !tThreadTraceFull)
       {
-         if (sCosts[i].mHash == hash)
+         int index = sNumThreadTraces.fetch_add(1);
+         if (index < kMaxTraceThreads)
          {
-            mIndex = i;
-            break;
+            ThreadTrace* trace = nullptr;
+            for (int i=0; i<kNumSpareThreadTraces && trace == nullptr; ++i)
+               trace = sSpareThreadTraces[i].exchange(nullptr, std::memory_order_acquire);
+            if (trace == nullptr)
+               trace = new ThreadTrace();   //only when a thread shows up without registering and the spares have run out
+            
+            trace->mIndex = index;
+            juce::Thread* thread = juce::Thread::getCurrentThread();
+            if (name == nullptr && thread != nullptr && thread->getThreadName().isNotEmpty())
+               name = thread->getThreadName().toRawUTF8();
+            if (name != nullptr)
+               snprintf(trace->mName, sizeof(trace->mName), "%s", name);
+            else
+               snprintf(trace->mName, sizeof(trace->mName), "thread %d", index);
+            
+            tThreadTrace = trace;
+            sThreadTraces[index].store(tThreadTrace, std::memory_order_release);
          }
-         if (sCosts[i].mName[0] == 0)
+         else
          {
-            mIndex = i;
-            sCosts[i].mName = name;
-            sCosts[i].mHash = hash;
-            break;
+            tThreadTraceFull = true;
          }
       }
-      
-      uint32_t aux;
-      mTimerStart = rdtscp(aux);
+      return tThreadTrace;
+   }
+   
+   string EscapeJson(const char* str)
+   {
+      string escaped;
+      for (const char* c = str; *c != 0; ++c)
+      {
+         if (*c == '"' || *c == '\\')
+            escaped += '\\';
+         if ((unsigned char)*c >= 0x20)
+            escaped += *c;
+      }
+      return escaped;
+   }
+}
 
-      //struct timespec t;
-      //clock_gettime(CLOCK_MONOTONIC, &t);
-      //mTimerStart = t.tv_sec * 1000000000 + t.tv_nsec;
+Profiler::Profiler(const char* name, uint32_t hash)
+: mIndex(-1)
+, mParent(-1)
+{
+   if (sEnableProfiler.load(std::memory_order_relaxed) && !sResetPending.load(std::memory_order_relaxed))
+      Begin(name, hash);
+}
+
+Profiler::Profiler(IDrawableModule* module)
+: mIndex(-1)
+, mParent(-1)
+{
+   if (sEnableProfiler.load(std::memory_order_relaxed) && module != nullptr && !sResetPending.load(std::memory_order_relaxed))
+   {
+      //key on the instance rather than the name, so two modules never share a line and renaming doesn't need a rehash
+      uint64_t address = (uint64_t)(uintptr_t)module;
+      Begin(module->Name(), uint32_t(address ^ (address >> 32)) * 2654435761u);
    }
 }
 
+void Profiler::Begin(const char* name, uint32_t hash)
+{
+   mIndex = FindOrAddCost(name, hash, tCurrentScope);
+   if (mIndex == -1)
+      return;
+   
+   mParent = tCurrentScope;
+   tCurrentScope = mIndex;
+   mTimerStart = GetTimestampNs();
+}
+
 Profiler::~Profiler()
 {
-   if (sEnableProfiler)
+   if (mIndex != -1)
    {
-      uint32_t aux;
-      sCosts[mIndex].mFrameCost += rdtscp(aux) - mTimerStart;
+      uint64_t timerEnd = GetTimestampNs();
+      sCosts[mIndex].mFrameCost.fetch_add(timerEnd - mTimerStart, std::memory_order_relaxed);
+      tCurrentScope = mParent;
       
-      //struct timespec t;
-      //clock_gettime(CLOCK_MONOTONIC, &t);
-      //unsigned long long timerEnd = t.tv_sec * 1000000000 + t.tv_nsec;
-   
-      //sCosts[mIndex].mFrameCost += timerEnd - mTimerStart;
+      if (sTracing.load(std::memory_order_relaxed))
+      {
+         ThreadTrace* trace = GetThreadTrace();
+         if (trace != nullptr)
+            trace->mEvents.produce(TraceEvent{ mIndex, mTimerStart, timerEnd });
+      }
+   }
+}
+
+//static
+int Profiler::FindOrAddCost(const char* name, uint32_t hash, int parent)
+{
+   //open addressing on the scope's hash and parent, so the same scope under different parents gets its own entry
+   uint64_t key = (1ull << 63) | (uint64_t(parent + 1) << 32) | hash;
+   int slot = (hash ^ (uint32_t(parent + 1) * 0x9E3779B1u)) & (PROFILER_MAX_TRACK - 1);
+   for (int probe = 0; probe < PROFILER_MAX_TRACK; ++probe)
+   {
+      uint64_t existing = sCosts[slot].mKey.load(std::memory_order_acquire);
+      if (existing == 0 && sCosts[slot].mKey.compare_exchange_strong(existing, key, std::memory_order_acq_rel))
+      {
+         strncpy(sCosts[slot].mName, name, sizeof(sCosts[slot].mName) - 1);
+         sCosts[slot].mName[sizeof(sCosts[slot].mName) - 1] = 0;
+         sCosts[slot].mParent = parent;
+         sCosts[slot].mReady.store(true, std::memory_order_release);
+         return slot;
+      }
+      if (existing == key)
+         return slot;
+      slot = (slot + 1) & (PROFILER_MAX_TRACK - 1);
+   }
+   sNumDroppedScopes.fetch_add(1, std::memory_order_relaxed);
+   return -1;
+}
+
+//static
+void Profiler::BeginFrame()
+{
+   //the workers are idle and no scopes are open on this thread, so this is the one place the costs can be cleared without racing the code that fills them
+   if (sResetPending.load(std::memory_order_acquire))
+   {
+      ResetCosts();
+      sResetPending.store(false, std::memory_order_release);
    }
 }
 
 //static
 void Profiler::PrintCounters()
 {
-   //bool printedBreak = false;
+   if (!sEnableProfiler)
+      return;
+   
    for (int i=0; i<PROFILER_MAX_TRACK; ++i)
    {
-      if (sCosts[i].mName[0] == 0)
-         break;
-      /*if (sCosts[i].mFrameCost > 500)
-      {
-         if (!printedBreak)
-         {
-            ofLog() << "******* PrintCounters():";
-            printedBreak = true;
-         }
-         ofLog() << sCosts[i].mName << " " << sCosts[i].mFrameCost << " us";
-      }*/
-      sCosts[i].EndFrame();
+      if (sCosts[i].mReady.load(std::memory_order_acquire))
+         sCosts[i].EndFrame();
    }
+   ++sNumFrames;
 }
 
 //static
 void Profiler::Draw()
 {
+   CollectTraceEvents(sTracing);
+   
    if (!sEnableProfiler)
       return;
    
@@ -128,29 +237,46 @@ void Profiler::Draw()
    ofTranslate(30,70);
    ofPushStyle();
    ofFill();
-   ofSetColor(0,0,0,140);
-   //ofRect(-5,-15,600,sCosts.size()*15+10);
-   long entireFrameUs = GetSafeFrameLengthNanoseconds();
+   long long dropped = sNumDroppedScopes.load(std::memory_order_relaxed);
+   if (dropped > 0)
+   {
+      ofSetColor(255,0,0);
+      gFont.DrawString("profiler is full, "+ofToString(dropped)+" scopes dropped", 15, 0, -15);
+   }
+   DrawCost(-1, 0, GetSafeFrameLengthNanoseconds());
+   ofPopStyle();
+   ofPopMatrix();
+}
+
+//static
+void Profiler::DrawCost(int parent, int depth, long entireFrameNs)
+{
+   if (depth > 16)
+      return;
+   
    for (int i=0; i<PROFILER_MAX_TRACK; ++i)
    {
-      if (sCosts[i].mName[0] == 0)
-         break;
       const Cost& cost = sCosts[i];
+      if (!cost.mReady.load(std::memory_order_acquire) || cost.mParent != parent)
+         continue;
+      
       long maxCost = cost.MaxCost();
+      if (maxCost < entireFrameNs / 200)   //skip the noise, there can be hundreds of modules
+         continue;
       
       ofSetColor(255,255,255);
-      gFont.DrawString(string(sCosts[i].mName)+": "+ofToString(maxCost/1000), 15, 0, 0);
+      gFont.DrawString(string(cost.mName)+": "+ofToString(maxCost/1000), 15, depth * 10, 0);
       
-      if (maxCost > entireFrameUs)
+      if (maxCost > entireFrameNs)
          ofSetColor(255,0,0);
       else
          ofSetColor(0,255,0);
-      ofRect(250, -10,(float)maxCost / entireFrameUs * (ofGetWidth() - 300) * .1f, 10);
+      ofRect(250, -10,(float)maxCost / entireFrameNs * (ofGetWidth() - 300) * .1f, 10);
       
       ofTranslate(0, 15);
+      
+      DrawCost(i, depth + 1, entireFrameNs);
    }
-   ofPopStyle();
-   ofPopMatrix();
 }
 
 //static
@@ -164,16 +290,166 @@ long Profiler::GetSafeFrameLengthNanoseconds()
 //static
 void Profiler::ToggleProfiler()
 {
-   sEnableProfiler = !sEnableProfiler;
-   
+   sEnableProfiler.store(!sEnableProfiler.load(std::memory_order_relaxed), std::memory_order_relaxed);
+   sResetPending.store(true, std::memory_order_release);
+}
+
+//static
+void Profiler::ResetCosts()
+{
    for (int i=0; i<PROFILER_MAX_TRACK; ++i)
+   {
+      sCosts[i].mKey = 0;
+      sCosts[i].mReady = false;
       sCosts[i].mName[0] = 0;
+      sCosts[i].mParent = -1;
+      sCosts[i].mFrameCost = 0;
+      bzero(sCosts[i].mHistory, sizeof(sCosts[i].mHistory));
+      sCosts[i].mTotalCost = 0;
+      sCosts[i].mPeakCost = 0;
+   }
+   sNumFrames = 0;
+   sNumDroppedScopes = 0;
+}
+
+//static
+void Profiler::RegisterThread(const char* name)
+{
+   GetThreadTrace(name);
+}
+
+//static
+void Profiler::StockThreadTraces()
+{
+   for (int i=0; i<kNumSpareThreadTraces; ++i)
+   {
+      if (sSpareThreadTraces[i].load(std::memory_order_relaxed) != nullptr)
+         continue;
+      ThreadTrace* trace = new ThreadTrace();
+      ThreadTrace* expected = nullptr;
+      if (!sSpareThreadTraces[i].compare_exchange_strong(expected, trace, std::memory_order_release))
+         delete trace;
+   }
+}
+
+//static
+void Profiler::ToggleTrace()
+{
+   if (!sTracing)
+   {
+      if (!sEnableProfiler)
+         ToggleProfiler();
+      CollectTraceEvents(false);   //throw out anything left over from the last capture
+      sCollectedTrace.clear();
+      sTraceStartNs = GetTimestampNs();
+      sTracing = true;
+      ofLog() << "capturing profiler trace, run \"trace\" again to save it";
+   }
+   else
+   {
+      sTracing = false;
+      CollectTraceEvents(true);
+      WriteTrace();
+      sCollectedTrace.clear();
+      sCollectedTrace.shrink_to_fit();
+   }
+}
+
+//static
+void Profiler::CollectTraceEvents(bool keep)
+{
+   StockThreadTraces();
+   
+   int numThreads = MIN(sNumThreadTraces.load(), kMaxTraceThreads);
+   for (int i=0; i<numThreads; ++i)
+   {
+      ThreadTrace* trace = sThreadTraces[i].load(std::memory_order_acquire);
+      if (trace == nullptr)
+         continue;
+      
+      TraceEvent event;
+      while (trace->mEvents.consume(event))
+      {
+         if (keep && sCollectedTrace.size() < kMaxCollectedTraceEvents)
+            sCollectedTrace.push_back(CollectedTraceEvent{ event, trace->mIndex });
+      }
+      
+      int dropped = trace->mEvents.getAndResetNumOverflows();
+      if (keep && dropped > 0)
+         ofLog() << "profiler trace dropped " << dropped << " events on " << trace->mName;
+   }
+}
+
+//static
+void Profiler::WriteTrace()
+{
+   //chrome trace event format, which chrome://tracing and ui.perfetto.dev can both open
+   std::ostringstream json;
+   json << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[";
+   
+   bool first = true;
+   int numThreads = MIN(sNumThreadTraces.load(), kMaxTraceThreads);
+   for (int i=0; i<numThreads; ++i)
+   {
+      ThreadTrace* trace = sThreadTraces[i].load(std::memory_order_acquire);
+      if (trace == nullptr)
+         continue;
+      json << (first ? "" : ",") << "\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << trace->mIndex << ",\"args\":{\"name\":\"" << EscapeJson(trace->mName) << "\"}}";
+      first = false;
+   }
+   
+   json.setf(std::ios::fixed);
+   json.precision(3);
+   for (const auto& collected : sCollectedTrace)
+   {
+      const TraceEvent& event = collected.mEvent;
+      if (event.mStartNs < sTraceStartNs)
+         continue;
+      json << (first ? "" : ",") << "\n{\"name\":\"" << EscapeJson(sCosts[event.mCostIndex].mName) << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << collected.mThreadIndex
+           << ",\"ts\":" << (event.mStartNs - sTraceStartNs) / 1000.0 << ",\"dur\":" << (event.mEndNs - event.mStartNs) / 1000.0 << "}";
+      first = false;
+   }
+   json << "\n]}\n";
+   
+   juce::File(ofToDataPath("recordings")).createDirectory();
+   string filename = ofGetTimestampString(ofToDataPath("recordings/trace_%Y-%m-%d_%H-%M-%S.json"));
+   juce::File(filename).replaceWithText(json.str());
+   ofLog() << "wrote profiler trace of " << sCollectedTrace.size() << " events to " << filename;
+}
+
+//static
+void Profiler::WriteSummary(string path)
+{
+   std::ostringstream json;
+   json << "{\"buffer_size\":" << gBufferSize << ",\"sample_rate\":" << gSampleRate << ",\"buffers\":" << sNumFrames << ",\"dropped_scopes\":" << sNumDroppedScopes.load() << ",\"scopes\":[";
+   
+   bool first = true;
+   for (int i=0; i<PROFILER_MAX_TRACK; ++i)
+   {
+      const Cost& cost = sCosts[i];
+      if (!cost.mReady.load(std::memory_order_acquire))
+         continue;
+      
+      //name each scope by its whole call path, since the same module can show up under different parents
+      string scopePath = cost.mName;
+      for (int parent = cost.mParent; parent != -1; parent = sCosts[parent].mParent)
+         scopePath = string(sCosts[parent].mName) + "/" + scopePath;
+      
+      json << (first ? "" : ",") << "\n{\"scope\":\"" << EscapeJson(scopePath.c_str()) << "\",\"total_ns\":" << cost.mTotalCost
+           << ",\"mean_ns\":" << (sNumFrames > 0 ? cost.mTotalCost / sNumFrames : 0) << ",\"peak_ns\":" << cost.mPeakCost << "}";
+      first = false;
+   }
+   json << "\n]}\n";
+   
+   juce::File(path).replaceWithText(json.str());
 }
 
 void Profiler::Cost::EndFrame()
 {
-   mHistory[mHistoryIdx] = mFrameCost;
-   mFrameCost = 0;
+   unsigned long long frameCost = mFrameCost.exchange(0, std::memory_order_relaxed);
+   mTotalCost += frameCost;
+   mPeakCost = MAX(mPeakCost, frameCost);
+   mHistory[mHistoryIdx] = frameCost;
    ++mHistoryIdx;
    if (mHistoryIdx >= PROFILER_HISTORY_LENGTH)
       mHistoryIdx = 0;
@@ -28,44 +28,76 @@
 
 #include "OpenFrameworksPort.h"
 #include "SynthGlobals.h"
+#include <atomic>
 
 #define PROFILER_HISTORY_LENGTH 500
-#define PROFILER_MAX_TRACK 100
+#define PROFILER_MAX_TRACK 512   //power of two
 
 #define PROFILER(profile_id) static uint32_t profile_id ## _hash = JenkinsHash(#profile_id); Profiler profilerScopeHolder(#profile_id, profile_id ## _hash)
+#define PROFILER_MODULE(module) Profiler profilerModuleScopeHolder(module)
 
+class IDrawableModule;
+
+//scoped timer. scopes nest per thread, so costs are tracked per call path (a module inside an effectchain gets its own line under it).
+//while a trace is being captured, every scope is also recorded as an event on its thread, for viewing in chrome://tracing or perfetto.
 class Profiler
 {
 public:
    Profiler(const char* name, uint32_t hash);
+   Profiler(IDrawableModule* module);   //attributes the scope to a module instance, by name
    ~Profiler();
    
+   static void BeginFrame();   //audio thread, before any scopes open
    static void PrintCounters();
    static void Draw();
    
    static void ToggleProfiler();
+   static bool IsEnabled() { return sEnableProfiler.load(std::memory_order_relaxed); }
+   
+   static void ToggleTrace();
+   static bool IsTracing() { return sTracing; }
+   
+   static void WriteSummary(string path);   //total, mean and peak cost of every scope since the profiler was enabled, as json
+   
+   static void RegisterThread(const char* name);   //call when a realtime thread starts, so tracing never allocates on it
+   static void StockThreadTraces();   //main thread, keeps buffers ready for threads that register
    
 private:
+   void Begin(const char* name, uint32_t hash);
+   static int FindOrAddCost(const char* name, uint32_t hash, int parent);
    static long GetSafeFrameLengthNanoseconds();
+   static void DrawCost(int parent, int depth, long entireFrameNs);
+   static void ResetCosts();
+   static void CollectTraceEvents(bool keep);
+   static void WriteTrace();
    
    struct Cost
    {
-      Cost() : mFrameCost(0), mHistoryIdx(0) { bzero(mHistory, sizeof(long)); }
+      Cost() : mKey(0), mReady(false), mParent(-1), mFrameCost(0), mHistoryIdx(0), mTotalCost(0), mPeakCost(0) { mName[0] = 0; bzero(mHistory, sizeof(mHistory)); }
       void EndFrame();
       unsigned long long MaxCost() const;
       
-      string mName;
-      uint32_t mHash;
-      unsigned long long mFrameCost;
+      std::atomic<uint64_t> mKey;   //the scope's hash and its parent's index, 0 if this slot is free
+      std::atomic<bool> mReady;   //set once mName and mParent are written, the ui thread only reads slots that are ready
+      char mName[64];
+      int mParent;
+      std::atomic<unsigned long long> mFrameCost;
       unsigned long long mHistory[PROFILER_HISTORY_LENGTH];
       int mHistoryIdx;
+      unsigned long long mTotalCost;
+      unsigned long long mPeakCost;
    };
    
    unsigned long long mTimerStart;
    int mIndex;
+   int mParent;
    
    static Cost sCosts[PROFILER_MAX_TRACK];
-   static bool sEnableProfiler;
+   static std::atomic<bool> sEnableProfiler;
+   static std::atomic<bool> sResetPending;   //set by ToggleProfiler(), the audio thread clears the costs between buffers
+   static long long sNumFrames;
+   static std::atomic<long long> sNumDroppedScopes;   //scopes that found every slot taken
+   static std::atomic<bool> sTracing;
 };
 
 #endif /* defined(__modularSynth__Profiler__) */
@@ -26,6 +26,7 @@
 #include "Pumper.h"
 #include "Profiler.h"
 #include "UIControlMacros.h"
+#include "Dynamics.h"
 
 namespace
 {
@@ -47,6 +48,8 @@ Pumper::Pumper()
    mAdsr.GetStageData(1).curve = -0.5f;
    
    SyncToAdsr();
+   
+   mGainBuffer = new float[gBufferSize];
 }
 
 void Pumper::CreateUIControls()
@@ -71,6 +74,7 @@ void Pumper::CreateUIControls()
 
 Pumper::~Pumper()
 {
+   delete[] mGainBuffer;
 }
 
 void Pumper::ProcessAudio(double time, ChannelBuffer* buffer)
@@ -80,7 +84,7 @@ void Pumper::ProcessAudio(double time, ChannelBuffer* buffer)
    if (!mEnabled)
       return;
 
-   float bufferSize = buffer->BufferSize();
+   int bufferSize = buffer->BufferSize();
    
    ComputeSliders(0);
    
@@ -94,14 +98,16 @@ void Pumper::ProcessAudio(double time, ChannelBuffer* buffer)
    float smoothingOffset = smoothingTimeMs / TheTransport->GetDuration(mInterval);
    mLFO.SetOffset(mOffset + smoothingOffset);*/
 
+   double intervalPerSample = gInvSampleRateMs / TheTransport->GetDuration(mInterval);
    for (int i=0; i<bufferSize; ++i)
    {
-      float adsrValue = mAdsr.Value((intervalPos + i * gInvSampleRateMs / TheTransport->GetDuration(mInterval)) * kAdsrTime);
+      float adsrValue = mAdsr.Value((intervalPos + i * intervalPerSample) * kAdsrTime);
       float value = mLastValue * .99f + adsrValue * .01f;
-      for (int ch=0; ch<buffer->NumActiveChannels(); ++ch)
-         buffer->GetChannel(ch)[i] *= value;
+      mGainBuffer[i] = value;
       mLastValue = value;
    }
+   
+   Dynamics::ApplyGain(buffer, mGainBuffer, bufferSize);
 }
 
 double Pumper::GetIntervalPos(double time)
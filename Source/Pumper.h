@@ -74,6 +74,7 @@ private:
    NoteInterval mInterval;
    DropdownList* mIntervalSelector;
    float mLastValue;
+   float* mGainBuffer;
    float mAmount;
    float mLength;
    float mAttack;
@@ -61,7 +61,38 @@ bool Ramp::HasValue(double time) const
 
 float Ramp::Value(double time) const
 {
-   const RampData* rampData = GetCurrentRampData(time);
+   return Evaluate(GetCurrentRampData(time), time);
+}
+
+void Ramp::FillBuffer(float* buffer, int length, double startTime, double timeStep) const
+{
+   int i = 0;
+   while (i < length)
+   {
+      double time = startTime + i * timeStep;
+      const RampData* rampData = GetCurrentRampData(time);
+      
+      //the current ramp only changes once we're past the start of a newer one, so there's no need to look it up again until then
+      double nextStartTime = DBL_MAX;
+      for (const auto& data : mRampDatas)
+      {
+         if (data.mStartTime >= time && data.mStartTime < nextStartTime)
+            nextStartTime = data.mStartTime;
+      }
+      
+      do
+      {
+         buffer[i] = Evaluate(rampData, time);
+         ++i;
+         time = startTime + i * timeStep;
+      }
+      while (i < length && time <= nextStartTime);
+   }
+}
+
+//static
+float Ramp::Evaluate(const RampData* rampData, double time)
+{
    if (rampData->mStartTime == -1 || time <= rampData->mStartTime)
       return rampData->mStartValue;
    if (time >= rampData->mEndTime)
@@ -38,6 +38,7 @@ public:
    void SetValue(float val);
    bool HasValue(double time) const;
    float Value(double time) const;
+   void FillBuffer(float* buffer, int length, double startTime, double timeStep) const;   //Value() at startTime + i*timeStep for each sample
    float Target(double time) const { return GetCurrentRampData(time)->mEndValue; }
 private:
    struct RampData
@@ -50,6 +51,7 @@ private:
    };
 
    const RampData* GetCurrentRampData(double time) const;
+   static float Evaluate(const RampData* rampData, double time);
 
    std::array<RampData, 10> mRampDatas;
    int mRampDataPointer;
@@ -28,6 +28,7 @@
 
 RollingBuffer::RollingBuffer(int sizeInSamples)
 : mBuffer(sizeInSamples)
+, mHasStash(false)
 {
    for (int i=0; i<ChannelBuffer::kMaxNumChannels; ++i)
       mOffsetToNow[i] = 0;
@@ -148,6 +149,16 @@ namespace
    const int kSaveStateRev = 3;
 }
 
+void RollingBuffer::StashSaveData(FileStreamOut& out)
+{
+   //the audio thread keeps writing while this copies, so take where "now" is first. only the oldest samples get overwritten after that.
+   for (int i=0; i<mBuffer.NumActiveChannels(); ++i)
+      mStashedOffsetToNow[i] = mOffsetToNow[i];
+   for (int i=0; i<mBuffer.NumActiveChannels(); ++i)
+      out.Stash(mBuffer.GetChannel(i), Size());
+   mHasStash = true;
+}
+
 void RollingBuffer::SaveState(FileStreamOut& out)
 {
    out << kSaveStateRev;
@@ -156,9 +167,10 @@ void RollingBuffer::SaveState(FileStreamOut& out)
    out << Size();
    for (int i=0; i<mBuffer.NumActiveChannels(); ++i)
    {
-      out << mOffsetToNow[i];
+      out << (mHasStash ? mStashedOffsetToNow[i] : mOffsetToNow[i]);
       out.Write(mBuffer.GetChannel(i), Size());
    }
+   mHasStash = false;
 }
 
 void RollingBuffer::LoadState(FileStreamIn& in)
@@ -183,12 +195,11 @@ void RollingBuffer::LoadState(FileStreamIn& in)
       else
       {
          //saved with a longer buffer than we have... not sure what the right solution here is, but lets just fill the buffer over and over again until we consume all of the samples
-         int sizeLeft = savedSize;
-         while (sizeLeft > 0)
-         {
-            in.Read(mBuffer.GetChannel(i), MIN(sizeLeft, Size()));
-            sizeLeft -= Size();
-         }
+         //(read it in one go, since the saved audio is split into chunks that have to be read whole)
+         vector<float> saved(savedSize);
+         in.Read(saved.data(), savedSize);
+         for (int pos=0; pos<savedSize; pos += Size())
+            BufferCopy(mBuffer.GetChannel(i), saved.data() + pos, MIN(savedSize - pos, Size()));
       }
    }
 }
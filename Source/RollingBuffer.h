@@ -48,10 +48,13 @@ public:
    void SetNumChannels(int channels) { mBuffer.SetNumActiveChannels(channels); }
    int NumChannels() const { return mBuffer.NumActiveChannels(); }
    
+   void StashSaveData(FileStreamOut& out);
    void SaveState(FileStreamOut& out);
    void LoadState(FileStreamIn& in);
 private:
    int mOffsetToNow[ChannelBuffer::kMaxNumChannels];
+   int mStashedOffsetToNow[ChannelBuffer::kMaxNumChannels];
+   bool mHasStash;
    ChannelBuffer mBuffer;
 };
 
@@ -28,6 +28,12 @@
 #include "FileStream.h"
 #include "ModularSynth.h"
 #include "ChannelBuffer.h"
+#include "SampleStream.h"
+
+namespace
+{
+   const double kStreamThresholdSeconds = 5 * 60;
+}
 
 Sample::Sample()
 : mData(0)
@@ -59,9 +65,17 @@ bool Sample::Read(const char* path, bool mono, ReadType readType)
    File file(ofToDataPath(mReadPath));
    delete mReader;
    mReader = TheSynth->GetGlobalManagers()->mAudioFormatManager.createReaderFor(file);
+   mStream.reset();
    
    if (mReader != nullptr)
    {
+      if (readType == ReadType::Stream && mReader->lengthInSamples > kStreamThresholdSeconds * mReader->sampleRate)
+      {
+         delete mReader;
+         mReader = nullptr;
+         return OpenStream(mono);
+      }
+
       mData.Resize((int)mReader->lengthInSamples);
       if (mono)
          mData.SetNumActiveChannels(1);
@@ -81,7 +95,7 @@ bool Sample::Read(const char* path, bool mono, ReadType readType)
          mReader->read(mReadBuffer.get(), 0, mNumSamples, 0, true, true);
          FinishRead();
       }
-      else if (readType == ReadType::Async)
+      else
       {
          mSamplesLeftToRead = mNumSamples;
          startTimer(100);
@@ -97,6 +111,33 @@ bool Sample::Read(const char* path, bool mono, ReadType readType)
    return false;
 }
 
+bool Sample::OpenStream(bool mono)
+{
+   auto stream = make_unique<SampleStream>();
+   if (!stream->Open(mReadPath, mono))
+   {
+      TheSynth->LogEvent("failed to stream sample " + mReadPath, kLogEventType_Error);
+      return false;
+   }
+
+   mData.Resize(1);
+   mData.SetNumActiveChannels(stream->GetNumChannels());
+   mData.Clear();
+   mNumSamples = stream->GetLength();
+   mOffset = mNumSamples;
+   mSampleRateRatio = float(stream->GetSampleRate()) / gSampleRate;
+   mSamplesLeftToRead = 0;
+   mStream = std::move(stream);
+   return true;
+}
+
+int Sample::NumChannels() const
+{
+   if (mStream != nullptr)
+      return mStream->GetNumChannels();
+   return mData.NumActiveChannels();
+}
+
 void Sample::FinishRead()
 {
    if (mData.NumActiveChannels() == 1 && mReadBuffer->getNumChannels() > 1)
@@ -132,6 +173,7 @@ void Sample::timerCallback()
 
 void Sample::Create(int length)
 {
+   mStream.reset();
    mData.Resize(length);
    mData.SetNumActiveChannels(1);
    Setup(length);
@@ -139,6 +181,7 @@ void Sample::Create(int length)
 
 void Sample::Create(ChannelBuffer* data)
 {
+   mStream.reset();
    int channels = data->NumActiveChannels();
    int length = data->BufferSize();
    mData.Resize(length);
@@ -161,6 +204,9 @@ void Sample::Setup(int length)
 
 bool Sample::Write(const char* path /*=nullptr*/)
 {
+   if (mStream != nullptr)
+      return false;   //nothing in memory to write
+
    const char* writeTo = path ? path : mReadPath.c_str();
    WriteDataToFile(writeTo, &mData, mNumSamples);
    return true;
@@ -225,6 +271,31 @@ bool Sample::ConsumeData(double time, ChannelBuffer* out, int size, bool replace
    }
    
    LockDataMutex(true);
+
+   //a stream can't be read one sample at a time, so pull this buffer's worth out of it up front
+   int streamStart = size;
+   float* streamed[ChannelBuffer::kMaxNumChannels];
+   if (mStream != nullptr)
+   {
+      assert(size * mStream->GetNumChannels() <= kWorkBufferSize);
+      double streamTime = time;
+      streamStart = 0;
+      while (streamStart < size && streamTime < mStartTime)
+      {
+         streamTime += gInvSampleRateMs;
+         ++streamStart;
+      }
+      for (int ch=0; ch<mStream->GetNumChannels(); ++ch)
+         streamed[ch] = gWorkBuffer + ch * size;
+      if (streamStart < size)
+      {
+         float* streamOutput[ChannelBuffer::kMaxNumChannels];
+         for (int ch=0; ch<mStream->GetNumChannels(); ++ch)
+            streamOutput[ch] = streamed[ch] + streamStart;
+         mStream->Read(mOffset, mRate * mSampleRateRatio, streamOutput, size - streamStart);
+      }
+   }
+
    for (int i=0; i<size; ++i)
    {
       if (time < mStartTime)
@@ -243,7 +314,12 @@ bool Sample::ConsumeData(double time, ChannelBuffer* out, int size, bool replace
             
             float sample = 0;
             if (mOffset < end || mLooping)
-               sample = GetInterpolatedSample(mOffset, mData.GetChannel(dataChannel), mNumSamples) * mVolume;
+            {
+               if (mStream != nullptr)
+                  sample = streamed[MIN(ch, mStream->GetNumChannels()-1)][i] * mVolume;
+               else
+                  sample = GetInterpolatedSample(mOffset, mData.GetChannel(dataChannel), mNumSamples) * mVolume;
+            }
             
             if (replace)
                out->GetChannel(ch)[i] = sample;
@@ -306,10 +382,15 @@ void Sample::ShiftWrap(int numSamplesToShift)
 
 void Sample::CopyFrom(Sample* sample)
 {
-   mNumSamples = sample->mNumSamples;
-   if (mData.BufferSize() != sample->mData.BufferSize())
-      mData.Resize(sample->mNumSamples);
-   mData.CopyFrom(&sample->mData);
+   mStream.reset();
+   mReadPath = sample->mReadPath;
+   if (sample->mStream == nullptr || !OpenStream(sample->mStream->GetNumChannels() == 1))
+   {
+      mNumSamples = sample->mNumSamples;
+      if (mData.BufferSize() != sample->mData.BufferSize())
+         mData.Resize(sample->mNumSamples);
+      mData.CopyFrom(&sample->mData);
+   }
    mNumBars = sample->mNumBars;
    mLooping = sample->mLooping;
    mRate = sample->mRate;
@@ -321,7 +402,13 @@ void Sample::CopyFrom(Sample* sample)
 
 namespace
 {
-   const int kSaveStateRev = 0;
+   const int kSaveStateRev = 1;
+}
+
+void Sample::StashSaveData(FileStreamOut& out)
+{
+   if (!IsStreaming() && mNumSamples > 0)
+      mData.Stash(out, mNumSamples);
 }
 
 void Sample::SaveState(FileStreamOut& out)
@@ -329,7 +416,10 @@ void Sample::SaveState(FileStreamOut& out)
    out << kSaveStateRev;
    
    out << mNumSamples;
-   if (mNumSamples > 0)
+   out << IsStreaming();
+   if (IsStreaming())
+      out << mStream->GetNumChannels();
+   else if (mNumSamples > 0)
       mData.Save(out, mNumSamples);
    out << mNumBars;
    out << mLooping;
@@ -346,7 +436,15 @@ void Sample::LoadState(FileStreamIn& in)
    in >> rev;
    
    in >> mNumSamples;
-   if (mNumSamples > 0)
+   bool streaming = false;
+   int streamChannels = 0;
+   if (rev >= 1)
+      in >> streaming;
+   if (streaming)
+   {
+      in >> streamChannels;
+   }
+   else if (mNumSamples > 0)
    {
       int readLength;
       mData.Load(in, readLength, ChannelBuffer::LoadMode::kSetBufferSize);
@@ -367,4 +465,13 @@ void Sample::LoadState(FileStreamIn& in)
    in >> mStopPoint;
    in >> mName;
    in >> mReadPath;
+
+   mStream.reset();
+   if (streaming && !OpenStream(streamChannels == 1))
+   {
+      //the file is gone, so keep the length and play silence
+      mData.Resize(MAX(mNumSamples, 1));
+      mData.SetNumActiveChannels(streamChannels);
+      mData.Clear();
+   }
 }
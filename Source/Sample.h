@@ -31,6 +31,7 @@
 
 class FileStreamOut;
 class FileStreamIn;
+class SampleStream;
 
 class Sample : public juce::Timer
 {
@@ -38,7 +39,8 @@ public:
    enum class ReadType
    {
       Sync,
-      Async
+      Async,
+      Stream   //long files play straight from disk, shorter ones load like Async
    };
 
    Sample();
@@ -51,7 +53,7 @@ public:
    string Name() const { return mName; }
    void SetName(string name) { mName = name; }
    int LengthInSamples() const { return mNumSamples; }
-   int NumChannels() const { return mData.NumActiveChannels(); }
+   int NumChannels() const;
    ChannelBuffer* Data() { return &mData; }
    int GetPlayPosition() const { return mOffset; }
    void SetPlayPosition(double sample) { mOffset = sample; }
@@ -76,11 +78,15 @@ public:
    void CopyFrom(Sample* sample);
    bool IsSampleLoading() { return mSamplesLeftToRead > 0; }
    float GetSampleLoadProgress() { return (mNumSamples > 0) ? (1 - (float(mSamplesLeftToRead) / mNumSamples)) : 1; }
+   bool IsStreaming() const { return mStream != nullptr; }
+   SampleStream* GetStream() { return mStream.get(); }   //when streaming, Data() is empty
    
+   void StashSaveData(FileStreamOut& out);
    void SaveState(FileStreamOut& out);
    void LoadState(FileStreamIn& in);
 private:
    void Setup(int length);
+   bool OpenStream(bool mono);
    void FinishRead();
    //juce::Timer
    void timerCallback();
@@ -103,6 +109,7 @@ private:
    AudioFormatReader* mReader;
    unique_ptr<AudioSampleBuffer> mReadBuffer;
    int mSamplesLeftToRead;
+   unique_ptr<SampleStream> mStream;
 };
 
 #endif /* defined(__modularSynth__Sample__) */
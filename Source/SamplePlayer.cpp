@@ -28,6 +28,7 @@
 #include "SamplePlayer.h"
 #include "IAudioReceiver.h"
 #include "Sample.h"
+#include "SampleStream.h"
 #include "SynthGlobals.h"
 #include "ModularSynth.h"
 #include "Profiler.h"
@@ -54,6 +55,7 @@ SamplePlayer::SamplePlayer()
 , mRecord(false)
 , mLoopCheckbox(nullptr)
 , mDrawBuffer(0)
+, mDrawBufferScale(1)
 , mPlayButton(nullptr)
 , mPauseButton(nullptr)
 , mStopButton(nullptr)
@@ -174,6 +176,18 @@ void SamplePlayer::Init()
 void SamplePlayer::Poll()
 {
    IDrawableModule::Poll();
+
+   if (mSample != nullptr && mSample->IsStreaming())
+   {
+      //let the stream keep the cue points in memory, so jumping to one doesn't have to wait on the disk
+      vector<int> cueFrames;
+      for (auto& cue : mSampleCuePoints)
+      {
+         if (cue.startSeconds > 0 || cue.lengthSeconds > 0)
+            cueFrames.push_back(int(cue.startSeconds * gSampleRate * mSample->GetSampleRateRatio()));
+      }
+      mSample->GetStream()->SetCuePositions(cueFrames);
+   }
    
    const juce::String& clipboard = TheSynth->GetTextFromClipboard();
    if (clipboard.contains("youtube"))
@@ -501,7 +515,7 @@ void SamplePlayer::AutoSlice(int slices)
 void SamplePlayer::FilesDropped(vector<string> files, int x, int y)
 {
    Sample* sample = new Sample();
-   sample->Read(files[0].c_str());
+   sample->Read(files[0].c_str(), false, Sample::ReadType::Stream);
    UpdateSample(sample, true);
 }
 
@@ -578,7 +592,7 @@ void SamplePlayer::ButtonClicked(ClickButton *button)
       LoadFile();
    if (button == mSaveFileButton)
       SaveFile();
-   if (button == mTrimToZoomButton && mSample != nullptr)
+   if (button == mTrimToZoomButton && mSample != nullptr && !mSample->IsStreaming())
    {
       for (auto& cuePoint : mSampleCuePoints)
          cuePoint.startSeconds = MAX(0, cuePoint.startSeconds - GetZoomStartSeconds());
@@ -732,7 +746,7 @@ void SamplePlayer::OnYoutubeDownloadComplete(string filename, string title)
    if (juce::File(ofToDataPath(filename)).existsAsFile())
    {
       Sample* sample = new Sample();
-      sample->Read(ofToDataPath(filename).c_str(), false, Sample::ReadType::Async);
+      sample->Read(ofToDataPath(filename).c_str(), false, Sample::ReadType::Stream);
       sample->SetName(title);
       UpdateSample(sample, true);
    }
@@ -809,7 +823,7 @@ void SamplePlayer::LoadFile()
 
       Sample* sample = new Sample();
       if (file.existsAsFile())
-         sample->Read(file.getFullPathName().toStdString().c_str());
+         sample->Read(file.getFullPathName().toStdString().c_str(), false, Sample::ReadType::Stream);
       UpdateSample(sample, true);
    }
 }
@@ -818,6 +832,12 @@ void SamplePlayer::SaveFile()
 {
    FileChooser chooser("Save sample", File(ofToDataPath("samples")),
                        "*.wav", true, false, TheSynth->GetMainComponent()->getTopLevelComponent());
+   if (mSample != nullptr && mSample->IsStreaming())
+   {
+      mErrorString = "this sample is streamed from disk, it's already saved as " + mSample->GetReadPath();
+      return;
+   }
+
    if (chooser.browseForFileToSave(true))
    {
       auto file = chooser.getResult();
@@ -868,13 +888,23 @@ ChannelBuffer* SamplePlayer::GetCueSampleData(int cueIndex)
       lengthSeconds = 1;
    int startSamples = startSeconds * gSampleRate * mSample->GetSampleRateRatio();
    int lengthSamplesSrc = lengthSeconds * gSampleRate * mSample->GetSampleRateRatio();
-   if (startSamples >= mSample->Data()->BufferSize())
-      startSamples = mSample->Data()->BufferSize() - 1;
-   if (startSamples + lengthSamplesSrc >= mSample->Data()->BufferSize())
-      lengthSamplesSrc = mSample->Data()->BufferSize() - 1 - startSamples;
+   if (startSamples >= mSample->LengthInSamples())
+      startSamples = mSample->LengthInSamples() - 1;
+   if (startSamples + lengthSamplesSrc >= mSample->LengthInSamples())
+      lengthSamplesSrc = mSample->LengthInSamples() - 1 - startSamples;
    int lengthSamplesDest = lengthSamplesSrc / speed / mSample->GetSampleRateRatio();
    ChannelBuffer* data = new ChannelBuffer(lengthSamplesDest);
-   data->SetNumActiveChannels(mSample->Data()->NumActiveChannels());
+   data->SetNumActiveChannels(mSample->NumChannels());
+
+   ChannelBuffer* source = mSample->Data();
+   ChannelBuffer streamed(MAX(lengthSamplesSrc, 1));
+   if (mSample->IsStreaming())
+   {
+      //only this slice is needed, so read it from the file instead of the stream
+      mSample->GetStream()->ReadDirect(startSamples, &streamed);
+      source = &streamed;
+      startSamples = 0;
+   }
    /*for (int ch = 0; ch < data->NumActiveChannels(); ++ch)
    {
       BufferCopy(data->GetChannel(ch), mSample->Data()->GetChannel(ch) + startSamples, lengthSamplesSrc);
@@ -885,7 +915,7 @@ ChannelBuffer* SamplePlayer::GetCueSampleData(int cueIndex)
       for (int i = 0; i < lengthSamplesDest; ++i)
       {
          float offset = i * speed * mSample->GetSampleRateRatio();
-         data->GetChannel(ch)[i] = GetInterpolatedSample(offset, mSample->Data()->GetChannel(ch) + startSamples, lengthSamplesSrc);
+         data->GetChannel(ch)[i] = GetInterpolatedSample(offset, source->GetChannel(ch) + startSamples, lengthSamplesSrc);
       }
    }
    
@@ -1066,7 +1096,7 @@ void SamplePlayer::DrawModule()
       }
       ofPopMatrix();
    }
-   else if (mRunningProcess != nullptr || (mSample && mSample->IsSampleLoading()))
+   else if (mRunningProcess != nullptr || (mSample && mSample->IsSampleLoading()) || IsWaitingForOverview())
    {
       const int kNumDots = 8;
       const float kCircleRadius = 20;
@@ -1111,14 +1141,16 @@ void SamplePlayer::DrawModule()
       if (mIsLoadingSample && !mSample->IsSampleLoading())
       {
          mIsLoadingSample = false;
-         mDrawBuffer.Resize(mSample->LengthInSamples());
-         mDrawBuffer.CopyFrom(mSample->Data());
+         ChannelBuffer* drawSource = mSample->IsStreaming() ? mSample->GetStream()->GetOverview() : mSample->Data();
+         mDrawBuffer.Resize(drawSource->BufferSize());
+         mDrawBuffer.CopyFrom(drawSource);
+         mDrawBufferScale = mSample->IsStreaming() ? 2.0f / mSample->GetStream()->GetOverviewStride() : 1;
       }
 
       int playPosition = mSample->GetPlayPosition();
       if (mAdsr.Value(gTime) == 0)
          playPosition = -1;
-      DrawAudioBuffer(sampleWidth, mHeight - 65, &mDrawBuffer, GetZoomStartSample(), GetZoomEndSample(), playPosition);
+      DrawAudioBuffer(sampleWidth, mHeight - 65, &mDrawBuffer, GetZoomStartSample() * mDrawBufferScale, GetZoomEndSample() * mDrawBufferScale, playPosition >= 0 ? playPosition * mDrawBufferScale : -1);
       
       ofPushStyle();
       ofFill();
@@ -1389,6 +1421,11 @@ void SamplePlayer::CheckboxUpdated(Checkbox* checkbox)
       mRecordGate.SetEnabled(mRecordAsClips);
 }
 
+bool SamplePlayer::IsWaitingForOverview() const
+{
+   return mSample != nullptr && mSample->IsStreaming() && !mSample->GetStream()->IsOverviewReady();
+}
+
 void SamplePlayer::StopRecording()
 {
    if (mDoRecording)
@@ -1462,6 +1499,13 @@ namespace
    const int kSaveStateRev = 1;
 }
 
+void SamplePlayer::StashSaveData(FileStreamOut& out)
+{
+   IDrawableModule::StashSaveData(out);
+   if (mSample != nullptr)
+      mSample->StashSaveData(out);
+}
+
 void SamplePlayer::SaveState(FileStreamOut& out)
 {
    IDrawableModule::SaveState(out);
@@ -87,6 +87,7 @@ public:
    void LoadLayout(const ofxJSONElement& moduleInfo) override;
    void SaveLayout(ofxJSONElement& moduleInfo) override;
    void SetUpFromSaveData() override;
+   void StashSaveData(FileStreamOut& out) override;
    void SaveState(FileStreamOut& out) override;
    void LoadState(FileStreamIn& in) override;
    vector<IUIControl*> ControlsToIgnoreInSaveState() const override;
@@ -113,6 +114,7 @@ private:
    void RunProcess(const StringArray& args);
    void AutoSlice(int slices);
    void StopRecording();
+   bool IsWaitingForOverview() const;
    
    //IDrawableModule
    void DrawModule() override;
@@ -160,6 +162,7 @@ private:
    float mOscWheelSpeed;
    
    ChannelBuffer mDrawBuffer;
+   float mDrawBufferScale;   //draw buffer entries per sample. streamed samples draw from an overview instead of the full data.
    
    NoteInputBuffer mNoteInputBuffer;
    ::ADSR mAdsr;
@@ -0,0 +1,447 @@
+/**
+    bespoke synth, a software modular synthesizer
+    Copyright (C) 2021 Ryan Challinor (contact: awwbees@gmail.com)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**/
+/*
+  ==============================================================================
+
+    SampleStream.cpp
+    Created: 19 Jul 2021 4:26:10pm
+    Author:  Ryan Challinor
+
+  ==============================================================================
+*/
+
+#include "SampleStream.h"
+#include "SynthGlobals.h"
+#include "ModularSynth.h"
+
+bool SampleStream::sSynchronous = false;
+
+//one thread reads ahead for every open stream
+class SampleStreamThread : public juce::Thread
+{
+public:
+   static SampleStreamThread& Get()
+   {
+      static SampleStreamThread sInstance;
+      return sInstance;
+   }
+
+   void Add(SampleStream* stream)
+   {
+      const ScopedLock lock(mStreamsLock);
+      mStreams.push_back(stream);
+      if (!isThreadRunning())
+         startThread(6);
+      notify();
+   }
+
+   void Remove(SampleStream* stream)
+   {
+      bool stop = false;
+      {
+         const ScopedLock lock(mStreamsLock);
+         RemoveFromVector(stream, mStreams);
+         stop = mStreams.empty();
+         if (stop)
+            signalThreadShouldExit();
+      }
+      if (stop)
+      {
+         notify();
+         stopThread(1000);
+      }
+   }
+
+private:
+   SampleStreamThread() : juce::Thread("sample streaming") {}
+   ~SampleStreamThread() { stopThread(1000); }
+
+   void run() override
+   {
+      while (!threadShouldExit())
+      {
+         bool moreToDo = false;
+         {
+            const ScopedLock lock(mStreamsLock);
+            for (auto* stream : mStreams)
+               moreToDo |= stream->Fill();
+         }
+         if (!moreToDo)
+            wait(10);
+      }
+   }
+
+   vector<SampleStream*> mStreams;
+   CriticalSection mStreamsLock;
+};
+
+SampleStream::SampleStream()
+: mLength(0)
+, mNumChannels(0)
+, mSampleRate(0)
+, mMono(false)
+, mIsMemoryMapped(false)
+, mHeadLength(0)
+, mBufferStart(0)
+, mBufferEnd(0)
+, mGeneration(0)
+, mReadPosition(0)
+, mOverview(0)
+, mOverviewStride(1)
+, mOverviewProgress(0)
+{
+}
+
+SampleStream::~SampleStream()
+{
+   if (mReader != nullptr && !sSynchronous)
+      SampleStreamThread::Get().Remove(this);
+}
+
+bool SampleStream::Open(string path, bool mono)
+{
+   assert(mReader == nullptr);
+
+   mPath = path;
+   File file(ofToDataPath(path));
+
+   //uncompressed wavs get mapped into memory, so reading ahead is just a copy
+   WavAudioFormat wavFormat;
+   std::unique_ptr<MemoryMappedAudioFormatReader> mappedReader(wavFormat.createMemoryMappedReader(file));
+   if (mappedReader != nullptr && mappedReader->mapEntireFile())
+   {
+      mReader = std::move(mappedReader);
+      mIsMemoryMapped = true;
+   }
+   else
+   {
+      mReader.reset(TheSynth->GetGlobalManagers()->mAudioFormatManager.createReaderFor(file));
+   }
+
+   if (mReader == nullptr || mReader->lengthInSamples <= 0)
+   {
+      mReader.reset();
+      return false;
+   }
+
+   mLength = (int)mReader->lengthInSamples;
+   mMono = mono;
+   mNumChannels = mono ? 1 : MIN((int)mReader->numChannels, ChannelBuffer::kMaxNumChannels);
+   mSampleRate = mReader->sampleRate;
+   mReadBuffer.setSize(mReader->numChannels, kReadChunkSize);
+
+   mHeadLength = MIN(mLength, kHeadSize);
+   float* head[ChannelBuffer::kMaxNumChannels];
+   for (int ch = 0; ch < mNumChannels; ++ch)
+   {
+      mHead[ch].resize(mHeadLength);
+      mRing[ch].resize(kRingSize);
+      for (auto& cue : mCues)
+         cue.mData[ch].resize(kCueSize);
+      head[ch] = mHead[ch].data();
+   }
+   for (int pos = 0; pos < mHeadLength; pos += kReadChunkSize)
+   {
+      float* chunk[ChannelBuffer::kMaxNumChannels];
+      for (int ch = 0; ch < mNumChannels; ++ch)
+         chunk[ch] = head[ch] + pos;
+      ReadFromFile(mReader.get(), pos, MIN(kReadChunkSize, mHeadLength - pos), chunk);
+   }
+
+   //the ring starts out holding what comes right after the head
+   mBufferStart = mHeadLength;
+   mBufferEnd = mHeadLength;
+   mReadPosition = 0;
+
+   mOverviewStride = MAX(1, (mLength + kOverviewPoints - 1) / kOverviewPoints);
+   mOverview.Resize(2 * ((mLength + mOverviewStride - 1) / mOverviewStride));
+   mOverview.SetNumActiveChannels(mNumChannels);
+   mOverview.Clear();
+   mOverviewProgress = 0;
+
+   if (!sSynchronous)
+      SampleStreamThread::Get().Add(this);
+
+   return true;
+}
+
+void SampleStream::ReadFromFile(AudioFormatReader* reader, juce::int64 start, int numSamples, float* const* output)
+{
+   assert(numSamples <= mReadBuffer.getNumSamples());
+   reader->read(&mReadBuffer, 0, numSamples, start, true, true);
+   if (mMono && mReadBuffer.getNumChannels() > 1)
+   {
+      BufferCopy(output[0], mReadBuffer.getReadPointer(0), numSamples);
+      for (int ch = 1; ch < mReadBuffer.getNumChannels(); ++ch)
+         Add(output[0], mReadBuffer.getReadPointer(ch), numSamples);
+      Mult(output[0], 1.0f / mReadBuffer.getNumChannels(), numSamples);
+   }
+   else
+   {
+      for (int ch = 0; ch < mNumChannels; ++ch)
+         BufferCopy(output[ch], mReadBuffer.getReadPointer(ch), numSamples);
+   }
+}
+
+bool SampleStream::Fill()
+{
+   const ScopedLock lock(mFillLock);
+
+   juce::int64 readPosition = std::min<juce::int64>(std::max<juce::int64>(mReadPosition.load(std::memory_order_relaxed), 0), mLength - 1);
+   juce::int64 start = mBufferStart.load(std::memory_order_relaxed);
+   juce::int64 end = mBufferEnd.load(std::memory_order_relaxed);
+   const juce::int64 kKeepBehind = kRingSize / 8;
+
+   //while playing out of the head or a cue, the ring needs to be ready for where that runs out
+   juce::int64 target = readPosition;
+   bool inMemory = false;
+   if (readPosition < mHeadLength)
+   {
+      target = mHeadLength;
+      inMemory = true;
+   }
+   else
+   {
+      for (auto& cue : mCues)
+      {
+         juce::int64 cueStart = cue.mStart.load(std::memory_order_relaxed);
+         juce::int64 cueEnd = cue.mEnd.load(std::memory_order_relaxed);
+         if (readPosition >= cueStart && readPosition < cueEnd && cueEnd > mHeadLength)
+         {
+            target = cueEnd;
+            inMemory = true;
+            break;
+         }
+      }
+   }
+   target = std::min<juce::int64>(target, mLength - 1);
+
+   if (mHeadLength == mLength)
+   {
+      //the whole file fits in the head, the ring is never needed
+   }
+   else if (target < start || target > end)
+   {
+      //jumped somewhere we don't have. if it went backwards, leave some room to keep going backwards.
+      if (inMemory)
+         start = target;
+      else
+         start = target < start ? target - kRingSize / 2 : target - kKeepBehind;
+      start = std::max<juce::int64>(start, mHeadLength);
+      end = start;
+      mGeneration.fetch_add(1, std::memory_order_relaxed);
+      std::atomic_thread_fence(std::memory_order_release);
+      mBufferEnd.store(end, std::memory_order_relaxed);
+      mBufferStart.store(start, std::memory_order_relaxed);
+      std::atomic_thread_fence(std::memory_order_release);
+   }
+   else if (target - kKeepBehind > start)
+   {
+      start = target - kKeepBehind;
+      mBufferStart.store(start, std::memory_order_relaxed);
+      std::atomic_thread_fence(std::memory_order_release);
+   }
+
+   juce::int64 fillTo = std::min<juce::int64>(mLength, start + kRingSize);
+   if (end < fillTo)
+   {
+      int numSamples = (int)std::min<juce::int64>(kReadChunkSize, fillTo - end);
+      numSamples = MIN(numSamples, kRingSize - int(end & (kRingSize - 1)));   //don't run off the end of the ring
+      float* chunk[ChannelBuffer::kMaxNumChannels];
+      for (int ch = 0; ch < mNumChannels; ++ch)
+         chunk[ch] = mRing[ch].data() + (end & (kRingSize - 1));
+      ReadFromFile(mReader.get(), end, numSamples, chunk);
+      mBufferEnd.store(end + numSamples, std::memory_order_release);
+      return true;
+   }
+
+   if (!sSynchronous && FillCues())
+      return true;
+
+   //nothing urgent, so work on the overview
+   juce::int64 overviewProgress = mOverviewProgress.load(std::memory_order_relaxed);
+   if (overviewProgress < mLength && !sSynchronous)
+   {
+      const int kPointsPerFill = 64;
+      for (int i = 0; i < kPointsPerFill && overviewProgress < mLength; ++i)
+      {
+         int point = int(overviewProgress / mOverviewStride);
+         int numSamples = (int)std::min<juce::int64>(mOverviewStride, mLength - overviewProgress);
+         Range<float> levels[ChannelBuffer::kMaxNumChannels];
+         mReader->readMaxLevels(overviewProgress, numSamples, levels, MIN((int)mReader->numChannels, ChannelBuffer::kMaxNumChannels));
+         for (int ch = 0; ch < mNumChannels; ++ch)
+         {
+            Range<float> range = mMono ? levels[0].getUnionWith(levels[MIN(1, (int)mReader->numChannels - 1)]) : levels[ch];
+            mOverview.GetChannel(ch)[point * 2] = range.getEnd();
+            mOverview.GetChannel(ch)[point * 2 + 1] = range.getStart();
+         }
+         overviewProgress += numSamples;
+      }
+      mOverviewProgress.store(overviewProgress, std::memory_order_release);
+      return true;
+   }
+
+   return false;
+}
+
+bool SampleStream::FillCues()
+{
+   vector<int> requested;
+   {
+      const ScopedLock lock(mCueRequestLock);
+      requested = mRequestedCues;
+   }
+
+   for (int i = 0; i < kMaxCues; ++i)
+   {
+      Cue& cue = mCues[i];
+      juce::int64 wanted = i < (int)requested.size() ? MAX(0, requested[i] - kCuePreRoll) : -1;
+      if (wanted >= 0 && (wanted + kCueSize <= mHeadLength || wanted >= mLength))
+         wanted = -1;   //already in the head, or not in the file
+
+      if (cue.mLoading != wanted)
+      {
+         if (cue.mStart.load(std::memory_order_relaxed) != -1)
+         {
+            cue.mStart.store(-1, std::memory_order_relaxed);
+            cue.mEnd.store(-1, std::memory_order_relaxed);
+            mGeneration.fetch_add(1, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_release);
+         }
+         cue.mLoading = wanted;
+         cue.mLoaded = 0;
+      }
+
+      juce::int64 length = std::min<juce::int64>(kCueSize, mLength - cue.mLoading);
+      if (cue.mLoading >= 0 && cue.mLoaded < length)
+      {
+         int numSamples = (int)std::min<juce::int64>(kReadChunkSize, length - cue.mLoaded);
+         float* chunk[ChannelBuffer::kMaxNumChannels];
+         for (int ch = 0; ch < mNumChannels; ++ch)
+            chunk[ch] = cue.mData[ch].data() + cue.mLoaded;
+         ReadFromFile(mReader.get(), cue.mLoading + cue.mLoaded, numSamples, chunk);
+         cue.mLoaded += numSamples;
+         if (cue.mLoaded == length)
+         {
+            cue.mEnd.store(cue.mLoading + length, std::memory_order_relaxed);
+            cue.mStart.store(cue.mLoading, std::memory_order_release);
+         }
+         return true;
+      }
+   }
+
+   return false;
+}
+
+void SampleStream::SetCuePositions(const vector<int>& positions)
+{
+   const ScopedLock lock(mCueRequestLock);
+   if (positions != mRequestedCues)
+      mRequestedCues = positions;
+}
+
+bool SampleStream::Read(double position, double increment, float* const* output, int numSamples)
+{
+   position = fmod(position, mLength);
+   if (position < 0)
+      position += mLength;
+
+   if (sSynchronous)
+   {
+      mReadPosition.store((juce::int64)position, std::memory_order_relaxed);
+      while (Fill())
+      {
+      }
+   }
+
+   uint32_t generation = mGeneration.load(std::memory_order_acquire);
+   juce::int64 bufferStart = mBufferStart.load(std::memory_order_acquire);
+   juce::int64 bufferEnd = mBufferEnd.load(std::memory_order_acquire);
+   juce::int64 cueStarts[kMaxCues];
+   juce::int64 cueEnds[kMaxCues];
+   for (int i = 0; i < kMaxCues; ++i)
+   {
+      cueStarts[i] = mCues[i].mStart.load(std::memory_order_acquire);
+      cueEnds[i] = cueStarts[i] == -1 ? -1 : mCues[i].mEnd.load(std::memory_order_relaxed);
+   }
+   juce::int64 lowestBufferedFrame = mLength;
+   bool usedCue = false;
+   bool missing = false;
+   juce::int64 missingFrame = 0;
+
+   for (int i = 0; i < numSamples; ++i)
+   {
+      juce::int64 frame = (juce::int64)position;
+      juce::int64 next = frame + 1 == mLength ? 0 : frame + 1;
+      float a = float(position - frame);
+      bool wasMissing = missing;
+      for (int ch = 0; ch < mNumChannels; ++ch)
+      {
+         float sample = GetFrame(ch, frame, bufferStart, bufferEnd, cueStarts, cueEnds, lowestBufferedFrame, usedCue, missing);
+         float nextSample = GetFrame(ch, next, bufferStart, bufferEnd, cueStarts, cueEnds, lowestBufferedFrame, usedCue, missing);
+         output[ch][i] = (1 - a) * sample + a * nextSample;
+      }
+      if (missing && !wasMissing)
+         missingFrame = frame;
+
+      position += increment;
+      if (position >= mLength)
+         position -= mLength;
+      else if (position < 0)
+         position += mLength;
+   }
+
+   //make sure the streaming thread didn't replace anything we just read. the head never changes, so playing from it doesn't care.
+   std::atomic_thread_fence(std::memory_order_acquire);
+   bool usedRing = lowestBufferedFrame < mLength;
+   if ((mGeneration.load(std::memory_order_relaxed) != generation && (usedRing || usedCue)) || mBufferStart.load(std::memory_order_relaxed) > lowestBufferedFrame)
+   {
+      for (int ch = 0; ch < mNumChannels; ++ch)
+         ::Clear(output[ch], numSamples);
+      missing = true;
+      missingFrame = (juce::int64)position;
+   }
+
+   mReadPosition.store(missing ? missingFrame : (juce::int64)position, std::memory_order_relaxed);
+   return !missing;
+}
+
+void SampleStream::ReadDirect(int start, ChannelBuffer* output)
+{
+   //use a reader of our own, the streaming thread owns mReader
+   File file(ofToDataPath(mPath));
+   std::unique_ptr<AudioFormatReader> reader(TheSynth->GetGlobalManagers()->mAudioFormatManager.createReaderFor(file));
+   output->SetNumActiveChannels(mNumChannels);
+   output->Clear();
+   if (reader == nullptr)
+      return;
+
+   AudioSampleBuffer readBuffer(reader->numChannels, output->BufferSize());
+   reader->read(&readBuffer, 0, output->BufferSize(), start, true, true);
+   if (mMono && readBuffer.getNumChannels() > 1)
+   {
+      for (int ch = 0; ch < readBuffer.getNumChannels(); ++ch)
+         Add(output->GetChannel(0), readBuffer.getReadPointer(ch), output->BufferSize());
+      Mult(output->GetChannel(0), 1.0f / readBuffer.getNumChannels(), output->BufferSize());
+   }
+   else
+   {
+      for (int ch = 0; ch < mNumChannels; ++ch)
+         BufferCopy(output->GetChannel(ch), readBuffer.getReadPointer(ch), output->BufferSize());
+   }
+}
@@ -0,0 +1,141 @@
+/**
+    bespoke synth, a software modular synthesizer
+    Copyright (C) 2021 Ryan Challinor (contact: awwbees@gmail.com)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**/
+/*
+  ==============================================================================
+
+    SampleStream.h
+    Created: 19 Jul 2021 4:26:10pm
+    Author:  Ryan Challinor
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include "OpenFrameworksPort.h"
+#include "ChannelBuffer.h"
+#include <atomic>
+
+//plays a file straight from disk instead of loading it into memory.
+//a shared streaming thread reads ahead of the play position into a ring buffer, and the audio thread reads out of that.
+class SampleStream
+{
+public:
+   SampleStream();
+   ~SampleStream();
+
+   bool Open(string path, bool mono);
+   int GetLength() const { return mLength; }
+   int GetNumChannels() const { return mNumChannels; }
+   double GetSampleRate() const { return mSampleRate; }
+   bool IsMemoryMapped() const { return mIsMemoryMapped; }
+
+   //audio thread. writes numSamples interpolated frames, starting at position and moving by increment each frame, wrapping around at the end of the file.
+   //frames that haven't come off the disk yet are silent, and the stream starts reading from there. returns false if that happened.
+   bool Read(double position, double increment, float* const* output, int numSamples);
+
+   //reads straight from the file on the calling thread, for when part of the sample is needed right away
+   void ReadDirect(int start, ChannelBuffer* output);
+
+   //UI thread. keeps a little of the file in memory from each of these frames too, so jumping to a cue point doesn't wait on the disk.
+   void SetCuePositions(const vector<int>& positions);
+
+   //min/max pairs covering the whole file, filled in by the streaming thread. one pair for every GetOverviewStride() frames.
+   bool IsOverviewReady() const { return mOverviewProgress.load(std::memory_order_acquire) >= mLength; }
+   ChannelBuffer* GetOverview() { return &mOverview; }
+   int GetOverviewStride() const { return mOverviewStride; }
+
+   //for offline rendering, where the audio thread runs faster than realtime and would outrun the streaming thread
+   static void SetSynchronous(bool synchronous) { sSynchronous = synchronous; }
+
+private:
+   friend class SampleStreamThread;
+
+   static const int kRingSize = 1 << 18;   //about five seconds
+   static const int kHeadSize = 1 << 15;   //the start of the file always stays in memory, so playing from the top and wrapping a loop don't wait on the disk
+   static const int kReadChunkSize = 1 << 14;
+   static const int kOverviewPoints = 1 << 15;
+   static const int kMaxCues = 16;
+   static const int kCueSize = 1 << 15;
+   static const int kCuePreRoll = 1 << 12;   //cues get triggered a little early to line up with the lookahead
+
+   bool Fill();   //streaming thread. returns true if there's more to do.
+   bool FillCues();
+   void ReadFromFile(AudioFormatReader* reader, juce::int64 start, int numSamples, float* const* output);
+
+   float GetFrame(int ch, juce::int64 frame, juce::int64 bufferStart, juce::int64 bufferEnd, const juce::int64* cueStarts, const juce::int64* cueEnds, juce::int64& lowestBufferedFrame, bool& usedCue, bool& missing) const
+   {
+      if (frame < mHeadLength)
+         return mHead[ch][frame];
+      if (frame >= bufferStart && frame < bufferEnd)
+      {
+         lowestBufferedFrame = MIN(lowestBufferedFrame, frame);
+         return mRing[ch][frame & (kRingSize - 1)];
+      }
+      for (int i = 0; i < kMaxCues; ++i)
+      {
+         if (frame >= cueStarts[i] && frame < cueEnds[i])
+         {
+            usedCue = true;
+            return mCues[i].mData[ch][frame - cueStarts[i]];
+         }
+      }
+      missing = true;
+      return 0;
+   }
+
+   string mPath;
+   int mLength;
+   int mNumChannels;
+   double mSampleRate;
+   bool mMono;
+   bool mIsMemoryMapped;
+   std::unique_ptr<AudioFormatReader> mReader;
+   AudioSampleBuffer mReadBuffer;
+   CriticalSection mFillLock;
+
+   vector<float> mHead[ChannelBuffer::kMaxNumChannels];
+   int mHeadLength;
+
+   //the ring holds frames [mBufferStart, mBufferEnd), each at index (frame & (kRingSize-1)). like a seqlock, a frame only gets
+   //overwritten after mBufferStart has moved past it or mGeneration has changed, so the audio thread can tell afterwards if it read something stale.
+   vector<float> mRing[ChannelBuffer::kMaxNumChannels];
+   std::atomic<juce::int64> mBufferStart;
+   std::atomic<juce::int64> mBufferEnd;
+   std::atomic<uint32_t> mGeneration;
+   std::atomic<juce::int64> mReadPosition;   //where the audio thread wants to read next
+
+   //frames [mStart, mEnd) from around a cue point. mStart is -1 while the streaming thread refills it, and mGeneration changes before that starts.
+   struct Cue
+   {
+      vector<float> mData[ChannelBuffer::kMaxNumChannels];
+      std::atomic<juce::int64> mStart{ -1 };
+      std::atomic<juce::int64> mEnd{ -1 };
+      juce::int64 mLoading{ -1 };   //streaming thread only
+      juce::int64 mLoaded{ 0 };
+   };
+   Cue mCues[kMaxCues];
+   vector<int> mRequestedCues;
+   CriticalSection mCueRequestLock;
+
+   ChannelBuffer mOverview;
+   int mOverviewStride;
+   std::atomic<juce::int64> mOverviewProgress;
+
+   static bool sSynchronous;
+};
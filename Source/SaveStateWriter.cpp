@@ -0,0 +1,157 @@
+/**
+    bespoke synth, a software modular synthesizer
+    Copyright (C) 2021 Ryan Challinor (contact: awwbees@gmail.com)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**/
+/*
+  ==============================================================================
+
+    SaveStateWriter.cpp
+    Created: 14 Jul 2021 9:05:12pm
+    Author:  Ryan Challinor
+
+  ==============================================================================
+*/
+
+#include "SaveStateWriter.h"
+#include "ModularSynth.h"
+
+SaveStateWriter::SaveStateWriter()
+: juce::Thread("save state writer")
+, mWriting(false)
+, mIdleEvent(true)
+{
+   mIdleEvent.signal();
+}
+
+SaveStateWriter::~SaveStateWriter()
+{
+   Stop();
+}
+
+void SaveStateWriter::Write(string path, std::unique_ptr<MemoryBlock> data, juce::int64 appendAt /*= -1*/, juce::int64 tableOffset /*= 0*/, string copyTo /*= ""*/)
+{
+   {
+      const ScopedLock lock(mJobsLock);
+      Job job;
+      job.mPath = path;
+      job.mData = std::move(data);
+      job.mAppendAt = appendAt;
+      job.mTableOffset = tableOffset;
+      job.mCopyTo = copyTo;
+      mJobs.push_back(std::move(job));
+      mIdleEvent.reset();
+   }
+   
+   if (!isThreadRunning())
+      startThread(3);
+   notify();
+}
+
+void SaveStateWriter::WaitUntilIdle()
+{
+   mIdleEvent.wait(-1);
+}
+
+void SaveStateWriter::Stop()
+{
+   //finish what's queued first, a half-written save is worse than a slow exit
+   WaitUntilIdle();
+   signalThreadShouldExit();
+   notify();
+   stopThread(1000);
+}
+
+void SaveStateWriter::run()
+{
+   while (!threadShouldExit())
+   {
+      Job job;
+      {
+         const ScopedLock lock(mJobsLock);
+         if (mJobs.empty())
+         {
+            mWriting = false;
+            mIdleEvent.signal();
+         }
+         else
+         {
+            job = std::move(mJobs.front());
+            mJobs.pop_front();
+            mWriting = true;
+         }
+      }
+      
+      if (mWriting)
+      {
+         if (!WriteToDisk(job))
+         {
+            const ScopedLock lock(mJobsLock);
+            mFailedPaths.push_back(job.mPath);
+         }
+         else if (!job.mCopyTo.empty() && !File(job.mPath).copyFileTo(File(job.mCopyTo)))
+         {
+            const ScopedLock lock(mJobsLock);
+            mFailedPaths.push_back(job.mCopyTo);
+         }
+      }
+      else
+         wait(-1);
+   }
+}
+
+bool SaveStateWriter::Poll()
+{
+   vector<string> failedPaths;
+   {
+      const ScopedLock lock(mJobsLock);
+      failedPaths.swap(mFailedPaths);
+   }
+   for (const auto& path : failedPaths)
+      TheSynth->LogEvent("couldn't write " + path, kLogEventType_Error);
+   return !failedPaths.empty();
+}
+
+//static
+bool SaveStateWriter::WriteToDisk(const Job& job)
+{
+   File destination(job.mPath);
+   
+   if (job.mAppendAt >= 0)
+   {
+      //add onto the end, and only point the header at the new chunk table once that's all on disk. until then the file still holds the previous save.
+      FileOutputStream stream(destination);
+      if (stream.failedToOpen() || stream.getPosition() != job.mAppendAt)
+         return false;
+      bool written = stream.write(job.mData->getData(), job.mData->getSize());
+      stream.flush();
+      if (written && stream.getStatus().wasOk())
+      {
+         written = stream.setPosition(sizeof(int)) && stream.write(&job.mTableOffset, sizeof(juce::int64));
+         stream.flush();
+         return written && stream.getStatus().wasOk();
+      }
+      stream.setPosition(job.mAppendAt);
+      stream.truncate();
+      return false;
+   }
+   
+   //write next to the destination and swap it in at the end, so a crash mid-write doesn't cost the previous save
+   File temp(job.mPath + ".tmp");
+   bool written = temp.replaceWithData(job.mData->getData(), job.mData->getSize());
+   if (written)
+      written = temp.moveFileTo(destination);
+   return written;
+}
@@ -0,0 +1,65 @@
+/**
+    bespoke synth, a software modular synthesizer
+    Copyright (C) 2021 Ryan Challinor (contact: awwbees@gmail.com)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**/
+/*
+  ==============================================================================
+
+    SaveStateWriter.h
+    Created: 14 Jul 2021 9:05:12pm
+    Author:  Ryan Challinor
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include "OpenFrameworksPort.h"
+#include <deque>
+#include <memory>
+
+//writes already-serialized save states to disk on a background thread, so the slow part of saving doesn't hold anything up
+class SaveStateWriter : private juce::Thread
+{
+public:
+   SaveStateWriter();
+   ~SaveStateWriter();
+   
+   void Write(string path, std::unique_ptr<MemoryBlock> data, juce::int64 appendAt = -1, juce::int64 tableOffset = 0, string copyTo = "");   //see SaveChunkIndex for appending. copyTo gets a copy of the file once it's written.
+   void WaitUntilIdle();   //block until everything queued so far is on disk
+   bool IsIdle() { return mIdleEvent.wait(0); }
+   void Stop();
+   bool Poll();   //main thread. logs any writes that failed, and returns true if there were some.
+   
+private:
+   struct Job
+   {
+      string mPath;
+      std::unique_ptr<MemoryBlock> mData;
+      juce::int64 mAppendAt{ -1 };
+      juce::int64 mTableOffset{ 0 };
+      string mCopyTo;
+   };
+   
+   void run() override;
+   static bool WriteToDisk(const Job& job);
+   
+   std::deque<Job> mJobs;
+   vector<string> mFailedPaths;
+   bool mWriting;
+   CriticalSection mJobsLock;
+   WaitableEvent mIdleEvent;
+};
@@ -50,6 +50,82 @@
 
 namespace py = pybind11;
 
+namespace
+{
+   CriticalSection sPythonMutex;
+   PyThreadState* sMainThreadState = nullptr;
+   CriticalSection sScriptModulesMutex;
+}
+
+//the script's entry points, looked up once each time the script runs instead of being parsed out of a string for every event
+struct ScriptModule::PythonCallbacks
+{
+   py::object mOnPulse;
+   py::object mOnNote;
+   py::object mOnMidi;
+   py::object mOnOsc;
+   py::object mOnGridButton;
+   std::unordered_map<string, py::object> mCompiledMethods;   //schedule_call() code, compiled the first time it runs
+};
+
+//runs every script's events and scheduled calls, so they don't wait on the UI frame rate
+class ScriptThread : public juce::Thread
+{
+public:
+   static ScriptThread& Get()
+   {
+      static ScriptThread sInstance;
+      return sInstance;
+   }
+
+private:
+   ScriptThread() : juce::Thread("script") {}
+   ~ScriptThread() { stopThread(1000); }
+
+   void run() override
+   {
+      vector<ScriptModule*> modules;
+      while (!threadShouldExit())
+      {
+         {
+            ScriptModule::ScopedPythonLock pythonLock;
+            if (ScriptModule::sPythonInitialized)
+            {
+               {
+                  const ScopedLock lock(sScriptModulesMutex);
+                  modules = ScriptModule::sScriptModules;
+               }
+               for (auto* module : modules)
+               {
+                  if (module != nullptr && !module->IsDeleted())
+                     module->ProcessScriptEvents();
+               }
+            }
+         }
+         wait(1);
+      }
+   }
+};
+
+ScriptModule::ScopedPythonLock::ScopedPythonLock()
+: mHoldsGIL(false)
+, mGILState(0)
+{
+   sPythonMutex.enter();
+   if (ScriptModule::sPythonInitialized)
+   {
+      mGILState = (int)PyGILState_Ensure();
+      mHoldsGIL = true;
+   }
+}
+
+ScriptModule::ScopedPythonLock::~ScopedPythonLock()
+{
+   if (mHoldsGIL)
+      PyGILState_Release((PyGILState_STATE)mGILState);
+   sPythonMutex.exit();
+}
+
 //static
 std::vector<ScriptModule*> ScriptModule::sScriptModules;
 //static
@@ -85,16 +161,24 @@ ScriptModule::ScriptModule()
 , mNextLineToExecute(-1)
 , mInitExecutePriority(0)
 , mOscInputPort(-1)
+, mScriptEventQueue(256)
+, mScriptOutputQueue(1024)
+, mNumDroppedNoteOutputs(0)
+, mCallbacks(new PythonCallbacks())
 , mShowJediWarning(false)
 {
+   mScriptEventQueueProducerLock.clear();
    CheckIfPythonEverSuccessfullyInitialized();
    if ((TheSynth->IsLoadingState() || Prefab::sLoadingPrefab) && sHasPythonEverSuccessfullyInitialized)
       InitializePythonIfNecessary();
 
    Reset();
    
-   mScriptModuleIndex = sScriptModules.size();
-   sScriptModules.push_back(this);
+   {
+      const ScopedLock lock(sScriptModulesMutex);
+      mScriptModuleIndex = sScriptModules.size();
+      sScriptModules.push_back(this);
+   }
 
    OSCReceiver::addListener(this);
    
@@ -103,6 +187,21 @@ ScriptModule::ScriptModule()
 
 ScriptModule::~ScriptModule()
 {
+   TheTransport->RemoveAudioPoller(this);
+
+   ScopedPythonLock pythonLock;
+   {
+      const ScopedLock lock(sScriptModulesMutex);
+      sScriptModules[mScriptModuleIndex] = nullptr;
+   }
+   mCallbacks.reset();
+}
+
+void ScriptModule::Init()
+{
+   IDrawableModule::Init();
+
+   TheTransport->AddAudioPoller(this);
 }
 
 void ScriptModule::CreateUIControls()
@@ -126,8 +225,19 @@ void ScriptModule::CreateUIControls()
 
 void ScriptModule::UninitializePython()
 {
+   ScriptThread::Get().stopThread(1000);
+
+   const ScopedLock lock(sPythonMutex);
    if (sPythonInitialized)
+   {
+      PyEval_RestoreThread(sMainThreadState);
+      for (auto* module : sScriptModules)
+      {
+         if (module != nullptr)
+            *module->mCallbacks = PythonCallbacks();
+      }
       py::finalize_interpreter();
+   }
    sPythonInitialized = false;
 }
 
@@ -145,8 +255,15 @@ void ScriptModule::InitializePythonIfNecessary()
       py::exec(GetBootstrapImportString(), py::globals());
       
       CodeEntry::OnPythonInit();
+
+      //let go of the GIL, ScopedPythonLock picks it back up on whichever thread needs it
+      sMainThreadState = PyEval_SaveThread();
+      {
+         const ScopedLock lock(sPythonMutex);
+         sPythonInitialized = true;
+      }
+      ScriptThread::Get().startThread();
    }
-   sPythonInitialized = true;
 
    if (!sHasPythonEverSuccessfullyInitialized)
    {
@@ -200,13 +317,18 @@ void ScriptModule::DrawModule()
    mCSlider->Draw();
    mDSlider->Draw();
    
-   if (mLastError != "")
+   string lastError;
+   {
+      const ScopedLock lock(mDisplayMutex);
+      lastError = mLastError;
+   }
+   if (lastError != "")
    {
       ofSetColor(255, 0, 0, gModuleDrawAlpha);
       ofVec2f errorPos = mStopButton->GetPosition(true);
       errorPos.x += 60;
       errorPos.y += 12;
-      DrawTextNormal(mLastError, errorPos.x, errorPos.y);
+      DrawTextNormal(lastError, errorPos.x, errorPos.y);
    }
    
    mLineExecuteTracker.Draw(mCodeEntry, 0, ofColor::green);
@@ -214,44 +336,47 @@ void ScriptModule::DrawModule()
    mMethodCallTracker.Draw(mCodeEntry, 1, IDrawableModule::GetColor(kModuleType_Other));
    mUIControlTracker.Draw(mCodeEntry, 1, IDrawableModule::GetColor(kModuleType_Modulator));
    
-   for (size_t i=0; i<mScheduledNoteOutput.size(); ++i)
    {
-      if (mScheduledNoteOutput[i].time != -1 &&
-          //mScheduledNoteOutput[i].velocity > 0 &&
-          gTime + 50 < mScheduledNoteOutput[i].time)
-         DrawTimer(mScheduledNoteOutput[i].lineNum, mScheduledNoteOutput[i].startTime, mScheduledNoteOutput[i].time, IDrawableModule::GetColor(kModuleType_Note), mScheduledNoteOutput[i].velocity > 0);
-   }
-   
-   for (size_t i=0; i<mScheduledMethodCall.size(); ++i)
-   {
-      if (mScheduledMethodCall[i].time != -1 &&
-          gTime + 50 < mScheduledMethodCall[i].time)
-         DrawTimer(mScheduledMethodCall[i].lineNum, mScheduledMethodCall[i].startTime, mScheduledMethodCall[i].time, IDrawableModule::GetColor(kModuleType_Other), true);
-   }
-   
-   for (size_t i=0; i<mScheduledUIControlValue.size(); ++i)
-   {
-      if (mScheduledUIControlValue[i].time != -1 &&
-          gTime + 50 < mScheduledUIControlValue[i].time)
-         DrawTimer(mScheduledUIControlValue[i].lineNum, mScheduledUIControlValue[i].startTime, mScheduledUIControlValue[i].time, IDrawableModule::GetColor(kModuleType_Modulator), true);
+      const ScopedLock lock(mScheduleMutex);
+
+      mScheduledNoteOutput.ForEach([this](const ScheduledNoteOutput& note)
+      {
+         if (gTime + 50 < note.time)
+            DrawTimer(note.lineNum, note.startTime, note.time, IDrawableModule::GetColor(kModuleType_Note), note.velocity > 0);
+      });
+      
+      mScheduledMethodCall.ForEach([this](const ScheduledMethodCall& call)
+      {
+         if (gTime + 50 < call.time)
+            DrawTimer(call.lineNum, call.startTime, call.time, IDrawableModule::GetColor(kModuleType_Other), true);
+      });
+      
+      mScheduledUIControlValue.ForEach([this](const ScheduledUIControlValue& controlValue)
+      {
+         if (gTime + 50 < controlValue.time)
+            DrawTimer(controlValue.lineNum, controlValue.startTime, controlValue.time, IDrawableModule::GetColor(kModuleType_Modulator), true);
+      });
    }
    
    ofPushStyle();
-   for (size_t i=0; i<mPrintDisplay.size(); ++i)
    {
-      if (mPrintDisplay[i].time == -1)
-         continue;
-
-      float fadeMs = 500;
-      if (gTime - mPrintDisplay[i].time >= 0 && gTime - mPrintDisplay[i].time < fadeMs)
+      const ScopedLock lock(mDisplayMutex);
+      for (size_t i=0; i<mPrintDisplay.size(); ++i)
       {
-         ofSetColor(ofColor::white, 255*(1-(gTime - mPrintDisplay[i].time)/fadeMs));
-         ofVec2f linePos = mCodeEntry->GetLinePos(mPrintDisplay[i].lineNum, K(end));
-         DrawTextNormal(mPrintDisplay[i].text, linePos.x + 10, linePos.y + 15);
-      }
-      else
-      {
-         mPrintDisplay[i].time = -1;
+         if (mPrintDisplay[i].time == -1)
+            continue;
+
+         float fadeMs = 500;
+         if (gTime - mPrintDisplay[i].time >= 0 && gTime - mPrintDisplay[i].time < fadeMs)
+         {
+            ofSetColor(ofColor::white, 255*(1-(gTime - mPrintDisplay[i].time)/fadeMs));
+            ofVec2f linePos = mCodeEntry->GetLinePos(mPrintDisplay[i].lineNum, K(end));
+            DrawTextNormal(mPrintDisplay[i].text, linePos.x + 10, linePos.y + 15);
+         }
+         else
+         {
+            mPrintDisplay[i].time = -1;
+         }
       }
    }
    
@@ -304,26 +429,25 @@ void ScriptModule::DrawModuleUnclipped()
    {
       string debugText = mLastRunLiteralCode;
       
-      for (size_t i=0; i<mScheduledNoteOutput.size(); ++i)
+      const ScopedLock lock(mScheduleMutex);
+
+      mScheduledNoteOutput.ForEach([&debugText](const ScheduledNoteOutput& note)
       {
-         if (mScheduledNoteOutput[i].time != -1 &&
-             gTime + 50 < mScheduledNoteOutput[i].time)
-            debugText += "\nP:"+ofToString(mScheduledNoteOutput[i].pitch) + " V:" + ofToString(mScheduledNoteOutput[i].velocity) + ", " + ofToString(mScheduledNoteOutput[i].time) + " " + ofToString(mScheduledNoteOutput[i].startTime) + ", line:" + ofToString(mScheduledNoteOutput[i].lineNum);
-      }
+         if (gTime + 50 < note.time)
+            debugText += "\nP:"+ofToString(note.pitch) + " V:" + ofToString(note.velocity) + ", " + ofToString(note.time) + " " + ofToString(note.startTime) + ", line:" + ofToString(note.lineNum);
+      });
       
-      for (size_t i=0; i<mScheduledMethodCall.size(); ++i)
+      mScheduledMethodCall.ForEach([&debugText](const ScheduledMethodCall& call)
       {
-         if (mScheduledMethodCall[i].time != -1 &&
-             gTime + 50 < mScheduledMethodCall[i].time)
-            debugText += "\n"+mScheduledMethodCall[i].method + ", " + ofToString(mScheduledMethodCall[i].time) + " " + ofToString(mScheduledMethodCall[i].startTime) + " " + ofToString(mScheduledMethodCall[i].lineNum);
-      }
+         if (gTime + 50 < call.time)
+            debugText += "\n"+call.method + ", " + ofToString(call.time) + " " + ofToString(call.startTime) + " " + ofToString(call.lineNum);
+      });
       
-      for (size_t i=0; i<mScheduledUIControlValue.size(); ++i)
+      mScheduledUIControlValue.ForEach([&debugText](const ScheduledUIControlValue& controlValue)
       {
-         if (mScheduledUIControlValue[i].time != -1 &&
-             gTime + 50 < mScheduledUIControlValue[i].time)
-            debugText += "\n"+ string(mScheduledUIControlValue[i].control->Name()) + ": " + ofToString(mScheduledUIControlValue[i].value) + ", " + ofToString(mScheduledUIControlValue[i].time) + " " + ofToString(mScheduledUIControlValue[i].startTime) + " " + ofToString(mScheduledUIControlValue[i].lineNum);
-      }
+         if (gTime + 50 < controlValue.time)
+            debugText += "\n"+ string(controlValue.control->Name()) + ": " + ofToString(controlValue.value) + ", " + ofToString(controlValue.time) + " " + ofToString(controlValue.startTime) + " " + ofToString(controlValue.lineNum);
+      });
       
       string lineNumbers = "";
       vector<string> lines = ofSplitString(mLastRunLiteralCode, "\n");
@@ -438,6 +562,22 @@ void ScriptModule::Poll()
 
    if (!sPythonInitialized)
       return;
+   
+   vector<ScheduledUIControlValue> controlValues;
+   vector<string> errors;
+   {
+      const ScopedLock lock(mDisplayMutex);
+      controlValues.swap(mPendingUIControlValues);
+      errors.swap(mPendingErrors);
+   }
+   for (const auto& controlValue : controlValues)
+      ApplyUIControlValue(controlValue.control, controlValue.value, controlValue.lineNum);
+   for (const auto& error : errors)
+      TheSynth->LogEvent(error, kLogEventType_Error);
+   
+   int droppedNotes = mNumDroppedNoteOutputs.exchange(0);
+   if (droppedNotes > 0)
+      ofLog() << Name() << " dropped " << droppedNotes << " notes, the audio thread isn't keeping up";
 
    if (sScriptsRequestingInitExecution.size() > 0)
    {
@@ -448,92 +588,180 @@ void ScriptModule::Poll()
       }
       sScriptsRequestingInitExecution.clear();
    }
-   
+}
+
+void ScriptModule::ProcessScriptEvents()
+{
+   //script thread, with the python lock held
+
    double time = gTime;
+   double lookahead = TheTransport->GetEventLookaheadMs();
    
-   for (size_t i=0; i<mScheduledPulseTimes.size(); ++i)
+   FlushUnsentNoteOutputs();
+
+   ScriptEvent event;
+   while (mScriptEventQueue.consume(event))
+      mPendingScriptEvents.push_back(event);
+
+   size_t numStillPending = 0;
+   for (size_t i=0; i<mPendingScriptEvents.size(); ++i)
    {
-      if (mScheduledPulseTimes[i] != -1)
-      {
-         double runTime = mScheduledPulseTimes[i];
-         mScheduledPulseTimes[i] = -1;
-         if (mLastError == "")
-         {
-            //if (runTime < time)
-            //   ofLog() << "trying to run script triggered by pulse too late!";
-            RunCode(runTime, "on_pulse()");
-         }
-      }
+      if (time + lookahead > mPendingScriptEvents[i].time)
+         RunScriptEvent(mPendingScriptEvents[i]);
+      else
+         mPendingScriptEvents[numStillPending++] = mPendingScriptEvents[i];
    }
+   mPendingScriptEvents.resize(numStillPending);
    
-   for (size_t i=0; i<mPendingNoteInput.size(); ++i)
    {
-      if (mPendingNoteInput[i].time != -1 &&
-          time + TheTransport->GetEventLookaheadMs() > mPendingNoteInput[i].time)
+      const ScopedLock lock(mScheduleMutex);
+
+      ScheduledUIControlValue controlValue;
+      while (mScheduledUIControlValue.PopDue(time + lookahead, controlValue))
+         AdjustUIControl(controlValue.control, controlValue.value, controlValue.lineNum);
+   
+      //notes come out in time order. a note off that a note on cuts short gets played along with the note on.
+      ScheduledNoteOutput note;
+      int handle;
+      while (mScheduledNoteOutput.PopDue(time + lookahead, note, handle))
       {
-         if (mLastError == "")
-         {
-            //if (mPendingNoteInput[i].time < time)
-            //   ofLog() << "trying to run script triggered by note too late!";
-            RunCode(mPendingNoteInput[i].time, "on_note("+ofToString(mPendingNoteInput[i].pitch)+", "+ofToString(mPendingNoteInput[i].velocity)+")");
-         }
-         mPendingNoteInput[i].time = -1;
+         if (note.velocity == 0)
+            RemoveFromVector(handle, mScheduledNoteOffsByPitch[GetPitchIndex(note.pitch)]);
+         PlayNote(note.time, note.pitch, note.velocity, note.pan, note.noteOutputIndex, note.lineNum);
       }
+
+      //take all the due calls up front, a call that schedules itself with no delay shouldn't run again until next time
+      ScheduledMethodCall call;
+      while (mScheduledMethodCall.PopDue(time + lookahead, call))
+         mDueMethodCalls.push_back(call);
    }
    
-   for (size_t i=0; i<mScheduledUIControlValue.size(); ++i)
+   for (const auto& call : mDueMethodCalls)
+   {
+      RunScheduledMethod(call.time, call.method);
+      mMethodCallTracker.AddEvent(call.lineNum);
+   }
+   mDueMethodCalls.clear();
+}
+
+void ScriptModule::RunScriptEvent(const ScriptEvent& event)
+{
+   if ((event.type == ScriptEventType::Pulse || event.type == ScriptEventType::Note) && mLastError != "")
+      return;
+
+   py::object* callback = nullptr;
+   switch (event.type)
+   {
+      case ScriptEventType::Pulse: callback = &mCallbacks->mOnPulse; break;
+      case ScriptEventType::Note: callback = &mCallbacks->mOnNote; break;
+      case ScriptEventType::Midi: callback = &mCallbacks->mOnMidi; break;
+      case ScriptEventType::Osc: callback = &mCallbacks->mOnOsc; break;
+      case ScriptEventType::GridButton: callback = &mCallbacks->mOnGridButton; break;
+   }
+
+   if (!*callback)
    {
-      if (mScheduledUIControlValue[i].time != -1 &&
-          time + TheTransport->GetEventLookaheadMs() > mScheduledUIControlValue[i].time)
+      //the script doesn't define it, so call it by name and let python report the error like it always has
+      string code;
+      switch (event.type)
       {
-         AdjustUIControl(mScheduledUIControlValue[i].control, mScheduledUIControlValue[i].value, mScheduledUIControlValue[i].lineNum);
-         mScheduledUIControlValue[i].time = -1;
+         case ScriptEventType::Pulse: code = "on_pulse()"; break;
+         case ScriptEventType::Note: code = "on_note("+ofToString(event.x)+", "+ofToString(event.y)+")"; break;
+         case ScriptEventType::Midi: code = "on_midi(" + ofToString(event.messageType) + ", " + ofToString(event.x) + ", " + ofToString(event.value) + ", " + ofToString(event.y) + ")"; break;
+         case ScriptEventType::Osc: code = "on_osc(\""+ event.text +"\")"; break;
+         case ScriptEventType::GridButton: code = "on_grid_button("+ofToString(event.x)+", "+ofToString(event.y)+", "+ofToString(event.value)+")"; break;
       }
+      RunCode(event.time, code);
+      return;
    }
-   
-   //note offs first
-   for (size_t i=0; i<mScheduledNoteOutput.size(); ++i)
+
+   ExecutePython(event.time, [&]()
    {
-      if (mScheduledNoteOutput[i].time != -1 &&
-          mScheduledNoteOutput[i].velocity == 0 &&
-          time + TheTransport->GetEventLookaheadMs() > mScheduledNoteOutput[i].time)
+      switch (event.type)
       {
-         PlayNote(mScheduledNoteOutput[i].time, mScheduledNoteOutput[i].pitch, mScheduledNoteOutput[i].velocity, mScheduledNoteOutput[i].pan, mScheduledNoteOutput[i].noteOutputIndex, mScheduledNoteOutput[i].lineNum);
-         mScheduledNoteOutput[i].time = -1;
+         case ScriptEventType::Pulse: (*callback)(); break;
+         case ScriptEventType::Note: (*callback)(event.x, event.y); break;
+         case ScriptEventType::Midi: (*callback)(event.messageType, event.x, event.value, event.y); break;
+         case ScriptEventType::Osc: (*callback)(event.text); break;
+         case ScriptEventType::GridButton: (*callback)(event.x, event.y, event.value); break;
       }
-   }
-   
-   //then note ons
-   for (size_t i=0; i<mScheduledNoteOutput.size(); ++i)
+   });
+}
+
+void ScriptModule::RunScheduledMethod(double time, const string& method)
+{
+   ExecutePython(time, [&]()
    {
-      if (mScheduledNoteOutput[i].time != -1 &&
-          mScheduledNoteOutput[i].velocity != 0 &&
-          time + TheTransport->GetEventLookaheadMs() > mScheduledNoteOutput[i].time)
+      auto it = mCallbacks->mCompiledMethods.find(method);
+      if (it == mCallbacks->mCompiledMethods.end())
       {
-         PlayNote(mScheduledNoteOutput[i].time, mScheduledNoteOutput[i].pitch, mScheduledNoteOutput[i].velocity, mScheduledNoteOutput[i].pan, mScheduledNoteOutput[i].noteOutputIndex, mScheduledNoteOutput[i].lineNum);
-         mScheduledNoteOutput[i].time = -1;
+         string code = method;
+         FixUpCode(code);
+         PyObject* compiled = Py_CompileString(code.c_str(), "<scheduled call>", Py_file_input);
+         if (compiled == nullptr)
+            throw py::error_already_set();
+         it = mCallbacks->mCompiledMethods.emplace(method, py::reinterpret_steal<py::object>(compiled)).first;
       }
+
+      py::dict globals = py::globals();
+      py::object result = py::reinterpret_steal<py::object>(PyEval_EvalCode(it->second.ptr(), globals.ptr(), globals.ptr()));
+      if (!result)
+         throw py::error_already_set();
+   });
+}
+
+void ScriptModule::QueueScriptEvent(const ScriptEvent& event)
+{
+   while (mScriptEventQueueProducerLock.test_and_set(std::memory_order_acquire))
+   {
    }
+   mScriptEventQueue.produce(event);
+   mScriptEventQueueProducerLock.clear(std::memory_order_release);
+}
+
+void ScriptModule::OnTransportAdvanced(float amount)
+{
+   ScriptOutput output;
+   while (mScriptOutputQueue.consume(output))
+      SendNoteFromScript(output.time, output.pitch, output.pitchBend, output.velocity, output.pan, output.noteOutputIndex);
+}
+
+void ScriptModule::QueueNoteOutput(const ScriptOutput& output)
+{
+   //script thread. notes wait their turn behind any that didn't fit before, so they stay in order.
+   mUnsentNoteOutputs.push_back(output);
+   FlushUnsentNoteOutputs();
+}
+
+void ScriptModule::FlushUnsentNoteOutputs()
+{
+   if (mUnsentNoteOutputs.empty())
+      return;
+   
+   int room = mScriptOutputQueue.getCapacity() - mScriptOutputQueue.getNumReady();
+   int numToSend = MIN(room, (int)mUnsentNoteOutputs.size());
+   mScriptOutputQueue.produceN(mUnsentNoteOutputs.data(), numToSend);
+   mUnsentNoteOutputs.erase(mUnsentNoteOutputs.begin(), mUnsentNoteOutputs.begin() + numToSend);
    
-   for (size_t i=0; i<mScheduledMethodCall.size(); ++i)
+   //if the audio thread has stopped pulling notes, let go of note ons but never note offs, so nothing gets stuck
+   const size_t kMaxUnsent = 4096;
+   if (mUnsentNoteOutputs.size() > kMaxUnsent)
    {
-      if (mScheduledMethodCall[i].time != -1 &&
-          time + TheTransport->GetEventLookaheadMs() > mScheduledMethodCall[i].time)
+      size_t numKept = 0;
+      for (size_t i=0; i<mUnsentNoteOutputs.size(); ++i)
       {
-         RunCode(mScheduledMethodCall[i].time, mScheduledMethodCall[i].method);
-         mMethodCallTracker.AddEvent(mScheduledMethodCall[i].lineNum);
-         mScheduledMethodCall[i].time = -1;
+         if (mUnsentNoteOutputs[i].velocity == 0)
+            mUnsentNoteOutputs[numKept++] = mUnsentNoteOutputs[i];
       }
+      mNumDroppedNoteOutputs += int(mUnsentNoteOutputs.size() - numKept);
+      mUnsentNoteOutputs.resize(numKept);
    }
+}
 
-   if (mMidiMessageQueue.size() > 0)
-   {
-      mMidiMessageQueueMutex.lock();
-      for (string& methodCall : mMidiMessageQueue)
-         RunCode(gTime, methodCall);
-      mMidiMessageQueue.clear();
-      mMidiMessageQueueMutex.unlock();
-   }
+//static
+bool ScriptModule::IsScriptThread()
+{
+   return Thread::getCurrentThread() == &ScriptThread::Get();
 }
 
 //static
@@ -580,55 +808,44 @@ void ScriptModule::PlayNoteFromScriptAfterDelay(float pitch, float velocity, dou
 
 void ScriptModule::ScheduleNote(double time, float pitch, float velocity, float pan, int noteOutputIndex)
 {
-   for (size_t i=0; i<mScheduledNoteOutput.size(); ++i)
-   {
-      if (mScheduledNoteOutput[i].time == -1)
-      {
-         mScheduledNoteOutput[i].time = time;
-         mScheduledNoteOutput[i].startTime = sMostRecentRunTime;
-         mScheduledNoteOutput[i].pitch = pitch;
-         mScheduledNoteOutput[i].velocity = velocity;
-         mScheduledNoteOutput[i].pan = pan;
-         mScheduledNoteOutput[i].noteOutputIndex = noteOutputIndex;
-         mScheduledNoteOutput[i].lineNum = mNextLineToExecute;
-         break;
-      }
-   }
+   ScheduledNoteOutput note;
+   note.time = time;
+   note.startTime = sMostRecentRunTime;
+   note.pitch = pitch;
+   note.velocity = velocity;
+   note.pan = pan;
+   note.noteOutputIndex = noteOutputIndex;
+   note.lineNum = mNextLineToExecute;
+
+   const ScopedLock lock(mScheduleMutex);
+   int handle = mScheduledNoteOutput.Add(note);
+   if (velocity == 0)
+      mScheduledNoteOffsByPitch[GetPitchIndex(pitch)].push_back(handle);
 }
 
 void ScriptModule::ScheduleMethod(string method, double delayMeasureTime)
 {
-   for (size_t i=0; i<mScheduledMethodCall.size(); ++i)
-   {
-      if (mScheduledMethodCall[i].time == -1)
-      {
-         double time = GetScheduledTime(delayMeasureTime);
-         
-         mScheduledMethodCall[i].time = time;
-         mScheduledMethodCall[i].startTime = sMostRecentRunTime;
-         mScheduledMethodCall[i].method = method;
-         mScheduledMethodCall[i].lineNum = mNextLineToExecute;
-         break;
-      }
-   }
+   ScheduledMethodCall call;
+   call.time = GetScheduledTime(delayMeasureTime);
+   call.startTime = sMostRecentRunTime;
+   call.method = method;
+   call.lineNum = mNextLineToExecute;
+
+   const ScopedLock lock(mScheduleMutex);
+   mScheduledMethodCall.Add(call);
 }
 
 void ScriptModule::ScheduleUIControlValue(IUIControl* control, float value, double delayMeasureTime)
 {
-   for (size_t i=0; i<mScheduledUIControlValue.size(); ++i)
-   {
-      if (mScheduledUIControlValue[i].time == -1)
-      {
-         double time = GetScheduledTime(delayMeasureTime);
-         
-         mScheduledUIControlValue[i].time = time;
-         mScheduledUIControlValue[i].startTime = sMostRecentRunTime;
-         mScheduledUIControlValue[i].control = control;
-         mScheduledUIControlValue[i].value = value;
-         mScheduledUIControlValue[i].lineNum = mNextLineToExecute;
-         break;
-      }
-   }
+   ScheduledUIControlValue controlValue;
+   controlValue.time = GetScheduledTime(delayMeasureTime);
+   controlValue.startTime = sMostRecentRunTime;
+   controlValue.control = control;
+   controlValue.value = value;
+   controlValue.lineNum = mNextLineToExecute;
+
+   const ScopedLock lock(mScheduleMutex);
+   mScheduledUIControlValue.Add(controlValue);
 }
 
 void ScriptModule::HighlightLine(int lineNum, int scriptModuleIndex)
@@ -645,6 +862,7 @@ void ScriptModule::HighlightLine(int lineNum, int scriptModuleIndex)
 
 void ScriptModule::PrintText(string text)
 {
+   const ScopedLock lock(mDisplayMutex);
    for (size_t i=0; i<mPrintDisplay.size(); ++i)
    {
       if (mPrintDisplay[i].time == -1 || mPrintDisplay[i].lineNum == mNextLineToExecute)
@@ -659,17 +877,64 @@ void ScriptModule::PrintText(string text)
 
 IUIControl* ScriptModule::GetUIControl(string path)
 {
-   IUIControl* control;
-   if (ofIsStringInString(path, "~"))
-      control = TheSynth->FindUIControl(path);
-   else
-      control = TheSynth->FindUIControl(Path() + "~" + path);
+   //only called from python, so the python lock keeps mUIControlHandles to one thread at a time
    
-   return control;
+   if (!ofIsStringInString(path, "~"))   //one of our own controls
+   {
+      IUIControl* control = FindUIControl(path.c_str(), false);
+      if (control == nullptr)
+         LogError("Couldn't find UI control at path \""+Path()+"~"+path+"\"");
+      return control;
+   }
+   
+   auto it = mUIControlHandles.find(path);
+   if (it == mUIControlHandles.end())
+      it = mUIControlHandles.insert(std::make_pair(path, UIControlHandle(path))).first;
+   return it->second.Get();
+}
+
+void ScriptModule::SetLastError(const string& error)
+{
+   const ScopedLock lock(mDisplayMutex);
+   mLastError = error;
+}
+
+void ScriptModule::LogError(const string& error)
+{
+   if (IsScriptThread())
+   {
+      const ScopedLock lock(mDisplayMutex);
+      mPendingErrors.push_back(error);
+   }
+   else
+   {
+      TheSynth->LogEvent(error, kLogEventType_Error);
+   }
 }
 
 void ScriptModule::AdjustUIControl(IUIControl* control, float value, int lineNum)
 {
+   if (IsScriptThread())
+   {
+      ScheduledUIControlValue controlValue;
+      controlValue.startTime = sMostRecentRunTime;
+      controlValue.time = sMostRecentRunTime;
+      controlValue.control = control;
+      controlValue.value = value;
+      controlValue.lineNum = lineNum;
+      
+      const ScopedLock lock(mDisplayMutex);
+      mPendingUIControlValues.push_back(controlValue);
+   }
+   else
+   {
+      ApplyUIControlValue(control, value, lineNum);
+   }
+}
+
+void ScriptModule::ApplyUIControlValue(IUIControl* control, float value, int lineNum)
+{
+   //main thread
    control->SetValue(value);
    
    mUIControlTracker.AddEvent(lineNum);
@@ -692,34 +957,59 @@ void ScriptModule::PlayNote(double time, float pitch, float velocity, float pan,
    if (velocity > 0)
    {
       //run through any scheduled note offs for this pitch
-      for (size_t i=0; i<mScheduledNoteOutput.size(); ++i)
+      const ScopedLock lock(mScheduleMutex);
+      vector<int>& noteOffs = mScheduledNoteOffsByPitch[GetPitchIndex(pitch)];
+      for (size_t i=0; i<noteOffs.size();)
       {
-         if (mScheduledNoteOutput[i].velocity == 0 &&
-             mScheduledNoteOutput[i].pitch == pitch &&
-             mScheduledNoteOutput[i].time != -1 &&
-             mScheduledNoteOutput[i].time - 3 <= time)
+         ScheduledNoteOutput noteOff = mScheduledNoteOutput.Get(noteOffs[i]);
+         if (noteOff.pitch == pitch && noteOff.time - 3 <= time)
          {
-            PlayNote(MIN(mScheduledNoteOutput[i].time, time), mScheduledNoteOutput[i].pitch, mScheduledNoteOutput[i].velocity, mScheduledNoteOutput[i].pan, mScheduledNoteOutput[i].noteOutputIndex, mScheduledNoteOutput[i].lineNum);
-            mScheduledNoteOutput[i].time = -1;
+            mScheduledNoteOutput.Cancel(noteOffs[i]);
+            noteOffs[i] = noteOffs.back();
+            noteOffs.pop_back();
+            PlayNote(MIN(noteOff.time, time), noteOff.pitch, noteOff.velocity, noteOff.pan, noteOff.noteOutputIndex, noteOff.lineNum);
+         }
+         else
+         {
+            ++i;
          }
       }
    }
    
    //ofLog() << "ScriptModule::PlayNote() " << velocity << " " << time;
    int intPitch = int(pitch+.5f);
-   ModulationParameters modulation;
-   modulation.pan = pan;
-   if (pitch - intPitch != 0)
+   if (IsScriptThread())
    {
-      modulation.pitchBend = &mPitchBends[intPitch];
-      modulation.pitchBend->SetValue(pitch - intPitch);
+      ScriptOutput output;
+      output.time = time;
+      output.pitch = intPitch;
+      output.pitchBend = pitch - intPitch;
+      output.velocity = velocity;
+      output.pan = pan;
+      output.noteOutputIndex = noteOutputIndex;
+      QueueNoteOutput(output);
+   }
+   else
+   {
+      SendNoteFromScript(time, intPitch, pitch - intPitch, velocity, pan, noteOutputIndex);
    }
-   SendNoteToIndex(noteOutputIndex, time, intPitch, (int)velocity, -1, modulation);
    
    if (velocity > 0)
       mNotePlayTracker.AddEvent(lineNum, ofToString(pitch) + " " + ofToString(velocity) + " " + ofToString(pan,1));
 }
 
+void ScriptModule::SendNoteFromScript(double time, int pitch, float pitchBend, float velocity, float pan, int noteOutputIndex)
+{
+   ModulationParameters modulation;
+   modulation.pan = pan;
+   if (pitchBend != 0)
+   {
+      modulation.pitchBend = &mPitchBends[pitch];
+      modulation.pitchBend->SetValue(pitchBend);
+   }
+   SendNoteToIndex(noteOutputIndex, time, pitch, (int)velocity, -1, modulation);
+}
+
 void ScriptModule::SendNoteToIndex(int index, double time, int pitch, int velocity, int voiceIdx, ModulationParameters modulation)
 {
    if (index == 0)
@@ -772,14 +1062,34 @@ void ScriptModule::oscMessageReceived(const OSCMessage& msg)
          messageString += " " + msg[i].getString().toStdString();
    }
 
-   RunCode(gTime, "on_osc(\""+ messageString +"\")");
+   ScriptEvent event;
+   event.type = ScriptEventType::Osc;
+   event.time = gTime;
+   event.text = messageString;
+   QueueScriptEvent(event);
 }
 
 void ScriptModule::MidiReceived(MidiMessageType messageType, int control, float value, int channel)
 {
-   mMidiMessageQueueMutex.lock();
-   mMidiMessageQueue.push_back("on_midi(" + ofToString((int)messageType) + ", " + ofToString(control) + ", " + ofToString(value) + ", " + ofToString(channel) + ")");
-   mMidiMessageQueueMutex.unlock();
+   ScriptEvent event;
+   event.type = ScriptEventType::Midi;
+   event.time = gTime;
+   event.messageType = (int)messageType;
+   event.x = control;
+   event.y = channel;
+   event.value = value;
+   QueueScriptEvent(event);
+}
+
+void ScriptModule::GridButtonReceived(int x, int y, float velocity)
+{
+   ScriptEvent event;
+   event.type = ScriptEventType::GridButton;
+   event.time = gTime;
+   event.x = x;
+   event.y = y;
+   event.value = velocity;
+   QueueScriptEvent(event);
 }
 
 void ScriptModule::ButtonClicked(ClickButton* button)
@@ -936,29 +1246,21 @@ void ScriptModule::OnCodeUpdated()
 
 void ScriptModule::OnPulse(double time, float velocity, int flags)
 {
-   for (size_t i=0; i<mScheduledPulseTimes.size(); ++i)
-   {
-      if (mScheduledPulseTimes[i] == -1)
-      {
-         mScheduledPulseTimes[i] = time;
-         break;
-      }
-   }
+   ScriptEvent event;
+   event.type = ScriptEventType::Pulse;
+   event.time = time;
+   QueueScriptEvent(event);
 }
 
 //INoteReceiver
 void ScriptModule::PlayNote(double time, int pitch, int velocity, int voiceIdx /*= -1*/, ModulationParameters modulation /*= ModulationParameters()*/)
 {
-   for (size_t i=0; i<mPendingNoteInput.size(); ++i)
-   {
-      if (mPendingNoteInput[i].time == -1)
-      {
-         mPendingNoteInput[i].time = time;
-         mPendingNoteInput[i].pitch = pitch;
-         mPendingNoteInput[i].velocity = velocity;
-         break;
-      }
-   }
+   ScriptEvent event;
+   event.type = ScriptEventType::Note;
+   event.time = time;
+   event.x = pitch;
+   event.y = velocity;
+   QueueScriptEvent(event);
 }
 
 string ScriptModule::GetThisName()
@@ -968,7 +1270,7 @@ string ScriptModule::GetThisName()
 
 pair<int,int> ScriptModule::RunScript(double time, int lineStart/*=-1*/, int lineEnd/*=-1*/)
 {
-   //should only be called from main thread
+   //main thread only, events and scheduled calls run on the script thread
 
    if (!sPythonInitialized)
    {
@@ -976,6 +1278,7 @@ pair<int,int> ScriptModule::RunScript(double time, int lineStart/*=-1*/, int lin
       return std::make_pair(0,0);
    }
 
+   ScopedPythonLock pythonLock;
    py::exec(GetThisName()+" = scriptmodule.get_me("+ofToString(mScriptModuleIndex)+")", py::globals());
    string code = mCodeEntry->GetText(true);
    vector<string> lines = ofSplitString(code, "\n");
@@ -1017,20 +1320,53 @@ pair<int,int> ScriptModule::RunScript(double time, int lineStart/*=-1*/, int lin
    mLastRunLiteralCode = code;
    
    RunCode(time, code);
+   ResolveCallbacks();
 
    return std::make_pair(executionStartLine, executionEndLine);
 }
 
 void ScriptModule::RunCode(double time, string code)
 {
-   //should only be called from main thread
-   
    if (!sPythonInitialized)
    {
-      TheSynth->LogEvent("trying to call ScriptModule::RunCode() before python is initialized", kLogEventType_Error);
+      LogError("trying to call ScriptModule::RunCode() before python is initialized");
       return;
    }
 
+   ExecutePython(time, [&]()
+   {
+      FixUpCode(code);
+      //ofLog() << code;
+      py::exec(code, py::globals());
+   });
+}
+
+void ScriptModule::ResolveCallbacks()
+{
+   //python lock is held
+   
+   py::dict globals = py::globals();
+   string prefix = GetMethodPrefix();
+   auto resolve = [&globals, &prefix](string name)
+   {
+      name += "__" + prefix;
+      if (globals.contains(name) && PyCallable_Check(globals[name.c_str()].ptr()))
+         return py::object(globals[name.c_str()]);
+      return py::object();
+   };
+
+   mCallbacks->mOnPulse = resolve("on_pulse");
+   mCallbacks->mOnNote = resolve("on_note");
+   mCallbacks->mOnMidi = resolve("on_midi");
+   mCallbacks->mOnOsc = resolve("on_osc");
+   mCallbacks->mOnGridButton = resolve("on_grid_button");
+   mCallbacks->mCompiledMethods.clear();
+}
+
+void ScriptModule::ExecutePython(double time, const std::function<void()>& execute)
+{
+   ScopedPythonLock pythonLock;
+
    sMostRecentRunTime = time;
    mNextLineToExecute = -1;
    ComputeSliders(0);
@@ -1038,18 +1374,10 @@ void ScriptModule::RunCode(double time, string code)
 
    try
    {
-      //ofLog() << "****";
-      //ofLog() << (string)py::str(mPythonGlobals);
-      
-      FixUpCode(code);
-      //ofLog() << code;
-      py::exec(code, py::globals());
-      
-      //ofLog() << "&&&&";
-      //ofLog() << (string)py::str(mPythonGlobals);
+      execute();
       
       mCodeEntry->SetError(false);
-      mLastError = "";
+      SetLastError("");
    }
    catch (pybind11::error_already_set &e)
    {
@@ -1058,7 +1386,7 @@ void ScriptModule::RunCode(double time, string code)
       if (mNextLineToExecute == -1) //this script hasn't executed yet
          sMostRecentLineExecutedModule = this;
       
-      sMostRecentLineExecutedModule->mLastError = (string)py::str(e.type()) + ": "+ (string)py::str(e.value());
+      sMostRecentLineExecutedModule->SetLastError((string)py::str(e.type()) + ": "+ (string)py::str(e.value()));
       
       int lineNumber = sMostRecentLineExecutedModule->mNextLineToExecute;
       if (lineNumber == -1)
@@ -1256,16 +1584,19 @@ void ScriptModule::OnModuleReferenceBound(IDrawableModule* target)
 
 void ScriptModule::Stop()
 {
+   ScopedPythonLock pythonLock;   //keep the script thread out of the schedules while they're cleared
    double time = gTime + gBufferSizeMs;
 
-   //run through any scheduled note offs for this pitch
-   for (size_t i=0; i<mScheduledNoteOutput.size(); ++i)
+   //run through any scheduled note offs
    {
-      if (mScheduledNoteOutput[i].time != -1 &&
-          mScheduledNoteOutput[i].velocity == 0)
+      const ScopedLock lock(mScheduleMutex);
+      for (const auto& noteOffs : mScheduledNoteOffsByPitch)
       {
-         PlayNote(time, mScheduledNoteOutput[i].pitch, 0, 0, mScheduledNoteOutput[i].noteOutputIndex, mScheduledNoteOutput[i].lineNum);
-         mScheduledNoteOutput[i].time = -1;
+         for (int handle : noteOffs)
+         {
+            const ScheduledNoteOutput& noteOff = mScheduledNoteOutput.Get(handle);
+            PlayNote(time, noteOff.pitch, 0, 0, noteOff.noteOutputIndex, noteOff.lineNum);
+         }
       }
    }
    
@@ -1274,20 +1605,16 @@ void ScriptModule::Stop()
 
 void ScriptModule::Reset()
 {
-   for (size_t i=0; i<mScheduledPulseTimes.size(); ++i)
-      mScheduledPulseTimes[i] = -1;
-   
-   for (size_t i=0; i<mScheduledNoteOutput.size(); ++i)
-      mScheduledNoteOutput[i].time = -1;
-   
-   for (size_t i=0; i<mScheduledMethodCall.size(); ++i)
-      mScheduledMethodCall[i].time = -1;
-   
-   for (size_t i=0; i<mScheduledUIControlValue.size(); ++i)
-      mScheduledUIControlValue[i].time = -1;
+   {
+      const ScopedLock lock(mScheduleMutex);
+      mScheduledNoteOutput.Clear();
+      for (auto& noteOffs : mScheduledNoteOffsByPitch)
+         noteOffs.clear();
+      mScheduledMethodCall.Clear();
+      mScheduledUIControlValue.Clear();
+   }
    
-   for (size_t i=0; i<mPendingNoteInput.size(); ++i)
-      mPendingNoteInput[i].time = -1;
+   mPendingScriptEvents.clear();
    
    for (size_t i=0; i<mPrintDisplay.size(); ++i)
       mPrintDisplay[i].time = -1;
@@ -1377,6 +1704,7 @@ void ScriptModule::LoadState(FileStreamIn& in)
 
 void ScriptModule::LineEventTracker::Draw(CodeEntry* codeEntry, int style, ofColor color)
 {
+   const ScopedLock lock(mMutex);
    ofPushStyle();
    ofFill();
    for (int i=0; i<(int)mText.size(); ++i)
@@ -37,8 +37,14 @@
 #include "DropdownList.h"
 #include "ModulationChain.h"
 #include "MidiController.h"
+#include "LockFreeQueue.h"
+#include "UIControlHandle.h"
+#include "IAudioPoller.h"
+#include "EventSchedule.h"
+#include <unordered_map>
+#include <functional>
 
-class ScriptModule : public IDrawableModule, public IButtonListener, public NoteEffectBase, public IPulseReceiver, public ICodeEntryListener, public IFloatSliderListener, public IDropdownListener,
+class ScriptModule : public IDrawableModule, public IButtonListener, public NoteEffectBase, public IPulseReceiver, public ICodeEntryListener, public IFloatSliderListener, public IDropdownListener, public IAudioPoller,
                      private OSCReceiver,
                      private OSCReceiver::Listener<OSCReceiver::MessageLoopCallback>
 {
@@ -53,6 +59,7 @@ public:
    
    string GetTitleLabel() override { return "script"; }
    void CreateUIControls() override;
+   void Init() override;
    
    void Poll() override;
    
@@ -68,6 +75,7 @@ public:
    void SetNumNoteOutputs(int num);
    void ConnectOscInput(int port);
    void MidiReceived(MidiMessageType messageType, int control, float value, int channel);
+   void GridButtonReceived(int x, int y, float velocity);
    void OnModuleReferenceBound(IDrawableModule* target);
    void SetContext();
    void ClearContext();
@@ -90,6 +98,9 @@ public:
 
    //OSCReceiver
    void oscMessageReceived(const OSCMessage& msg) override;
+
+   //IAudioPoller
+   void OnTransportAdvanced(float amount) override;
    
    bool HasDebugDraw() const override { return true; }
    
@@ -117,13 +128,50 @@ public:
    ModulationChain* GetPressure(int pitch) { return &mPressures[pitch]; }
 
    static string GetBootstrapImportString() { return "import bespoke; import module; import scriptmodule; import random; import math"; }
+
+   //python only runs on one thread at a time. hold one of these around anything that touches the interpreter.
+   class ScopedPythonLock
+   {
+   public:
+      ScopedPythonLock();
+      ~ScopedPythonLock();
+   private:
+      bool mHoldsGIL;
+      int mGILState;
+   };
    
 private:
+   friend class ScriptThread;
+   struct PythonCallbacks;
+   
+   //notes that scripts play on the script thread, for the audio thread to send along
+   struct ScriptOutput
+   {
+      double time;
+      int pitch;
+      float pitchBend;
+      float velocity;
+      float pan;
+      int noteOutputIndex;
+   };
+
    void PlayNote(double time, float pitch, float velocity, float pan, int noteOutputIndex, int lineNum);
+   void SendNoteFromScript(double time, int pitch, float pitchBend, float velocity, float pan, int noteOutputIndex);
    void AdjustUIControl(IUIControl* control, float value, int lineNum);
+   void ApplyUIControlValue(IUIControl* control, float value, int lineNum);
+   void SetLastError(const string& error);
+   void LogError(const string& error);
+   void QueueNoteOutput(const ScriptOutput& output);
+   void FlushUnsentNoteOutputs();
    pair<int,int> RunScript(double time, int lineStart = -1, int lineEnd = -1);
+   void ExecutePython(double time, const std::function<void()>& execute);
+   void RunScheduledMethod(double time, const string& method);
+   void ResolveCallbacks();
+   void ProcessScriptEvents();
+   static bool IsScriptThread();
    void FixUpCode(string& code);
    void ScheduleNote(double time, float pitch, float velocity, float pan, int noteOutputIndex);
+   static int GetPitchIndex(float pitch) { return CLAMP(int(pitch+.5f), 0, 127); }
    void SendNoteToIndex(int index, double time, int pitch, int velocity, int voiceIdx, ModulationParameters modulation);
    string GetThisName();
    string GetIndentation(string line);
@@ -164,7 +212,6 @@ private:
    
    float mWidth;
    float mHeight;
-   std::array<double, 20> mScheduledPulseTimes;
    static double sMostRecentRunTime;
    string mLastError;
    size_t mScriptModuleIndex;
@@ -183,7 +230,8 @@ private:
       int noteOutputIndex;
       int lineNum;
    };
-   std::array<ScheduledNoteOutput, 200> mScheduledNoteOutput;
+   EventSchedule<ScheduledNoteOutput> mScheduledNoteOutput;
+   std::array<vector<int>, 128> mScheduledNoteOffsByPitch;   //handles into mScheduledNoteOutput, so a note on can find the note offs it cuts short
    
    struct ScheduledMethodCall
    {
@@ -192,7 +240,8 @@ private:
       string method;
       int lineNum;
    };
-   std::array<ScheduledMethodCall, 50> mScheduledMethodCall;
+   EventSchedule<ScheduledMethodCall> mScheduledMethodCall;
+   vector<ScheduledMethodCall> mDueMethodCalls;
    
    struct ScheduledUIControlValue
    {
@@ -202,15 +251,13 @@ private:
       float value;
       int lineNum;
    };
-   std::array<ScheduledUIControlValue, 50> mScheduledUIControlValue;
+   EventSchedule<ScheduledUIControlValue> mScheduledUIControlValue;
+   CriticalSection mScheduleMutex;   //the schedules get drawn on the UI thread while the script thread runs them
    
-   struct PendingNoteInput
-   {
-      double time;
-      int pitch;
-      int velocity;
-   };
-   std::array<PendingNoteInput, 50> mPendingNoteInput;
+   //what the script thread hands over to the UI thread: setting a control can run any listener, so values get applied in Poll()
+   CriticalSection mDisplayMutex;   //also guards mPrintDisplay and mLastError, which DrawModule() reads
+   vector<ScheduledUIControlValue> mPendingUIControlValues;
+   vector<string> mPendingErrors;
    
    struct PrintDisplay
    {
@@ -242,6 +289,7 @@ private:
       {
          if (lineNum >= 0 && lineNum < (int)mTimes.size())
          {
+            const ScopedLock lock(mMutex);
             mTimes[lineNum] = gTime;
             mText[lineNum] = text;
          }
@@ -251,6 +299,7 @@ private:
    private:
       std::array<double, 256> mTimes;
       std::array<string, 256> mText;
+      CriticalSection mMutex;   //events come from the script thread, and get drawn on the UI thread
    };
    
    LineEventTracker mLineExecuteTracker;
@@ -269,11 +318,41 @@ private:
    std::vector<string> mScriptFilePaths;
    
    std::vector<AdditionalNoteCable*> mExtraNoteOutputs;
+   std::unordered_map<string, UIControlHandle> mUIControlHandles;   //scripts tend to set the same few controls over and over
    std::array<ModulationChain, 128> mPitchBends;
    std::array<ModulationChain, 128> mModWheels;
    std::array<ModulationChain, 128> mPressures;
-   std::list<string> mMidiMessageQueue;
-   ofMutex mMidiMessageQueueMutex;
+   
+   //pulses, notes, midi, osc and grid presses get queued up from whatever thread they arrive on, and the script thread runs them
+   enum class ScriptEventType
+   {
+      Pulse,
+      Note,
+      Midi,
+      Osc,
+      GridButton
+   };
+   struct ScriptEvent
+   {
+      ScriptEventType type;
+      double time;
+      int x;   //pitch, midi control, or grid x
+      int y;   //velocity, midi channel, or grid y
+      float value;   //midi value or grid velocity
+      int messageType;
+      string text;   //osc message
+   };
+   void QueueScriptEvent(const ScriptEvent& event);
+   void RunScriptEvent(const ScriptEvent& event);
+   LockFreeQueue<ScriptEvent> mScriptEventQueue;
+   std::atomic_flag mScriptEventQueueProducerLock;  //events can come from the audio thread, midi, osc and the UI
+   vector<ScriptEvent> mPendingScriptEvents;   //guarded by the python lock
+
+   LockFreeQueue<ScriptOutput> mScriptOutputQueue;
+   vector<ScriptOutput> mUnsentNoteOutputs;   //notes that didn't fit in mScriptOutputQueue, sent ahead of anything newer
+   std::atomic<int> mNumDroppedNoteOutputs;
+
+   std::unique_ptr<PythonCallbacks> mCallbacks;
    
    bool mShowJediWarning;
 };
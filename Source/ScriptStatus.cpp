@@ -80,7 +80,10 @@ void ScriptStatus::Poll()
    
    if (gTime > mNextUpdateTime)
    {
-      mStatus = py::str(py::globals());
+      {
+         ScriptModule::ScopedPythonLock pythonLock;
+         mStatus = py::str(py::globals());
+      }
       ofStringReplace(mStatus, ",", "\n");
       mNextUpdateTime = gTime + 100;
    }
@@ -94,7 +94,8 @@ void SeaOfGrain::CreateUIControls()
       float x = 10 + i * 130;
       mManualVoices[i].mGainSlider = new FloatSlider(this,("gain "+ofToString(i+1)).c_str(),x,mBufferY+mBufferH+12,120,15,&mManualVoices[i].mGain,0,1);
       mManualVoices[i].mPositionSlider = new FloatSlider(this,("pos "+ofToString(i+1)).c_str(),mManualVoices[i].mGainSlider,kAnchor_Below,120,15,&mManualVoices[i].mPosition,0,1);
-      mManualVoices[i].mOverlapSlider = new FloatSlider(this,("overlap "+ofToString(i+1)).c_str(),mManualVoices[i].mPositionSlider,kAnchor_Below,120,15,&mManualVoices[i].mGranulator.mGrainOverlap,.25,MAX_GRAINS);
+      mManualVoices[i].mOverlapSlider = new FloatSlider(this,("overlap "+ofToString(i+1)).c_str(),mManualVoices[i].mPositionSlider,kAnchor_Below,120,15,&mManualVoices[i].mGranulator.mGrainOverlap,.25,Granulator::kMaxGrains/2);
+      mManualVoices[i].mOverlapSlider->SetMode(FloatSlider::kSquare);   //dense clouds go well past the other granulators' overlap range
       mManualVoices[i].mSpeedSlider = new FloatSlider(this,("speed "+ofToString(i+1)).c_str(),mManualVoices[i].mOverlapSlider,kAnchor_Below,120,15,&mManualVoices[i].mGranulator.mSpeed,-3,3);
       mManualVoices[i].mLengthMsSlider = new FloatSlider(this,("len ms "+ofToString(i+1)).c_str(),mManualVoices[i].mSpeedSlider,kAnchor_Below,120,15,&mManualVoices[i].mGranulator.mGrainLengthMs,1,1000);
       mManualVoices[i].mPosRandomizeSlider = new FloatSlider(this,("pos r "+ofToString(i+1)).c_str(),mManualVoices[i].mLengthMsSlider,kAnchor_Below,120,15,&mManualVoices[i].mGranulator.mPosRandomizeMs,0,200);
@@ -251,6 +252,16 @@ float SeaOfGrain::GetSourceBufferOffset()
       return 0;
 }
 
+void SeaOfGrain::RenderGrains(Granulator& granulator, double sourcePosition, float** grains, int bufferSize)
+{
+   //the voices mix into gWorkChannelBuffer, so each voice's grains go into gWorkBuffer first
+   ChannelBuffer* source = GetSourceBuffer();
+   assert(bufferSize * ChannelBuffer::kMaxNumChannels <= kWorkBufferSize);
+   for (int ch = 0; ch < source->NumActiveChannels(); ++ch)
+      grains[ch] = gWorkBuffer + ch * bufferSize;
+   granulator.Process(gTime, source, source->BufferSize(), sourcePosition + GetSourceBufferOffset(), 0, grains, bufferSize);
+}
+
 void SeaOfGrain::FilesDropped(vector<string> files, int x, int y)
 {
    mLoading = true;
@@ -398,6 +409,15 @@ namespace
    const int kSaveStateRev = 1;
 }
 
+void SeaOfGrain::StashSaveData(FileStreamOut& out)
+{
+   IDrawableModule::StashSaveData(out);
+   if (mHasRecordedInput)
+      mRecordBuffer.StashSaveData(out);
+   else
+      mSample->StashSaveData(out);
+}
+
 void SeaOfGrain::SaveState(FileStreamOut& out)
 {
    IDrawableModule::SaveState(out);
@@ -451,28 +471,31 @@ void SeaOfGrain::GrainMPEVoice::Process(ChannelBuffer* output, int bufferSize)
 {
    if (!mADSR.IsDone(gTime) && mOwner->GetSourceBuffer()->BufferSize() > 0)
    {
+      //grain parameters only matter when a grain spawns, so they're taken once per buffer
+      float pitchBend = mPitchBend ? mPitchBend->GetValue(0) : 0;
+      float pressure = mPressure ? mPressure->GetValue(0) : 0;
+      float modwheel = mModWheel ? mModWheel->GetValue(0) : 0;
+      if (pressure > 0)
+      {
+         mGranulator.mGrainOverlap = ofMap(pressure * pressure, 0, 1, 3, MAX_GRAINS);
+         mGranulator.mPosRandomizeMs = ofMap(pressure * pressure, 0, 1, 100, .03f);
+      }
+      mGranulator.mGrainLengthMs = ofMap(modwheel, -1, 1, 10, 700);
+      
+      float pos = (mPitch + pitchBend + MIN(.125f, mPlay) - mOwner->mKeyboardBasePitch) / mOwner->mKeyboardNumPitches;
+      float* grains[ChannelBuffer::kMaxNumChannels];
+      mOwner->RenderGrains(mGranulator, ofLerp(mOwner->GetSourceStartSample(), mOwner->GetSourceEndSample(), pos), grains, bufferSize);
+      
       double time = gTime;
       for (int i=0; i< bufferSize; ++i)
       {
-         float pitchBend = mPitchBend ? mPitchBend->GetValue(i) : 0;
-         float pressure = mPressure ? mPressure->GetValue(i) : 0;
-         float modwheel = mModWheel ? mModWheel->GetValue(i) : 0;
-         if (pressure > 0)
-         {
-            mGranulator.mGrainOverlap = ofMap(pressure * pressure, 0, 1, 3, MAX_GRAINS);
-            mGranulator.mPosRandomizeMs = ofMap(pressure * pressure, 0, 1, 100, .03f);
-         }
-         mGranulator.mGrainLengthMs = ofMap(modwheel, -1, 1, 10, 700);
-         
+         pressure = mPressure ? mPressure->GetValue(i) : 0;
          float blend = .0005f;
          mGain = mGain * (1-blend) + pressure * blend;
 
-         float outSample[ChannelBuffer::kMaxNumChannels];
-         Clear(outSample, ChannelBuffer::kMaxNumChannels);
-         float pos = (mPitch + pitchBend + MIN(.125f, mPlay) - mOwner->mKeyboardBasePitch) / mOwner->mKeyboardNumPitches;
-         mGranulator.ProcessFrame(time, mOwner->GetSourceBuffer(), mOwner->GetSourceBuffer()->BufferSize(), ofLerp(mOwner->GetSourceStartSample(), mOwner->GetSourceEndSample(), pos) + mOwner->GetSourceBufferOffset(), outSample);
-         for (int ch = 0; ch < output->NumActiveChannels(); ++ch)
-            output->GetChannel(ch)[i] += outSample[ch] * sqrtf(mGain) * mADSR.Value(time);
+         float gain = sqrtf(mGain) * mADSR.Value(time);
+         for (int ch = 0; ch < output->NumActiveChannels() && ch < mOwner->GetSourceBuffer()->NumActiveChannels(); ++ch)
+            output->GetChannel(ch)[i] += grains[ch][i] * gain;
 
          time += gInvSampleRateMs;
          mPlay += .001f;
@@ -524,17 +547,16 @@ void SeaOfGrain::GrainManualVoice::Process(ChannelBuffer* output, int bufferSize
 {
    if (mGain > 0 && mOwner->GetSourceBuffer()->BufferSize() > 0)
    {
-      double time = gTime;
       float panLeft = GetLeftPanGain(mPan);
       float panRight = GetRightPanGain(mPan);
-      for (int i=0; i < bufferSize; ++i)
+      float* grains[ChannelBuffer::kMaxNumChannels];
+      mOwner->RenderGrains(mGranulator, ofLerp(mOwner->GetSourceStartSample(), mOwner->GetSourceEndSample(), mPosition), grains, bufferSize);
+      for (int ch = 0; ch < output->NumActiveChannels() && ch < mOwner->GetSourceBuffer()->NumActiveChannels(); ++ch)
       {
-         float outSample[ChannelBuffer::kMaxNumChannels];
-         Clear(outSample, ChannelBuffer::kMaxNumChannels);
-         mGranulator.ProcessFrame(time, mOwner->GetSourceBuffer(), mOwner->GetSourceBuffer()->BufferSize(), ofLerp(mOwner->GetSourceStartSample(), mOwner->GetSourceEndSample(), mPosition) + mOwner->GetSourceBufferOffset(), outSample);
-         for (int ch = 0; ch < output->NumActiveChannels(); ++ch)
-            output->GetChannel(ch)[i] += outSample[ch] * mGain * (ch == 0 ? panLeft : panRight);
-         time += gInvSampleRateMs;
+         float* channel = output->GetChannel(ch);
+         float gain = mGain * (ch == 0 ? panLeft : panRight);
+         for (int i=0; i < bufferSize; ++i)
+            channel[i] += grains[ch][i] * gain;
       }
    }
    else
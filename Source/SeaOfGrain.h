@@ -83,6 +83,7 @@ public:
    virtual void LoadLayout(const ofxJSONElement& moduleInfo) override;
    virtual void SetUpFromSaveData() override;
    
+   void StashSaveData(FileStreamOut& out) override;
    void SaveState(FileStreamOut& out) override;
    void LoadState(FileStreamIn& in) override;
    
@@ -101,6 +102,7 @@ private:
    float GetSourceStartSample();
    float GetSourceEndSample();
    float GetSourceBufferOffset();
+   void RenderGrains(Granulator& granulator, double sourcePosition, float** grains, int bufferSize);
    
    struct GrainMPEVoice
    {
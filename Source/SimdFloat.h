@@ -0,0 +1,288 @@
+/**
+    bespoke synth, a software modular synthesizer
+    Copyright (C) 2021 Ryan Challinor (contact: awwbees@gmail.com)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**/
+/*
+  ==============================================================================
+
+    SimdFloat.h
+    Created: 10 Jul 2021 2:18:44pm
+    Author:  Ryan Challinor
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#if defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define BESPOKE_SIMD_SSE 1
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#define BESPOKE_SIMD_NEON 1
+#include <arm_neon.h>
+#else
+#include <cmath>
+#endif
+
+//four floats processed together. uses SSE on x86 and NEON on arm, and falls back to plain loops elsewhere.
+//comparisons return a mask with all bits set in the lanes where they are true, for use with Select().
+struct SimdFloat
+{
+   static const int kNumLanes = 4;
+
+#if BESPOKE_SIMD_SSE
+   typedef __m128 Register;
+#elif BESPOKE_SIMD_NEON
+   typedef float32x4_t Register;
+#else
+   struct Register { float v[kNumLanes]; };
+#endif
+
+   SimdFloat() {}
+   SimdFloat(Register value) : mValue(value) {}
+   SimdFloat(float value) : mValue(Broadcast(value).mValue) {}
+
+   static SimdFloat Load(const float* data)
+   {
+#if BESPOKE_SIMD_SSE
+      return _mm_loadu_ps(data);
+#elif BESPOKE_SIMD_NEON
+      return vld1q_f32(data);
+#else
+      Register r;
+      for (int i=0; i<kNumLanes; ++i)
+         r.v[i] = data[i];
+      return r;
+#endif
+   }
+
+   void Store(float* data) const
+   {
+#if BESPOKE_SIMD_SSE
+      _mm_storeu_ps(data, mValue);
+#elif BESPOKE_SIMD_NEON
+      vst1q_f32(data, mValue);
+#else
+      for (int i=0; i<kNumLanes; ++i)
+         data[i] = mValue.v[i];
+#endif
+   }
+
+   static SimdFloat Broadcast(float value)
+   {
+#if BESPOKE_SIMD_SSE
+      return _mm_set1_ps(value);
+#elif BESPOKE_SIMD_NEON
+      return vdupq_n_f32(value);
+#else
+      Register r;
+      for (int i=0; i<kNumLanes; ++i)
+         r.v[i] = value;
+      return r;
+#endif
+   }
+
+   float Sum() const
+   {
+      float lanes[kNumLanes];
+      Store(lanes);
+      return (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+   }
+
+   Register mValue;
+};
+
+#if BESPOKE_SIMD_SSE
+
+inline SimdFloat operator+(SimdFloat a, SimdFloat b) { return _mm_add_ps(a.mValue, b.mValue); }
+inline SimdFloat operator-(SimdFloat a, SimdFloat b) { return _mm_sub_ps(a.mValue, b.mValue); }
+inline SimdFloat operator*(SimdFloat a, SimdFloat b) { return _mm_mul_ps(a.mValue, b.mValue); }
+inline SimdFloat operator/(SimdFloat a, SimdFloat b) { return _mm_div_ps(a.mValue, b.mValue); }
+inline SimdFloat Min(SimdFloat a, SimdFloat b) { return _mm_min_ps(a.mValue, b.mValue); }
+inline SimdFloat Max(SimdFloat a, SimdFloat b) { return _mm_max_ps(a.mValue, b.mValue); }
+inline SimdFloat Abs(SimdFloat a) { return _mm_andnot_ps(_mm_set1_ps(-0.0f), a.mValue); }
+inline SimdFloat operator>(SimdFloat a, SimdFloat b) { return _mm_cmpgt_ps(a.mValue, b.mValue); }
+inline SimdFloat operator<(SimdFloat a, SimdFloat b) { return _mm_cmplt_ps(a.mValue, b.mValue); }
+inline SimdFloat Select(SimdFloat mask, SimdFloat ifTrue, SimdFloat ifFalse) { return _mm_or_ps(_mm_and_ps(mask.mValue, ifTrue.mValue), _mm_andnot_ps(mask.mValue, ifFalse.mValue)); }
+inline SimdFloat Floor(SimdFloat a)
+{
+   //SSE2 has no floor, so truncate and step down for negative values that weren't already whole
+   __m128 truncated = _mm_cvtepi32_ps(_mm_cvttps_epi32(a.mValue));
+   return _mm_sub_ps(truncated, _mm_and_ps(_mm_cmpgt_ps(truncated, a.mValue), _mm_set1_ps(1)));
+}
+//for positive normal values: returns the mantissa in [1,2), and puts the power of two in exponent
+inline SimdFloat SplitExponent(SimdFloat a, SimdFloat& exponent)
+{
+   __m128i bits = _mm_castps_si128(a.mValue);
+   exponent = _mm_cvtepi32_ps(_mm_sub_epi32(_mm_srli_epi32(bits, 23), _mm_set1_epi32(127)));
+   return _mm_castsi128_ps(_mm_or_si128(_mm_and_si128(bits, _mm_set1_epi32(0x007fffff)), _mm_set1_epi32(0x3f800000)));
+}
+//2^n for whole numbers n in [-126,127]
+inline SimdFloat Pow2Whole(SimdFloat n)
+{
+   return _mm_castsi128_ps(_mm_slli_epi32(_mm_add_epi32(_mm_cvttps_epi32(n.mValue), _mm_set1_epi32(127)), 23));
+}
+
+#elif BESPOKE_SIMD_NEON
+
+inline SimdFloat operator+(SimdFloat a, SimdFloat b) { return vaddq_f32(a.mValue, b.mValue); }
+inline SimdFloat operator-(SimdFloat a, SimdFloat b) { return vsubq_f32(a.mValue, b.mValue); }
+inline SimdFloat operator*(SimdFloat a, SimdFloat b) { return vmulq_f32(a.mValue, b.mValue); }
+#if defined(__aarch64__) || defined(_M_ARM64)
+inline SimdFloat operator/(SimdFloat a, SimdFloat b) { return vdivq_f32(a.mValue, b.mValue); }
+#else
+inline SimdFloat operator/(SimdFloat a, SimdFloat b)
+{
+   float32x4_t reciprocal = vrecpeq_f32(b.mValue);
+   reciprocal = vmulq_f32(vrecpsq_f32(b.mValue, reciprocal), reciprocal);
+   reciprocal = vmulq_f32(vrecpsq_f32(b.mValue, reciprocal), reciprocal);
+   return vmulq_f32(a.mValue, reciprocal);
+}
+#endif
+inline SimdFloat Min(SimdFloat a, SimdFloat b) { return vminq_f32(a.mValue, b.mValue); }
+inline SimdFloat Max(SimdFloat a, SimdFloat b) { return vmaxq_f32(a.mValue, b.mValue); }
+inline SimdFloat Abs(SimdFloat a) { return vabsq_f32(a.mValue); }
+inline SimdFloat operator>(SimdFloat a, SimdFloat b) { return vreinterpretq_f32_u32(vcgtq_f32(a.mValue, b.mValue)); }
+inline SimdFloat operator<(SimdFloat a, SimdFloat b) { return vreinterpretq_f32_u32(vcltq_f32(a.mValue, b.mValue)); }
+inline SimdFloat Select(SimdFloat mask, SimdFloat ifTrue, SimdFloat ifFalse) { return vbslq_f32(vreinterpretq_u32_f32(mask.mValue), ifTrue.mValue, ifFalse.mValue); }
+inline SimdFloat Floor(SimdFloat a)
+{
+   float32x4_t truncated = vcvtq_f32_s32(vcvtq_s32_f32(a.mValue));
+   uint32x4_t needsStep = vcgtq_f32(truncated, a.mValue);
+   return vsubq_f32(truncated, vreinterpretq_f32_u32(vandq_u32(needsStep, vreinterpretq_u32_f32(vdupq_n_f32(1)))));
+}
+inline SimdFloat SplitExponent(SimdFloat a, SimdFloat& exponent)
+{
+   uint32x4_t bits = vreinterpretq_u32_f32(a.mValue);
+   exponent = vcvtq_f32_s32(vsubq_s32(vreinterpretq_s32_u32(vshrq_n_u32(bits, 23)), vdupq_n_s32(127)));
+   return vreinterpretq_f32_u32(vorrq_u32(vandq_u32(bits, vdupq_n_u32(0x007fffff)), vdupq_n_u32(0x3f800000)));
+}
+inline SimdFloat Pow2Whole(SimdFloat n)
+{
+   return vreinterpretq_f32_s32(vshlq_n_s32(vaddq_s32(vcvtq_s32_f32(n.mValue), vdupq_n_s32(127)), 23));
+}
+
+#else
+
+namespace SimdFloatDetail
+{
+   template<class Op>
+   inline SimdFloat Apply(SimdFloat a, SimdFloat b, Op op)
+   {
+      SimdFloat::Register r;
+      for (int i=0; i<SimdFloat::kNumLanes; ++i)
+         r.v[i] = op(a.mValue.v[i], b.mValue.v[i]);
+      return r;
+   }
+
+   inline float Mask(bool condition)
+   {
+      union { unsigned int i; float f; } bits;
+      bits.i = condition ? 0xffffffff : 0;
+      return bits.f;
+   }
+
+   inline bool IsSet(float mask)
+   {
+      union { unsigned int i; float f; } bits;
+      bits.f = mask;
+      return bits.i != 0;
+   }
+}
+
+inline SimdFloat operator+(SimdFloat a, SimdFloat b) { return SimdFloatDetail::Apply(a, b, [](float x, float y) { return x + y; }); }
+inline SimdFloat operator-(SimdFloat a, SimdFloat b) { return SimdFloatDetail::Apply(a, b, [](float x, float y) { return x - y; }); }
+inline SimdFloat operator*(SimdFloat a, SimdFloat b) { return SimdFloatDetail::Apply(a, b, [](float x, float y) { return x * y; }); }
+inline SimdFloat operator/(SimdFloat a, SimdFloat b) { return SimdFloatDetail::Apply(a, b, [](float x, float y) { return x / y; }); }
+inline SimdFloat Min(SimdFloat a, SimdFloat b) { return SimdFloatDetail::Apply(a, b, [](float x, float y) { return x < y ? x : y; }); }
+inline SimdFloat Max(SimdFloat a, SimdFloat b) { return SimdFloatDetail::Apply(a, b, [](float x, float y) { return x > y ? x : y; }); }
+inline SimdFloat Abs(SimdFloat a) { return SimdFloatDetail::Apply(a, a, [](float x, float) { return std::fabs(x); }); }
+inline SimdFloat operator>(SimdFloat a, SimdFloat b) { return SimdFloatDetail::Apply(a, b, [](float x, float y) { return SimdFloatDetail::Mask(x > y); }); }
+inline SimdFloat operator<(SimdFloat a, SimdFloat b) { return SimdFloatDetail::Apply(a, b, [](float x, float y) { return SimdFloatDetail::Mask(x < y); }); }
+inline SimdFloat Select(SimdFloat mask, SimdFloat ifTrue, SimdFloat ifFalse)
+{
+   SimdFloat::Register r;
+   for (int i=0; i<SimdFloat::kNumLanes; ++i)
+      r.v[i] = SimdFloatDetail::IsSet(mask.mValue.v[i]) ? ifTrue.mValue.v[i] : ifFalse.mValue.v[i];
+   return r;
+}
+inline SimdFloat Floor(SimdFloat a) { return SimdFloatDetail::Apply(a, a, [](float x, float) { return std::floor(x); }); }
+inline SimdFloat SplitExponent(SimdFloat a, SimdFloat& exponent)
+{
+   SimdFloat::Register mantissa;
+   for (int i=0; i<SimdFloat::kNumLanes; ++i)
+   {
+      int power;
+      mantissa.v[i] = std::frexp(a.mValue.v[i], &power) * 2;
+      exponent.mValue.v[i] = float(power - 1);
+   }
+   return mantissa;
+}
+inline SimdFloat Pow2Whole(SimdFloat n) { return SimdFloatDetail::Apply(n, n, [](float x, float) { return std::ldexp(1.0f, int(x)); }); }
+
+#endif
+
+inline SimdFloat Clamp(SimdFloat a, SimdFloat low, SimdFloat high) { return Min(Max(a, low), high); }
+
+//x - floor(x/period)*period, so the result is always in [0,period) like a positive fmod
+inline SimdFloat Wrap(SimdFloat a, float period)
+{
+   return a - Floor(a * (1.0f / period)) * period;
+}
+
+//sin() for any phase, using a 9th order polynomial on the folded range [-pi/2,pi/2]. accurate to about 4e-6.
+inline SimdFloat FastSin(SimdFloat phase)
+{
+   const float kPi = 3.14159265358979323846f;
+   const float kTwoPi = 6.28318530717958647693f;
+   SimdFloat x = Wrap(phase + kPi, kTwoPi) - kPi;   //[-pi,pi)
+   x = Max(Min(x, SimdFloat(kPi) - x), SimdFloat(-kPi) - x);   //[-pi/2,pi/2], mirrored so sin is unchanged
+   SimdFloat x2 = x * x;
+   SimdFloat poly = SimdFloat(1.0f / 362880) * x2 + (-1.0f / 5040);
+   poly = poly * x2 + (1.0f / 120);
+   poly = poly * x2 + (-1.0f / 6);
+   poly = poly * x2 + 1;
+   return poly * x;
+}
+
+//log2() for positive values, from the exponent bits and the atanh series on the mantissa. accurate to about 2e-5.
+inline SimdFloat FastLog2(SimdFloat a)
+{
+   const float kInvLn2 = 1.44269504088896340736f;
+   SimdFloat exponent;
+   SimdFloat mantissa = SplitExponent(a, exponent);   //[1,2)
+   SimdFloat t = (mantissa - 1) / (mantissa + 1);   //[0,1/3)
+   SimdFloat t2 = t * t;
+   SimdFloat poly = SimdFloat(2 * kInvLn2 / 7) * t2 + (2 * kInvLn2 / 5);
+   poly = poly * t2 + (2 * kInvLn2 / 3);
+   poly = poly * t2 + (2 * kInvLn2);
+   return exponent + poly * t;
+}
+
+//2^x, from a whole power of two and a 5th order polynomial on the remainder. relative error about 3e-6, with x clamped to [-126,126].
+inline SimdFloat FastExp2(SimdFloat x)
+{
+   const float kLn2 = 0.69314718055994530942f;
+   x = Clamp(x, -126.0f, 126.0f);
+   SimdFloat whole = Floor(x + .5f);
+   SimdFloat f = (x - whole) * kLn2;   //[-ln2/2,ln2/2]
+   SimdFloat poly = SimdFloat(1.0f / 120) * f + (1.0f / 24);
+   poly = poly * f + (1.0f / 6);
+   poly = poly * f + .5f;
+   poly = poly * f + 1;
+   poly = poly * f + 1;
+   return Pow2Whole(whole) * poly;
+}
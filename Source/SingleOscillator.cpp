@@ -73,6 +73,7 @@ SingleOscillator::SingleOscillator()
    mVoiceParams.mVelToEnvelope = 0;
    mVoiceParams.mSoften = 0;
    mVoiceParams.mLiteCPUMode = false;
+   mVoiceParams.mBandLimited = false;
    
    mPolyMgr.Init(kVoiceType_SingleOscillator, &mVoiceParams);
 }
@@ -109,6 +110,7 @@ void SingleOscillator::CreateUIControls()
    FLOATSLIDER(mUnisonWidthSlider, "width", &mVoiceParams.mUnisonWidth, 0, 1);
    FLOATSLIDER_DIGITS(mLengthMultiplierSlider, "adsr len", &mLengthMultiplier, .01f, 10, 1);
    CHECKBOX(mLiteCPUModeCheckbox, "lite cpu", &mVoiceParams.mLiteCPUMode);
+   CHECKBOX(mBandLimitedCheckbox, "band limit", &mVoiceParams.mBandLimited);
    ENDUIBLOCK(width, height);
    mWidth = MAX(width, mWidth);
    mHeight = MAX(height, mHeight);
@@ -174,7 +176,7 @@ void SingleOscillator::Process(double time)
    
    mNoteInputBuffer.Process(time);
    
-   ComputeSliders(0);
+   ComputeSliderBlocks();   //the voices only recompute the modulated sliders per sample
    
    int bufferSize = target->GetBuffer()->BufferSize();
    assert(bufferSize == gBufferSize);
@@ -273,6 +275,7 @@ void SingleOscillator::DrawModule()
    mMultSelector->Draw();
    mSoftenSlider->Draw();
    mLiteCPUModeCheckbox->Draw();
+   mBandLimitedCheckbox->Draw();
    
    {
       ofPushStyle();
@@ -106,6 +106,7 @@ private:
    FloatSlider* mVelToVolumeSlider;
    FloatSlider* mVelToEnvelopeSlider;
    Checkbox* mLiteCPUModeCheckbox;
+   Checkbox* mBandLimitedCheckbox;
    
    FloatSlider* mFilterCutoffMaxSlider;
    FloatSlider* mFilterCutoffMinSlider;
@@ -31,9 +31,23 @@
 #include "ChannelBuffer.h"
 
 SingleOscillatorVoice::SingleOscillatorVoice(IDrawableModule* owner)
-: mUseFilter(false)
+: mOsc(kOsc_Square)
+, mUnisonInputsValid(false)
+, mUseFilter(false)
+, mJumpFilterCoefficients(true)
 , mOwner(owner)
 {
+   for (int u=0; u<kMaxUnison; ++u)
+   {
+      mPhase[u] = 0;
+      mSyncPhase[u] = 0;
+      mDetuneFactor[u] = 0;
+      mPhaseInc[u] = 0;
+      mPhaseOffset[u] = 0;
+      mUnisonGain[u] = 0;
+      mLeftPanGain[u] = 0;
+      mRightPanGain[u] = 0;
+   }
 }
 
 SingleOscillatorVoice::~SingleOscillatorVoice()
@@ -52,138 +66,242 @@ bool SingleOscillatorVoice::Process(double time, ChannelBuffer* out, int oversam
    if (IsDone(time))
       return false;
    
-   for (int u=0; u<mVoiceParams->mUnison && u<kMaxUnison; ++u)
-      mOscData[u].mOsc.SetType(mVoiceParams->mOscType);
+   mOsc.SetType(mVoiceParams->mOscType);
+   mUnisonInputsValid = false;   //pick up anything that changed between buffers, like the scale
    
+   switch (mVoiceParams->mOscType)
+   {
+      case kOsc_Sin: ProcessUnison<kOsc_Sin>(time, out); break;
+      case kOsc_Square: ProcessUnison<kOsc_Square>(time, out); break;
+      case kOsc_Tri: ProcessUnison<kOsc_Tri>(time, out); break;
+      case kOsc_Saw: ProcessUnison<kOsc_Saw>(time, out); break;
+      case kOsc_NegSaw: ProcessUnison<kOsc_NegSaw>(time, out); break;
+      default: ProcessUnison<kOsc_Random>(time, out); break;   //uses the scalar Oscillator::Value() for whatever mOsc is set to
+   }
+   
+   return true;
+}
+
+template<OscillatorType kType>
+void SingleOscillatorVoice::ProcessUnison(double time, ChannelBuffer* out)
+{
    bool mono = (out->NumActiveChannels() == 1);
       
    float syncPhaseInc = GetPhaseInc(mVoiceParams->mSyncFreq);
    
-   float pitch;
    float freq;
    float vol;
    
    if (mVoiceParams->mLiteCPUMode)
-      DoParameterUpdate(0, pitch, freq, vol);
+      DoParameterUpdate(0, GetPitch(0), GetPressure(0), freq, vol);
+   
+   //render the voice modulation a chunk at a time instead of evaluating the chains every sample
+   float pitches[kModulationChunkSize];
+   float pressures[kModulationChunkSize];
+   float modWheels[kModulationChunkSize];
+   
+   SimdFloat phase[kNumLaneGroups];
+   SimdFloat syncPhase[kNumLaneGroups];
+   for (int g=0; g<kNumLaneGroups; ++g)
+   {
+      phase[g] = SimdFloat::Load(mPhase + g * SimdFloat::kNumLanes);
+      syncPhase[g] = SimdFloat::Load(mSyncPhase + g * SimdFloat::kNumLanes);
+   }
    
    for (int pos=0; pos<out->BufferSize(); ++pos)
    {
+      int chunkPos = pos % kModulationChunkSize;
+      if (chunkPos == 0)
+      {
+         int chunkLength = MIN(kModulationChunkSize, out->BufferSize() - pos);
+         if (!mVoiceParams->mLiteCPUMode)
+         {
+            GetPitches(pitches, pos, chunkLength);
+            GetPressures(pressures, pos, chunkLength);
+         }
+         if (mUseFilter)
+         {
+            GetModWheels(modWheels, pos, chunkLength);
+            
+            //work out the cutoff at the end of the chunk, and ramp the coefficients there over the chunk
+            double chunkEndTime = time + (chunkLength - 1) * gInvSampleRateMs;
+            float f = ofLerp(mVoiceParams->mFilterCutoffMin, mVoiceParams->mFilterCutoffMax, mFilterAdsr.Value(chunkEndTime)) * (1 - modWheels[chunkLength - 1] * .9f);
+            float q = mVoiceParams->mFilterQ;
+            if (f != mFilterCoefficients.mF || q != mFilterCoefficients.mQ)
+               mFilterCoefficients.SetFilterParams(f, q);
+            mFilter.SetTargetAllLanes(0, mFilterCoefficients);
+            mFilter.StartRamp(mJumpFilterCoefficients ? 0 : chunkLength);
+            mJumpFilterCoefficients = false;
+         }
+      }
+      
       if (!mVoiceParams->mLiteCPUMode)
-         DoParameterUpdate(pos, pitch, freq, vol);
+         DoParameterUpdate(pos, pitches[chunkPos], pressures[chunkPos], freq, vol);
       
-      float adsrVal = mAdsr.Value(time);
+      mOsc.SetPulseWidth(mVoiceParams->mPulseWidth);
+      mOsc.SetShuffle(mVoiceParams->mShuffle);
+      mOsc.SetSoften(mVoiceParams->mSoften);
       
-      float summedLeft = 0;
-      float summedRight = 0;
-      for (int u=0; u<mVoiceParams->mUnison && u<kMaxUnison; ++u)
+      SimdFloat amplitude(mAdsr.Value(time) * vol);
+      
+      //lanes past the unison count are silent, so skip any group that's entirely made of them
+      int numLaneGroups = (mVoiceParams->mUnison + SimdFloat::kNumLanes - 1) / SimdFloat::kNumLanes;
+      if (numLaneGroups < 1 || numLaneGroups > kNumLaneGroups)
+         numLaneGroups = kNumLaneGroups;
+      
+      SimdFloat summedLeft(0.0f);
+      SimdFloat summedRight(0.0f);
+      for (int g=0; g<numLaneGroups; ++g)
       {
-         mOscData[u].mOsc.SetPulseWidth(mVoiceParams->mPulseWidth);
-         mOscData[u].mOsc.SetShuffle(mVoiceParams->mShuffle);
-         mOscData[u].mOsc.SetSoften(mVoiceParams->mSoften);
+         int lane = g * SimdFloat::kNumLanes;
+         
+         phase[g] = phase[g] + SimdFloat::Load(mPhaseInc + lane);
+         SimdFloat wrapped = phase[g] > FTWO_PI*2;
+         phase[g] = Select(wrapped, Wrap(phase[g], FTWO_PI*2), phase[g]);
+         syncPhase[g] = Select(wrapped, 0.0f, syncPhase[g]) + syncPhaseInc;
          
+         SimdFloat oscPhase;
+         SimdFloat oscPhaseInc;
+         if (mVoiceParams->mSync)
          {
-            //PROFILER(SingleOscillatorVoice_UpdatePhase);
-            mOscData[u].mPhase += mOscData[u].mCurrentPhaseInc;
-            if (mOscData[u].mPhase == INFINITY)
-            {
-               ofLog() << "Infinite phase. phaseInc:" + ofToString(mOscData[u].mCurrentPhaseInc) + " detune:" + ofToString(mVoiceParams->mDetune) + " freq:" + ofToString(freq) + " pitch:" + ofToString(pitch) + " getpitch:" + ofToString(GetPitch(pos));
-            }
-            else
-            {
-               while (mOscData[u].mPhase > FTWO_PI*2)
-               {
-                  mOscData[u].mPhase -= FTWO_PI*2;
-                  mOscData[u].mSyncPhase = 0;
-               }
-            }
-            mOscData[u].mSyncPhase += syncPhaseInc;
+            oscPhase = syncPhase[g];
+            oscPhaseInc = syncPhaseInc;
          }
-         
-         float sample;
-         
+         else
          {
-            //PROFILER(SingleOscillatorVoice_GetOscValue);
-            if (mVoiceParams->mSync)
-               sample = mOscData[u].mOsc.Value(mOscData[u].mSyncPhase) * adsrVal * vol;
-            else
-               sample = mOscData[u].mOsc.Value(mOscData[u].mPhase + mVoiceParams->mPhaseOffset * (1 + (float(u) / mVoiceParams->mUnison))) * adsrVal * vol;
+            oscPhase = phase[g] + SimdFloat::Load(mPhaseOffset + lane);
+            oscPhaseInc = SimdFloat::Load(mPhaseInc + lane);
          }
          
-         if (u >= 2)
-            sample *= 1 - (mOscData[u].mDetuneFactor * .5f);
+         SimdFloat sample;
+         if (mVoiceParams->mBandLimited)
+            sample = mOsc.BandLimitedValue<kType>(oscPhase, oscPhaseInc);
+         else
+            sample = mOsc.Value<kType>(oscPhase);
+         sample = sample * amplitude * SimdFloat::Load(mUnisonGain + lane);
          
          if (mono)
          {
-            summedLeft += sample;
+            summedLeft = summedLeft + sample;
          }
          else
          {
-            //PROFILER(SingleOscillatorVoice_pan);
-            float unisonPan;
-            if (mVoiceParams->mUnison == 1)
-               unisonPan = 0;
-            else if (u == 0)
-               unisonPan = -1;
-            else if (u == 1)
-               unisonPan = 1;
-            else
-               unisonPan = mOscData[u].mDetuneFactor;
-            float pan = GetPan() + unisonPan * mVoiceParams->mUnisonWidth;
-            summedLeft += sample * GetLeftPanGain(pan);
-            summedRight += sample * GetRightPanGain(pan);
+            summedLeft = summedLeft + sample * SimdFloat::Load(mLeftPanGain + lane);
+            summedRight = summedRight + sample * SimdFloat::Load(mRightPanGain + lane);
          }
       }
       
+      float left = summedLeft.Sum();
+      float right = mono ? 0 : summedRight.Sum();
+      
       if (mUseFilter)
       {
          //PROFILER(SingleOscillatorVoice_filter);
-         float f = ofLerp(mVoiceParams->mFilterCutoffMin, mVoiceParams->mFilterCutoffMax, mFilterAdsr.Value(time)) * (1 - GetModWheel(pos) * .9f);
-         float q = mVoiceParams->mFilterQ;
-         if (f != mFilterLeft.mF || q != mFilterLeft.mQ)
-            mFilterLeft.SetFilterParams(f, q);
-         summedLeft = mFilterLeft.Filter(summedLeft);
-         if (!mono)
-         {
-            mFilterRight.CopyCoeffFrom(mFilterLeft);
-            summedRight = mFilterRight.Filter(summedRight);
-         }
+         float lanes[BiquadBank::kNumLanes] = { left, right, 0, 0 };
+         mFilter.Process(SimdFloat::Load(lanes)).Store(lanes);
+         left = lanes[0];
+         right = lanes[1];
       }
       
       {
          //PROFILER(SingleOscillatorVoice_output);
          if (mono)
          {
-            out->GetChannel(0)[pos] += summedLeft;
+            out->GetChannel(0)[pos] += left;
          }
          else
          {
-            out->GetChannel(0)[pos] += summedLeft;
-            out->GetChannel(1)[pos] += summedRight;
+            out->GetChannel(0)[pos] += left;
+            out->GetChannel(1)[pos] += right;
          }
       }
       time += gInvSampleRateMs;
    }
    
-   return true;
+   for (int g=0; g<kNumLaneGroups; ++g)
+   {
+      phase[g].Store(mPhase + g * SimdFloat::kNumLanes);
+      syncPhase[g].Store(mSyncPhase + g * SimdFloat::kNumLanes);
+   }
+   
+   for (int u=0; u<kMaxUnison; ++u)
+   {
+      if (!std::isfinite(mPhase[u]))
+      {
+         ofLog() << "Infinite phase. phaseInc:" + ofToString(mPhaseInc[u]) + " detune:" + ofToString(mVoiceParams->mDetune) + " freq:" + ofToString(freq) + " pitch:" + ofToString(mUnisonInputs.mPitch) + " getpitch:" + ofToString(GetPitch(0));
+         mPhase[u] = 0;
+      }
+   }
 }
 
 void SingleOscillatorVoice::DoParameterUpdate(int samplesIn,
-                                              float& pitch,
+                                              float pitch,
+                                              float pressure,
                                               float& freq,
                                               float& vol)
 {
    if (mOwner)
-      mOwner->ComputeSliders(samplesIn);
+      mOwner->ComputeModulatedSliders(samplesIn);   //the owner ran ComputeSliderBlocks() at the start of the buffer
    
-   pitch = GetPitch(samplesIn);
-   freq = TheScale->PitchToFreq(pitch) * mVoiceParams->mMult;
    vol = mVoiceParams->mVol * .4f / mVoiceParams->mUnison;
    
-   for (int u=0; u<mVoiceParams->mUnison && u<kMaxUnison; ++u)
+   if (mUnisonInputsValid &&
+       pitch == mUnisonInputs.mPitch &&
+       pressure == mUnisonInputs.mPressure &&
+       mVoiceParams->mMult == mUnisonInputs.mMult &&
+       mVoiceParams->mDetune == mUnisonInputs.mDetune &&
+       mVoiceParams->mUnison == mUnisonInputs.mUnison &&
+       mVoiceParams->mUnisonWidth == mUnisonInputs.mUnisonWidth &&
+       mVoiceParams->mPhaseOffset == mUnisonInputs.mPhaseOffset &&
+       GetPan() == mUnisonInputs.mPan)
    {
-      float detune = exp2(mVoiceParams->mDetune * mOscData[u].mDetuneFactor * (1 - GetPressure(samplesIn)));
-      mOscData[u].mCurrentPhaseInc = GetPhaseInc(freq * detune);
+      freq = mUnisonInputs.mFreq;
+      return;  //nothing the unison voices depend on has moved, skip the PitchToFreq() and exp2()s
    }
+   
+   freq = TheScale->PitchToFreq(pitch) * mVoiceParams->mMult;
+   
+   int unison = MIN(mVoiceParams->mUnison, kMaxUnison);
+   for (int u=0; u<kMaxUnison; ++u)
+   {
+      if (u < unison)
+      {
+         float detune = exp2(mVoiceParams->mDetune * mDetuneFactor[u] * (1 - pressure));
+         mPhaseInc[u] = GetPhaseInc(freq * detune);
+         mPhaseOffset[u] = mVoiceParams->mPhaseOffset * (1 + (float(u) / mVoiceParams->mUnison));
+         mUnisonGain[u] = (u >= 2) ? 1 - (mDetuneFactor[u] * .5f) : 1;
+         
+         float unisonPan;
+         if (mVoiceParams->mUnison == 1)
+            unisonPan = 0;
+         else if (u == 0)
+            unisonPan = -1;
+         else if (u == 1)
+            unisonPan = 1;
+         else
+            unisonPan = mDetuneFactor[u];
+         float pan = GetPan() + unisonPan * mVoiceParams->mUnisonWidth;
+         mLeftPanGain[u] = GetLeftPanGain(pan);
+         mRightPanGain[u] = GetRightPanGain(pan);
+      }
+      else
+      {
+         mPhaseInc[u] = 0;
+         mPhaseOffset[u] = 0;
+         mUnisonGain[u] = 0;
+      }
+   }
+   
+   mUnisonInputs.mPitch = pitch;
+   mUnisonInputs.mPressure = pressure;
+   mUnisonInputs.mMult = mVoiceParams->mMult;
+   mUnisonInputs.mDetune = mVoiceParams->mDetune;
+   mUnisonInputs.mUnison = mVoiceParams->mUnison;
+   mUnisonInputs.mUnisonWidth = mVoiceParams->mUnisonWidth;
+   mUnisonInputs.mPhaseOffset = mVoiceParams->mPhaseOffset;
+   mUnisonInputs.mPan = GetPan();
+   mUnisonInputs.mFreq = freq;
+   mUnisonInputsValid = true;
 }
 
 //static
@@ -203,8 +321,8 @@ void SingleOscillatorVoice::Start(double time, float target)
    if (mVoiceParams->mFilterCutoffMax != SINGLEOSCILLATOR_NO_CUTOFF)
    {
       mUseFilter = true;
-      mFilterLeft.SetFilterType(kFilterType_Lowpass);
-      mFilterRight.SetFilterType(kFilterType_Lowpass);
+      mFilterCoefficients.SetFilterType(kFilterType_Lowpass);
+      mJumpFilterCoefficients = true;
       mFilterAdsr.Start(time, 1, mVoiceParams->mFilterAdsr, adsrScale);
    }
    else
@@ -225,15 +343,15 @@ void SingleOscillatorVoice::ClearVoice()
    mFilterAdsr.Clear();
    for (int u=0; u<kMaxUnison; ++u)
    {
-      mOscData[u].mPhase = 0;
-      mOscData[u].mSyncPhase = 0;
+      mPhase[u] = 0;
+      mSyncPhase[u] = 0;
    }
    
    //set this up so it's different with each fresh voice, but doesn't reset when voice is retriggered
-   mOscData[0].mDetuneFactor = 1;
-   mOscData[1].mDetuneFactor = 0;
+   mDetuneFactor[0] = 1;
+   mDetuneFactor[1] = 0;
    for (int u=2; u<kMaxUnison; ++u)
-      mOscData[u].mDetuneFactor = ofRandom(-1,1);
+      mDetuneFactor[u] = ofRandom(-1,1);
 }
 
 void SingleOscillatorVoice::SetVoiceParams(IVoiceParams* params)
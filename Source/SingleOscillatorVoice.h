@@ -34,6 +34,7 @@
 #include "EnvOscillator.h"
 #include "LFO.h"
 #include "BiquadFilter.h"
+#include "BiquadBank.h"
 
 #define SINGLEOSCILLATOR_NO_CUTOFF 10000
 
@@ -63,6 +64,7 @@ public:
    float mVelToEnvelope;
    
    bool mLiteCPUMode;
+   bool mBandLimited;
 };
 
 class SingleOscillatorVoice : public IMidiVoice
@@ -83,28 +85,54 @@ public:
    
    static const int kMaxUnison = 8;
 private:
+   //4 wide (SSE2/NEON) rather than 8 wide AVX: the build targets baseline x86-64, so AVX would need a second, runtime-dispatched copy of ProcessUnison, and with kMaxUnison at 8 it would only pay off above 4 unison voices
+   static const int kNumLaneGroups = kMaxUnison / SimdFloat::kNumLanes;
+   static const int kModulationChunkSize = 64;
+   static_assert(kMaxUnison % SimdFloat::kNumLanes == 0, "unison voices must fill whole SimdFloats");
+   
+   template<OscillatorType kType> void ProcessUnison(double time, ChannelBuffer* out);
    void DoParameterUpdate(int samplesIn,
-                          float& pitch,
+                          float pitch,
+                          float pressure,
                           float& freq,
                           float& vol);
    
-   struct OscData
+   //per unison voice, laid out so SimdFloat::kNumLanes of them can be processed at once.
+   //voices past mUnison have zero gain.
+   Oscillator mOsc;
+   float mPhase[kMaxUnison];
+   float mSyncPhase[kMaxUnison];
+   float mDetuneFactor[kMaxUnison];
+   float mPhaseInc[kMaxUnison];
+   float mPhaseOffset[kMaxUnison];
+   float mUnisonGain[kMaxUnison];
+   float mLeftPanGain[kMaxUnison];
+   float mRightPanGain[kMaxUnison];
+   
+   //what the values above were last computed from, so they're only recomputed when something moves
+   struct UnisonInputs
    {
-      OscData() : mPhase(0), mSyncPhase(0), mOsc(kOsc_Square), mDetuneFactor(0) {}
-      float mPhase;
-      float mSyncPhase;
-      Oscillator mOsc;
-      float mDetuneFactor;
-      float mCurrentPhaseInc;
+      float mPitch;
+      float mPressure;
+      float mMult;
+      float mDetune;
+      int mUnison;
+      float mUnisonWidth;
+      float mPhaseOffset;
+      float mPan;
+      float mFreq;
    };
-   OscData mOscData[kMaxUnison];
+   UnisonInputs mUnisonInputs;
+   bool mUnisonInputsValid;
+   
    ::ADSR mAdsr;
    OscillatorVoiceParams* mVoiceParams;
    
    ::ADSR mFilterAdsr;
-   BiquadFilter mFilterLeft;
-   BiquadFilter mFilterRight;
+   BiquadFilter mFilterCoefficients;
+   BiquadBank mFilter;   //left and right in the first two lanes
    bool mUseFilter;
+   bool mJumpFilterCoefficients;
    
    IDrawableModule* mOwner;
 };
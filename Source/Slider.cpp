@@ -65,6 +65,7 @@ FloatSlider::FloatSlider(IFloatSliderListener* owner, const char* label, int x,
 , mComputeHasBeenCalledOnce(false)
 , mLastComputeTime(0)
 , mLastComputeSamplesIn(0)
+, mBlockTime(-1)
 , mLastDisplayedValue(FLT_MAX)
 , mFloatEntry(nullptr)
 , mAllowMinMaxAdjustment(true)
@@ -76,8 +77,7 @@ FloatSlider::FloatSlider(IFloatSliderListener* owner, const char* label, int x,
    SetPosition(x,y);
    (dynamic_cast<IDrawableModule*>(owner))->AddUIControl(this);
    SetParent(dynamic_cast<IClickable*>(owner));
-   mLastComputeCacheTime = new double[gBufferSize];
-   mLastComputeCacheValue = new float[gBufferSize];
+   mBlockValues = new float[gBufferSize];
 }
 
 FloatSlider::FloatSlider(IFloatSliderListener* owner, const char* label, IUIControl* anchor, AnchorDirection anchorDir, int w, int h, float* var, float min, float max, int digits /* = -1 */)
@@ -90,6 +90,7 @@ FloatSlider::~FloatSlider()
 {
    if (mIsSmoothing)
       TheTransport->RemoveAudioPoller(this);
+   delete[] mBlockValues;
 }
 
 void FloatSlider::Init()
@@ -630,14 +631,18 @@ void FloatSlider::Compute(int samplesIn /*= 0*/)
 
    float oldVal = *mVar;
 
-   static bool sUseCache = true;
-   if (sUseCache && samplesIn >= 0 && samplesIn < gBufferSize && mLastComputeCacheTime[samplesIn] == gTime)
+   bool modulated = mModulator && mModulator->Active();
+   bool inBlock = samplesIn >= 0 && samplesIn < gBufferSize;
+   if (inBlock && (modulated || mIsSmoothing) && (samplesIn > 0 || mBlockTime == gTime))
    {
-      *mVar = mLastComputeCacheValue[samplesIn];
+      //we're being computed per sample, so render the whole buffer once and look the values up from then on
+      if (mBlockTime != gTime)
+         ComputeBlock(modulated);
+      *mVar = mBlockValues[samplesIn];
    }
    else
    {
-      if (mModulator && mModulator->Active())
+      if (modulated)
       {
          if (mIsSmoothing)
             mSmoothTarget = mModulator->Value(samplesIn);
@@ -647,18 +652,48 @@ void FloatSlider::Compute(int samplesIn /*= 0*/)
 
       if (mIsSmoothing)
          *mVar = mRamp.Value(gTime + samplesIn * gInvSampleRateMs);
-
-      if (samplesIn >= 0 && samplesIn < gBufferSize && mLastComputeCacheTime[samplesIn] == gTime)
-      {
-         mLastComputeCacheValue[samplesIn] = *mVar;
-         mLastComputeCacheTime[samplesIn] = gTime;
-      }
    }
 
    if (oldVal != *mVar)
       mOwner->FloatSliderUpdated(this, oldVal);
 }
 
+bool FloatSlider::ComputeForBlock()
+{
+   bool modulated = mModulator && mModulator->Active();
+   bool lowRes = mLFOControl && mLFOControl->Active() && mLFOControl->InLowResMode();
+   if ((!modulated && !mIsSmoothing) || lowRes)
+   {
+      Compute(0);
+      return false;
+   }
+
+   if (mBlockTime != gTime)
+      ComputeBlock(modulated);
+   Compute(0);
+   return true;
+}
+
+bool FloatSlider::IsModulated() const
+{
+   return (mModulator && mModulator->Active()) || mIsSmoothing;
+}
+
+void FloatSlider::ComputeBlock(bool modulated)
+{
+   mBlockTime = gTime;  //mark this first, so a modulation loop back into this slider reads stale values instead of recursing
+
+   if (modulated)
+   {
+      mModulator->FillBlock(mBlockValues, gBufferSize);
+      if (mIsSmoothing)
+         mSmoothTarget = mBlockValues[gBufferSize - 1];
+   }
+
+   if (mIsSmoothing)
+      mRamp.FillBuffer(mBlockValues, gBufferSize, gTime, gInvSampleRateMs);
+}
+
 float* FloatSlider::GetModifyValue()
 {
    if (!TheSynth->IsLoadingModule() && mModulator && mModulator->Active() && mModulator->CanAdjustRange())
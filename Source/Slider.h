@@ -55,6 +55,7 @@ public:
    bool IsMouseDown() const override { return mMouseDown; }
    void SetExtents(float min, float max) { mMin = min; mMax = max; }
    void Compute(int samplesIn = 0);
+   bool ComputeForBlock();   //Compute(0), rendering the whole buffer if we can change partway through it. returns whether we can.
    void DisplayLFOControl();
    void DisableLFO();
    FloatSliderLFOControl* GetLFO() { return mLFOControl; }
@@ -72,6 +73,7 @@ public:
    void SetBezierControl(float control) { mBezierControl = control; }
    void SetModulator(IModulator* modulator);
    IModulator* GetModulator() { return mModulator; }
+   bool IsModulated() const;
    float& GetModulatorMin() { return mModulatorMin; }
    float& GetModulatorMax() { return mModulatorMax; }
    void OnTransportAdvanced(float amount) override;
@@ -118,6 +120,7 @@ private:
    float ValToPos(float val, bool ignoreSmooth) const;
    bool AdjustSmooth() const;
    void SmoothUpdated();
+   void ComputeBlock(bool modulated);
    
    int mWidth;
    int mHeight;
@@ -151,8 +154,8 @@ private:
    bool mComputeHasBeenCalledOnce;
    double mLastComputeTime;
    int mLastComputeSamplesIn;
-   double* mLastComputeCacheTime;
-   float* mLastComputeCacheValue;
+   double mBlockTime;
+   float* mBlockValues;   //this buffer's values, rendered all at once when we're computed per sample
    
    float mLastDisplayedValue;
    
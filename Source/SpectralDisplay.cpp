@@ -39,14 +39,8 @@ SpectralDisplay::SpectralDisplay()
 : IAudioProcessor(gBufferSize)
 , mWidth(400)
 , mHeight(100)
-, mFFT(kNumFFTBins)
-, mFFTData(kNumFFTBins, kNumFFTBins/2+1)
-, mRollingInputBuffer(kNumFFTBins)
+, mAnalysis(kNumFFTBins, kNumFFTBins/4)
 {
-   // Generate a window with a single raised cosine from N/4 to 3N/4
-   mWindower = new float[kNumFFTBins];
-   for (int i=0; i<kNumFFTBins; ++i)
-      mWindower[i] = -.5f*cos(FTWO_PI*i/kNumFFTBins)+.5f;
    mSmoother = new float[kNumFFTBins/2+1-kBinIgnore];
    for (int i=0; i<kNumFFTBins/2+1-kBinIgnore; ++i)
       mSmoother[i] = 0;
@@ -59,7 +53,6 @@ void SpectralDisplay::CreateUIControls()
 
 SpectralDisplay::~SpectralDisplay()
 {
-   delete[] mWindower;
    delete[] mSmoother;
 }
 
@@ -90,15 +83,8 @@ void SpectralDisplay::Process(double time)
       }
    }
    
-   mRollingInputBuffer.WriteChunk(gWorkBuffer, GetBuffer()->BufferSize(), 0);
-   
-   //copy rolling input buffer into working buffer and window it
-   mRollingInputBuffer.ReadChunk(mFFTData.mTimeDomain, kNumFFTBins, 0, 0);
-   Mult(mFFTData.mTimeDomain, mWindower, kNumFFTBins);
-   
-   mFFT.Forward(mFFTData.mTimeDomain,
-                mFFTData.mRealValues,
-                mFFTData.mImaginaryValues);
+   //the display only ever shows the newest spectrum
+   mAnalysis.WriteLatest(gWorkBuffer, GetBuffer()->BufferSize());
       
    GetBuffer()->Reset();
 }
@@ -123,7 +109,7 @@ void SpectralDisplay::DrawModule()
    for (int i=kBinIgnore; i<end; i++)
    {
       float x = sqrtf(float(i-kBinIgnore)/(end-kBinIgnore-1)) * w;
-      float samp = sqrtf(fabsf(mFFTData.mRealValues[i]) / end) * 3;
+      float samp = sqrtf(fabsf(mAnalysis.GetFrame().mRealValues[i]) / end) * 3;
       float y = ofClamp(samp, 0, 1) * h;
       ofVertex(x, h-y);
       
@@ -31,8 +31,7 @@
 #include "IAudioProcessor.h"
 #include "IDrawableModule.h"
 #include "Slider.h"
-#include "FFT.h"
-#include "RollingBuffer.h"
+#include "Stft.h"
 
 class SpectralDisplay : public IAudioProcessor, public IDrawableModule, public IFloatSliderListener
 {
@@ -66,11 +65,8 @@ private:
    float mWidth;
    float mHeight;
    
-   float* mWindower;
    float* mSmoother;
 
-   ::FFT mFFT;
-   FFTData mFFTData;
-   RollingBuffer mRollingInputBuffer;
+   StftAnalysis mAnalysis;
 };
 
@@ -0,0 +1,155 @@
+/**
+    bespoke synth, a software modular synthesizer
+    Copyright (C) 2021 Ryan Challinor (contact: awwbees@gmail.com)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**/
+/*
+  ==============================================================================
+
+    Stft.cpp
+    Created: 18 Jul 2021 11:02:47am
+    Author:  Ryan Challinor
+
+  ==============================================================================
+*/
+
+#include "Stft.h"
+
+namespace
+{
+   void MakeWindow(vector<float>& window, int size, StftWindowType type)
+   {
+      window.resize(size);
+      for (int i=0; i<size; ++i)
+      {
+         if (type == kStftWindow_Hann)
+            window[i] = -.5*cos(FTWO_PI*i/size)+.5;
+         else
+            window[i] = 1;
+      }
+   }
+}
+
+StftAnalysis::StftAnalysis(int windowSize, int hopSize, StftWindowType window)
+: mWindowSize(windowSize)
+, mHopSize(hopSize)
+, mNumBuffered(0)
+, mInput(windowSize)
+, mFFT(windowSize)
+, mFrame(windowSize, windowSize/2 + 1)
+, mFrameIndex(0)
+{
+   assert(hopSize > 0 && hopSize <= windowSize);
+   MakeWindow(mWindow, windowSize, window);
+}
+
+void StftAnalysis::SetHopSize(int hopSize)
+{
+   assert(hopSize > 0 && hopSize <= mWindowSize);
+   mHopSize = hopSize;
+   mNumBuffered = MIN(mNumBuffered, mHopSize - 1);
+}
+
+bool StftAnalysis::Write(const float* input, int numSamples, float gain)
+{
+   return Write(input, numSamples, gain, true);
+}
+
+bool StftAnalysis::WriteLatest(const float* input, int numSamples, float gain)
+{
+   bool analyzed = false;
+   for (int pos=0; pos<numSamples;)
+   {
+      int segment = MIN(numSamples - pos, SamplesUntilFrame());
+      bool isLastFrame = numSamples - pos - segment < mHopSize;
+      analyzed |= Write(input + pos, segment, gain, isLastFrame);
+      pos += segment;
+   }
+   return analyzed;
+}
+
+bool StftAnalysis::Write(const float* input, int numSamples, float gain, bool analyze)
+{
+   assert(numSamples <= SamplesUntilFrame());
+   
+   float* dest = mInput.data() + mWindowSize - mHopSize + mNumBuffered;
+   BufferCopy(dest, input, numSamples);
+   if (gain != 1)
+      Mult(dest, gain, numSamples);
+   mNumBuffered += numSamples;
+   
+   if (mNumBuffered < mHopSize)
+      return false;
+   
+   if (analyze)
+   {
+      BufferCopy(mFrame.mTimeDomain, mInput.data(), mWindowSize);
+      Mult(mFrame.mTimeDomain, mWindow.data(), mWindowSize);
+      mFFT.Forward(mFrame.mTimeDomain, mFrame.mRealValues, mFrame.mImaginaryValues);
+      ++mFrameIndex;
+   }
+   
+   memmove(mInput.data(), mInput.data() + mHopSize, (mWindowSize - mHopSize) * sizeof(float));
+   mNumBuffered = 0;
+   return analyze;
+}
+
+StftSynthesis::StftSynthesis(int windowSize, int hopSize, StftWindowType window)
+: mWindowSize(windowSize)
+, mHopSize(hopSize)
+, mReadPos(0)
+, mOutput(windowSize)
+, mFFT(windowSize)
+{
+   assert(hopSize > 0 && hopSize <= windowSize);
+   MakeWindow(mWindow, windowSize, window);
+}
+
+void StftSynthesis::SetHopSize(int hopSize)
+{
+   assert(hopSize > 0 && hopSize <= mWindowSize);
+   mHopSize = hopSize;
+   mReadPos = MIN(mReadPos, mHopSize);
+}
+
+void StftSynthesis::AddFrame(FFTData& frame, float gain)
+{
+   //the hop that was just read out is done, so slide everything along to make room for the new frame's tail
+   memmove(mOutput.data(), mOutput.data() + mHopSize, (mWindowSize - mHopSize) * sizeof(float));
+   Clear(mOutput.data() + mWindowSize - mHopSize, mHopSize);
+   mReadPos = 0;
+   
+   mFFT.Inverse(frame.mRealValues, frame.mImaginaryValues, frame.mTimeDomain);
+   Mult(frame.mTimeDomain, mWindow.data(), mWindowSize);
+   if (gain != 1)
+      Mult(frame.mTimeDomain, gain, mWindowSize);
+   Add(mOutput.data(), frame.mTimeDomain, mWindowSize);
+}
+
+void StftSynthesis::Read(float* output, int numSamples)
+{
+   assert(mReadPos + numSamples <= mHopSize);
+   BufferCopy(output, mOutput.data() + mReadPos, numSamples);
+   mReadPos += numSamples;
+}
+
+float StftSynthesis::GetUnityGain() const
+{
+   //the inverse transform scales by the window size, and every output sample is covered by windowSize/hopSize overlapping squared windows
+   float windowEnergy = 0;
+   for (int i=0; i<mWindowSize; ++i)
+      windowEnergy += mWindow[i] * mWindow[i];
+   return mHopSize / (windowEnergy * mWindowSize);
+}
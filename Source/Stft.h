@@ -0,0 +1,95 @@
+/**
+    bespoke synth, a software modular synthesizer
+    Copyright (C) 2021 Ryan Challinor (contact: awwbees@gmail.com)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**/
+/*
+  ==============================================================================
+
+    Stft.h
+    Created: 18 Jul 2021 11:02:47am
+    Author:  Ryan Challinor
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include "FFT.h"
+
+enum StftWindowType
+{
+   kStftWindow_Hann,
+   kStftWindow_Rectangular
+};
+
+//the analysis half of a short time fourier transform. input is collected a hop at a time, and each full hop windows and transforms the latest windowSize samples.
+//the frame stays put until the next hop, so any number of consumers can read the same analysis.
+class StftAnalysis
+{
+public:
+   StftAnalysis(int windowSize, int hopSize, StftWindowType window = kStftWindow_Hann);
+   
+   void SetHopSize(int hopSize);
+   int GetWindowSize() const { return mWindowSize; }
+   int GetHopSize() const { return mHopSize; }
+   int SamplesUntilFrame() const { return mHopSize - mNumBuffered; }
+   
+   //takes up to SamplesUntilFrame() samples, scaled by gain. returns true if that completed a hop and produced a new frame.
+   bool Write(const float* input, int numSamples, float gain = 1);
+   //takes any number of samples, but only transforms the last frame they complete. for consumers that only look at the latest spectrum.
+   bool WriteLatest(const float* input, int numSamples, float gain = 1);
+   
+   //the latest frame, in the FFT::Forward() layout. consumers may change it in place, e.g. before passing it to StftSynthesis::AddFrame().
+   FFTData& GetFrame() { return mFrame; }
+   uint64_t GetFrameIndex() const { return mFrameIndex; }
+   
+private:
+   bool Write(const float* input, int numSamples, float gain, bool analyze);
+   
+   int mWindowSize;
+   int mHopSize;
+   int mNumBuffered;
+   vector<float> mWindow;
+   vector<float> mInput;   //the latest windowSize samples, oldest first
+   ::FFT mFFT;
+   FFTData mFrame;
+   uint64_t mFrameIndex;
+};
+
+//the resynthesis half. frames are inverse transformed, windowed and overlap-added, and the finished output is read out a hop at a time.
+//read each hop before writing the matching input to StftAnalysis, and the output trails the input by windowSize samples.
+class StftSynthesis
+{
+public:
+   StftSynthesis(int windowSize, int hopSize, StftWindowType window = kStftWindow_Hann);
+   
+   void SetHopSize(int hopSize);
+   
+   //takes a frame in the FFT::Inverse() layout. overwrites the frame's time domain buffer.
+   void AddFrame(FFTData& frame, float gain);
+   void Read(float* output, int numSamples);
+   
+   //the AddFrame() gain that brings an untouched analysis frame back out at its original level
+   float GetUnityGain() const;
+   
+private:
+   int mWindowSize;
+   int mHopSize;
+   int mReadPos;
+   vector<float> mWindow;
+   vector<float> mOutput;   //overlap-add accumulator, the next mHopSize samples are finished
+   ::FFT mFFT;
+};
@@ -63,8 +63,8 @@ RetinaTrueTypeFont gFontFixedWidth;
 float gModuleDrawAlpha = 255;
 float gNullBuffer[kWorkBufferSize];
 float gZeroBuffer[kWorkBufferSize];
-float gWorkBuffer[kWorkBufferSize];
-ChannelBuffer gWorkChannelBuffer(kWorkBufferSize);
+thread_local float gWorkBuffer[kWorkBufferSize];
+thread_local ChannelBuffer gWorkChannelBuffer(kWorkBufferSize);
 IDrawableModule* gHoveredModule = nullptr;
 IUIControl* gHoveredUIControl = nullptr;
 IUIControl* gHotBindUIControl[10];
@@ -74,7 +74,7 @@ bool gShowDevModules = false;
 float gCornerRoundness = 1;
 
 std::random_device gRandomDevice;
-std::mt19937 gRandom(gRandomDevice());
+thread_local ThreadRandom gRandom;
 
 void SynthInit()
 {
@@ -262,6 +262,26 @@ void Clear(float* buffer, int bufferSize)
 #endif
 }
 
+void Fill(float* buffer, float value, int bufferSize)
+{
+#ifdef USE_VECTOR_OPS
+   FloatVectorOperations::fill(buffer, value, bufferSize);
+#else
+   for (int i=0; i<bufferSize; ++i)
+      buffer[i] = value;
+#endif
+}
+
+void Clamp(float* buffer, float min, float max, int bufferSize)
+{
+#ifdef USE_VECTOR_OPS
+   FloatVectorOperations::clip(buffer, buffer, min, max, bufferSize);
+#else
+   for (int i=0; i<bufferSize; ++i)
+      buffer[i] = ofClamp(buffer[i], min, max);
+#endif
+}
+
 void BufferCopy(float* dst, const float* src, int bufferSize)
 {
 #ifdef USE_VECTOR_OPS
@@ -105,8 +105,8 @@ extern RetinaTrueTypeFont gFontFixedWidth;
 extern float gModuleDrawAlpha;
 extern float gNullBuffer[kWorkBufferSize];
 extern float gZeroBuffer[kWorkBufferSize];
-extern float gWorkBuffer[kWorkBufferSize];  //scratch buffer for doing work in
-extern ChannelBuffer gWorkChannelBuffer;
+extern thread_local float gWorkBuffer[kWorkBufferSize];  //scratch buffer for doing work in, one per thread so audio worker threads don't stomp on each other
+extern thread_local ChannelBuffer gWorkChannelBuffer;
 extern IDrawableModule* gHoveredModule;
 extern IUIControl* gHoveredUIControl;
 extern IUIControl* gHotBindUIControl[10];
@@ -115,7 +115,23 @@ extern float gDrawScale;
 extern bool gShowDevModules;
 extern float gCornerRoundness;
 extern std::random_device gRandomDevice;
-extern std::mt19937 gRandom;
+
+//a thread's random generator. audio sources swap in one of their own while they process (see IAudioSource::GetRandom()),
+//so what they generate doesn't depend on which audio worker runs them.
+class ThreadRandom
+{
+public:
+   typedef std::mt19937::result_type result_type;
+   ThreadRandom() : mOwn(gRandomDevice()), mEngine(&mOwn) {}
+   result_type operator()() { return (*mEngine)(); }
+   static constexpr result_type min() { return std::mt19937::min(); }
+   static constexpr result_type max() { return std::mt19937::max(); }
+   void SetEngine(std::mt19937* engine) { mEngine = engine != nullptr ? engine : &mOwn; }
+private:
+   std::mt19937 mOwn;
+   std::mt19937* mEngine;
+};
+extern thread_local ThreadRandom gRandom;
 
 struct GlobalManagers
 {
@@ -170,6 +186,8 @@ void Subtract(float* buff1, const float* buff2, int bufferSize);
 void Mult(float* buff, float val, int bufferSize);
 void Mult(float* buff1, const float* buff2, int bufferSize);
 void Clear(float* buffer, int bufferSize);
+void Fill(float* buffer, float value, int bufferSize);
+void Clamp(float* buffer, float min, float max, int bufferSize);
 void BufferCopy(float* dst, const float* src, int bufferSize);
 string NoteName(int pitch, bool flat=false, bool includeOctave = false);
 int PitchFromNoteName(string noteName);
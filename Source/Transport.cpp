@@ -139,11 +139,8 @@ void Transport::Advance(double ms)
 
    UpdateListeners(ms);
 
-   for (list<IAudioPoller*>::iterator i = mAudioPollers.begin(); i != mAudioPollers.end(); ++i)
-   {
-      IAudioPoller* poller = *i;
+   for (auto* poller : mAudioPollerSnapshot.Get())
       poller->OnTransportAdvanced(amount);
-   }
 }
 
 float QuadraticBezier (float x, float a, float b)
@@ -318,13 +315,22 @@ void Transport::AddAudioPoller(IAudioPoller* poller)
       assert(module->IsInitialized());
 #endif
 
-   if (!ListContains(poller, mAudioPollers))
-      mAudioPollers.push_front(poller);
+   const ScopedLock lock(mAudioPollerLock);
+   if (!VectorContains(poller, mAudioPollers))
+   {
+      mAudioPollers.insert(mAudioPollers.begin(), poller);
+      mAudioPollerSnapshot.Publish(new vector<IAudioPoller*>(mAudioPollers));
+   }
 }
 
 void Transport::RemoveAudioPoller(IAudioPoller* poller)
 {
-   mAudioPollers.remove(poller);
+   const ScopedLock lock(mAudioPollerLock);
+   if (VectorContains(poller, mAudioPollers))
+   {
+      RemoveFromVector(poller, mAudioPollers);
+      mAudioPollerSnapshot.Publish(new vector<IAudioPoller*>(mAudioPollers));
+   }
 }
 
 int Transport::GetQuantized(double time, const TransportListenerInfo* listenerInfo, double* remainderMs /*=nullptr*/)
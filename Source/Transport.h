@@ -33,6 +33,7 @@
 #include "DropdownList.h"
 #include "Checkbox.h"
 #include "IAudioPoller.h"
+#include "AudioThreadEpoch.h"
 
 class ITimeListener
 {
@@ -186,7 +187,9 @@ private:
    int mLoopEndMeasure;
 
    list<TransportListenerInfo> mListeners;
-   list<IAudioPoller*> mAudioPollers;
+   vector<IAudioPoller*> mAudioPollers;
+   AudioThreadSnapshot< vector<IAudioPoller*> > mAudioPollerSnapshot;   //what the audio thread iterates
+   CriticalSection mAudioPollerLock;
 };
 
 extern Transport* TheTransport;
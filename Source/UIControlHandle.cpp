@@ -0,0 +1,53 @@
+/**
+    bespoke synth, a software modular synthesizer
+    Copyright (C) 2021 Ryan Challinor (contact: awwbees@gmail.com)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**/
+/*
+  ==============================================================================
+
+    UIControlHandle.cpp
+    Created: 13 Jul 2021 8:52:40pm
+    Author:  Ryan Challinor
+
+  ==============================================================================
+*/
+
+#include "UIControlHandle.h"
+#include "ModularSynth.h"
+
+UIControlHandle::UIControlHandle()
+: mControl(nullptr)
+, mPathGeneration(-1)
+{
+}
+
+UIControlHandle::UIControlHandle(string path)
+: mPath(path)
+, mControl(nullptr)
+, mPathGeneration(-1)
+{
+}
+
+IUIControl* UIControlHandle::Get()
+{
+   int generation = IClickable::GetPathGeneration();
+   if (generation != mPathGeneration)
+   {
+      mControl = TheSynth->FindUIControl(mPath);
+      mPathGeneration = generation;
+   }
+   return mControl;
+}
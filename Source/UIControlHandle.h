@@ -0,0 +1,49 @@
+/**
+    bespoke synth, a software modular synthesizer
+    Copyright (C) 2021 Ryan Challinor (contact: awwbees@gmail.com)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**/
+/*
+  ==============================================================================
+
+    UIControlHandle.h
+    Created: 13 Jul 2021 8:52:40pm
+    Author:  Ryan Challinor
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include "OpenFrameworksPort.h"
+
+class IUIControl;
+
+//a ui control path that remembers what it resolved to, for callers that look up the same path over and over.
+//it only looks the path up again after something has been added, removed or renamed.
+class UIControlHandle
+{
+public:
+   UIControlHandle();
+   explicit UIControlHandle(string path);
+   
+   IUIControl* Get();
+   const string& GetPath() const { return mPath; }
+   
+private:
+   string mPath;
+   IUIControl* mControl;
+   int mPathGeneration;
+};
@@ -60,6 +60,8 @@ void UserPrefsEditor::CreateUIControls()
    CHECKBOX(mAutosaveCheckbox, "autosave", &mAutosave);
    TEXTENTRY(mRecordingsPathEntry, "recordings_path", 70, &mRecordingsPath);
    TEXTENTRY_NUM(mRecordBufferLengthEntry, "record_buffer_length_minutes", 5, &mRecordBufferLengthMinutes, 1, 120);
+   TEXTENTRY_NUM(mAudioWorkerThreadsEntry, "audio_worker_threads", 5, &mAudioWorkerThreads, 0, 64);
+   CHECKBOX(mDeterministicAudioGraphCheckbox, "deterministic_audio_graph", &mDeterministicAudioGraph);
    TEXTENTRY(mTooltipsFilePathEntry, "tooltips", 100, &mTooltipsFilePath);
    TEXTENTRY(mDefaultLayoutPathEntry, "layout", 100, &mDefaultLayoutPath);
    TEXTENTRY(mYoutubeDlPathEntry, "youtube-dl_path", 100, &mYoutubeDlPath);
@@ -138,6 +140,16 @@ void UserPrefsEditor::Show()
    else
       mRecordBufferLengthMinutes = TheSynth->GetUserPrefs()["record_buffer_length_minutes"].asDouble();
 
+   if (TheSynth->GetUserPrefs()["audio_worker_threads"].isNull())
+      mAudioWorkerThreads = 0;
+   else
+      mAudioWorkerThreads = TheSynth->GetUserPrefs()["audio_worker_threads"].asInt();
+
+   if (TheSynth->GetUserPrefs()["deterministic_audio_graph"].isNull())
+      mDeterministicAudioGraph = false;
+   else
+      mDeterministicAudioGraph = TheSynth->GetUserPrefs()["deterministic_audio_graph"].asBool();
+
    if (TheSynth->GetUserPrefs()["tooltips"].isNull())
       mTooltipsFilePath = "tooltips_eng.txt";
    else
@@ -388,6 +400,8 @@ void UserPrefsEditor::DrawModule()
    }
    DrawRightLabel(mZoomSlider, "(currently: " + ofToString(gDrawScale) + ")", ofColor::white);
    DrawRightLabel(mRecordingsPathEntry, "(default: recordings/)", ofColor::white);
+   DrawRightLabel(mAudioWorkerThreadsEntry, "(0 processes audio on the audio thread only, cores: " + ofToString(juce::SystemStats::getNumCpus()) + ")", ofColor::white);
+   DrawRightLabel(mDeterministicAudioGraphCheckbox, "(output matches single-threaded processing exactly, at the cost of some parallelism)", ofColor::white);
 }
 
 void UserPrefsEditor::DrawRightLabel(IUIControl* control, string text, ofColor color)
@@ -493,6 +507,8 @@ void UserPrefsEditor::ButtonClicked(ClickButton* button)
       UpdatePrefBool(userPrefs, "autosave", mAutosave);
       UpdatePrefStr(userPrefs, "recordings_path", mRecordingsPath);
       UpdatePrefFloat(userPrefs, "record_buffer_length_minutes", mRecordBufferLengthMinutes);
+      UpdatePrefInt(userPrefs, "audio_worker_threads", mAudioWorkerThreads);
+      UpdatePrefBool(userPrefs, "deterministic_audio_graph", mDeterministicAudioGraph);
       UpdatePrefStr(userPrefs, "tooltips", mTooltipsFilePath);
       UpdatePrefStr(userPrefs, "layout", mDefaultLayoutPath);
       UpdatePrefStr(userPrefs, "youtube-dl_path", mYoutubeDlPath);
@@ -107,6 +107,10 @@ private:
    string mRecordingsPath;
    TextEntry* mRecordBufferLengthEntry;
    float mRecordBufferLengthMinutes;
+   TextEntry* mAudioWorkerThreadsEntry;
+   int mAudioWorkerThreads;
+   Checkbox* mDeterministicAudioGraphCheckbox;
+   bool mDeterministicAudioGraph;
    TextEntry* mTooltipsFilePathEntry;
    string mTooltipsFilePath;
    TextEntry* mDefaultLayoutPathEntry;
@@ -29,15 +29,13 @@
 
 #define VOCODER_WINDOW_SIZE 1024
 #define FFT_FREQDOMAIN_SIZE VOCODER_WINDOW_SIZE/2 + 1
+#define VOCODER_HOP_SIZE VOCODER_WINDOW_SIZE/4
 
 Vocoder::Vocoder()
 : IAudioProcessor(gBufferSize)
-, mFFT(VOCODER_WINDOW_SIZE)
-, mRollingInputBuffer(VOCODER_WINDOW_SIZE)
-, mRollingOutputBuffer(VOCODER_WINDOW_SIZE)
-, mFFTData(VOCODER_WINDOW_SIZE, FFT_FREQDOMAIN_SIZE)
-, mRollingCarrierBuffer(VOCODER_WINDOW_SIZE)
-, mCarrierFFTData(VOCODER_WINDOW_SIZE, FFT_FREQDOMAIN_SIZE)
+, mAnalysis(VOCODER_WINDOW_SIZE, VOCODER_HOP_SIZE)
+, mSynthesis(VOCODER_WINDOW_SIZE, VOCODER_HOP_SIZE)
+, mCarrierAnalysis(VOCODER_WINDOW_SIZE, VOCODER_HOP_SIZE)
 , mInputPreamp(1)
 , mCarrierPreamp(1)
 , mVolume(1)
@@ -57,11 +55,6 @@ Vocoder::Vocoder()
 , mCutSlider(nullptr)
 , mCarrierDataSet(false)
 {
-   // Generate a window with a single raised cosine from N/4 to 3N/4
-   mWindower = new float[VOCODER_WINDOW_SIZE];
-   for (int i=0; i<VOCODER_WINDOW_SIZE; ++i)
-      mWindower[i] = -.5*cos(FTWO_PI*i/VOCODER_WINDOW_SIZE)+.5;
-
    mCarrierInputBuffer = new float[GetBuffer()->BufferSize()];
    Clear(mCarrierInputBuffer, GetBuffer()->BufferSize());
 
@@ -87,7 +80,6 @@ void Vocoder::CreateUIControls()
 
 Vocoder::~Vocoder()
 {
-   delete[] mWindower;
    delete[] mCarrierInputBuffer;
 }
 
@@ -133,49 +125,53 @@ void Vocoder::Process(double time)
 
    mGate.ProcessAudio(time, GetBuffer());
 
-   mRollingInputBuffer.WriteChunk(GetBuffer()->GetChannel(0), bufferSize, 0);
-   
-   //copy rolling input buffer into working buffer and window it
-   mRollingInputBuffer.ReadChunk(mFFTData.mTimeDomain, VOCODER_WINDOW_SIZE, 0, 0);
-   Mult(mFFTData.mTimeDomain, mWindower, VOCODER_WINDOW_SIZE);
-   Mult(mFFTData.mTimeDomain, inputPreampSq, VOCODER_WINDOW_SIZE);
-
-   mFFT.Forward(mFFTData.mTimeDomain,
-                mFFTData.mRealValues,
-                mFFTData.mImaginaryValues);
-
-   if (!fricative)
-   {
-      mRollingCarrierBuffer.WriteChunk(mCarrierInputBuffer, bufferSize, 0);
-   }
-   else
+   const float* carrier = mCarrierInputBuffer;
+   if (fricative)
    {
       //use noise as carrier signal if it's a fricative
       //but make the noise the same-ish volume as input carrier
       for (int i=0; i<bufferSize; ++i)
-         mRollingCarrierBuffer.Write(mCarrierInputBuffer[gRandom()%bufferSize]*2, 0);
+         gWorkBuffer[i] = mCarrierInputBuffer[gRandom()%bufferSize]*2;
+      carrier = gWorkBuffer;
    }
 
-   //copy rolling carrier buffer into working buffer and window it
-   mRollingCarrierBuffer.ReadChunk(mCarrierFFTData.mTimeDomain, VOCODER_WINDOW_SIZE, 0, 0);
-   Mult(mCarrierFFTData.mTimeDomain, mWindower, VOCODER_WINDOW_SIZE);
-   Mult(mCarrierFFTData.mTimeDomain, carrierPreampSq, VOCODER_WINDOW_SIZE);
+   //both analyses see the same hops, so their frames always line up
+   float* input = GetBuffer()->GetChannel(0);
+   float* wet = gWorkChannelBuffer.GetChannel(0);
+   for (int pos=0; pos<bufferSize;)
+   {
+      int numSamples = MIN(bufferSize - pos, mAnalysis.SamplesUntilFrame());
+      mSynthesis.Read(wet + pos, numSamples);
+      mCarrierAnalysis.Write(carrier + pos, numSamples, carrierPreampSq);
+      if (mAnalysis.Write(input + pos, numSamples, inputPreampSq))
+         ProcessFrame(mAnalysis.GetFrame(), mCarrierAnalysis.GetFrame());
+      pos += numSamples;
+   }
+
+   Mult(input, (1-mDryWet)*inputPreampSq, bufferSize);
+   Mult(wet, volSq * mDryWet, bufferSize);
+   Add(input, wet, bufferSize);
 
-   mFFT.Forward(mCarrierFFTData.mTimeDomain,
-                mCarrierFFTData.mRealValues,
-                mCarrierFFTData.mImaginaryValues);
+   Add(target->GetBuffer()->GetChannel(0), input, bufferSize);
 
+   GetVizBuffer()->WriteChunk(input, bufferSize, 0);
+
+   GetBuffer()->Reset();
+}
+
+void Vocoder::ProcessFrame(FFTData& frame, const FFTData& carrierFrame)
+{
    for (int i=0; i<FFT_FREQDOMAIN_SIZE; ++i)
    {
-      float real = mFFTData.mRealValues[i];
-      float imag = mFFTData.mImaginaryValues[i];
+      float real = frame.mRealValues[i];
+      float imag = frame.mImaginaryValues[i];
 
       //cartesian to polar
       float amp = 2.*sqrtf(real*real + imag*imag);
       //float phase = atan2(imag,real);
 
-      float carrierReal = mCarrierFFTData.mRealValues[i];
-      float carrierImag = mCarrierFFTData.mImaginaryValues[i];
+      float carrierReal = carrierFrame.mRealValues[i];
+      float carrierImag = carrierFrame.mImaginaryValues[i];
 
       //cartesian to polar
       float carrierAmp = 2.*sqrtf(carrierReal*carrierReal + carrierImag*carrierImag);
@@ -196,31 +192,11 @@ void Vocoder::Process(double time)
       real = amp*cos(phase);
       imag = amp*sin(phase);
 
-      mFFTData.mRealValues[i] = real;
-      mFFTData.mImaginaryValues[i] = imag;
+      frame.mRealValues[i] = real;
+      frame.mImaginaryValues[i] = imag;
    }
 
-   mFFT.Inverse(mFFTData.mRealValues,
-                mFFTData.mImaginaryValues,
-                mFFTData.mTimeDomain);
-
-   for (int i=0; i<bufferSize; ++i)
-      mRollingOutputBuffer.Write(0, 0);
-
-   //copy rolling input buffer into working buffer and window it
-   for (int i=0; i<VOCODER_WINDOW_SIZE; ++i)
-      mRollingOutputBuffer.Accum(VOCODER_WINDOW_SIZE-i-1, mFFTData.mTimeDomain[i] * mWindower[i] * .0001f, 0);
-
-   Mult(GetBuffer()->GetChannel(0), (1-mDryWet)*inputPreampSq, GetBuffer()->BufferSize());
-
-   for (int i=0; i<bufferSize; ++i)
-      GetBuffer()->GetChannel(0)[i] += mRollingOutputBuffer.GetSample(VOCODER_WINDOW_SIZE-i-1, 0) * volSq * mDryWet;
-
-   Add(target->GetBuffer()->GetChannel(0), GetBuffer()->GetChannel(0), bufferSize);
-
-   GetVizBuffer()->WriteChunk(GetBuffer()->GetChannel(0),bufferSize, 0);
-
-   GetBuffer()->Reset();
+   mSynthesis.AddFrame(frame, .0001f);
 }
 
 void Vocoder::DrawModule()
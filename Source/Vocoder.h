@@ -30,8 +30,7 @@
 #include "IAudioProcessor.h"
 #include "IDrawableModule.h"
 #include "Checkbox.h"
-#include "FFT.h"
-#include "RollingBuffer.h"
+#include "Stft.h"
 #include "Slider.h"
 #include "GateEffect.h"
 #include "BiquadFilterEffect.h"
@@ -71,19 +70,13 @@ private:
    void GetModuleDimensions(float& w, float& h) override { w=235; h=170; }
    bool Enabled() const override { return mEnabled; }
 
-   FFTData mFFTData;
-   
-   float* mWindower;
-
-   
+   void ProcessFrame(FFTData& frame, const FFTData& carrierFrame);
 
-   ::FFT mFFT;
-   RollingBuffer mRollingInputBuffer;
-   RollingBuffer mRollingOutputBuffer;
+   StftAnalysis mAnalysis;
+   StftSynthesis mSynthesis;
 
    float* mCarrierInputBuffer;
-   RollingBuffer mRollingCarrierBuffer;
-   FFTData mCarrierFFTData;
+   StftAnalysis mCarrierAnalysis;
 
    float mInputPreamp;
    float mCarrierPreamp;
@@ -51,9 +51,17 @@ Waveshaper::Waveshaper()
 , mDSlider(nullptr)
 , mE(0)
 , mESlider(nullptr)
+, mOversampleMode(Oversampler::kOff)
+, mOversampleDropdown(nullptr)
 , mExpressionValid(false)
 {
    mEntryString = "x";
+   
+   int maxLength = gBufferSize * Oversampler::kMaxFactor;
+   mInputHistory = new float[maxLength + 2];
+   mTimeBlock = new float[maxLength];
+   for (int i=0; i<kNumBlockParameters; ++i)
+      mParameterBlocks[i] = new float[maxLength];
 }
 
 void Waveshaper::CreateUIControls()
@@ -68,6 +76,9 @@ void Waveshaper::CreateUIControls()
    mCSlider = new FloatSlider(this,"c",mBSlider,kAnchor_Below,110,15,&mC,-10,10,4);
    mDSlider = new FloatSlider(this,"d",mCSlider,kAnchor_Below,110,15,&mD,-10,10,4);
    mESlider = new FloatSlider(this,"e",mDSlider,kAnchor_Below,110,15,&mE,-10,10,4);
+   mOversampleDropdown = new DropdownList(this,"oversample",mESlider,kAnchor_Below,&mOversampleMode,60);
+   
+   Oversampler::AddModeLabels(mOversampleDropdown);
    
    mSymbolTable.add_variable("x",mExpressionInput);
    mSymbolTable.add_variable("x1",mHistPre1);
@@ -81,7 +92,6 @@ void Waveshaper::CreateUIControls()
    mSymbolTable.add_variable("d",mD);
    mSymbolTable.add_variable("e",mE);
    mSymbolTable.add_constants();
-   mExpression.register_symbol_table(mSymbolTable);
    
    mSymbolTableDraw.add_variable("x",mExpressionInputDraw);
    mSymbolTableDraw.add_variable("x1",mExpressionInputDraw);
@@ -102,6 +112,10 @@ void Waveshaper::CreateUIControls()
 
 Waveshaper::~Waveshaper()
 {
+   delete[] mInputHistory;
+   delete[] mTimeBlock;
+   for (int i=0; i<kNumBlockParameters; ++i)
+      delete[] mParameterBlocks[i];
 }
 
 void Waveshaper::Process(double time)
@@ -122,15 +136,37 @@ void Waveshaper::Process(double time)
    {
       int bufferSize = GetBuffer()->BufferSize();
       
+      mOversampler.SetMode(mOversampleMode);
+      int oversampling = mOversampler.GetFactor();
+      int length = bufferSize * oversampling;
+      
+      const ExpressionProgram& program = mProgram.Get();
+      
+      //y1 and y2 feed each sample's output into the next one, so those expressions still have to go a sample at a time
+      bool runBlock = program.mCompiled.IsValid() &&
+                      !program.mCompiled.Uses(CompiledExpression::kVariableY1) &&
+                      !program.mCompiled.Uses(CompiledExpression::kVariableY2);
+      bool modulated = HasModulatedSliders();
+      if (runBlock)
+         PrepareBlockInputs(program.mCompiled, length, modulated, oversampling);
+      
       ChannelBuffer* out = target->GetBuffer();
       for (int ch=0; ch<GetBuffer()->NumActiveChannels(); ++ch)
       {
          float* buffer = GetBuffer()->GetChannel(ch);
-         if (mExpressionValid)
+         if (oversampling > 1)
+            buffer = mOversampler.Upsample(ch, buffer, bufferSize);
+         
+         if (runBlock)
+         {
+            ProcessBlock(program.mCompiled, ch, buffer, length, modulated, min, max);
+         }
+         else if (program.mValid)
          {
-            for (int i=0; i<bufferSize; ++i)
+            for (int i=0; i<length; ++i)
             {
-               ComputeSliders(i);
+               if (i % oversampling == 0)
+                  ComputeSliders(i / oversampling);
                mExpressionInput = buffer[i] * mRescale;
                
                mHistPre1 = mBiquadState[ch].mHistPre1;
@@ -143,8 +179,16 @@ void Waveshaper::Process(double time)
                if (mExpressionInput < min)
                   min = mExpressionInput;
                
-               mT = (gTime + i * gInvSampleRateMs) * .001;
-               buffer[i] = mExpression.value() / mRescale;
+               mT = (gTime + i * gInvSampleRateMs / oversampling) * .001;
+               if (program.mCompiled.IsValid())
+               {
+                  float variables[CompiledExpression::kNumVariables] = { mExpressionInput, mHistPre1, mHistPre2, mHistPost1, mHistPost2, mT, mA, mB, mC, mD, mE };
+                  buffer[i] = program.mCompiled.EvaluateSample(variables) / mRescale;
+               }
+               else
+               {
+                  buffer[i] = program.mExpression.value() / mRescale;
+               }
                
                mBiquadState[ch].mHistPre2 = mBiquadState[ch].mHistPre1;
                mBiquadState[ch].mHistPre1 = mExpressionInput;
@@ -152,6 +196,13 @@ void Waveshaper::Process(double time)
                mBiquadState[ch].mHistPost1 = ofClamp(buffer[i], -1, 1); //keep feedback from spiraling out of control
             }
          }
+         
+         if (oversampling > 1)
+         {
+            buffer = GetBuffer()->GetChannel(ch);
+            mOversampler.Downsample(ch, buffer, bufferSize);
+         }
+         
          Add(out->GetChannel(ch), buffer, bufferSize);
          GetVizBuffer()->WriteChunk(buffer, bufferSize, ch);
       }
@@ -163,12 +214,108 @@ void Waveshaper::Process(double time)
    GetBuffer()->Reset();
 }
 
+void Waveshaper::PrepareBlockInputs(const CompiledExpression& compiled, int length, bool modulated, int oversampling)
+{
+   if (compiled.Uses(CompiledExpression::kVariableT))
+   {
+      for (int i=0; i<length; ++i)
+         mTimeBlock[i] = (gTime + i * gInvSampleRateMs / oversampling) * .001;
+   }
+   
+   if (modulated)
+   {
+      for (int i=0; i<length; ++i)
+      {
+         if (i % oversampling == 0)
+            ComputeSliders(i / oversampling);
+         mParameterBlocks[kBlockRescale][i] = mRescale;
+         mParameterBlocks[kBlockA][i] = mA;
+         mParameterBlocks[kBlockB][i] = mB;
+         mParameterBlocks[kBlockC][i] = mC;
+         mParameterBlocks[kBlockD][i] = mD;
+         mParameterBlocks[kBlockE][i] = mE;
+      }
+   }
+   else
+   {
+      ComputeSliders(0);
+   }
+}
+
+void Waveshaper::ProcessBlock(CompiledExpression& compiled, int ch, float* buffer, int length, bool modulated, float& min, float& max)
+{
+   BiquadState& state = mBiquadState[ch];
+   mInputHistory[0] = state.mHistPre2;
+   mInputHistory[1] = state.mHistPre1;
+   float* input = mInputHistory + 2;
+   
+   BufferCopy(input, buffer, length);
+   if (modulated)
+      Mult(input, mParameterBlocks[kBlockRescale], length);
+   else
+      Mult(input, mRescale, length);
+   
+   for (int i=0; i<length; ++i)
+   {
+      if (input[i] > max)
+         max = input[i];
+      if (input[i] < min)
+         min = input[i];
+   }
+   
+   CompiledExpression::Inputs inputs;
+   inputs.SetBlock(CompiledExpression::kVariableX, input);
+   inputs.SetBlock(CompiledExpression::kVariableX1, input - 1);
+   inputs.SetBlock(CompiledExpression::kVariableX2, input - 2);
+   inputs.SetBlock(CompiledExpression::kVariableT, mTimeBlock);
+   const float parameters[] = { mA, mB, mC, mD, mE };
+   for (int i=0; i<5; ++i)
+   {
+      CompiledExpression::Variable variable = (CompiledExpression::Variable)(CompiledExpression::kVariableA + i);
+      if (modulated)
+         inputs.SetBlock(variable, mParameterBlocks[kBlockA + i]);
+      else
+         inputs.SetConstant(variable, parameters[i]);
+   }
+   
+   compiled.Evaluate(inputs, buffer, length);
+   
+   if (modulated)
+   {
+      for (int i=0; i<length; ++i)
+         buffer[i] /= mParameterBlocks[kBlockRescale][i];
+   }
+   else
+   {
+      Mult(buffer, 1 / mRescale, length);
+   }
+   
+   for (int i=MAX(0, length-2); i<length; ++i)
+   {
+      state.mHistPre2 = state.mHistPre1;
+      state.mHistPre1 = input[i];
+      state.mHistPost2 = state.mHistPost1;
+      state.mHistPost1 = ofClamp(buffer[i], -1, 1);
+   }
+}
+
 void Waveshaper::TextEntryComplete(TextEntry* entry)
 {
    exprtk::parser<float> parser;
-   mExpressionValid = parser.compile(mEntryString, mExpression);
-   if (mExpressionValid)
+   ExpressionProgram* program = new ExpressionProgram();
+   program->mExpression.register_symbol_table(mSymbolTable);
+   program->mValid = parser.compile(mEntryString, program->mExpression);
+   program->mCompiled.SetTableRange(-10, 10);  //full scale input at the highest rescale
+   if (program->mValid)
+   {
       parser.compile(mEntryString, mExpressionDraw);
+      
+      const unsigned int kAllVariables = (1 << CompiledExpression::kNumVariables) - 1;
+      program->mCompiled.Compile(mEntryString, kAllVariables);
+   }
+   
+   mExpressionValid = program->mValid;
+   mProgram.Publish(program);
 }
 
 void Waveshaper::DrawModule()
@@ -220,12 +367,13 @@ void Waveshaper::DrawModule()
    mCSlider->Draw();
    mDSlider->Draw();
    mESlider->Draw();
+   mOversampleDropdown->Draw();
 }
 
 void Waveshaper::GetModuleDimensions(float& w, float& h)
 {
    w = MAX(kGraphX + kGraphWidth + 2, 4 + mTextEntry->GetRect().width); 
-   h = kGraphY + kGraphHeight;
+   h = MAX(kGraphY + kGraphHeight, mOversampleDropdown->GetRect(true).getMaxY() + 2);
 }
 
 void Waveshaper::LoadLayout(const ofxJSONElement& moduleInfo)
@@ -32,9 +32,11 @@
 #include "Slider.h"
 #include "ClickButton.h"
 #include "TextEntry.h"
-#include "exprtk/exprtk.hpp"
+#include "DropdownList.h"
+#include "Oversampler.h"
+#include "ExpressionProgram.h"
 
-class Waveshaper : public IAudioProcessor, public IDrawableModule, public IFloatSliderListener, public ITextEntryListener
+class Waveshaper : public IAudioProcessor, public IDrawableModule, public IFloatSliderListener, public ITextEntryListener, public IDropdownListener
 {
 public:
    Waveshaper();
@@ -54,6 +56,9 @@ public:
    //ITextEntryListener
    void TextEntryComplete(TextEntry* entry) override;
    
+   //IDropdownListener
+   void DropdownUpdated(DropdownList* list, int oldVal) override {}
+   
    virtual void LoadLayout(const ofxJSONElement& moduleInfo) override;
    virtual void SetUpFromSaveData() override;
    
@@ -63,6 +68,9 @@ private:
    void GetModuleDimensions(float& w, float& h) override;
    bool Enabled() const override { return mEnabled; }
    
+   void PrepareBlockInputs(const CompiledExpression& compiled, int length, bool modulated, int oversampling);
+   void ProcessBlock(CompiledExpression& compiled, int ch, float* buffer, int length, bool modulated, float& min, float& max);
+   
    float mRescale;
    FloatSlider* mRescaleSlider;
    float mA;
@@ -75,11 +83,14 @@ private:
    FloatSlider* mDSlider;
    float mE;
    FloatSlider* mESlider;
+   int mOversampleMode;
+   DropdownList* mOversampleDropdown;
+   Oversampler mOversampler;   //x1, x2, y1, y2 and t all step at the oversampled rate
    
    string mEntryString;
    TextEntry* mTextEntry;
    exprtk::symbol_table<float> mSymbolTable;
-   exprtk::expression<float> mExpression;
+   AudioThreadSnapshot<ExpressionProgram> mProgram;
    exprtk::symbol_table<float> mSymbolTableDraw;
    exprtk::expression<float> mExpressionDraw;
    
@@ -90,7 +101,7 @@ private:
    float mHistPost2;
    float mExpressionInputDraw;
    float mT;
-   bool mExpressionValid;
+   bool mExpressionValid;   //ui thread, for drawing
    float mSmoothMax;
    float mSmoothMin;
    
@@ -109,4 +120,19 @@ private:
    };
    
    BiquadState mBiquadState[ChannelBuffer::kMaxNumChannels];
+   
+   enum BlockParameter
+   {
+      kBlockRescale,
+      kBlockA,
+      kBlockB,
+      kBlockC,
+      kBlockD,
+      kBlockE,
+      kNumBlockParameters
+   };
+   
+   float* mInputHistory;   //x2 and x1 from the end of the last buffer, followed by this buffer's x
+   float* mTimeBlock;
+   float* mParameterBlocks[kNumBlockParameters];
 };